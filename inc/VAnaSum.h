@@ -6,6 +6,8 @@
 #include "VOnOff.h"
 #include "VRatePlots.h"
 #include "VAnaSumRunParameter.h"
+#include "VFileChecksum.h"
+#include "VMSCWRunInfo.h"
 #include "VRunSummary.h"
 #include "VStatistics.h"
 #include "VStereoAnalysis.h"
@@ -23,6 +25,7 @@
 #include "TLatex.h"
 #include "TLeaf.h"
 #include "TMacro.h"
+#include "TNamed.h"
 #include "TStyle.h"
 #include "TSystem.h"
 #include "TTree.h"
@@ -44,11 +47,15 @@ class VAnaSum
 {
 	public:
 		VAnaSum( string i_datadir, unsigned int fMode );
-		~VAnaSum() {}
+		~VAnaSum();
 		
 		void doStereoAnalysis( bool iSkyPlots );
 		void initialize( string i_longlistfilename, string i_shortlistfilename, int i_singletel, unsigned int iRunType,
 						 string i_outfile, int iRandomSeed, string fRunParameterfile );
+		void setRunCacheDirectory( string iDir )
+		{
+			fRunCacheDir = iDir;
+		}
 		void terminate();
 		
 	private:
@@ -60,13 +67,22 @@ class VAnaSum
 							 double i_nevts_on, double i_nevts_off, double i_norm_alpha,
 							 double i_sig, double i_rate, double i_rateOFF, VOnOff* fstereo_onoff );
 		double getAzRange( int i_run, string i_treename, double& azmin, double& azmax );
+		void   getAzRangeFromDataTree( string iFileName, string i_treename, double& azmin, double& azmax );
 		double getNoiseLevel( int i_run );
+		string getRunCacheFileName( int i_run );
+		string getRunCacheKey( VAnaSumRunParameter* iRunPara, unsigned int i, string iRunParameterMD5, int iRandomSeed );
+		bool   isValidRunCacheFile( string iFileName, string iKey );
+		bool   updateRunCache( string i_LongListFilename, string i_ShortListFilename, int i_singletel,
+							   int iRandomSeed, string iRunParameterfile );
 		
 		set< int > fOldRunList;
+		set< int > fSelectedRuns;                 // analyse these runs only (empty: all runs in run list)
+		string fRunCacheDir;                      // directory with per-run anasum files (incremental analysis)
 		
 		unsigned int fAnalysisType;               // (see anasum.cpp)
 		unsigned int fAnalysisRunMode;            // 0: loop over all files (sequentiell)
 		// 1: combine several anasum result file and merge analysis results
+		// 2: incremental analysis (analyse new or changed runs into run cache, then as 1)
 		
 		VAnaSumRunParameter* fRunPara;            //!< all run parameters (run numbers, background models, etc.)
 		string fDatadir;                          //!< Directory containing the parameter data files
@@ -202,6 +202,8 @@ class VAnaSumRunParameter : public TNamed, public VGlobalRunParameter
 		bool fWriteAllEvents;
 		// write data_on and data_off trees (subset of DL3 tree)
 		bool fWriteDataOnOffTrees;
+		// directory for DL3 FITS files (one file per run; empty: no FITS output)
+		string fDL3FITSDirectory;
 		
 		// vector with all run parameters
 		vector< VAnaSumRunParameterDataClass > fRunList;
@@ -272,6 +274,6 @@ class VAnaSumRunParameter : public TNamed, public VGlobalRunParameter
 		bool writeListOfExcludedSkyRegions();
 		bool getListOfExcludedSkyRegions( TFile* f );
 		
-		ClassDef( VAnaSumRunParameter, 18 ) ;
+		ClassDef( VAnaSumRunParameter, 19 ) ;
 };
 #endif
@@ -4,11 +4,13 @@
 #define VBFDATAREADER_H
 
 #include "VBaseRawDataReader.h"
+#include "VBFPacketIndex.h"
 
 #include <VBankFileReader.h>
 #include <VPacket.h>
 
 #include <bitset>
+#include <climits>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -30,6 +32,15 @@ class VBFDataReader : public VBaseRawDataReader
 		
 		vector< bool > ib_temp;
 		
+		// event range (using stored packet index, otherwise checked for each decoded packet)
+		VBFPacketIndex* fPacketIndex;
+		VBFPacketIndex* fPacketIndexBuild;        // index filled while reading (stored after the last packet)
+		bool            fEventRange;
+		uint32_t        fFirstEventNumber;
+		uint32_t        fLastEventNumber;
+		unsigned int    fFirstPacket;
+		unsigned int    fLastPacket;
+		
 	public:
 		VBFDataReader( string,
 					   int isourcetype,
@@ -73,6 +84,7 @@ class VBFDataReader : public VBaseRawDataReader
 		uint16_t          getNumSamples();
 		bool              hasArrayTrigger();
 		bool              hasLocalTrigger( unsigned int iTel );
+		bool              setEventRange( uint32_t iFirstEvent, uint32_t iLastEvent, string iIndexDirectory = "" );
 		void              setPerformFADCAnalysis( bool iB )
 		{
 			iB = false;
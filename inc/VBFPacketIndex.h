@@ -0,0 +1,94 @@
+//! VBFPacketIndex persistent packet index for VBF files (event number, telescope presence, event type per packet)
+
+#ifndef VBFPACKETINDEX_H
+#define VBFPACKETINDEX_H
+
+#include <VArrayEvent.h>
+#include <VBankFileReader.h>
+#include <VPacket.h>
+#include <VSimulationData.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "TSystem.h"
+
+using namespace std;
+
+// index entry for one VBF packet
+struct sVBFPacketIndexEntry
+{
+	uint32_t  fPacket;                         // packet number (as used by VBankFileReader::readPacket())
+	uint32_t  fEventNumber;                    // array (trigger) event number or simulated event number
+	ULong64_t fTelescopeMask;                  // telescopes present in array event (bit coded)
+	uint8_t   fEventType;                      // array trigger event type (new style code)
+	uint8_t   fFlags;                          // content of packet (see VBFPacketIndex::e... flags)
+};
+
+class VBFPacketIndex
+{
+	private:
+	
+		bool   fDebug;
+		string fVBFFileName;
+		string fIndexDirectory;                    // directory for index files (empty: index is not stored)
+		string fIndexFileName;
+		
+		vector< sVBFPacketIndexEntry > fIndex;
+		
+		bool   buildIndex( VBankFileReader* iReader );
+		bool   getVBFFileInfo( Long64_t& iFileSize, Long_t& iFileModTime );
+		void   setFileNames( string iVBFFileName );
+		bool   readIndexFile( Long64_t iFileSize, Long_t iFileModTime );
+		bool   writeIndexFile( Long64_t iFileSize, Long_t iFileModTime );
+		
+	public:
+	
+		// packet content flags
+		static const uint8_t eArrayEvent = 1;
+		static const uint8_t eArrayTrigger = 2;
+		static const uint8_t eSimulationHeader = 4;
+		static const uint8_t eSimulationData = 8;
+		static const uint8_t eEventNumber = 16;
+		
+		VBFPacketIndex( bool iDebug = false );
+		~VBFPacketIndex() {}
+		
+		void           addPacket( const sVBFPacketIndexEntry& iEntry )
+		{
+			fIndex.push_back( iEntry );
+		}
+		const sVBFPacketIndexEntry& getEntry( unsigned int i )
+		{
+			return fIndex[i];
+		}
+		unsigned int   getFirstPacket( uint32_t iEventNumber );
+		unsigned int   getLastPacket( uint32_t iEventNumber );
+		unsigned int   getNPackets()
+		{
+			return fIndex.size();
+		}
+		unsigned int   getNEvents();
+		static sVBFPacketIndexEntry getPacketEntry( unsigned int iPacket, VPacket* iPack );
+		bool           hasEventNumber( unsigned int i )
+		{
+			return ( i < fIndex.size() && ( fIndex[i].fFlags & eEventNumber ) );
+		}
+		bool           hasSimulationHeader( unsigned int i )
+		{
+			return ( i < fIndex.size() && ( fIndex[i].fFlags & eSimulationHeader ) );
+		}
+		bool           open( string iVBFFileName, VBankFileReader* iReader = 0 );
+		bool           openIndexFile( string iVBFFileName );
+		void           reset( string iVBFFileName );
+		void           setIndexDirectory( string iDir )
+		{
+			fIndexDirectory = iDir;
+		}
+		bool           storeIndex( unsigned int iNPackets );
+};
+#endif
@@ -4,6 +4,7 @@
 #define VBASEDATAREADER_H
 
 #include "VDetectorGeometry.h"
+#include "VFileChecksum.h"
 #include "VMonteCarloRunHeader.h"
 #include "VNoiseFileReader.h"
 #include <VRawEventParser.h>
@@ -48,7 +49,7 @@ class VBaseRawDataReader : public VVirtualDataReader, public VSimulationDataRead
 		uint8_t           fNoiseFileFADCRange;
 		
 		double            finjectGaussianNoise;
-		TRandom3*         fRandomInjectGaussianNoise;
+		UInt_t            finjectGaussianNoiseSeed;
 		
 		// trace amplitude correction
 		vector< float > fTraceAmplitudeCorrectionS;
@@ -56,6 +57,9 @@ class VBaseRawDataReader : public VVirtualDataReader, public VSimulationDataRead
 		
 		VMonteCarloRunHeader* fMonteCarloHeader;
 		
+		// checksum of raw data file (computed while reading)
+		VFileChecksum*    fChecksum;
+		
 		// QADC values
 		std::valarray<double> fSums;
 		std::valarray<double> fTraceMax;
@@ -65,6 +69,17 @@ class VBaseRawDataReader : public VVirtualDataReader, public VSimulationDataRead
 		std::valarray<double> v;
 		std::vector< std::valarray<double> > vv;
 		
+		// trace post processing (noise and throughput correction)
+		std::vector< uint8_t > fTraceSampleBuffer;
+		std::vector< double >  fTraceAmplitudeBuffer;
+		
+		void                   getGaussianNoisePair( uint64_t iKey, unsigned int iPair, double& z0, double& z1 );
+		uint64_t               getGaussianNoiseKey( unsigned int channel );
+		static uint64_t        hashCounter( uint64_t x );
+		void                   updateChecksum( double iFraction );
+		void                   postProcessTrace( unsigned channel, unsigned iFirstSample, unsigned iNSamples,
+				uint8_t* iTrace, bool iNewNoiseTrace );
+				
 	public:
 		VBaseRawDataReader( string,
 							int isourcetype,
@@ -236,6 +251,8 @@ class VBaseRawDataReader : public VVirtualDataReader, public VSimulationDataRead
 			return 0;
 		}
 		uint8_t                     getSample( unsigned channel, unsigned sample, bool iNewNoiseTrace = true );
+		void                        getSamples_double( unsigned channel, unsigned iFirstSample, unsigned iNSamples,
+				vector< double >& iTrace );
 		std::vector< uint8_t >      getSamplesVec();
 		uint32_t                    getHitID( uint32_t i );
 		bool                        getHiLo( uint32_t i );
@@ -329,6 +346,10 @@ class VBaseRawDataReader : public VVirtualDataReader, public VSimulationDataRead
 		
 		void                       setDebug( bool iDebug = false );
 		
+		// checksum of raw data file
+		string                     finishChecksum();
+		bool                       initChecksum();
+		
 		VMonteCarloRunHeader* getMonteCarloHeader()
 		{
 			return fMonteCarloHeader;
@@ -332,6 +332,7 @@ class VCalibrationData
 		valarray<double>& getPedvars( bool iLowGain = false, unsigned int iSW = 0, double iTime = -99. );
 		unsigned int getTSTimeIndex( double iTime, unsigned int& i1, unsigned int& i2, double& ifrac1, double& ifrac2 );
 		
+		bool     readCache( istream& is );
 		void     recoverLowGainPedestals();
 		void    setIPRGraph( unsigned int iSumWindow, TGraphErrors* g );
 		bool 	setLowGainPedestalFile( string file )
@@ -357,6 +358,7 @@ class VCalibrationData
 			fSumWindow = isw;
 		}
 		bool     terminate( vector< unsigned int > a, vector< unsigned int > b, unsigned int iTraceIntegrationMethod, bool iDST = false );
+		void     writeCache( ostream& os );
 		bool     usePedestalsInTimeSlices( bool iB )
 		{
 			if( !iB )
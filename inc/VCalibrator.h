@@ -13,7 +13,9 @@
 #include "TH1F.h"
 #include "TLeaf.h"
 #include "TMath.h"
+#include "TMD5.h"
 #include "TProfile.h"
+#include "TROOT.h"
 #include "TSystem.h"
 #include "TTree.h"
 
@@ -21,14 +23,29 @@
 #include <map>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace std;
 
+// buffered pedestal and IPR histogram fills of one telescope type
+struct sPedestalFillBuffer
+{
+	vector< TH1F* > fHisto;
+	vector< double > fValue;
+};
+
+// job description for filling of pedestal and IPR histograms (list of telescope types)
+struct sPedestalFillJob
+{
+	vector< sPedestalFillBuffer* > fBuffer;
+};
+
 class VCalibrator : public VImageBaseAnalyzer
 {
 	private:
 		int fCalibrationfileVersion;
+		static const unsigned int fCalibrationCacheVersion = 1;   // version of binary calibration cache files
 		
 		bool fIPRAverageTel;                    // flag to make average of all telescopes IPR in case there is not enough statistics to produce IPR graphs
 		map< ULong64_t, int > fNumberPedestalEvents;        //!< number of events used in pedestal analysis
@@ -40,6 +57,8 @@ class VCalibrator : public VImageBaseAnalyzer
 		map< ULong64_t, vector< vector<TH1F* > > > hpedPerTelescopeType;  //<! one histogram per teltype/channel/sumwindow
 		map< ULong64_t, vector< vector<TH1F* > > > hped_vec;  //<! one histogram per telescope/channel/sumwindow
 		map< ULong64_t, TClonesArray* > fPedestalsHistoClonesArray;
+		map< ULong64_t, sPedestalFillBuffer > fPedestalFillBuffer;  //<! histogram fills per telescope type (filled in parallel)
+		unsigned int fPedestalFillBufferSize;                       //<! number of buffered histogram fills
 		TFile* opfgain;
 		TFile* opftoff;
 		vector<TH1F* > hgain;
@@ -87,6 +106,9 @@ class VCalibrator : public VImageBaseAnalyzer
 		vector< string > fLowGainTZeroFileNameC;
 		
 		TTree* fillCalibrationSummaryTree( unsigned int itel, string iName, vector<TH1F* > h );
+		void   fillPedestalHistogram( ULong64_t iTelType, TH1F* h, double iValue );
+		static void fillPedestalHistogramsJob( sPedestalFillJob* iJob );
+		void   flushPedestalFillBuffers();
 		bool   fillPedestalTree( unsigned int tel, VPedestalCalculator* iP );
 		bool   initializePedestalHistograms( ULong64_t iTelType, bool iLowGain,
 											 vector< double > minSumPerSumWindow,
@@ -97,7 +119,10 @@ class VCalibrator : public VImageBaseAnalyzer
 		unsigned int getNumberOfEventsUsedInCalibration( map< ULong64_t, int > iE, int iTelID );
 		TFile* getPedestalRootFile( ULong64_t iTel );
 		int  readLowGainCalibrationValues_fromCalibFile( string iVariable = "LOWGAINPED", unsigned int iTel = 9999, int iSumWindow = 9999 );
+		string getCalibrationCacheFileName();
+		string getCalibrationCacheKey();
 		string getCalibrationFileName( int iTel, int irun, string iSuffix, string name = "" );
+		bool readCalibrationCache();
 		void readCalibrationData();
 		bool readCalibrationDatafromDSTFiles( string iSourceFile );
 		void readfromVOFFLINE_DBText( int gain_or_toff, vector< unsigned int >& VchannelList, vector< double >& Vmean, vector< double >& Vrms );
@@ -124,6 +149,7 @@ class VCalibrator : public VImageBaseAnalyzer
 		void writePeds( bool iLowGain, VPedestalCalculator* iP = 0, bool iWriteAsciiFile = true );
 		void writeTOffsets( bool iLowGain = false );
 		void writeAverageTZeros( bool iLowGain = false );
+		bool writeCalibrationCache();
 		bool writeIPRgraphs( string iFile = "" );
 		
 		
@@ -7,6 +7,7 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <algorithm>
 #include <map>
 #include <set>
 #include <sstream>
@@ -14,6 +15,8 @@
 #include <vector>
 
 #include "TMath.h"
+#include "TMD5.h"
+#include "TSystem.h"
 #include <TSQLResult.h>
 #include <TSQLRow.h>
 #include <TSQLServer.h>
@@ -28,6 +31,14 @@ class VCameraRead : public VGlobalRunParameter
 {
 	private:
 	
+		static const unsigned int fGeometryCacheVersion = 1;   // version of binary geometry cache files
+		
+		bool                 findNeighbours( unsigned int iTelID, vector< vector< int > >& iNeighbour );
+		string               getGeometryCacheFileName( string iFile, string iKey );
+		string               getGeometryCacheKey( string iFile, unsigned int iNTel );
+		bool                 readGeometryCache( string iCacheFile, string iKey );
+		bool                 writeGeometryCache( string iCacheFile, string iKey );
+		
 	protected:
 		bool fDebug;
 		unsigned int fGrIsuVersion;               //!< GrIsu Version
@@ -39,6 +50,7 @@ class VCameraRead : public VGlobalRunParameter
 		map< unsigned int, unsigned int > fTelIDGrisu;
 		unsigned int fNTel;                       //!< number of telescopes
 		string fConfigDir;                        //!< directory with geometry config files
+		string fGeometryCacheDirectory;           //!< directory with binary geometry cache files (empty: no caching)
 		// telescope type
 		vector< ULong64_t > fTelType;
 		// telescope positions
@@ -367,6 +379,10 @@ class VCameraRead : public VGlobalRunParameter
 		{
 			fConfigDir = iDir;
 		}
+		void                 setGeometryCacheDirectory( string iDir )
+		{
+			fGeometryCacheDirectory = iDir;
+		}
 		bool                 setLengthOfSampleTimeSlice( unsigned int iTelID, float iSample_time_slice );
 		void                 setTelID_matrix( map< unsigned int, unsigned int > m )
 		{
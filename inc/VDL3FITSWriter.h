@@ -0,0 +1,82 @@
+//! VDL3FITSWriter streaming writer for DL3 event lists, good time intervals and effective areas (GADF FITS format)
+
+#ifndef VDL3FITSWRITER_H
+#define VDL3FITSWRITER_H
+
+#if defined(__CINT__)
+#define _SYS_TYPES_H_
+#endif
+
+#include <iostream>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "TGraphAsymmErrors.h"
+#include "TMath.h"
+
+#include <fitsio.h>
+
+#include "VTimeMask.h"
+
+using namespace std;
+
+class VDL3FITSWriter
+{
+	private:
+	
+		fitsfile* fFitsFile;
+		string    fFileName;
+		int       fRunNumber;
+		int       fEventsHDU;                  // HDU number of EVENTS table
+		
+		unsigned int fBufferSize;              // number of events buffered before writing to disk
+		long      fNRowsWritten;               // number of rows in EVENTS table on disk
+		
+		// time reference (MJD, UTC)
+		static const int fMJDREFI = 51910;
+		
+		double    fTStart;                     // start of first good time interval [s since MJDREF]
+		double    fTStop;                      // end of last good time interval [s since MJDREF]
+		double    fOnTime;                     // sum of all good time intervals [s]
+		
+		// event buffers (one vector per column of the EVENTS table)
+		vector< LONGLONG > fEVENT_ID;
+		vector< double > fTIME;
+		vector< float >  fRA;
+		vector< float >  fDEC;
+		vector< float >  fENERGY;
+		vector< float >  fALT;
+		vector< float >  fAZ;
+		vector< short >  fMULTIP;
+		vector< float >  fCOREX;
+		vector< float >  fCOREY;
+		vector< float >  fHIL_MSW;
+		vector< float >  fHIL_MSL;
+		
+		void clearBuffers();
+		bool flushEvents();
+		bool printerror( int status );
+		bool writeHDUClassKeys( string iClass1, string iClass2 = "", string iClass3 = "", string iClass4 = "" );
+		
+	public:
+	
+		VDL3FITSWriter( unsigned int iBufferSize = 10000 );
+		~VDL3FITSWriter();
+		bool close( double iDeadTimeFraction = 0. );
+		void fillEvent( int iEventNumber, int iMJD, double iTime, double iRA, double iDec, double iEnergy,
+						double iAlt, double iAz, int iMultiplicity, double iCoreX, double iCoreY,
+						double iMSCW, double iMSCL );
+		long getNumberOfEvents()
+		{
+			return fNRowsWritten + ( long )fTIME.size();
+		}
+		bool isOpen()
+		{
+			return ( fFitsFile != 0 );
+		}
+		bool open( string iFileName, int iRunNumber, string iObject, double iRA_PNT, double iDec_PNT );
+		bool writeEffectiveArea( TGraphAsymmErrors* g, double iOffsetMax, double iRadMax );
+		bool writeGTI( VTimeMask* iMask );
+};
+#endif
@@ -21,7 +21,8 @@ class VDetectorGeometry : public VCameraRead
 		VDetectorGeometry() {}
 		VDetectorGeometry( unsigned int iNTel, bool iDebug = false );
 		VDetectorGeometry( unsigned int iNTel, vector< string > iCamera, string iDir, bool iDebug = false,
-						   float iCoordinateTransformerX = 1., float iCoordinateTransformerY = 1., int iSourceType = 3 );
+						   float iCoordinateTransformerX = 1., float iCoordinateTransformerY = 1., int iSourceType = 3,
+						   string iGeometryCacheDirectory = "" );
 		~VDetectorGeometry() {}
 		vector< unsigned int > getNChannels()
 		{
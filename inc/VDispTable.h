@@ -14,13 +14,90 @@
 #include "TMath.h"
 #include "TProfile2D.h"
 #include "TProfile3D.h"
+#include "TROOT.h"
 
 #include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace std;
 
+/*
+ * mergeable statistics for disp tables
+ *
+ * sums, sums of squares and counts per table bin (same bin numbering
+ * as TH1::GetBin(), including under/overflow bins) for disp, dispPhi and miss;
+ * partial fills can be combined exactly with add(); the sums are stored
+ * with the disp tables (getSparseStatistics()) and tables from different
+ * fills are combined exactly with addSparseStatistics()
+ */
+class VDispTableStatistics
+{
+	private:
+	
+		vector< int >    fNBins;           // number of bins per axis (without under/overflow)
+		vector< double > fMin;
+		vector< double > fMax;
+		double fValueMin;                  // accepted range of values (not applied for fValueMin >= fValueMax)
+		double fValueMax;
+		
+		vector< double > fEvents;          // number of events per bin
+		vector< vector< double > > fN;     // number of values per bin [value type][bin]
+		vector< vector< double > > fSum;
+		vector< vector< double > > fSum2;
+		
+	public:
+	
+		enum E_DispTableValue { E_DISP, E_PHI, E_MISS };
+		
+		VDispTableStatistics( TH1* iH, double iValueMin = 0., double iValueMax = 0. );
+		~VDispTableStatistics() {}
+		bool   add( VDispTableStatistics* iS );
+		bool   addEventHistogram( TH1* iHN );
+		bool   addHistogram( unsigned int iValue, TH1* iH, TH1* iHN );
+		bool   addSparseStatistics( vector< int >* iBin, vector< double >* iValue );
+		void   fill( unsigned int iValue, int iBin, double iV );
+		void   fillEvent( int iBin )
+		{
+			fEvents[iBin]++;
+		}
+		bool   fillHistogram( unsigned int iValue, TH1* iH );
+		bool   fillEventHistogram( TH1* iH );
+		int    getBin( double x, double y, double z = 0. );
+		double getMean( unsigned int iValue, int iBin )
+		{
+			if( fN[iValue][iBin] > 0. )
+			{
+				return fSum[iValue][iBin] / fN[iValue][iBin];
+			}
+			return 0.;
+		}
+		unsigned int getNBins()
+		{
+			return fEvents.size();
+		}
+		void   getSparseStatistics( vector< int >* iBin, vector< double >* iValue );
+		void   reset();
+};
+
+class VDispTable;
+
+// job description for filling disp tables for a range of entries in a MC file
+struct sDispTableFillJob
+{
+	VDispTable* fTable;
+	string   fMCFile;
+	Long64_t fFirstEntry;
+	Long64_t fLastEntry;
+	bool     bMissPass;                                   // second pass: fill miss tables
+	vector< VDispTableStatistics* > f2D;                  // statistics per azimuth bin
+	vector< VDispTableStatistics* > f3D;
+	double   fPedvarSum;
+	double   fPedvarN;
+	bool     bSuccess;
+};
+
 class VDispTable
 {
 	private:
@@ -30,15 +107,20 @@ class VDispTable
 		vector< float > fAz_min;
 		vector< float > fAz_max;
 		// 2D histograms
-		vector< TProfile2D* > h2D_AzDispTable;
-		vector< TH2F* >       h2D_AzDispTableN;
-		vector< TProfile2D* > h2D_AzDispPhiTable;
-		vector< TProfile2D* > h2D_AzDispMissTable;
+		vector< TH2F* > h2D_AzDispTable;
+		vector< TH2F* > h2D_AzDispTableN;
+		vector< TH2F* > h2D_AzDispPhiTable;
+		vector< TH2F* > h2D_AzDispMissTable;
 		// 3D histograms
-		vector< TProfile3D* > h3D_AzDispTable;
-		vector< TH3F* >       h3D_AzDispTableN;
-		vector< TProfile3D* > h3D_AzDispPhiTable;
-		vector< TProfile3D* > h3D_AzDispMissTable;
+		vector< TH3F* > h3D_AzDispTable;
+		vector< TH3F* > h3D_AzDispTableN;
+		vector< TH3F* > h3D_AzDispPhiTable;
+		vector< TH3F* > h3D_AzDispMissTable;
+		// table statistics (sums per bin; merged from all fill jobs)
+		vector< VDispTableStatistics* > f2D_AzStatistics;
+		vector< VDispTableStatistics* > f3D_AzStatistics;
+		
+		unsigned int fNThreads;
 		
 		TFile* fTableFile;
 		VDispTableReader* fData;
@@ -55,6 +137,8 @@ class VDispTable
 		
 		bool prepareTraining( string );
 		bool isGoodEvent( Ctpars* );                              // check quality cuts
+		bool runFillJobs( vector< sDispTableFillJob >& iJobs );
+		static void fillTableJob( sDispTableFillJob* iJob );
 		
 	public:
 	
@@ -63,6 +147,10 @@ class VDispTable
 		~VDispTable() {}
 		void addAzBin( float iMin, float iMax, bool iPE = false );
 		bool fillTable( string iMCfile, float i_ze, float i_woff, int iNentries = -1 );
+		void setNumberOfThreads( unsigned int iNThreads = 1 )
+		{
+			fNThreads = iNThreads;
+		}
 		void setNoise( unsigned int k, float iNoise )
 		{
 			if( fData )
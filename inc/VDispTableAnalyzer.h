@@ -25,6 +25,15 @@ struct sDispTableEventData
 	float disp;
 };
 
+// resident copy of disp tables (see VDispTableAnalyzer::fillTableCache())
+struct sDispTableCache
+{
+	bool bFilled;
+	vector< vector< double > > fBinEdges;   // bin edges for each table axis
+	unsigned int fNCells;                    // number of bins per table (incl. under/overflow bins)
+	vector< float > fData;                   // table values (flat array)
+};
+
 class VDispTableAnalyzer
 {
 	private:
@@ -44,7 +53,12 @@ class VDispTableAnalyzer
 		vector< float > x_disp;          // x coordinate of disp calculation
 		vector< float > y_disp;          // y coordinate of disp calculation
 		
-		float calculateDisp( float iWidth, float iLength, float iSize, float iPedvar, float iZe, float iAz, bool b2D = true );
+		// disp tables (2D: width/length vs size; 3D: width vs length vs size)
+		sDispTableCache f2DTable;
+		sDispTableCache f3DTable;
+		
+		bool  fillTableCache( bool b2D );
+		int   getTableCell( sDispTableCache* iC, float iWidth, float iLength, float iSize, bool b2D );
 		double interpolate( double w1, double ze1, double w2, double ze2, double ze, bool iCos = false );
 		
 	public:
@@ -28,8 +28,6 @@ class VDispTableReader : public TNamed
 		TList* hisList;
 		TTree* fData;
 		
-		void         getIndexBoundary( unsigned int* ib, unsigned int* il, vector< float >& iV, float x );
-		unsigned int getTreeEntryID( int i_found_ze, int i_found_az, int i_found_woff, int i_found_noise );
 		bool         isHistoBinningSet( string iVarName );
 		
 	public:
@@ -57,6 +55,13 @@ class VDispTableReader : public TNamed
 		TH3F* h3D_DispPhiTable;
 		TH3F* h3D_DispTableN;
 		TH3F* h3D_DispMissTable;
+		// mergeable table statistics (double precision; bins with events only;
+		// see VDispTableStatistics::getSparseStatistics())
+		vector< int >*    f2D_StatisticsBin;            //!
+		vector< double >* f2D_Statistics;               //!
+		vector< int >*    f3D_StatisticsBin;            //!
+		vector< double >* f3D_Statistics;               //!
+		bool              bStatistics;                  //! statistics branches available
 		// histogram binning
 		vector< string > fHisto_ListOfVariables;
 		map< string, int >    fHisto_binning;
@@ -73,6 +78,7 @@ class VDispTableReader : public TNamed
 		
 		bool fill( float i_ze, unsigned int i_az, float i_az_min, float i_az_max, float i_woff, float i_meanPedvars, TH2* iH2D, TH2* iH2DN, TH2* h2DPhi, TH2* h2DMiss, TH3* iH3D, TH3* iH3DN, TH3* h3DPhi, TH3* h3DMiss );
 		unsigned int getAzBin( float az );
+		void         getIndexBoundary( unsigned int* ib, unsigned int* il, vector< float >& iV, float x );
 		float getLowerZe( float );
 		float getUpperZe( float );
 		TTree* getTree()
@@ -81,7 +87,12 @@ class VDispTableReader : public TNamed
 		}
 		int  getTreeEntryFinder( unsigned int );
 		int  getTreeEntryFinder( float iZe, float iAz, float iWoff, float iPedvar, int iZe_Inter );
-		bool initialize( bool iRead = true );
+		unsigned int getTreeEntryID( int i_found_ze, int i_found_az, int i_found_woff, int i_found_noise );
+		bool hasStatistics()
+		{
+			return bStatistics;
+		}
+		bool initialize( bool iRead = true, bool iReadStatistics = false );
 		bool plot( int iEntry = 0 );
 		void print( bool bDetailed = false );
 		void reset();
@@ -110,6 +121,6 @@ class VDispTableReader : public TNamed
 		}
 		void terminate();
 		
-		ClassDef( VDispTableReader, 6 );
+		ClassDef( VDispTableReader, 7 );
 };
 #endif
@@ -38,6 +38,42 @@
 
 using namespace std;
 
+// cut decisions for a single event
+// (evaluated once and shared between effective area and resolution filling)
+struct sEffectiveAreaCutDecision
+{
+	bool bMCXYoff;
+	bool bFiducialArea;
+	bool bStereoQuality;
+	bool bStereoQualityIRF;                   // stereo quality cut for energy reconstruction method used for IRFs
+	bool bTelType;
+	bool bDirection;
+	bool bEnergyQuality;
+	bool bEnergyReconstructed;
+	bool bGamma;
+};
+
+// interpolated effective area for a given query point (ze, woff, noise, spectral index)
+// (bracketing bins are resolved once per query point; curves are reused until
+//  the query moves to different bins)
+struct sEffectiveAreaInterpolation
+{
+	bool   bValid;
+	double fZe;                               // last query point
+	double fWoff;
+	double fPedVar;
+	double fSpectralIndex;
+	
+	unsigned int fZeBins[2];                  // bracketing bins
+	unsigned int fWoffBins[4];                // [ze*2+woff]
+	unsigned int fNoiseBins[8];               // [(ze*2+woff)*2+noise]
+	
+	vector< vector< double > > fIndexCurves;  // interpolated in spectral index (8 curves)
+	vector< vector< double > > fNoiseCurves;  // interpolated in noise (4 curves)
+	vector< vector< double > > fWoffCurves;   // interpolated in wobble offset (2 curves)
+	vector< double > fEff;                    // interpolated effective area curve
+};
+
 class VEffectiveAreaCalculator
 {
 	private:
@@ -279,6 +315,12 @@ class VEffectiveAreaCalculator
 		double fsolid_angle_norm;                   // solid angle normalisation needed for the CRweight filled in fAcceptance_AfterCuts_tree (for the histogram it is done later in VSensitivityCalculator)
 		void Calculate_Bck_solid_angle_norm();
 		
+		// event loop state (set in initializeFill())
+		unsigned int fFill_EnergyReconstructionMethod;
+		Long64_t     fFill_FirstEntry;
+		int          fFill_AzBinIndex;
+		Long64_t     fFill_EventsAfterCuts;
+		
 		
 		// effective area smoothing
 		int fSmoothIter;
@@ -294,6 +336,7 @@ class VEffectiveAreaCalculator
 		double fEffectiveAreas_meanPedVar;
 		double fEffectiveAreas_meanIndex;
 		double fEffectiveAreas_meanN;
+		sEffectiveAreaInterpolation fEffAreaInterpolation;
 		
 		// effective areas fit functions
 		vector< TF1* > fEffAreaFitFunction;
@@ -318,15 +361,23 @@ class VEffectiveAreaCalculator
 												double iSpectralIndex, bool bAddtoMeanEffectiveArea = true,
 												int iEffectiveAreaVsEnergyMC = 2 );
 		bool   getMonteCarloSpectra( VEffectiveAreaCalculatorMCHistograms* );
+		bool   getReconstructedEnergy( CData* d, double& eRec, double& eRecLin );
+		double getEffectiveAreaAtEnergy( double lerec, const vector< double >& iEff, bool bAddtoMeanEffectiveArea );
+		const vector< double >* getInterpolatedEffectiveArea( double ze, double woff, double iPedVar, double iSpectralIndex );
 		double getMCSolidAngleNormalization();
-		vector< unsigned int > getUpperLowBins( vector< double > i_values, double d );
+		vector< unsigned int > getUpperLowBins( const vector< double >& i_values, double d );
 		bool   initializeEffectiveAreasFromHistograms( TTree*, TH1D*, double azmin, double azmax, double ispectralindex, double ipedvar, TTree* iEffAreaH2F = 0 );
 		vector< double > interpolate_effectiveArea( double iV, double iVLower, double iVupper,
-				vector< double > iEL, vector< double > iEU, bool iCos = true );
+				const vector< double >& iEL, const vector< double >& iEU, bool iCos = true );
+		void   interpolate_effectiveArea( double iV, double iVLower, double iVupper,
+										  const vector< double >& iEL, const vector< double >& iEU,
+										  vector< double >& iEResult, bool iCos );
 				
 		TH2F*  interpolate_responseMatrix( double iV, double iVLower, double iVupper, TH2F* iElower, TH2F* iEupper, bool iCos = true );
 		void   multiplyByScatterArea( TGraphAsymmErrors* g );
 		void   reset();
+		bool   resolveEffectiveAreaBins( double ze, double woff, double iPedVar,
+										 unsigned int* iZeBins, unsigned int* iWoffBins, unsigned int* iNoiseBins );
 		void   smoothEffectiveAreas( map< unsigned int, vector< double > > );
 		
 	public:
@@ -338,8 +389,15 @@ class VEffectiveAreaCalculator
 		~VEffectiveAreaCalculator();
 		
 		void cleanup();
+		void evaluateCuts( CData* d, Long64_t i, sEffectiveAreaCutDecision& iCut,
+						   bool bEffectiveAreas = true, bool bIRF = false, unsigned int iIRFMethod = 0 );
 		bool fill( TH1D* hE0mc, CData* d, VEffectiveAreaCalculatorMCHistograms* iMC_histo, unsigned int iMethod );
+		void fillEvent( CData* d, sEffectiveAreaCutDecision& iCut );
 		TH1D*     getHistogramhEmc();
+		Long64_t  getFirstEntryToFill()
+		{
+			return fFill_FirstEntry;
+		}
 		TGraphErrors* getMeanSystematicErrorHistogram();
 		TTree* getTree()
 		{
@@ -377,7 +435,9 @@ class VEffectiveAreaCalculator
 		
 		void setTimeBinnedMeanEffectiveArea();
 		void setTimeBinnedMeanEffectiveAreaMC( double i_time );
+		bool terminateFill();
 		
+		bool initializeFill( CData* d, VEffectiveAreaCalculatorMCHistograms* iMC_histo, unsigned int iMethod );
 		void initializeHistograms( vector< double > iAzMin, vector< double > iAzMax, vector< double > iSpectralIndex );
 		void resetHistograms( unsigned int iZe );
 		void resetHistogramsVectors( unsigned int iZe );
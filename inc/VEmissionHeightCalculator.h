@@ -36,8 +36,22 @@ class VEmissionHeightCalculator
 		vector< double > fTelY;
 		vector< double > fTelZ;
 		
-		double getTelescopeDistanceSC( unsigned int iTel1, unsigned int iTel2, double az, double z );
+		// telescope positions projected onto the plane perpendicular
+		// to the pointing direction (updated only if pointing changes)
+		double fPointingAz;
+		double fPointingEl;
+		vector< double > fTelXSC;
+		vector< double > fTelYSC;
+		vector< double > fTelZSC;
+		
+		// images used in the current event
+		vector< unsigned int > fImgTel;
+		vector< double > fImgX;
+		vector< double > fImgY;
+		vector< double > fImgInvLogSize;         // 1./log10(size)
+		
 		double imageDistance( double c1x, double c2x, double c1y, double c2y );
+		void   updatePointing( double az, double el );
 		
 	public:
 	
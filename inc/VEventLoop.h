@@ -25,6 +25,7 @@
 
 #include "VDeadPixelOrganizer.h"
 
+#include <climits>
 #include <iostream>
 #include <map>
 #include <string>
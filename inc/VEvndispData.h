@@ -24,6 +24,7 @@
 #include "VPointing.h"
 #include "VArrayPointing.h"
 #include "VTraceHandler.h"
+#include "VTreeIOPolicy.h"
 
 #include "TDirectory.h"
 #include "TFile.h"
@@ -123,6 +124,7 @@ class VEvndispData
 		//!< data class with analysis results from all telescopes
 		static VShowerParameters* fShowerParameters;
 		static VMCParameters* fMCParameters;      //!< data class with MC parameters
+		static VTreeIOPolicy* fTreeIOPolicy;      //!< I/O settings for output trees
 		
 		// timing results
 		static vector< TGraphErrors* > fXGraph;   //!< Long axis timing graph
@@ -715,6 +717,7 @@ class VEvndispData
 		{
 			return fOutputfile;
 		}
+		VTreeIOPolicy*      getTreeIOPolicy();
 		bool                getPedsFromPLine()
 		{
 			return fCalData[fTelID]->fPedFromPLine;
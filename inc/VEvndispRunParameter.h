@@ -71,8 +71,12 @@ class VEvndispRunParameter : public TNamed, public VGlobalRunParameter
 		int    fsourcetype;                       // source type (0=rawdata,1=GrIsu,2=MC in vbf format,3=Rawdata in vbf,4=DST,5=multiple GrIsu file)
 		bool   fRunIsZeroSuppressed;              // run is zero suppressed
 		string fsourcefile;                       // name of data file
+		bool   fComputeChecksum;                  // compute MD5 checksum of raw data file while reading (VBF files)
+		string fSourceFileChecksum;               // MD5 checksum of raw data file
 		int    fnevents;                          // total number of events to be analyzed
 		int    fFirstEvent;                       // skip up till this event
+		int    fLastEvent;                        // stop after this event (VBF files only; uses packet index)
+		string fVBFPacketIndexDirectory;          // directory for VBF packet index files (empty: index is not stored)
 		int    fTimeCutsMin_min;                  // start to analyse run at this min
 		int    fTimeCutsMin_max;                  // stop to analyse this run at this min
 		
@@ -107,6 +111,7 @@ class VEvndispRunParameter : public TNamed, public VGlobalRunParameter
 		// array/telescope geometry parameters
 		unsigned int fNTelescopes;                // number of telescopes
 		vector<string> fcamera;                   // name of camera configuration files
+		string fGeometryCacheDirectory;           // directory for binary geometry caches (empty: no caching)
 		vector< unsigned int > fTelToAnalyze;     // analyze only this telescope (Telescope 1 = 0!! )
 		bool   fUseVBFSampleLength;               // use number of samples from VBF file (ignore .cfg file)
 		
@@ -140,6 +145,8 @@ class VEvndispRunParameter : public TNamed, public VGlobalRunParameter
 		bool fWriteExtraCalibTree;		  // write additional tree into .gain.root file with channel charges/monitor charge/nHiLo for each event
 		bool fWriteImagePixelList;        // write image pixel list to tpars tree
 		string fLowGainCalibrationFile;           // file with file name for low-gain calibration
+		string fCalibrationCacheDirectory;        // directory for binary calibration caches (empty: no caching)
+		unsigned int fCalibrationNThreads;        // number of threads for filling of pedestal histograms (per telescope type)
 		int fNCalibrationEvents;                  // events to be used for calibration
 		float faverageTZeroFiducialRadius;        // fiducial radius for average tzero calculation (DST), in fraction of FOV
 		unsigned int fCombineChannelsForPedestalCalculation; // combine all channels per telescope type for the pedestal calculation
@@ -200,6 +207,7 @@ class VEvndispRunParameter : public TNamed, public VGlobalRunParameter
 		vector< double > fSumWindowMaxTimedifferenceToDoublePassPosition; // maximum difference between doublepass calculated window start and t0 (in samples, default: 10 )
 		double ftracefit;                         // tracefit mode or getquick mode (-1.=no fitting, 0=fit all PMTs, else: fit only PMTs with maximum ftracefit x tracerms
 		string ftracefitfunction;                 // number of tracefit function (default=ev, others: grisu);
+		bool   ftracefitMinuit;                   // fit traces with Minuit (default: fast Levenberg-Marquardt fit, VPulseFitter)
 		bool   fperformFADCAnalysis;              // run FADC analysis (important e.g. for CTA DST files, where sim_tel results are available as well )
 		
 		float  fFADCtoPhe[VDST_MAXTELTYPES];                  //! default conversion factor c[phes/fadc]: [phes]=c*[fadc] for certain integ. window (4slices)
@@ -254,6 +262,11 @@ class VEvndispRunParameter : public TNamed, public VGlobalRunParameter
 		unsigned int fwriteMCtree;                // 0: do not write MC tree
 		bool fWriteTriggerOnly;                   // true: write triggered events for simulation only
 		bool fFillMCHistos;                       // true: fill MC histograms with thrown events
+		string fTreeCompression;                  // compression of output trees (ALGORITHM:LEVEL, e.g. ZSTD:5; empty = ROOT default)
+		Long64_t fTreeAutoFlush;                  // auto flush of output trees (>0: entries; <0: bytes; 0: ROOT default)
+		int fTreeBasketSize;                      // basket size of all branches of output trees (0: ROOT default)
+		vector< string > fTreeBranchBasketSize;   // basket sizes of individual branches (BRANCHNAME:BYTES)
+		unsigned int fTreeIOThreads;              // number of threads for parallel basket compression (0: off)
 		
 		// display parameters
 		bool   fdisplaymode;                      // display mode or command line mode
@@ -332,6 +345,6 @@ class VEvndispRunParameter : public TNamed, public VGlobalRunParameter
 			return ( fDBTextDirectory.size() > 0 );
 		}
 		
-		ClassDef( VEvndispRunParameter, 2007 ); //(increase this number)
+		ClassDef( VEvndispRunParameter, 2015 ); //(increase this number)
 };
 #endif
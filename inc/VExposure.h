@@ -15,6 +15,7 @@
 #include <iostream>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 #include <bitset>
 
@@ -40,6 +41,43 @@
 
 using namespace std;
 
+// precomputed geometry and acceptance kernel for exposure map filling (shared by all fill jobs)
+struct sExposureMapKernel
+{
+	vector< double > fAcceptance;                 // acceptance in bins of equal solid angle (1-cos(r))
+	double           fStep;                       // kernel bin width in 1-cos(r)
+	double           fCosRMax;                    // cos( maximum integration radius )
+	double           fCosRAcc;                    // cos( acceptance cutoff ) (kernel range; acceptance is 0 beyond)
+	int              fWindowB;                    // integration window in latitude (bins)
+	vector< int >    fWindowL;                    // integration window in longitude (bins; per map row)
+	vector< double > fSinL;                       // map columns
+	vector< double > fCosL;
+	vector< double > fSinB;                       // map rows
+	vector< double > fCosB;
+	vector< int >    fRunBinL;                    // runs
+	vector< int >    fRunBinB;
+	vector< double > fRunSinL;
+	vector< double > fRunCosL;
+	vector< double > fRunSinB;
+	vector< double > fRunCosB;
+	vector< double > fRunWeight;                  // run duration [h]
+};
+
+// job description for filling the exposure maps for a subset of map rows
+struct sExposureMapFillJob
+{
+	const sExposureMapKernel* fKernel;
+	int       fNBinsL;
+	int       fNBinsB;
+	Double_t* fMap;                               // bin contents and squared weights of the maps
+	Double_t* fMapW2;
+	Double_t* fAccMap;
+	Double_t* fAccMapW2;
+	int       fFirstRow;                          // rows fFirstRow, fFirstRow + fRowStep, ...
+	int       fRowStep;
+	Long64_t  fNEntries;
+};
+
 class VExposure : public TObject, public VGlobalRunParameter
 {
 	private:
@@ -129,6 +167,9 @@ class VExposure : public TObject, public VGlobalRunParameter
 		TH2D* fRadAccMapGal2D;
 		TH2D* fMapGal2D_aitoff;
 		TH2D* fRadAccMapGal2D_aitoff;
+		vector< int > fAitoffBin;                 //! bin in aitoff maps for each bin of the galactic maps
+		
+		unsigned int fNThreads;
 		
 		TH1D* fTimeDifferencesBetweenRuns;
 		
@@ -147,6 +188,7 @@ class VExposure : public TObject, public VGlobalRunParameter
 		void   aitoff2xy( Double_t l, Double_t b, Double_t& Al, Double_t& Ab );
 		bool   doDQM( unsigned int iIndex, double iMinDuration = 600. );
 		void   drawAitoffCoordinateSystem();
+		static void fillExposureMapJob( sExposureMapFillJob* iJob );
 		double getAcceptance( double r );
 		void   getDBMJDTime( string itemp, int& MJD, double& Time, bool bStrip );
 		bool   getDBSourceCoordinates( TSQLServer* f_db, string iSource, double& iEVNTargetDec, double& iEVNTargetRA );
@@ -206,6 +248,10 @@ class VExposure : public TObject, public VGlobalRunParameter
 		{
 			fDoCheckSums = iB;
 		}
+		void setNumberOfThreads( unsigned int iNThreads = 1 )
+		{
+			fNThreads = iNThreads;
+		}
 		void setMaximumIntegrationRadius( double iR = 1.5 )
 		{
 			fMaximumIntegrationRadius = iR;    // FOV (VERITAS is 3.5 deg, this is the (optimistic) region of constant radial acceptance)
@@ -248,6 +294,6 @@ class VExposure : public TObject, public VGlobalRunParameter
 		int checkMD5sum( int date, int run, bool force_download = false ) ;
 		void printChecksumSummary();
 		
-		ClassDef( VExposure, 8 );
+		ClassDef( VExposure, 9 );
 };
 #endif
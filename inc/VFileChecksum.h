@@ -0,0 +1,50 @@
+//! VFileChecksum streaming MD5 checksum of a file (computed in-process, incrementally or in one go)
+
+#ifndef VFILECHECKSUM_H
+#define VFILECHECKSUM_H
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "TMD5.h"
+#include "TSystem.h"
+
+using namespace std;
+
+class VFileChecksum
+{
+	private:
+	
+		string   fFileName;
+		FILE*    fFile;
+		Long64_t fFileSize;
+		Long64_t fNBytesDone;                      // number of bytes added to checksum
+		bool     fError;
+		
+		TMD5*    fMD5;
+		vector< unsigned char > fBuffer;
+		
+		void     close();
+		
+	public:
+	
+		VFileChecksum( unsigned int iBufferSize = 4194304 );
+		~VFileChecksum();
+		
+		static string calcMD5sum( string iFileName );
+		string   finish( bool iReadRemaining = true );
+		Long64_t getFileSize()
+		{
+			return fFileSize;
+		}
+		Long64_t getNBytesDone()
+		{
+			return fNBytesDone;
+		}
+		bool     open( string iFileName );
+		bool     update( Long64_t iNBytes );
+		bool     updateFraction( double iFraction );
+};
+#endif
@@ -17,6 +17,7 @@
 #include "TMath.h"
 #include "TMinuit.h"
 
+#include "VPulseFitter.h"
 #include "VTraceHandler.h"
 #include "VVirtualDataReader.h"
 
@@ -39,6 +40,9 @@ class VFitTraceHandler : public VTraceHandler
 		int fMaxSamples;                          //!< sample maximum (usually 64)
 		bool fFitted;                             //!< true after trace fit
 		bool fMinuitPrint;                        //!< if true, long printout from minuit
+		bool fMinuitFit;                          //!< if true, fit traces with Minuit (default: VPulseFitter)
+		VPulseFitter* fPulseFitter;               //!< fast pulse fitter (Levenberg-Marquardt)
+		bool fPulseFitterValid;                   //!< true if trace maximum is taken from a successful VPulseFitter fit
 		
 		double fChi2;                             //!< Chi2 for this trace
 		double fTraceNorm;                        //!< trace normalisation
@@ -60,6 +64,16 @@ class VFitTraceHandler : public VTraceHandler
 		double fFitThresh;                        //!< threshold above trace is fitted
 		
 		void fitTrace( unsigned int chanID );
+		void fitTrace_Minuit( double ipeak, int ipeakpos );
+		void fitTrace_PulseFitter( double ipeak, int ipeakpos );
+		bool usePulseFitter()
+		{
+			return ( !fMinuitFit && fPulseFitter && fFitted && fnstat > 0 );
+		}
+		bool usePulseFitterMaximum()
+		{
+			return ( usePulseFitter() && fPulseFitterValid );
+		}
 		
 	public:
 		VFitTraceHandler( string );
@@ -126,6 +140,10 @@ class VFitTraceHandler : public VTraceHandler
 		{
 			fFitThresh = ithres;
 		}
+		void   setMinuitFit( bool iMinuit )       //!< if true, fit traces with Minuit (slow)
+		{
+			fMinuitFit = iMinuit;
+		}
 		void   setMinuitPrint( bool iPrint )      //!< if true, long printout of fitting
 		{
 			fMinuitPrint = iPrint;
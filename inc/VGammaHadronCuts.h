@@ -119,6 +119,11 @@ class VGammaHadronCuts : public VAnalysisUtilities
 		unsigned int fProbabilityCut_NSelectors;      // number of elements in fProbabilityCut_SelectionCut[]
 		unsigned int fProbabilityCut_ProbID;          // array element to be used from fProbabilityCut_SelectionCut[]
 		double fProbabilityCut_SelectionCut[VANACUTS_PROBSELECTIONCUTS_MAX];    // selection cut
+		// probability cut decisions and selectors for all entries of the friend tree (read once in initProbabilityCuts)
+		vector< unsigned char > fProbabilityCut_Table_Decision;       //! bit 0: passed (on); bit 1: passed (off)
+		vector< unsigned int >  fProbabilityCut_Table_NSelectors;     //!
+		vector< double >        fProbabilityCut_Table_SelectionCut;   //! entries x fProbabilityCut_Table_Stride
+		unsigned int            fProbabilityCut_Table_Stride;         //!
 		
 		//////////////////////////
 		// TMVA evaluator
@@ -164,18 +169,27 @@ class VGammaHadronCuts : public VAnalysisUtilities
 		// energy dependent cuts
 		map< string, TGraph* > fEnergyDependentCut;
 		
+		// lookup table for energy dependent direction cut (angular resolution graph or function vs log10 energy; piecewise linear)
+		bool   fAngResTable_F1;                                     //! table is tabulated from fF1AngRes
+		double fAngResTable_InvBinWidth;                            //!
+		vector< double > fAngResTable_X;                            //!
+		vector< double > fAngResTable_Y;                            //!
+		vector< unsigned int > fAngResTable_Segment;                //! first node of segment at lower edge of each lookup bin
+		
 		// cut statistics
 		VGammaHadronCutsStatistics* fStats;                       //!
 		
 		bool   applyProbabilityCut( int i, bool fIsOn );
-		double getEnergyDependentCut( double energy_TeV, TGraph* iG, bool bUseEvalue = true, bool bMaxCut = true );
 		TGraph* getEnergyDependentCut( string iCutName );
 		bool   getEnergyDependentCutFromFile( string iFileName, string iVariable );
+		double getAngularResolutionFromTable( double log10e );
 		bool   initAngularResolutionFile();
+		void   initAngularResolutionTable();
 		bool   initPhaseCuts( int irun );
 		bool   initPhaseCuts( string iDir );
 		bool   initProbabilityCuts( int irun );
 		bool   initProbabilityCuts( string iDir );
+		bool   initProbabilityCutTable();
 		bool   initTMVAEvaluator( string iTMVAFile, unsigned int iTMVAWeightFileIndex_Emin, unsigned int iTMVAWeightFileIndex_Emax, unsigned int iTMVAWeightFileIndex_Zmin, unsigned int iTMVAWeightFileIndex_Zmax );
 		string getTelToAnalyzeString();
 		
@@ -431,6 +445,6 @@ class VGammaHadronCuts : public VAnalysisUtilities
 			return fUseOrbitalPhaseCuts;
 		}
 		
-		ClassDef( VGammaHadronCuts, 59 );
+		ClassDef( VGammaHadronCuts, 60 );
 };
 #endif
@@ -3,6 +3,7 @@
 #ifndef VGRISUREADER_H
 #define VGRISUREADER_H
 
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <map>
@@ -19,6 +20,7 @@
 
 #include "VDetectorGeometry.h"
 #include "VMonteCarloRunHeader.h"
+#include "VNoiseTraceLibrary.h"
 #include "VSkyCoordinatesUtilities.h"
 #include "VVirtualDataReader.h"
 
@@ -113,8 +115,8 @@ class VGrIsuReader : public VVirtualDataReader
 		// traces for background
 		TFile* fTraceFile;                        //!< file for background trace library
 		string fTraceFileName;
-		vector< TTree* > fTraceTree;              //!< vector for background trace trees (one per telescope, preliminary)
-		short int fTrace[500][64];                //!< background trace array
+		VNoiseTraceLibrary* fTraceLibrary;        //!< background traces (contiguous, read-only buffer for all telescopes)
+		int    fTracePedShift[256];               //!< sample value minus default pedestal (for trace library mixing)
 		
 		//  random dead channels
 		int fMCNdead;                             //!< number of pixels set randomly dead
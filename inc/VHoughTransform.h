@@ -8,6 +8,7 @@
 #include <iostream>
 #include <stdio.h>
 #include <stdlib.h>
+#include <vector>
 
 
 //ROOT includes
@@ -66,13 +67,21 @@ class VHoughTransform
 		
 		vector <double> fPMTDiameter; //Diameter of a PMT in mm
 		
-		vector <TH3D*> fAccumulatorArray; //Hough transform accumulator arrays
+		vector <TH3D*> fAccumulatorArray; //Hough transform accumulator arrays (binning only, the bin contents are kept in fAccumulator)
 		
-		vector <TTree*> fHTLookupTableTree; //Trees with the Hough transform lookup tables
+		vector < vector <unsigned int> > fAccumulator; //Hough transform accumulators (indexed by the global bin number of fAccumulatorArray)
+		
+		vector < vector <unsigned int> > fAccumulatorFilledBins; //Non-zero bins of the accumulators (used for the peak search and reset)
+		
+		vector < vector <unsigned int> > fHTLookupTableOffset; //Lookup tables: first entry in fHTLookupTableBins for each pixel (one extra entry at the end)
+		
+		vector < vector <unsigned int> > fHTLookupTableBins; //Lookup tables: accumulator bins of the circle parametrizations hitting a pixel (packed for all pixels)
+		
+		void findAccumulatorPeaks( unsigned int fTelID, int* fPeakBins, double* fPeakBinValues ); //Find the three highest bins of the accumulator array
 		
 		TH3D* initAccumulatorArray( int fRMinDpmt, int fRMaxDpmt, int fStepsPerPMTDiameter, unsigned int fTelID ); //Method for initializaing the Hough transform accumulator array
 		
-		TTree* initLookupTable( int fRMinDpmt, int fRMaxDpmt, int fStepsPerPMTDiameter, unsigned int fTelID ); //Method for initializing the Hough transform lookup table
+		void initLookupTable( int fRMinDpmt, int fRMaxDpmt, int fStepsPerPMTDiameter, unsigned int fTelID ); //Method for initializing the Hough transform lookup table
 		
 		void readHTParameterFile( unsigned int fTelID );
 		
@@ -0,0 +1,78 @@
+//! VImageLLFitter loglikelihood fit of a 2D Gaussian to an image (analytic gradient and Hessian, Levenberg-Marquardt minimisation)
+
+#ifndef VIMAGELLFITTER_H
+#define VIMAGELLFITTER_H
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "TMath.h"
+
+using namespace std;
+
+class VImageLLFitter
+{
+	private:
+	
+		static const unsigned int fNPar = 6;      // rho, meanX, sigmaX, meanY, sigmaY, signal (as in get_LL_imageParameter_2DGauss)
+		
+		bool   fDebug;
+		unsigned int fMaxIterations;
+		double fEDM_max;                          // convergence criterion (estimated distance to minimum)
+		
+		// pixels of current image (contiguous arrays, memory is reused for all images)
+		vector< double > fX;
+		vector< double > fY;
+		vector< double > fN;
+		
+		double fPar[fNPar];
+		double fParMin[fNPar];
+		double fParMax[fNPar];
+		double fParErr[fNPar];
+		
+		double fLL;                               // -log likelihood at minimum
+		double fEDM;
+		int    fFitStat;
+		unsigned int fNIterations;
+		
+		double getLL( const double* p, double* g = 0, double* H = 0 );
+		bool   solve( const double* A, const double* b, double* x, const bool* iFree );
+		
+	public:
+	
+		VImageLLFitter( unsigned int iMaxIterations = 100 );
+		~VImageLLFitter() {}
+		
+		void   addPixel( double x, double y, double n )
+		{
+			fX.push_back( x );
+			fY.push_back( y );
+			fN.push_back( n );
+		}
+		void   clear();
+		bool   fit();
+		double getEDM()
+		{
+			return fEDM;
+		}
+		int    getFitStat()
+		{
+			return fFitStat;
+		}
+		double getLL()
+		{
+			return fLL;
+		}
+		unsigned int getNIterations()
+		{
+			return fNIterations;
+		}
+		void   getParameter( unsigned int i, double& iPar, double& iParErr );
+		void   setDebug( bool iB = true )
+		{
+			fDebug = iB;
+		}
+		void   setParameter( unsigned int i, double iPar, double iMin, double iMax );
+};
+#endif
@@ -11,6 +11,7 @@
 #include "VDetectorGeometry.h"
 #include "VEvndispData.h"
 #include "VHoughTransform.h"
+#include "VImageLLFitter.h"
 #include "VImageParameter.h"
 
 #include "TError.h"
@@ -54,6 +55,7 @@ class VImageParameterCalculation : public TObject
 		vector<double> fll_Sums;                  //!< data vector for minuit function
 		vector<double> fll_Pedvars;               //!< data vector for minuit function
 		vector<bool> fLLEst;                      //!< true if channel has an estimated sum from the LL fit
+		VImageLLFitter* fLLImageFitter;           //!< loglikelihood fit with analytic derivatives
 		
 		double getFractionOfImageBorderPixelUnderImage( double, double, double, double, double, double );
 		double redang( double angle, double maxI );  //!< reduce angle to intervall [0.,maxI]
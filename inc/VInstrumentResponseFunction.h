@@ -83,6 +83,7 @@ class VInstrumentResponseFunction
 			return false;
 		}
 		bool   fill();
+		void   fillEvent();
 		bool   fillResolutionGraphs( vector< vector< VInstrumentResponseFunctionData* > > iIRFData );
 		double getContainmentProbability()
 		{
@@ -10,9 +10,12 @@
 #include "TList.h"
 #include "TMath.h"
 #include "TRandom.h"
+#include "TRandom3.h"
+#include "TROOT.h"
 
 #include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "CData.h"
@@ -43,9 +46,15 @@ class VInstrumentResponseFunctionData : public TObject, public VHistogramUtiliti
 		double  fArrayCentre_X;
 		double  fArrayCentre_Y;
 		
-		TList*  calculateResolution( TH2D* iHistogram, TGraphErrors* iResult, string iHistoName,
-									 double iContainmentProbability, double iContainmentProbabilityError );
-		double  getResolutionErrorfromToyMC( double i68, double iN );
+		// uncertainties of resolution curves
+		unsigned int fResolutionErrorBootstrapN;          // number of bootstrap replicas (0: analytic order statistics)
+		unsigned int fResolutionErrorNThreads;            //! number of threads for bootstrap replicas
+		
+		bool    calculateResolution( TH2D* iHistogram, TGraphErrors* iResult, double iContainmentProbability );
+		static void   calculateResolutionErrorBootstrap( unsigned int iThread, unsigned int iNThreads, unsigned int iNReplicas,
+				vector< double >* iContent, vector< double >* iNeff, vector< double >* iEdges,
+				double iContainmentProbability, vector< double >* iError );
+		static double getContainmentQuantile( const double* iContent, const double* iEdges, unsigned int iN, double iP );
 		int     testResponseFunctionType( string iType );
 		
 	public:
@@ -107,6 +116,11 @@ class VInstrumentResponseFunctionData : public TObject, public VHistogramUtiliti
 			fEnergyReconstructionMethod = iMethod;
 		}
 		void   setPlottingStyle( int icolor, double iwidth = 1., int imarker = 20, double isize = 1., int iFillStyle = 0, int iLineStyle = 1 );
+		void   setResolutionErrorBootstrap( unsigned int iNReplicas = 0, unsigned int iNThreads = 1 )
+		{
+			fResolutionErrorBootstrapN = iNReplicas;
+			fResolutionErrorNThreads = iNThreads;
+		}
 		void   setHistogramEbinning( int iN = 60, double iMin = -2.0, double iMax = 4.0 )
 		{
 			fHistogrambinningEnergy_TeV_Log = iN;
@@ -121,7 +135,7 @@ class VInstrumentResponseFunctionData : public TObject, public VHistogramUtiliti
 		}
 		bool   terminate( double iContainmentProbability, double iContainmentProbabilityError );
 		
-		ClassDef( VInstrumentResponseFunctionData, 9 );
+		ClassDef( VInstrumentResponseFunctionData, 10 );
 };
 
 #endif
@@ -60,6 +60,10 @@ class VInstrumentResponseFunctionRunParameter : public TNamed
 		unsigned int fResponseMatricesEbinning;      // bins in the ResponseMatrices
 		unsigned int fhistoNEbins;                   // E binning (affects 2D histograms only)
 		
+		// uncertainties of resolution curves (0 replicas: analytic order statistics)
+		unsigned int fResolutionErrorBootstrapN;     // number of bootstrap replicas
+		unsigned int fResolutionErrorNThreads;       // number of threads for bootstrap replicas
+		
 		string          fCoreScatterMode;
 		double          fCoreScatterRadius;
 		
@@ -110,7 +114,7 @@ class VInstrumentResponseFunctionRunParameter : public TNamed
 		bool                  readRunParameterFromTextFile( string iFile );
 		bool                  testRunparameters();
 		
-		ClassDef( VInstrumentResponseFunctionRunParameter, 17 );
+		ClassDef( VInstrumentResponseFunctionRunParameter, 18 );
 };
 
 #endif
@@ -21,6 +21,7 @@
 #include <iomanip>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 #include "TSpectrum.h"
 #include "TVirtualFitter.h"
@@ -29,6 +30,33 @@
 
 using namespace std;
 
+// gain ratio fit for one channel and gain (high/low)
+struct sLowGainFitResult
+{
+	int    fTel;
+	int    fChannel;
+	int    fHiLo;
+	vector< double > fX;                          // fit points (light level, mean charge)
+	vector< double > fY;
+	vector< double > fXErr;
+	vector< double > fYErr;
+	double fM;
+	double fMErr;
+	double fChi2;
+	int    fNDF;
+	int    fStatus;
+};
+
+class VLowGainCalibrator;
+
+// job description for charge accumulation (list of telescopes) or gain ratio fits (list of fits)
+struct sLowGainCalibratorJob
+{
+	VLowGainCalibrator* fCalibrator;
+	vector< int > fTel;
+	vector< unsigned int > fFit;                  // index in fFitResults
+};
+
 class VLowGainCalibrator
 {
 
@@ -129,6 +157,24 @@ class VLowGainCalibrator
 		double calcMeanMonitorCharge( int tel, int ientry = -1 );
 		double calcMedianMonitorCharge( int tel, int ientry = -1 );
 		
+		// charges extracted once from the DST tree (per telescope; [event * nChannels + channel])
+		bool fChargesRead;                                    //!
+		vector< unsigned int > fEventNumber;                  //!
+		vector< double > fQMon[fNTel];                        //! monitor charge per event
+		vector< float > fQ[fNTel];                            //! charge (sum2)
+		vector< UChar_t > fQFlag[fNTel];                      //! bit 0: low gain, bit 1: dead
+		vector< Short_t > fQRawMax[fNTel];                    //!
+		vector< sLowGainFitResult > fFitResults;              //!
+		
+		unsigned int fNThreads;
+		
+		static void accumulateChargesJob( sLowGainCalibratorJob* iJob );
+		static void fitJob( sLowGainCalibratorJob* iJob );
+		static bool fitProportional( sLowGainFitResult* iFit );
+		int  getLightLevel( int tel, double qmon );
+		bool readCharges();
+		void runJobs( vector< sLowGainCalibratorJob >& iJobs, void ( *iFunction )( sLowGainCalibratorJob* ) );
+		
 		bool fIsOk;
 		
 		unsigned int fMinDSTEvent;
@@ -187,9 +233,14 @@ class VLowGainCalibrator
 		{
 			fMinDSTEvent = a;
 			fMaxDSTEvent = b;
+			fChargesRead = false;
+		}
+		void setNumberOfThreads( unsigned int iNThreads = 1 )
+		{
+			fNThreads = iNThreads;
 		}
 		
-		ClassDef( VLowGainCalibrator, 4 );
+		ClassDef( VLowGainCalibrator, 5 );
 		
 };
 
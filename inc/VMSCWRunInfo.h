@@ -0,0 +1,63 @@
+//! VMSCWRunInfo run level summary of a mscw_energy output file (sidecar file, used by anasum for all run preflight checks)
+
+#ifndef VMSCWRUNINFO_H
+#define VMSCWRUNINFO_H
+
+#include <bitset>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "TSystem.h"
+
+using namespace std;
+
+class VMSCWRunInfo
+{
+	private:
+	
+		bool     fAzSet;
+		double   fZeSum;
+		Long64_t fNZe;
+		
+		static bool getFileInfo( string iFileName, Long64_t& iFileSize, Long_t& iFileModTime );
+		
+	public:
+	
+		int      fRunNumber;
+		bool     fIsMC;
+		
+		Long64_t fNEvents;                        // number of events in data tree
+		Long64_t fNEventsWithImages;              // number of events with at least one selected image
+		vector< unsigned int > fTelToAnalyze;     // telescopes used in the analysis
+		vector< Long64_t > fNImagesPerTel;        // number of events with a selected image (per telescope)
+		
+		double   fAzMin;                          // telescope azimuth of first event with selected images [deg]
+		double   fAzMax;                          // telescope azimuth of last event with selected images [deg]
+		double   fZeMin;                          // minimum array pointing zenith angle [deg]
+		double   fZeMax;                          // maximum array pointing zenith angle [deg]
+		double   fZeMean;                         // mean array pointing zenith angle [deg]
+		double   fMeanPedvars;                    // mean pedvars (from table lookup run parameters)
+		
+		int      fMJDStart;                       // time of first event (MJD)
+		double   fTimeStart;                      // time of first event (seconds of day)
+		int      fMJDStop;                        // time of last event (MJD)
+		double   fTimeStop;                       // time of last event (seconds of day)
+		
+		VMSCWRunInfo();
+		~VMSCWRunInfo() {}
+		
+		void   fill( int iMJD, double iTime, ULong64_t iImgSel, double* iTelAzimuth,
+					 double iArrayPointing_Elevation, unsigned int iNTel );
+		static string getSidecarFileName( string iMSCWFileName )
+		{
+			return iMSCWFileName + ".runinfo";
+		}
+		void   print();
+		bool   readSidecarFile( string iMSCWFileName );
+		void   reset();
+		bool   writeSidecarFile( string iMSCWFileName );
+};
+#endif
@@ -0,0 +1,75 @@
+//! VNoiseTraceLibrary read-only, memory resident background trace library (for grisu simulations)
+
+#ifndef VNOISETRACELIBRARY_H
+#define VNOISETRACELIBRARY_H
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "TFile.h"
+#include "TSystem.h"
+#include "TTree.h"
+
+using namespace std;
+
+class VNoiseTraceLibrary
+{
+	private:
+	
+		bool fDebug;
+		
+		string   fTraceFileName;
+		string   fSidecarFileName;
+		unsigned int fNTel;
+		
+		vector< Long64_t > fNEntries;              // number of library entries per telescope
+		vector< Long64_t > fOffset;                // offset of first trace of each telescope in data buffer
+		
+		// trace buffer (memory mapped sidecar file or memory buffer)
+		const uint8_t*     fData;
+		vector< uint8_t >  fMemoryBuffer;
+		void*              fMappedData;
+		size_t             fMappedSize;
+		
+		bool   fillFromTraceFile( Long64_t iTraceFileSize, Long_t iTraceFileModTime );
+		bool   getTraceFileInfo( Long64_t& iTraceFileSize, Long_t& iTraceFileModTime );
+		bool   mapSidecarFile( Long64_t iTraceFileSize, Long_t iTraceFileModTime );
+		void   unmap();
+		bool   writeSidecarFile( Long64_t iTraceFileSize, Long_t iTraceFileModTime );
+		
+	public:
+	
+		static const unsigned int fNPixel = 500;   // number of pixels per library entry (see fTrace branch)
+		static const unsigned int fNSamples = 64;  // number of samples per pixel (see fTrace branch)
+		
+		VNoiseTraceLibrary( bool iDebug = false );
+		~VNoiseTraceLibrary();
+		
+		Long64_t       getNEntries( unsigned int iTel )
+		{
+			if( iTel < fNEntries.size() )
+			{
+				return fNEntries[iTel];
+			}
+			return 0;
+		}
+		unsigned int   getNTel()
+		{
+			return fNTel;
+		}
+		//!< return pointer to fNSamples samples of given telescope, library entry and pixel (real data numbering)
+		const uint8_t* getTrace( unsigned int iTel, Long64_t iEntry, unsigned int iPixel )
+		{
+			return fData + fOffset[iTel] + ( iEntry * fNPixel + iPixel ) * fNSamples;
+		}
+		bool           isValid()
+		{
+			return ( fData != 0 );
+		}
+		bool           open( string iTraceFileName, unsigned int iNTel );
+};
+#endif
@@ -0,0 +1,107 @@
+//! VPulseFitter fast fit of FADC pulses (Levenberg-Marquardt with analytic derivatives)
+
+#ifndef VPulseFitter_H
+#define VPulseFitter_H
+
+#include <iostream>
+#include <math.h>
+#include <string>
+#include <vector>
+
+#include "TMath.h"
+
+using namespace std;
+
+class VPulseFitter
+{
+	public:
+	
+		enum E_PulseShape { EV = 0, GRISU = 1 };
+		
+	private:
+	
+		static const unsigned int fNPar = 4;     //!< number of free parameters (pedestal is fixed)
+		
+		E_PulseShape fShape;
+		unsigned int fMaxIterations;
+		double       fTolerance;                  //!< relative change in chi2 to stop iterations
+		
+		double fPar[fNPar];
+		double fParMin[fNPar];
+		double fParMax[fNPar];
+		
+		double       fChi2;
+		int          fNDF;
+		int          fStatus;                     //!< fit status (as Minuit: 3=converged, 1=not converged, 0=failed)
+		unsigned int fNIterations;
+		
+		// sample positions, pedestal subtracted values and weights (1/sigma2) of current trace
+		vector< double > fX;
+		vector< double > fY;
+		vector< double > fW;
+		
+		double getChi2( const double* p );
+		bool   getNormalEquations( const double* p, double iA[fNPar][fNPar], double iB[fNPar] );
+		double getSimpsonIntegral( double a, double b );
+		void   setLimits();
+		bool   solve( double iA[fNPar][fNPar], double* iB, double* iX );
+		
+	public:
+	
+		VPulseFitter( E_PulseShape iShape = EV );
+		~VPulseFitter() {}
+		
+		double       eval( double x, const double* p, double* dfdp = 0 );
+		double       eval( double x )
+		{
+			return eval( x, fPar );
+		}
+		int          fit( const vector< double >& iTrace, double iPed, double iPedrms,
+						  double iAmplitude, double iPeakPosition, double iCharge );
+		double       getAmplitude();
+		double       getChi2()
+		{
+			return fChi2;
+		}
+		double       getIntegral( double a, double b );
+		unsigned int getNIterations()
+		{
+			return fNIterations;
+		}
+		int          getNDF()
+		{
+			return fNDF;
+		}
+		unsigned int getNPar()
+		{
+			return fNPar;
+		}
+		double       getParameter( unsigned int i )
+		{
+			if( i < fNPar )
+			{
+				return fPar[i];
+			}
+			return 0.;
+		}
+		double       getPeakPosition();
+		E_PulseShape getShape()
+		{
+			return fShape;
+		}
+		int          getStatus()
+		{
+			return fStatus;
+		}
+		double       getTime( double iFraction, bool iRisingEdge );
+		void         setMaxIterations( unsigned int iN = 50 )
+		{
+			fMaxIterations = iN;
+		}
+		void         setShape( E_PulseShape iShape );
+		void         setTolerance( double iT = 1.e-6 )
+		{
+			fTolerance = iT;
+		}
+};
+#endif
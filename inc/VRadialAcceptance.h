@@ -58,6 +58,7 @@ class VRadialAcceptance
 		TList* hList;
 		TList* hListNormalizeHistograms;
 		TList* hListFitHistograms;
+		TList* hListNotWrittenHistograms;           //!< filled histograms which are not written to the output file
 		TH1F* hscale;
 		TH1F* hPhiDist;
 		TH1F* hPhiDistDeRot;
@@ -65,6 +66,9 @@ class VRadialAcceptance
 		vector< double > fZe;                      //!< ze bins (upper limit of zenith angle bin)
 		double fAzCut_min;
 		double fAzCut_max;
+		double fZeCut_min;
+		double fZeCut_max;
+		ULong64_t fImgSelCut;                      //!< image selection (0 = all image selections)
 		vector< TH1F* >  hAccZe;                   //!< zenith angle dependent acceptance curves
 		vector< TF1* >   fAccZe;                   //!< zenith angle dependent acceptance curves
 		
@@ -138,7 +142,10 @@ class VRadialAcceptance
 		VRadialAcceptance( string ifile );                                              //!< use acceptance curve from this file
 		~VRadialAcceptance();
 		
+		bool   add( VRadialAcceptance* iAcc );                                         //!< add histograms of acceptance with same configuration
+		bool   applyCuts( int entry );                                                  //!< quality and gamma/hadron cuts
 		int    fillAcceptanceFromData( CData* c, int entry );
+		void   fillEvent( CData* c );                                                   //!< fill event (no cuts applied)
 		double getAcceptance( double x, double y, double erec = 0., double ze = 0. );   //!< return radial acceptance
 		double getCorrectionFactor( double x, double y, double erec );                  //!< return correction factor (1/radial acceptance)
 		double getNumberofRawFiles()
@@ -148,6 +155,7 @@ class VRadialAcceptance
 		bool   isExcluded( double, double );                                            //!< region excluded from analysis
 		bool   isExcludedfromBackground( double, double );                              //!< region excluded from background analysis
 		bool   isExcludedfromSource( double, double );                                  //!< region excluded from source analyis
+		bool   isInConfiguration( CData* c );                                           //!< event in az/ze/image selection range
 		void   setAzCut( double iAzMin = -1.e9, double iAzMax = 1.e9 )
 		{
 			fAzCut_min = iAzMin;    //!< cut on Az (shower directory)
@@ -157,10 +165,19 @@ class VRadialAcceptance
 		{
 			fEnergyReconstructionMethod = iEMethod;
 		}
+		void   setImgSelCut( ULong64_t iImgSel = 0 )
+		{
+			fImgSelCut = iImgSel;    //!< cut on image selection (0 = no cut)
+		}
 		void   setSource( double x, double y, double r, double idist, double imaxdist = 5. ); //!< set source position, radius, and minimal distance between source and background
 		void   setRegionToExcludeAcceptance( vector<double> x, vector<double> y, vector<double> r ); //set the region to be exclude in the analysis
 		// for ellipsoidal region
 		void   setRegionToExcludeAcceptance( vector<double> x, vector<double> y, vector<double> r1, vector<double> r2, vector<double> theta ); //set the region to be exclude in the analysis
+		void   setZeCut( double iZeMin = -1.e9, double iZeMax = 1.e9 )
+		{
+			fZeCut_min = iZeMin;    //!< cut on Ze (shower direction)
+			fZeCut_max = iZeMax;
+		}
 		bool   terminate( TDirectory* iDirectory );
 		
 		
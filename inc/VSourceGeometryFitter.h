@@ -16,11 +16,18 @@
 #include "TLine.h"
 #include "TMath.h"
 #include "Minuit2/FCNBase.h"
-// #include "TFitterMinuit.h"
+#include "Minuit2/FCNGradientBase.h"
+#include "Minuit2/FunctionMinimum.h"
+#include "Minuit2/MnMigrad.h"
+#include "Minuit2/MnUserParameters.h"
 #include "TMinuit.h"
 
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
@@ -56,6 +63,7 @@ class VSourceGeometryFitter : public VAnalysisUtilities, public VPlotUtilities
 		double fXStart;
 		double fYStart;
 		double fPSF;
+		unsigned int fNThreads;                // number of threads for likelihood summation
 		
 		// sky map to be fitted
 		TH2D* fHisSkyMap;
@@ -74,7 +82,7 @@ class VSourceGeometryFitter : public VAnalysisUtilities, public VPlotUtilities
 		VSourceGeometryFitter( string iAnaSumDataFile, int irun = -1 );
 		~VSourceGeometryFitter() {}
 		
-		void     fitSource( string iHisName = "hmap_stereoUC_diff", double xStart = 0., double yStart = 0., double xyRange = 0.15 );
+		void     fitSource( string iHisName = "hmap_stereoUC_diff", double xStart = 0., double yStart = 0., double xyRange = 0.15, unsigned int iNThreads = 0 );
 		TH2D*    getSkyMap()
 		{
 			return fHisSkyMap;
@@ -88,6 +96,10 @@ class VSourceGeometryFitter : public VAnalysisUtilities, public VPlotUtilities
 			fDebug = iB;
 		}
 		bool     setFitter( string iFitter );
+		void     setNumberOfThreads( unsigned int iNThreads = 1 )
+		{
+			fNThreads = iNThreads;
+		}
 		void     setPSF( double psf )
 		{
 			fPSF = psf;
@@ -97,12 +109,70 @@ class VSourceGeometryFitter : public VAnalysisUtilities, public VPlotUtilities
 			return fPSF;
 		}
 		
-		ClassDef( VSourceGeometryFitter, 1 );
+		ClassDef( VSourceGeometryFitter, 2 );
 };
 
 
 
 
+///////////////////////////////////////////////////////////////////////////////
+// base class for all fit functions
+//
+// sky map bins inside the fit range are extracted once into contiguous
+// arrays; sums over bins are calculated over blocks of fixed size (partial
+// sums are added in fixed block order, independent of the number of threads);
+// blocks are summed in parallel by worker threads which are started once per fit
+///////////////////////////////////////////////////////////////////////////////
+class VSourceGeometryFitterFCN
+{
+	private:
+	
+		// worker threads (worker w sums blocks w, w + n, w + 2n, ...; worker 0 is the calling thread)
+		vector< std::thread >                fWorkers;
+		unsigned int                         fNWorkers;           // number of workers (including the calling thread)
+		mutable std::mutex                   fWorkerMutex;
+		mutable std::condition_variable      fWorkerStart;
+		mutable std::condition_variable      fWorkerDone;
+		mutable unsigned int                 fWorkerGeneration;   // incremented for each sum over bins
+		mutable unsigned int                 fWorkerPending;      // number of worker threads not yet finished
+		bool                                 bWorkerStop;
+		mutable const vector< double >*      fWorkerPar;
+		mutable bool                         bWorkerGradient;
+		static const unsigned int            fBinsPerBlock = 1000;
+		vector< unsigned int >               fBlockFirst;         // bin range [first, last) per block
+		vector< unsigned int >               fBlockLast;
+		mutable vector< double >             fBlockSum;
+		mutable vector< vector< double > >   fBlockGradient;
+		
+		static void runWorker( VSourceGeometryFitterFCN* iFCN, unsigned int iWorker, unsigned int iGeneration );
+		void   startWorkers();
+		void   sumBlocks( const vector< double >& par, unsigned int iWorker, bool iGradient ) const;
+		void   stopWorkers();
+		
+	protected:
+	
+		vector< double > fX;                  // bin centres
+		vector< double > fY;
+		vector< double > fN;                  // bin contents
+		vector< double > fNErr;               // bin errors
+		unsigned int     fNThreads;
+		
+		void   fillBins( TH2D* iSkymap, double i_xmin, double i_xmax, double i_ymin, double i_ymax );
+		double sumBins( const vector< double >& par, vector< double >* iGradient ) const;
+		
+	public:
+	
+		VSourceGeometryFitterFCN();
+		virtual ~VSourceGeometryFitterFCN();
+		// sum over bins [iFirst, iLast); gradient is added to iGradient (if not 0)
+		virtual double evaluateBins( const vector< double >& par, unsigned int iFirst, unsigned int iLast, vector< double >* iGradient ) const = 0;
+		unsigned int getNBins()
+		{
+			return fN.size();
+		}
+		void setNumberOfThreads( unsigned int iNThreads = 1 );
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -115,20 +185,14 @@ class VSourceGeometryFitter : public VAnalysisUtilities, public VPlotUtilities
 //  PSF description (1) - radial symmetric PSF with an offset
 //
 ///////////////////////////////////////////////////////////////////////////////
-class VFun_PSFDescription_2DGauss_Chi2 : public ROOT::Minuit2::FCNBase
+class VFun_PSFDescription_2DGauss_Chi2 : public ROOT::Minuit2::FCNGradientBase, public VSourceGeometryFitterFCN
 {
-	private:
-	
-		TH2D* hSkyMap;
-		double xmin;
-		double xmax;
-		double ymin;
-		double ymax;
-		
 	public:
 	
 		VFun_PSFDescription_2DGauss_Chi2( TH2D* iSkymap = 0, double i_xmin = -1., double i_xmax = 1., double i_ymin = -1., double i_ymax = 1. );
 		
+		double evaluateBins( const vector< double >& par, unsigned int iFirst, unsigned int iLast, vector< double >* iGradient ) const;
+		
 		/////////////////////////////////
 		// function to be minimized
 		double operator()( const std::vector<double>& par ) const
@@ -139,78 +203,16 @@ class VFun_PSFDescription_2DGauss_Chi2 : public ROOT::Minuit2::FCNBase
 				cout << "VFun_PSFDescription_2DGauss_Chi2: error in parameter vector size; expect 5, is " << par.size() << endl;
 				return 0.;
 			}
-			
-			// set variables
-			double x = 0.;
-			double y = 0.;
-			
-			double sum = 0.;
-			double fT = 0.;
-			double fH = 0.;
-			double fHErr = 0.;
-			
-			double t2 = 0.;
-			double sigmaSource2 = par[2] * par[2];
-			
-			// loop over sky map
-			if( hSkyMap )
+			return sumBins( par, 0 );
+		}
+		std::vector< double > Gradient( const std::vector<double>& par ) const
+		{
+			std::vector< double > g( par.size(), 0. );
+			if( par.size() == 5 )
 			{
-				int nbinsX = hSkyMap->GetNbinsX();
-				int nbinsY = hSkyMap->GetNbinsY();
-				for( int i = 1; i <= nbinsX; i++ )
-				{
-					x = hSkyMap->GetXaxis()->GetBinCenter( i );
-					// check x-range
-					if( x > xmax )
-					{
-						continue;
-					}
-					if( x < xmin )
-					{
-						continue;
-					}
-					for( int j = 1; j <= nbinsY; j++ )
-					{
-						y = hSkyMap->GetYaxis()->GetBinCenter( j );
-						// check y-range
-						if( y > ymax )
-						{
-							continue;
-						}
-						if( y < ymin )
-						{
-							continue;
-						}
-						
-						// skip empty bins
-						// if( hSkyMap->GetBinContent( i, j ) <= 0. )
-						// {
-						//	continue;
-						// }
-						
-						// calculate theta2
-						t2 = ( x - par[3] ) * ( x - par[3] ) + ( y - par[4] ) * ( y - par[4] );
-						
-						// calculate expectation from model function
-						fT = par[0] + par[1] * TMath::Exp( -1.*t2 / 2. / sigmaSource2 );
-						if( isnan( fT ) )
-						{
-							continue;
-						}
-						
-						// get value and error in histogram
-						fH = hSkyMap->GetBinContent( i, j );
-						fHErr = hSkyMap->GetBinError( i, j );
-						
-						// calculate chi2
-						if( fHErr > 0. && fH > -90. )
-						{
-							sum += ( fT - fH ) * ( fT - fH ) / fHErr / fHErr;
-						}
-					}
-				}
+				sumBins( par, &g );
 			}
-			return sum;
+			return g;
 		}
 		double Up() const
 		{
@@ -225,20 +227,14 @@ class VFun_PSFDescription_2DGauss_Chi2 : public ROOT::Minuit2::FCNBase
 //
 //
 ///////////////////////////////////////////////////////////////////////////////
-class VFun_PSFDescription_2DGauss_LL : public ROOT::Minuit2::FCNBase
+class VFun_PSFDescription_2DGauss_LL : public ROOT::Minuit2::FCNGradientBase, public VSourceGeometryFitterFCN
 {
-	private:
-	
-		TH2D* hSkyMap;
-		double xmin;
-		double xmax;
-		double ymin;
-		double ymax;
-		
 	public:
 	
 		VFun_PSFDescription_2DGauss_LL( TH2D* iSkymap = 0, double i_xmin = -1., double i_xmax = 1., double i_ymin = -1., double i_ymax = 1. );
 		
+		double evaluateBins( const vector< double >& par, unsigned int iFirst, unsigned int iLast, vector< double >* iGradient ) const;
+		
 		/////////////////////////////////
 		// function to be minimized
 		double operator()( const std::vector<double>& par ) const
@@ -247,76 +243,19 @@ class VFun_PSFDescription_2DGauss_LL : public ROOT::Minuit2::FCNBase
 			if( par.size() != 3 )
 			{
 				cout << "VFun_PSFDescription_2DGauss_LL: error in parameter vector size; expect 3, is " << par.size() << endl;
+				return 0.;
 			}
-			
-			// initialize variables
-			double  LL = 0.;
-			double  sum = 0.;
-			double  meanX  = par[0];
-			double  meanY  = par[1];
-			double  sigma = par[2];
-			
-			double x = 0.;
-			double y = 0.;
-			double n = 0.;                                // measured sum in channel i
-			
-			if( sigma >= 0. ) // && sigmaH >= 0. )
+			return sumBins( par, 0 );
+		}
+		std::vector< double > Gradient( const std::vector<double>& par ) const
+		{
+			std::vector< double > g( par.size(), 0. );
+			if( par.size() == 3 )
 			{
-				int nbinsX = hSkyMap->GetNbinsX();
-				int nbinsY = hSkyMap->GetNbinsY();
-				for( int i = 1; i <= nbinsX; i++ )
-				{
-					x = hSkyMap->GetXaxis()->GetBinCenter( i );
-					// check x-range
-					if( x > xmax )
-					{
-						continue;
-					}
-					if( x < xmin )
-					{
-						continue;
-					}
-					for( int j = 1; j <= nbinsY; j++ )
-					{
-						y = hSkyMap->GetYaxis()->GetBinCenter( j );
-						// check y-range
-						if( y > ymax )
-						{
-							continue;
-						}
-						if( y < ymin )
-						{
-							continue;
-						}
-						
-						n = hSkyMap->GetBinContent( i, j );
-						
-						// check for valid entries
-						if( n > -999. )
-						{
-							// calculate log-likelihood
-							sum  = ( x - meanX ) * ( x - meanX ) / sigma / sigma ;
-							sum += ( y - meanY ) * ( y - meanY ) / sigma / sigma ;
-							sum *= -1. / 2. ;
-							sum  = sqrt( 1. / 2. / M_PI / sigma / sigma ) * exp( sum );
-							
-							// assume Poisson fluctuations (neglecting background noise)
-							if( n > 0. && sum > 0. )
-							{
-								LL += n * log( sum ) - sum - n * log( n ) + n;
-							}
-							else
-							{
-								LL += -1. * sum;
-							}
-						}
-					}
-				}
+				sumBins( par, &g );
 			}
-			
-			return -1. * LL;
+			return g;
 		}
-		
 		double Up() const
 		{
 			return 1.;
@@ -330,20 +269,14 @@ class VFun_PSFDescription_2DGauss_LL : public ROOT::Minuit2::FCNBase
 //
 //
 ///////////////////////////////////////////////////////////////////////////////
-class VFun_PSFDescription_LinearSuperposition2DGauss_LL: public ROOT::Minuit2::FCNBase
+class VFun_PSFDescription_LinearSuperposition2DGauss_LL: public ROOT::Minuit2::FCNGradientBase, public VSourceGeometryFitterFCN
 {
-	private:
-	
-		TH2D* hSkyMap;
-		double xmin;
-		double xmax;
-		double ymin;
-		double ymax;
-		
 	public:
 	
 		VFun_PSFDescription_LinearSuperposition2DGauss_LL( TH2D* iSkymap = 0, double i_xmin = -1., double i_xmax = 1., double i_ymin = -1., double i_ymax = 1. );
 		
+		double evaluateBins( const vector< double >& par, unsigned int iFirst, unsigned int iLast, vector< double >* iGradient ) const;
+		
 		/////////////////////////////////
 		// function to be minimized
 		double operator()( const std::vector<double>& par ) const
@@ -352,87 +285,19 @@ class VFun_PSFDescription_LinearSuperposition2DGauss_LL: public ROOT::Minuit2::F
 			if( par.size() != 5 )
 			{
 				cout << "VFun_PSFDescription_LinearSuperposition2DGauss_LL: error in parameter vector size; expect 5, is " << par.size() << endl;
+				return 0.;
 			}
-			
-			// initialize variables
-			double  LL = 0.;
-			double  sum = 0.;
-			double  sum1 = 0.; // central spot
-			double  sum2 = 0.; // broad halo
-			double  meanX  = par[0];
-			double  meanY  = par[1];
-			double  sigma1 = par[2];
-			double  sigma2 = par[3];
-			double  alpha  = par[4]; // relative importance of each component , alpha = 1 only central spot matters
-			
-			
-			double x = 0.;
-			double y = 0.;
-			double n = 0.;                                // measured sum in channel i
-			
-			if( sigma1 >= 0. && sigma2 >= 0. )
+			return sumBins( par, 0 );
+		}
+		std::vector< double > Gradient( const std::vector<double>& par ) const
+		{
+			std::vector< double > g( par.size(), 0. );
+			if( par.size() == 5 )
 			{
-				int nbinsX = hSkyMap->GetNbinsX();
-				int nbinsY = hSkyMap->GetNbinsY();
-				for( int i = 1; i <= nbinsX; i++ )
-				{
-					x = hSkyMap->GetXaxis()->GetBinCenter( i );
-					// check x-range
-					if( x > xmax )
-					{
-						continue;
-					}
-					if( x < xmin )
-					{
-						continue;
-					}
-					for( int j = 1; j <= nbinsY; j++ )
-					{
-						y = hSkyMap->GetYaxis()->GetBinCenter( j );
-						// check y-range
-						if( y > ymax )
-						{
-							continue;
-						}
-						if( y < ymin )
-						{
-							continue;
-						}
-						
-						n = hSkyMap->GetBinContent( i, j );
-						
-						// check for valid entries
-						if( n > -999. )
-						{
-							// calculate log-likelihood
-							sum1  = ( x - meanX ) * ( x - meanX ) / sigma1 / sigma1 ;
-							sum1 += ( y - meanY ) * ( y - meanY ) / sigma1 / sigma1 ;
-							sum1 *= -1. / 2. ;
-							
-							sum2  = ( x - meanX ) * ( x - meanX ) / sigma2 / sigma2 ;
-							sum2 += ( y - meanY ) * ( y - meanY ) / sigma2 / sigma2 ;
-							sum2 *= -1. / 2. ;
-							
-							sum  = alpha * sqrt( 1. / 2. / M_PI / sigma1 / sigma1 ) * exp( sum1 );
-							sum += ( 1 - alpha ) * sqrt( 1. / 2. / M_PI / sigma2 / sigma2 ) * exp( sum2 );
-							
-							
-							// assume Poisson fluctuations (neglecting background noise)
-							if( n > 0. && sum > 0. )
-							{
-								LL += n * log( sum ) - sum - n * log( n ) + n;
-							}
-							else
-							{
-								LL += -1. * sum;
-							}
-						}
-					}
-				}
+				sumBins( par, &g );
 			}
-			return -1. * LL;
+			return g;
 		}
-		
 		double Up() const
 		{
 			return 1.;
@@ -452,21 +317,18 @@ class VFun_PSFDescription_LinearSuperposition2DGauss_LL: public ROOT::Minuit2::F
 ///////////////////////////////////////////////////////////////////////////////
 // Source Description (1); radial symmetric source, Chi2
 ///////////////////////////////////////////////////////////////////////////////
-class VFun_SourceDescription_RadialSymmetricSource_Chi2 : public ROOT::Minuit2::FCNBase
+class VFun_SourceDescription_RadialSymmetricSource_Chi2 : public ROOT::Minuit2::FCNGradientBase, public VSourceGeometryFitterFCN
 {
 	private:
 	
-		TH2D* hSkyMap;
-		double xmin;
-		double xmax;
-		double ymin;
-		double ymax;
 		double sigmaPSF;
 		
 	public:
 	
 		VFun_SourceDescription_RadialSymmetricSource_Chi2( TH2D* iSkymap = 0, double i_xmin = -1., double i_xmax = 1., double i_ymin = -1., double i_ymax = 1., double i_psf = 0.063 );
 		
+		double evaluateBins( const vector< double >& par, unsigned int iFirst, unsigned int iLast, vector< double >* iGradient ) const;
+		
 		/////////////////////////////////
 		// function to be minimized
 		double operator()( const std::vector<double>& par ) const
@@ -477,78 +339,16 @@ class VFun_SourceDescription_RadialSymmetricSource_Chi2 : public ROOT::Minuit2::
 				cout << "VFun_SourceDescription_RadialSymmetricSource_Chi2: error in parameter vector size; expect 4, is " << par.size() << endl;
 				return 0.;
 			}
-			
-			// set variables
-			double x = 0.;
-			double y = 0.;
-			
-			double sum = 0.;
-			double fT = 0.;
-			double fH = 0.;
-			double fHErr = 0;
-			
-			double t2 = 0.;
-			double sigmaSRC = par[2];
-			
-			// loop over sky map
-			if( hSkyMap )
+			return sumBins( par, 0 );
+		}
+		std::vector< double > Gradient( const std::vector<double>& par ) const
+		{
+			std::vector< double > g( par.size(), 0. );
+			if( par.size() == 4 )
 			{
-				int nbinsX = hSkyMap->GetNbinsX();
-				int nbinsY = hSkyMap->GetNbinsY();
-				for( int i = 1; i <= nbinsX; i++ )
-				{
-					x = hSkyMap->GetXaxis()->GetBinCenter( i );
-					// check x-range
-					if( x > xmax )
-					{
-						continue;
-					}
-					if( x < xmin )
-					{
-						continue;
-					}
-					for( int j = 1; j <= nbinsY; j++ )
-					{
-						y = hSkyMap->GetYaxis()->GetBinCenter( j );
-						// check y-range
-						if( y > ymax )
-						{
-							continue;
-						}
-						if( y < ymin )
-						{
-							continue;
-						}
-						
-						// skip empty bins
-						//	if( hSkyMap->GetBinContent( i, j ) <= 0. )
-						//	{
-						//		continue;
-						//	}
-						
-						// calculate theta2
-						t2 = ( x - par[0] ) * ( x - par[0] ) + ( y - par[1] ) * ( y - par[1] );
-						
-						// calculate expectation from model function
-						fT = par[3] * TMath::Exp( -1.*t2 / 2. / ( sigmaSRC * sigmaSRC + sigmaPSF * sigmaPSF ) );
-						if( isnan( fT ) )
-						{
-							continue;
-						}
-						
-						// get value and error in histogram
-						fH = hSkyMap->GetBinContent( i, j );
-						fHErr = hSkyMap->GetBinError( i, j );
-						
-						// calculate chi2
-						if( fHErr > 0. && fH > -90. )
-						{
-							sum += ( fT - fH ) * ( fT - fH ) / fHErr / fHErr;
-						}
-					}
-				}
+				sumBins( par, &g );
 			}
-			return sum;
+			return g;
 		}
 		double Up() const
 		{
@@ -656,26 +456,22 @@ class VFun_SourceDescription_RadialSymmetricSource_Chi2 : public ROOT::Minuit2::
 */
 
 
-
 ///////////////////////////////////////////////////////////////////////////////
 // Source Description (3): Radial Symmetric Sources, LL
 // TODO: needs more work to take zero and negative bins into account
 ///////////////////////////////////////////////////////////////////////////////
-class VFun_SourceDescription_RadialSymmetricSource_LL: public ROOT::Minuit2::FCNBase
+class VFun_SourceDescription_RadialSymmetricSource_LL: public ROOT::Minuit2::FCNGradientBase, public VSourceGeometryFitterFCN
 {
 	private:
 	
-		TH2D* hSkyMap;
-		double xmin;
-		double xmax;
-		double ymin;
-		double ymax;
 		double sigmaPSF;
 		
 	public:
 	
 		VFun_SourceDescription_RadialSymmetricSource_LL( TH2D* iSkymap = 0, double i_xmin = -1., double i_xmax = 1., double i_ymin = -1., double i_ymax = 1., double i_psf = 0.063 );
 		
+		double evaluateBins( const vector< double >& par, unsigned int iFirst, unsigned int iLast, vector< double >* iGradient ) const;
+		
 		/////////////////////////////////
 		// function to be minimized
 		double operator()( const std::vector<double>& par ) const
@@ -684,77 +480,19 @@ class VFun_SourceDescription_RadialSymmetricSource_LL: public ROOT::Minuit2::FCN
 			if( par.size() != 3 )
 			{
 				cout << "VFun_SourceDescription_RadialSymmetricSource_LL: error in parameter vector size; expect 3, is " << par.size() << endl;
+				return 0.;
 			}
-			
-			
-			// initialize variables
-			double  LL = 0.;
-			double  sum = 0.;
-			double  meanX = par[0];
-			double  meanY = par[1];
-			double  sigmaSRC = par[2];
-			
-			double x = 0.;
-			double y = 0.;
-			double n = 0.;                                // measured sum in channel i
-			
-			if( sigmaSRC > 0. )
+			return sumBins( par, 0 );
+		}
+		std::vector< double > Gradient( const std::vector<double>& par ) const
+		{
+			std::vector< double > g( par.size(), 0. );
+			if( par.size() == 3 )
 			{
-				int nbinsX = hSkyMap->GetNbinsX();
-				int nbinsY = hSkyMap->GetNbinsY();
-				for( int i = 1; i <= nbinsX; i++ )
-				{
-					x = hSkyMap->GetXaxis()->GetBinCenter( i );
-					// check x-range
-					if( x > xmax )
-					{
-						continue;
-					}
-					if( x < xmin )
-					{
-						continue;
-					}
-					for( int j = 1; j <= nbinsY; j++ )
-					{
-						y = hSkyMap->GetYaxis()->GetBinCenter( j );
-						// check y-range
-						if( y > ymax )
-						{
-							continue;
-						}
-						if( y < ymin )
-						{
-							continue;
-						}
-						
-						n = hSkyMap->GetBinContent( i, j );
-						
-						// check for valid entries
-						if( n > -999. )
-						{
-							// calculate log-likelihood
-							sum  = ( x - meanX ) * ( x - meanX ) / ( sigmaSRC * sigmaSRC + sigmaPSF * sigmaPSF );
-							sum += ( y - meanY ) * ( y - meanY ) / ( sigmaSRC * sigmaSRC + sigmaPSF * sigmaPSF );
-							sum *= -1. / 2.;
-							sum  = exp( sum );
-							sum *= 1. / 2. / M_PI / ( sigmaSRC * sigmaSRC + sigmaPSF * sigmaPSF );
-							
-							// assume Poisson fluctuations (neglecting background noise)
-							if( n > 0. && sum > 0. )
-							{
-								LL += n * log( sum ) - sum - n * log( n ) + n;
-							}
-							else
-							{
-								LL += -1. * sum;
-							}
-						}
-					}
-				}
+				sumBins( par, &g );
 			}
-			return -1. * LL;
+			return g;
 		}
-		
 		double Up() const
 		{
 			return 1.;
@@ -767,22 +505,21 @@ class VFun_SourceDescription_RadialSymmetricSource_LL: public ROOT::Minuit2::FCN
 ///////////////////////////////////////////////////////////////////////////////
 // Source Description (4): Radial asymmetric gaussian, convolved with simple PSF
 // TODO: needs more work to take zero and negative bins into account
+//
+// (no analytic gradient; correlation depends on the rotation angle)
 ///////////////////////////////////////////////////////////////////////////////
-class VFun_SourceDescription_RadialAsymmetricSource_LL: public ROOT::Minuit2::FCNBase
+class VFun_SourceDescription_RadialAsymmetricSource_LL: public ROOT::Minuit2::FCNBase, public VSourceGeometryFitterFCN
 {
 	private:
 	
-		TH2D* hSkyMap;
-		double xmin;
-		double xmax;
-		double ymin;
-		double ymax;
 		double sigmaPSF;
 		
 	public:
 	
 		VFun_SourceDescription_RadialAsymmetricSource_LL( TH2D* iSkymap = 0, double i_xmin = -1., double i_xmax = 1., double i_ymin = -1., double i_ymax = 1., double i_psf = 0.063 );
 		
+		double evaluateBins( const vector< double >& par, unsigned int iFirst, unsigned int iLast, vector< double >* iGradient ) const;
+		
 		/////////////////////////////////
 		// function to be minimized
 		double operator()( const std::vector<double>& par ) const
@@ -791,81 +528,9 @@ class VFun_SourceDescription_RadialAsymmetricSource_LL: public ROOT::Minuit2::FC
 			if( par.size() != 5 )
 			{
 				cout << "VFun_SourceDescription_RadialAsymmetricSource_LL: error in parameter vector size; expect 5, is " << par.size() << endl;
+				return 0.;
 			}
-			
-			
-			// initialize variables
-			double  LL = 0.;
-			double  sum = 0.;
-			//    double  rho =  par[0];
-			double  meanX = par[1];
-			double  sigmaX = par[2];
-			double  meanY = par[3];
-			double  sigmaY = par[4];
-			double  angle = par[0];
-			double  rho = 1. / 2. * tan( 2 * angle ) * ( sigmaX * sigmaX - sigmaY * sigmaY ) / sqrt( sigmaX * sigmaX + sigmaPSF * sigmaPSF ) / sqrt( sigmaY * sigmaY + sigmaPSF * sigmaPSF );
-			
-			
-			double x = 0.;
-			double y = 0.;
-			double n = 0.;                                // measured sum in channel i
-			
-			if( rho * rho < 1. && sigmaX > 0. && sigmaY > 0. )
-			{
-				int nbinsX = hSkyMap->GetNbinsX();
-				int nbinsY = hSkyMap->GetNbinsY();
-				for( int i = 1; i <= nbinsX; i++ )
-				{
-					x = hSkyMap->GetXaxis()->GetBinCenter( i );
-					// check x-range
-					if( x > xmax )
-					{
-						continue;
-					}
-					if( x < xmin )
-					{
-						continue;
-					}
-					for( int j = 1; j <= nbinsY; j++ )
-					{
-						y = hSkyMap->GetYaxis()->GetBinCenter( j );
-						// check y-range
-						if( y > ymax )
-						{
-							continue;
-						}
-						if( y < ymin )
-						{
-							continue;
-						}
-						
-						n = hSkyMap->GetBinContent( i, j );
-						
-						// check for valid entries
-						if( n > -999. )
-						{
-							// calculate log-likelihood
-							sum  = ( x - meanX ) * ( x - meanX ) / ( sigmaX * sigmaX + sigmaPSF * sigmaPSF );
-							sum += ( y - meanY ) * ( y - meanY ) / ( sigmaY * sigmaY + sigmaPSF * sigmaPSF );
-							sum += -2. * rho * ( x - meanX ) / sqrt( sigmaX * sigmaX + sigmaPSF * sigmaPSF ) * ( y - meanY ) / sqrt( sigmaY * sigmaY + sigmaPSF * sigmaPSF );
-							sum *= -1. / 2. / ( 1. - rho * rho );
-							sum  = exp( sum );
-							sum *= 1. / 2. / M_PI / sqrt( sigmaX * sigmaX + sigmaPSF * sigmaPSF ) /  sqrt( sigmaY * sigmaY + sigmaPSF * sigmaPSF ) / sqrt( 1. - rho * rho );
-							
-							// assume Poisson fluctuations (neglecting background noise)
-							if( n > 0. && sum > 0. )
-							{
-								LL += n * log( sum ) - sum - n * log( n ) + n;
-							}
-							else
-							{
-								LL += -1. * sum;
-							}
-						}
-					}
-				}
-			}
-			return -1. * LL;
+			return sumBins( par, 0 );
 		}
 		
 		double Up() const
@@ -16,6 +16,9 @@
 #include "VSkyCoordinates.h"
 #include "VSkyCoordinatesUtilities.h"
 #include "VPointingDB.h"
+#ifndef NOFITS
+#include "VDL3FITSWriter.h"
+#endif
 
 #include "TDirectory.h"
 #include "TDirectoryFile.h"
@@ -45,7 +48,7 @@ class VStereoAnalysis
 	
 		VStereoAnalysis( bool isOnrun, string i_hsuffix, VAnaSumRunParameter* irunpara,
 						 vector< TDirectory* > iRDir, TDirectory* iDir, string iDataDir, int iRandomSeed, bool iTotalAnalysisOnly );
-		~VStereoAnalysis() {}
+		~VStereoAnalysis();
 		double fillHistograms( int icounter, int irun, double AzMin = -1.e3, double AzMax = 1.e3, double iPedVar = -1. );
 		TH2D*  getAlpha();
 		TH2D*  getAlphaUC();
@@ -202,6 +205,9 @@ class VStereoAnalysis
 		double  fDL3EventTree_MVA;
 		UInt_t  fDL3EventTree_IsGamma;
 		VRadialAcceptance* fDL3_Acceptance;
+#ifndef NOFITS
+		VDL3FITSWriter* fDL3FITSWriter;     // DL3 FITS output (EVENTS, GTI, EFFECTIVE AREA)
+#endif
 		
 		double  fDeadTimeStorage ;
 		//double fullMJD ;
@@ -132,7 +132,7 @@ class VStereoMaps
 		TH1D* hAux_theta2Ratio;
 		
 		VStereoMaps( bool, int, bool );
-		~VStereoMaps() {}
+		~VStereoMaps();
 		
 		void              calculateTheta2( bool, double, double );
 		bool              fill( bool is_on, double x_sky, double y_sky, double theta2CutMax, double ze,
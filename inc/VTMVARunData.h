@@ -65,6 +65,11 @@ class VTMVARunData : public TNamed
 		unsigned int      fnTrain_Signal;
 		unsigned int      fnTrain_Background;
 		
+		// preparation of training samples
+		unsigned int      fPrepareTrainingThreads;
+		UInt_t            fTrainingSampleSeed;
+		string            fTrainingSampleCacheDirectory;
+		
 		// list of training variables
 		vector< string >  fTrainingVariable;
 		vector< char >    fTrainingVariableType;
@@ -114,7 +119,7 @@ class VTMVARunData : public TNamed
 		void shuffleFileVectors();
 		void updateTrainingEvents( string iVarName, unsigned int iNEvents );
 		
-		ClassDef( VTMVARunData, 11 );
+		ClassDef( VTMVARunData, 12 );
 };
 
 #endif
@@ -0,0 +1,68 @@
+//! VTMVATrainingSample training samples for TMVA (parallel filling per input file, deterministic merging, caching)
+
+#ifndef VTMVATrainingSample_H
+#define VTMVATrainingSample_H
+
+#include "TDirectory.h"
+#include "TFile.h"
+#include "TMD5.h"
+#include "TNamed.h"
+#include "TROOT.h"
+#include "TSystem.h"
+#include "TTree.h"
+
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+class VTMVATrainingSample
+{
+	private:
+	
+		bool fDebug;
+		
+		string fName;                              // tree name
+		string fTitle;                             // tree title
+		vector< string > fVariableName;            // list of variables
+		vector< char >   fVariableType;            // variable types (D=Double_t, F=Float_t, I=Int_t, i=UInt_t)
+		vector< vector< double > > fFileData;      // selected events per input file (one row per event)
+		
+		static void processFileQueue( unsigned int iNFiles, atomic< unsigned int >* iNextFile,
+									  atomic< bool >* iSuccess, function< bool( unsigned int ) >* iFileProcessor );
+		
+	public:
+	
+		VTMVATrainingSample( string iName, string iTitle = "" );
+		~VTMVATrainingSample() {}
+		
+		void      addVariable( string iName, char iType = 'D' );
+		void      clear();
+		Long64_t  getEntries();
+		Long64_t  getEntries( unsigned int iFile );
+		vector< double >* getFileData( unsigned int iFile );
+		unsigned int getNVariables()
+		{
+			return fVariableName.size();
+		}
+		TTree*    getTree();
+		vector< string > getVariableNames()
+		{
+			return fVariableName;
+		}
+		bool      readCache( string iCacheFileName, string iKey );
+		void      setNFiles( unsigned int iNFiles );
+		bool      writeCache( string iCacheFileName, string iKey );
+		
+		static vector< string > getFileKeys( vector< string > iFileName );
+		static string getKey( vector< string > iConfiguration );
+		static UInt_t getSeed( UInt_t iSeed, unsigned int iFile );
+		static bool   processFiles( unsigned int iNFiles, unsigned int iNThreads,
+								   function< bool( unsigned int ) > iFileProcessor );
+};
+#endif
@@ -7,10 +7,12 @@
 #include "VDeadTime.h"
 #include "VEffectiveAreaCalculatorMCHistograms.h"
 #include "VMonteCarloRunHeader.h"
+#include "VMSCWRunInfo.h"
 #include "VDispAnalyzer.h"
 #include "VPointingCorrectionsTreeReader.h"
 #include "VSimpleStereoReconstructor.h"
 #include "VTableLookupRunParameter.h"
+#include "VTreeIOPolicy.h"
 #include "VUtilities.h"
 
 #include "TChain.h"
@@ -50,6 +52,8 @@ class VTableLookupDataHandler
 		vector< string > finputfile;                        //!< input file name
 		string foutputfile;                       //!< output file name
 		TFile* fOutFile;                          //!< point to output file
+		VTreeIOPolicy* fTreeIOPolicy;             //!< I/O settings for output tree
+		VMSCWRunInfo fRunInfo;                    //!< run summary of output tree (written as sidecar file)
 		bool   fwrite;                            //!< true for table filling
 		
 		unsigned int fNTel;                       //!< number of telescopes
@@ -86,6 +86,13 @@ class VTableLookupRunParameter : public TNamed, public VGlobalRunParameter
 		
 		Long64_t fNentries;
 		double fMaxRunTime;
+		// I/O settings
+		string fTreeCompression;                  // compression of output tree (ALGORITHM:LEVEL, e.g. ZSTD:5; empty = ROOT default)
+		Long64_t fTreeAutoFlush;                  // auto flush of output tree (>0: entries; <0: bytes; 0: ROOT default)
+		int fTreeBasketSize;                      // basket size of all branches of output tree (0: ROOT default)
+		vector< string > fTreeBranchBasketSize;   // basket sizes of individual branches (BRANCHNAME:BYTES)
+		unsigned int fTreeIOThreads;              // number of threads for parallel basket compression (0: off)
+		Long64_t fTreeReadCacheSize;              // read cache size for evndisp input trees (bytes; 0: ROOT default)
 		// parameters to be used in anasum
 		double meanpedvars;                       // mean pedvar
 		vector< double > pedvars;                 // mean pedvar per telescope
@@ -110,6 +117,6 @@ class VTableLookupRunParameter : public TNamed, public VGlobalRunParameter
 		void print( int iB = 0 );
 		void printHelp();
 		
-		ClassDef( VTableLookupRunParameter, 30 );
+		ClassDef( VTableLookupRunParameter, 31 );
 };
 #endif
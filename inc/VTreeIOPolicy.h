@@ -0,0 +1,49 @@
+//! VTreeIOPolicy I/O settings (compression, clustering, basket sizes, read cache) for output and input trees
+
+#ifndef VTreeIOPolicy_H
+#define VTreeIOPolicy_H
+
+#include "TFile.h"
+#include "TROOT.h"
+#include "TTree.h"
+
+#include <iostream>
+#include <map>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "VUtilities.h"
+
+using namespace std;
+
+class VTreeIOPolicy
+{
+	private:
+	
+		bool fDebug;
+		
+		int      fCompressionAlgorithm;           // ROOT compression algorithm (1=ZLIB, 2=LZMA, 4=LZ4, 5=ZSTD; <0 = ROOT default)
+		int      fCompressionLevel;               // compression level (0-9)
+		Long64_t fAutoFlush;                      // auto flush (>0: entries; <0: bytes; 0: ROOT default)
+		int      fBasketSize;                     // default basket size (bytes) for all branches (0: ROOT default)
+		map< string, int > fBranchBasketSize;     // basket sizes for individual branches (wildcards allowed)
+		unsigned int fNThreads;                   // number of threads for parallel basket compression (0: off)
+		
+		bool     setCompression( string iCompression );
+		
+	public:
+	
+		VTreeIOPolicy();
+		~VTreeIOPolicy() {}
+		
+		void     apply( TFile* iFile );
+		void     apply( TTree* iTree );
+		int      getCompressionSettings();
+		bool     isDefault();
+		void     print();
+		bool     set( string iCompression, Long64_t iAutoFlush = 0, int iBasketSize = 0,
+					  vector< string > iBranchBasketSize = vector< string >(), unsigned int iNThreads = 0 );
+		static void setReadCache( TTree* iTree, Long64_t iCacheSize, Long64_t iLearnEntries = 100 );
+};
+#endif
@@ -155,6 +155,8 @@ class VVirtualDataReader
 			return 3;
 		}
 		double                              getSample_double( unsigned channel, unsigned sample, bool iNewNoiseTrace = true );
+		virtual void                        getSamples_double( unsigned channel, unsigned iFirstSample, unsigned iNSamples,
+				vector< double >& iTrace );
 		virtual std::vector< uint16_t >     getSamplesVec16Bit()
 		{
 			return iSampleVec16bit;
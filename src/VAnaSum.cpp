@@ -24,6 +24,39 @@ VAnaSum::VAnaSum( string i_datadir, unsigned int iAnalysisType )
 	fTotalDir = 0;
 	fTotalDirName = "total_1";
 	fStereoTotalDir = 0;
+	
+	fRunCacheDir = "";
+}
+
+/*
+   (histograms are owned by the output file and deleted when closing it)
+*/
+VAnaSum::~VAnaSum()
+{
+	if( fStereoOn )
+	{
+		delete fStereoOn;
+	}
+	if( fStereoOff )
+	{
+		delete fStereoOff;
+	}
+	if( fRatePlots )
+	{
+		delete fRatePlots;
+	}
+	if( fRunSummary )
+	{
+		delete fRunSummary;
+	}
+	if( fRunPara )
+	{
+		delete fRunPara;
+	}
+	if( fOPfile )
+	{
+		delete fOPfile;
+	}
 }
 
 /*
@@ -47,6 +80,20 @@ void VAnaSum::initialize(
 	///////////////////////////////////////////////////////////////////////////////
 	// check analysis run mode
 	fAnalysisRunMode = iRunType;
+	// incremental analysis
+	// (analyse new or changed runs into the run cache, then merge all runs from the run cache)
+	if( fAnalysisRunMode == 2 )
+	{
+		cout << "incremental analysis (run cache: " << fRunCacheDir << ")" << endl << endl;
+		if( !updateRunCache( i_LongListFilename, i_ShortListFilename, i_singletel, iRandomSeed, iRunParameterfile ) )
+		{
+			cout << "error while updating run cache" << endl;
+			cout << "...exiting" << endl;
+			exit( EXIT_FAILURE );
+		}
+		fDatadir = fRunCacheDir + "/";
+		fAnalysisRunMode = 1;
+	}
 	// merging analysis
 	if( fAnalysisRunMode == 1 )
 	{
@@ -76,6 +123,25 @@ void VAnaSum::initialize(
 	{
 		i_npair = fRunPara->loadShortFileList( i_ShortListFilename, fDatadir, ( fAnalysisRunMode == 1 ) );
 	}
+	// analyse selected runs only (incremental analysis)
+	if( fSelectedRuns.size() > 0 )
+	{
+		vector< VAnaSumRunParameterDataClass > iRunList;
+		for( unsigned int j = 0; j < fRunPara->fRunList.size(); j++ )
+		{
+			if( fSelectedRuns.find( fRunPara->fRunList[j].fRunOn ) != fSelectedRuns.end() )
+			{
+				iRunList.push_back( fRunPara->fRunList[j] );
+			}
+		}
+		fRunPara->fRunList = iRunList;
+		fRunPara->fMapRunList.clear();
+		for( unsigned int j = 0; j < fRunPara->fRunList.size(); j++ )
+		{
+			fRunPara->fMapRunList[fRunPara->fRunList[j].fRunOn] = fRunPara->fRunList[j];
+		}
+		i_npair = ( int )fRunPara->fRunList.size();
+	}
 	if( i_npair == 0 )
 	{
 		cout << "VAnaSum error: no files found in runlist" << endl;
@@ -1033,6 +1099,190 @@ void VAnaSum::fillRunSummary( int onrun, int offrun, double iexp_on, double iexp
 }
 
 
+/*
+ * per-run anasum file in run cache
+ *
+ */
+string VAnaSum::getRunCacheFileName( int i_run )
+{
+	ostringstream iFileName;
+	iFileName << fRunCacheDir << "/" << i_run << ".anasum.root";
+	return iFileName.str();
+}
+
+/*
+ * key describing all input to the analysis of a run
+ *
+ * (a cached run is reanalysed if its key changes: new mscw files, modified
+ *  run parameter file, changed run list entry, different anasum version)
+ */
+string VAnaSum::getRunCacheKey( VAnaSumRunParameter* iRunPara, unsigned int i, string iRunParameterMD5, int iRandomSeed )
+{
+	if( !iRunPara || i >= iRunPara->fRunList.size() )
+	{
+		return "";
+	}
+	VAnaSumRunParameterDataClass* r = &iRunPara->fRunList[i];
+	ostringstream iKey;
+	iKey.precision( 12 );
+	iKey << "version " << VGlobalRunParameter::getEVNDISP_VERSION();
+	iKey << " analysistype " << fAnalysisType;
+	iKey << " randomseed " << iRandomSeed;
+	iKey << " runparameter " << iRunParameterMD5;
+	// mscw files (size and modification time)
+	int iRun[] = { r->fRunOn, r->fRunOff };
+	for( unsigned int f = 0; f < 2; f++ )
+	{
+		ostringstream iFileName;
+		iFileName << fDatadir << fPrefix << iRun[f] << fSuffix;
+		FileStat_t iStat;
+		if( gSystem->GetPathInfo( iFileName.str().c_str(), iStat ) != 0 )
+		{
+			return "";
+		}
+		iKey << " run " << iRun[f] << " " << iStat.fSize << " " << iStat.fMtime;
+	}
+	// run list entry
+	iKey << " target " << r->fTarget << " " << r->fTargetShiftNorth << " " << r->fTargetShiftWest;
+	iKey << " pairoffset " << r->fPairOffset;
+	iKey << " tel " << r->fTelToAna;
+	for( unsigned int t = 0; t < r->fTelToAnalyze.size(); t++ )
+	{
+		iKey << " " << r->fTelToAnalyze[t];
+	}
+	iKey << " cuts " << r->fCutFile;
+	iKey << " effarea " << r->fEffectiveAreaFile;
+	iKey << " acceptance " << r->fAcceptanceFile << " " << r->f2DAcceptanceMode;
+	iKey << " background " << r->fBackgroundModel << " " << r->fSourceRadius << " " << r->fmaxradius;
+	iKey << " " << r->fNBoxSmooth << " " << r->fOO_alpha;
+	iKey << " " << r->fRM_RingRadius << " " << r->fRM_RingWidth;
+	iKey << " " << r->fRE_distanceSourceOff << " " << r->fRE_nMinoffsource << " " << r->fRE_nMaxoffsource;
+	iKey << " " << r->fTE_mscw_min << " " << r->fTE_mscw_max << " " << r->fTE_mscl_min << " " << r->fTE_mscl_max;
+	
+	return iKey.str();
+}
+
+/*
+ * check that a per-run anasum file exists and was produced with the given key
+ *
+ */
+bool VAnaSum::isValidRunCacheFile( string iFileName, string iKey )
+{
+	if( iKey.size() == 0 || gSystem->AccessPathName( iFileName.c_str() ) )
+	{
+		return false;
+	}
+	TFile iF( iFileName.c_str() );
+	if( iF.IsZombie() )
+	{
+		return false;
+	}
+	bool bValid = false;
+	TNamed* iCacheKey = ( TNamed* )iF.Get( "anasumRunCacheKey" );
+	if( iCacheKey && iKey == iCacheKey->GetTitle() && iF.Get( fTotalDirName.c_str() ) )
+	{
+		bValid = true;
+	}
+	iF.Close();
+	return bValid;
+}
+
+/*
+ * analyse all runs without valid per-run anasum file in run cache
+ *
+ * (each run is analysed as in the sequential analysis with a run list
+ *  restricted to this run; resulting anasum file is identical in format
+ *  to the files used in the merging analysis)
+ */
+bool VAnaSum::updateRunCache( string i_LongListFilename, string i_ShortListFilename, int i_singletel,
+							  int iRandomSeed, string iRunParameterfile )
+{
+	if( fRunCacheDir.size() == 0 )
+	{
+		cout << "VAnaSum::updateRunCache error: no run cache directory given" << endl;
+		return false;
+	}
+	gSystem->mkdir( fRunCacheDir.c_str(), kTRUE );
+	
+	// list of runs (as for the sequential analysis)
+	VAnaSumRunParameter* iRunPara = new VAnaSumRunParameter();
+	if( !iRunPara->readRunParameter( iRunParameterfile ) )
+	{
+		delete iRunPara;
+		return false;
+	}
+	if( i_LongListFilename.size() > 0 )
+	{
+		iRunPara->loadLongFileList( i_LongListFilename, false, false );
+	}
+	else
+	{
+		iRunPara->loadShortFileList( i_ShortListFilename, fDatadir, false );
+	}
+	string iRunParameterMD5 = VFileChecksum::calcMD5sum( iRunParameterfile );
+	
+	vector< int > iRunsToAnalyse;
+	vector< string > iRunKeys;
+	for( unsigned int j = 0; j < iRunPara->fRunList.size(); j++ )
+	{
+		string iKey = getRunCacheKey( iRunPara, j, iRunParameterMD5, iRandomSeed );
+		if( iKey.size() == 0 )
+		{
+			cout << "VAnaSum::updateRunCache error: data files not found for run " << iRunPara->fRunList[j].fRunOn << endl;
+			delete iRunPara;
+			return false;
+		}
+		if( !isValidRunCacheFile( getRunCacheFileName( iRunPara->fRunList[j].fRunOn ), iKey ) )
+		{
+			iRunsToAnalyse.push_back( iRunPara->fRunList[j].fRunOn );
+			iRunKeys.push_back( iKey );
+		}
+	}
+	cout << "run cache: " << iRunPara->fRunList.size() - iRunsToAnalyse.size() << " run(s) up to date, ";
+	cout << iRunsToAnalyse.size() << " run(s) to be analysed" << endl;
+	delete iRunPara;
+	
+	// analyse new or changed runs
+	string iDataDir = fDatadir.substr( 0, fDatadir.size() - 1 );
+	for( unsigned int j = 0; j < iRunsToAnalyse.size(); j++ )
+	{
+		cout << endl;
+		cout << "=======================================================================" << endl;
+		cout << "run cache: analysing run " << iRunsToAnalyse[j] << " (" << j + 1 << " out of " << iRunsToAnalyse.size() << ")" << endl;
+		string iCacheFileName = getRunCacheFileName( iRunsToAnalyse[j] );
+		ostringstream iTempFileName;
+		iTempFileName << iCacheFileName << "." << gSystem->GetPid() << ".tmp.root";
+		
+		VAnaSum iRunAnaSum( iDataDir, fAnalysisType );
+		iRunAnaSum.fSelectedRuns.insert( iRunsToAnalyse[j] );
+		iRunAnaSum.initialize( i_LongListFilename, i_ShortListFilename, i_singletel, 0,
+							   iTempFileName.str(), iRandomSeed, iRunParameterfile );
+		iRunAnaSum.doStereoAnalysis( fAnalysisType == 3 );
+		iRunAnaSum.terminate();
+		
+		// write key and move file into run cache
+		TFile iF( iTempFileName.str().c_str(), "update" );
+		if( iF.IsZombie() )
+		{
+			cout << "VAnaSum::updateRunCache error: cannot open " << iTempFileName.str() << endl;
+			return false;
+		}
+		TNamed iCacheKey( "anasumRunCacheKey", iRunKeys[j].c_str() );
+		iCacheKey.Write();
+		iF.Close();
+		if( gSystem->Rename( iTempFileName.str().c_str(), iCacheFileName.c_str() ) != 0 )
+		{
+			cout << "VAnaSum::updateRunCache error: cannot write " << iCacheFileName << endl;
+			gSystem->Unlink( iTempFileName.str().c_str() );
+			return false;
+		}
+	}
+	cout << "=======================================================================" << endl;
+	cout << endl;
+	
+	return true;
+}
+
 void VAnaSum::terminate()
 {
 	if( fOPfile )
@@ -1057,10 +1307,59 @@ double VAnaSum::getAzRange( int i_run, string i_treename, double& azmin, double&
 	
 	char i_temp[2000];
 	sprintf( i_temp, "%s%s%d%s", fDatadir.c_str(), fPrefix.c_str(), i_run, fSuffix.c_str() );
-	TFile* i_f = new TFile( i_temp );
+	
+	// azimuth range from run summary (no need to read the data tree)
+	VMSCWRunInfo iRunInfo;
+	if( iRunInfo.readSidecarFile( i_temp ) )
+	{
+		azmin = iRunInfo.fAzMin;
+		azmax = iRunInfo.fAzMax;
+	}
+	else
+	{
+		getAzRangeFromDataTree( i_temp, i_treename, azmin, azmax );
+	}
+	if( azmin > 180. )
+	{
+		azmin -= 360.;
+	}
+	if( azmax > 180. )
+	{
+		azmax -= 360.;
+	}
+	cout << "\t azimuth range: [" << azmin << "," << azmax << "]" << endl;
+	
+	// calculate mean az
+	// mean azimuth angle
+	if( azmin > 120. && azmax < -120. )
+	{
+		azmax += 360.;
+	}
+	else if( azmin < -150. && azmax > 120. )
+	{
+		azmin += 360.;
+	}
+	
+	azmean = 0.5 * ( azmin + azmax );
+	if( azmean > 180. )
+	{
+		azmean -= 360.;
+	}
+	
+	return azmean;
+}
+
+/*
+ * get azimuth range of a run from the data tree
+ * (for mscw files without run summary)
+ *
+ */
+void VAnaSum::getAzRangeFromDataTree( string iFileName, string i_treename, double& azmin, double& azmax )
+{
+	TFile* i_f = new TFile( iFileName.c_str() );
 	if( i_f->IsZombie() )
 	{
-		cout << "VAnaSum::getAZRange fatal error: file not found, " << i_temp << endl;
+		cout << "VAnaSum::getAZRange fatal error: file not found, " << iFileName << endl;
 		exit( EXIT_FAILURE );
 	}
 	
@@ -1146,37 +1445,8 @@ double VAnaSum::getAzRange( int i_run, string i_treename, double& azmin, double&
 			break;
 		}
 	}
-	if( azmin > 180. )
-	{
-		azmin -= 360.;
-	}
-	if( azmax > 180. )
-	{
-		azmax -= 360.;
-	}
-	cout << "\t azimuth range: [" << azmin << "," << azmax << "]" << endl;
-	
-	// calculate mean az
-	// mean azimuth angle
-	if( azmin > 120. && azmax < -120. )
-	{
-		azmax += 360.;
-	}
-	else if( azmin < -150. && azmax > 120. )
-	{
-		azmin += 360.;
-	}
-	
-	azmean = 0.5 * ( azmin + azmax );
-	if( azmean > 180. )
-	{
-		azmean -= 360.;
-	}
-	
 	i_f->Close();
 	delete i_f;
-	
-	return azmean;
 }
 
 /*!
@@ -1190,6 +1460,16 @@ double VAnaSum::getNoiseLevel( int i_run )
 	double ipedv = -1.;
 	
 	sprintf( i_temp, "%s%s%d%s", fDatadir.c_str(), fPrefix.c_str(), i_run, fSuffix.c_str() );
+	
+	// noise level from run summary (no need to open the mscw file)
+	VMSCWRunInfo iRunInfo;
+	if( iRunInfo.readSidecarFile( i_temp ) )
+	{
+		ipedv = iRunInfo.fMeanPedvars;
+		cout << "\t mean pedestal variations in run " << i_run << ": " << ipedv << endl;
+		return ipedv;
+	}
+	
 	TFile* i_f = new TFile( i_temp );
 	if( i_f->IsZombie() )
 	{
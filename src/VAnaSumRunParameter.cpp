@@ -160,6 +160,8 @@ VAnaSumRunParameter::VAnaSumRunParameter()
 	fWriteAllEvents = false;
 	// Write Dataon/dataoff trees
 	fWriteDataOnOffTrees = false;
+	// DL3 FITS output directory
+	fDL3FITSDirectory = "";
 	
 	// if 0, use default 1D radial acceptance
 	// if >0, use alternate 2D-dependent acceptance
@@ -677,6 +679,11 @@ int VAnaSumRunParameter::readRunParameter( string i_filename )
 					fWriteDataOnOffTrees = true;
 				}
 			}
+			// write DL3 FITS files (EVENTS, GTI, EFFECTIVE AREA) into the given directory
+			else if( temp == "WRITEDL3FITS" )
+			{
+				fDL3FITSDirectory = temp2;
+			}
 			else
 			{
 				cout << "Warning: unknown line in parameter file " << i_filename << ": " << endl;
@@ -422,6 +422,7 @@ void VArrayAnalyzer::initOutput()
 		char i_textTitle[300];
 		sprintf( i_textTitle, "VERSION %d (short tree: %d)", getRunParameter()->getEVNDISP_TREE_VERSION(), ( int )getRunParameter()->fShortTree );
 		fOutputfile = new TFile( fRunPar->foutputfileName.c_str(), "RECREATE", i_textTitle );
+		getTreeIOPolicy()->apply( fOutputfile );
 	}
 }
 
@@ -449,6 +450,7 @@ void VArrayAnalyzer::initTree()
 	// tree versioning numbers used in mscw_energy
 	sprintf( i_textTitle, "Shower Parameters (VERSION %d)", getRunParameter()->getEVNDISP_TREE_VERSION() );
 	fShowerParameters->initTree( i_text, i_textTitle, fReader->isMC() );
+	getTreeIOPolicy()->apply( fShowerParameters->getTree() );
 	if( isMC() && fMCParameters )
 	{
 		fMCParameters->initTree();
@@ -1370,84 +1372,7 @@ int VArrayAnalyzer::rcs_method_4( unsigned int iMethod )
 	// Hofmann et al 1999, Method 1 (HEGRA method)
 	// (modified weights)
 	
-	float itotweight = 0.;
-	float iweight = 1.;
-	float ixs = 0.;
-	float iys = 0.;
-	float iangdiff = 0.;
-	float b1 = 0.;
-	float b2 = 0.;
-	
-	double i_weight_max = 0.;
-	
-	for( unsigned int ii = 0; ii < m.size(); ii++ )
-	{
-		for( unsigned int jj = 1; jj < m.size(); jj++ )
-		{
-			if( ii == jj || ii > jj )
-			{
-				continue;
-			}
-			
-			// check minimum angle between image lines; ignore if too small
-			iangdiff = fabs( atan( m[jj] ) - atan( m[ii] ) );
-			if( iangdiff < fEvndispReconstructionParameter->fAxesAngles_min[iMethod] / TMath::RadToDeg() ||
-					fabs( 180. / TMath::RadToDeg() - iangdiff ) < fEvndispReconstructionParameter->fAxesAngles_min[iMethod] / TMath::RadToDeg() )
-			{
-				continue;
-			}
-			// weight is sin of angle between image lines
-			iangdiff = fabs( sin( fabs( atan( m[jj] ) - atan( m[ii] ) ) ) );
-			
-			b1 = y[ii] - m[ii] * x[ii];
-			b2 = y[jj] - m[jj] * x[jj];
-			
-			// line intersection
-			if( m[ii] != m[jj] )
-			{
-				xs = ( b2 - b1 )  / ( m[ii] - m[jj] );
-			}
-			else
-			{
-				xs = 0.;
-			}
-			ys = m[ii] * xs + b1;
-			
-			
-			iweight  = 1. / ( 1. / w[ii] + 1. / w[jj] ); // weight 1: size of images
-			iweight *= ( 1. - l[ii] ) * ( 1. - l[jj] ); // weight 2: elongation of images (width/length)
-			iweight *= iangdiff;                      // weight 3: angular differences between the two image axis
-			iweight *= iweight;                       // use squared value
-			
-			if( iweight > i_weight_max )
-			{
-				i_weight_max = iweight;
-			}
-			
-			/*  DEBUG for reconstruction
-				    cout << "PAIR " << telID[ii] << "," << telID[jj] << ": ";
-				    cout << iweight << ", " << w[ii] << ", " << w[jj] << ", S: " << 1./(1./w[ii] + 1./w[jj]);
-				    cout << ", " << l[ii] << ", " << l[jj] << ", L: " << (1.-l[ii])*(1.-l[jj]);
-				    cout << ", " << iangdiff;
-				    cout << ",I " << x[ii] << ", " << y[ii];
-				    cout << ",J " << x[jj] << ", " << y[jj];
-				    cout << ", X " << xs << " Y " << ys << endl; */
-			
-			ixs += xs * iweight;
-			iys += ys * iweight;
-			itotweight += iweight;
-		}
-	}
-	if( itotweight > 0. )
-	{
-		xs = ixs / itotweight;
-		ys = iys / itotweight;
-	}
-	else
-	{
-		xs = -99999.;
-		ys = -99999.;
-	}
+	rcs_pairwise_intersection( x, y, w, m, l, fEvndispReconstructionParameter->fAxesAngles_min[iMethod] / TMath::RadToDeg(), &xs, &ys );
 	
 	if( !fillShowerDirection( iMethod, xs, ys, 0. ) )
 	{
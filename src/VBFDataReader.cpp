@@ -19,6 +19,13 @@ VBFDataReader::VBFDataReader( string sourcefile, int isourcetype, unsigned int i
 	fNIncompleteEvent.assign( iNTel, 0 );
 	setDebug( iDebug );
 	fPrintDetectorConfig = iPrintDetectorConfig;
+	fPacketIndex = 0;
+	fPacketIndexBuild = 0;
+	fEventRange = false;
+	fFirstEventNumber = 0;
+	fLastEventNumber = 0;
+	fFirstPacket = 0;
+	fLastPacket = 0;
 }
 
 
@@ -32,6 +39,70 @@ VBFDataReader::~VBFDataReader()
 	{
 		delete pack;
 	}
+	if( fPacketIndex )
+	{
+		delete fPacketIndex;
+	}
+	if( fPacketIndexBuild )
+	{
+		delete fPacketIndexBuild;
+	}
+}
+
+/*
+ * restrict reading to events with event numbers in [iFirstEvent, iLastEvent]
+ *
+ * with a stored packet index in iIndexDirectory: packets before the range
+ * are skipped without decoding (with the exception of simulation header packets)
+ *
+ * without stored packet index: packets are read in one pass and the event
+ * number is checked after decoding (reading stops after the last event);
+ * if an index directory is given, the index is filled during this pass and
+ * stored once all packets of the file have been read
+ */
+bool VBFDataReader::setEventRange( uint32_t iFirstEvent, uint32_t iLastEvent, string iIndexDirectory )
+{
+	fFirstEventNumber = iFirstEvent;
+	fLastEventNumber = iLastEvent;
+	fEventRange = ( iFirstEvent > 0 || iLastEvent < UINT_MAX );
+	if( !fPacketIndex && iIndexDirectory.size() > 0 )
+	{
+		fPacketIndex = new VBFPacketIndex( fDebug );
+		fPacketIndex->setIndexDirectory( iIndexDirectory );
+		if( !fPacketIndex->openIndexFile( fSourceFileName ) )
+		{
+			delete fPacketIndex;
+			fPacketIndex = 0;
+			// fill index during reading (packets are read sequentially from the beginning of the file)
+			if( !fPacketIndexBuild && index == 0 )
+			{
+				fPacketIndexBuild = new VBFPacketIndex( fDebug );
+				fPacketIndexBuild->setIndexDirectory( iIndexDirectory );
+				fPacketIndexBuild->reset( fSourceFileName );
+			}
+		}
+	}
+	if( !fPacketIndex )
+	{
+		if( fEventRange )
+		{
+			cout << "VBFDataReader: reading events " << fFirstEventNumber << " to " << fLastEventNumber;
+			cout << " (no stored packet index, reading packets sequentially)" << endl;
+		}
+		return false;
+	}
+	fFirstPacket = fPacketIndex->getFirstPacket( iFirstEvent );
+	fLastPacket = fPacketIndex->getLastPacket( iLastEvent );
+	if( fLastPacket == fPacketIndex->getNPackets() )
+	{
+		fLastPacket = 0;
+		fFirstPacket = fPacketIndex->getNPackets();
+	}
+	
+	cout << "VBFDataReader: reading events " << fFirstEventNumber << " to " << fLastEventNumber;
+	cout << " (packets " << fFirstPacket << " to " << fLastPacket << ")" << endl;
+	
+	return true;
 }
 
 
@@ -51,8 +122,35 @@ bool VBFDataReader::getNextEvent()
 		}
 		for( ;; )
 		{
+			// event range: skip packets without decoding (stored packet index)
+			if( fEventRange && fPacketIndex )
+			{
+				while( index < fFirstPacket && !fPacketIndex->hasSimulationHeader( index ) )
+				{
+					index++;
+				}
+				if( index >= fFirstPacket && index > fLastPacket )
+				{
+					setEventStatus( 999 );
+					return false;
+				}
+				if( fPacketIndex->hasEventNumber( index )
+						&& ( fPacketIndex->getEntry( index ).fEventNumber < fFirstEventNumber
+							 || fPacketIndex->getEntry( index ).fEventNumber > fLastEventNumber ) )
+				{
+					index++;
+					continue;
+				}
+			}
 			if( !reader.hasPacket( index ) )
 			{
+				// all packets read: store packet index filled during reading
+				if( fPacketIndexBuild )
+				{
+					fPacketIndexBuild->storeIndex( reader.numPackets() );
+					delete fPacketIndexBuild;
+					fPacketIndexBuild = 0;
+				}
 				setEventStatus( 999 );
 				return false;
 			}
@@ -70,11 +168,43 @@ bool VBFDataReader::getNextEvent()
 				return false;
 			}
 			delete old_pack;
+			// checksum of raw data file follows the decoded packets
+			// (file content is still in the page cache)
+			if( fChecksum && reader.numPackets() > 0 )
+			{
+				updateChecksum( ( double )( index + 1 ) / ( double )reader.numPackets() );
+			}
 			if( fDebug )
 			{
 				cout << "\t VBFRawDataReader::getNextEvent(): index " << index << endl;
 			}
 			fEventNumber = index - 1;
+			
+			// fill packet index during reading; event range without stored packet index:
+			// check event number of decoded packet
+			if( fPacketIndexBuild || ( fEventRange && !fPacketIndex ) )
+			{
+				sVBFPacketIndexEntry i_entry = VBFPacketIndex::getPacketEntry( index, pack );
+				if( fPacketIndexBuild )
+				{
+					fPacketIndexBuild->addPacket( i_entry );
+				}
+				if( fEventRange && !fPacketIndex
+						&& ( i_entry.fFlags & VBFPacketIndex::eEventNumber )
+						&& !( i_entry.fFlags & VBFPacketIndex::eSimulationHeader ) )
+				{
+					if( i_entry.fEventNumber > fLastEventNumber )
+					{
+						setEventStatus( 999 );
+						return false;
+					}
+					if( i_entry.fEventNumber < fFirstEventNumber )
+					{
+						index++;
+						continue;
+					}
+				}
+			}
 			index++;
 			
 			// check if this is a simulation header
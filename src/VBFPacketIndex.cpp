@@ -0,0 +1,420 @@
+/*! \class VBFPacketIndex
+    \brief persistent packet index for VBF files
+
+    The index is built in one pass over all packets of a VBF file
+    (open()), or filled packet by packet while a VBF file is read
+    sequentially (reset(), addPacket(), storeIndex()).
+    If an index directory is set, the index is stored there
+    (<index directory>/<vbf file name>.evndisp.vbfindex). Later jobs read
+    the index file (if it matches size and modification time of the VBF file)
+    and can e.g. seek to an event range without decoding any packets.
+    No index file is written without index directory (the directory of
+    the raw data might be read-only or shared).
+
+    Building the index in a separate pass doubles the reading and decoding
+    work; openIndexFile() reads a stored index only.
+
+    For each packet:
+       - event number (array trigger event number, otherwise simulated event number,
+         otherwise event number of first telescope event)
+       - telescopes present in array event (bit coded)
+       - array trigger event type
+       - packet content flags
+
+*/
+
+#include "VBFPacketIndex.h"
+
+VBFPacketIndex::VBFPacketIndex( bool iDebug )
+{
+	fDebug = iDebug;
+	fVBFFileName = "";
+	fIndexDirectory = "";
+	fIndexFileName = "";
+}
+
+/*
+ * read index from index file or build it (using iReader, if given)
+ *
+ */
+bool VBFPacketIndex::open( string iVBFFileName, VBankFileReader* iReader )
+{
+	setFileNames( iVBFFileName );
+	fIndex.clear();
+	
+	Long64_t iFileSize = 0;
+	Long_t iFileModTime = 0;
+	if( !getVBFFileInfo( iFileSize, iFileModTime ) )
+	{
+		cout << "VBFPacketIndex::open error: VBF file not found: " << fVBFFileName << endl;
+		return false;
+	}
+	if( fIndexFileName.size() > 0 && readIndexFile( iFileSize, iFileModTime ) )
+	{
+		cout << "VBFPacketIndex: reading packet index from " << fIndexFileName;
+		cout << " (" << fIndex.size() << " packets)" << endl;
+		return true;
+	}
+	
+	cout << "VBFPacketIndex: building packet index for " << fVBFFileName << endl;
+	bool bGood = false;
+	if( iReader )
+	{
+		bGood = buildIndex( iReader );
+	}
+	else
+	{
+		VBankFileReader i_reader( fVBFFileName );
+		bGood = buildIndex( &i_reader );
+	}
+	if( !bGood )
+	{
+		return false;
+	}
+	if( fIndexFileName.size() > 0 )
+	{
+		writeIndexFile( iFileSize, iFileModTime );
+	}
+	
+	return true;
+}
+
+/*
+ * read index from index file only (no pass over the VBF file)
+ *
+ * returns false if there is no (valid) index file in the index directory
+ */
+bool VBFPacketIndex::openIndexFile( string iVBFFileName )
+{
+	setFileNames( iVBFFileName );
+	fIndex.clear();
+	
+	Long64_t iFileSize = 0;
+	Long_t iFileModTime = 0;
+	if( fIndexFileName.size() == 0 || !getVBFFileInfo( iFileSize, iFileModTime ) )
+	{
+		return false;
+	}
+	if( !readIndexFile( iFileSize, iFileModTime ) )
+	{
+		fIndex.clear();
+		return false;
+	}
+	cout << "VBFPacketIndex: reading packet index from " << fIndexFileName;
+	cout << " (" << fIndex.size() << " packets)" << endl;
+	return true;
+}
+
+/*
+ * start an empty index (to be filled with addPacket())
+ *
+ */
+void VBFPacketIndex::reset( string iVBFFileName )
+{
+	setFileNames( iVBFFileName );
+	fIndex.clear();
+}
+
+/*
+ * write index filled with addPacket() to the index directory
+ *
+ * (index is written only if all iNPackets packets of the file have been added)
+ */
+bool VBFPacketIndex::storeIndex( unsigned int iNPackets )
+{
+	if( fIndexFileName.size() == 0 || fIndex.size() != iNPackets )
+	{
+		return false;
+	}
+	Long64_t iFileSize = 0;
+	Long_t iFileModTime = 0;
+	if( !getVBFFileInfo( iFileSize, iFileModTime ) )
+	{
+		return false;
+	}
+	return writeIndexFile( iFileSize, iFileModTime );
+}
+
+void VBFPacketIndex::setFileNames( string iVBFFileName )
+{
+	fVBFFileName = iVBFFileName;
+	fIndexFileName = "";
+	if( fIndexDirectory.size() > 0 )
+	{
+		fIndexFileName = fIndexDirectory + "/" + gSystem->BaseName( iVBFFileName.c_str() ) + ".evndisp.vbfindex";
+	}
+}
+
+bool VBFPacketIndex::getVBFFileInfo( Long64_t& iFileSize, Long_t& iFileModTime )
+{
+	Long_t iID = 0;
+	Long_t iFlags = 0;
+	if( gSystem->GetPathInfo( fVBFFileName.c_str(), &iID, &iFileSize, &iFlags, &iFileModTime ) != 0 )
+	{
+		return false;
+	}
+	return true;
+}
+
+/*
+ * loop once over all packets and fill index
+ *
+ */
+bool VBFPacketIndex::buildIndex( VBankFileReader* iReader )
+{
+	if( !iReader )
+	{
+		return false;
+	}
+	fIndex.clear();
+	try
+	{
+		unsigned int i_numPackets = iReader->numPackets();
+		fIndex.reserve( i_numPackets );
+		for( unsigned int i = 0; i < i_numPackets; i++ )
+		{
+			VPacket* i_pack = iReader->readPacket( i );
+			fIndex.push_back( getPacketEntry( i, i_pack ) );
+			if( i_pack )
+			{
+				delete i_pack;
+			}
+		}
+	}
+	catch( const std::exception& e )
+	{
+		cout << "VBFPacketIndex::buildIndex: exception while reading file " << fVBFFileName << ": " << e.what() << endl;
+		fIndex.clear();
+		return false;
+	}
+	return true;
+}
+
+/*
+ * index entry for one decoded packet
+ *
+ */
+sVBFPacketIndexEntry VBFPacketIndex::getPacketEntry( unsigned int iPacket, VPacket* iPack )
+{
+	sVBFPacketIndexEntry i_entry;
+	i_entry.fPacket = iPacket;
+	i_entry.fEventNumber = 0;
+	i_entry.fTelescopeMask = 0;
+	i_entry.fEventType = 0;
+	i_entry.fFlags = 0;
+	
+	if( !iPack )
+	{
+		return i_entry;
+	}
+	if( iPack->hasSimulationHeader() )
+	{
+		i_entry.fFlags |= eSimulationHeader;
+	}
+	if( iPack->hasSimulationData() && iPack->getSimulationData() )
+	{
+		i_entry.fFlags |= eSimulationData;
+		i_entry.fFlags |= eEventNumber;
+		i_entry.fEventNumber = iPack->getSimulationData()->fEventNumber;
+	}
+	if( iPack->hasArrayEvent() && iPack->getArrayEvent() )
+	{
+		VArrayEvent* i_ae = iPack->getArrayEvent();
+		i_entry.fFlags |= eArrayEvent;
+		for( unsigned int t = 0; t < i_ae->getPresentTelescopes().size() && t < 64; t++ )
+		{
+			if( i_ae->getPresentTelescopes()[t] )
+			{
+				i_entry.fTelescopeMask |= ( ( ULong64_t )1 << t );
+			}
+		}
+		if( i_ae->hasTrigger() && i_ae->getTrigger() )
+		{
+			i_entry.fFlags |= eArrayTrigger;
+			i_entry.fFlags |= eEventNumber;
+			i_entry.fEventNumber = i_ae->getTrigger()->getEventNumber();
+			i_entry.fEventType = i_ae->getTrigger()->getEventType().getBestNewStyleCode();
+		}
+		else if( !( i_entry.fFlags & eEventNumber ) && i_ae->getNumEvents() > 0 && i_ae->getEvent( 0 ) )
+		{
+			i_entry.fFlags |= eEventNumber;
+			i_entry.fEventNumber = i_ae->getEvent( 0 )->getEventNumber();
+			i_entry.fEventType = i_ae->getEvent( 0 )->getEventType().getBestNewStyleCode();
+		}
+	}
+	return i_entry;
+}
+
+/*
+ * index file layout:
+ *
+ *    "EVNDVBI1" | VBF file size, modification time (Long64_t) | number of packets (UInt_t)
+ *    | packet numbers (uint32_t) | event numbers (uint32_t) | telescope masks (ULong64_t)
+ *    | event types (uint8_t) | flags (uint8_t)
+ *
+ */
+bool VBFPacketIndex::writeIndexFile( Long64_t iFileSize, Long_t iFileModTime )
+{
+	unsigned int n = fIndex.size();
+	vector< uint32_t > i_packet( n );
+	vector< uint32_t > i_eventnumber( n );
+	vector< ULong64_t > i_mask( n );
+	vector< uint8_t > i_type( n );
+	vector< uint8_t > i_flags( n );
+	for( unsigned int i = 0; i < n; i++ )
+	{
+		i_packet[i] = fIndex[i].fPacket;
+		i_eventnumber[i] = fIndex[i].fEventNumber;
+		i_mask[i] = fIndex[i].fTelescopeMask;
+		i_type[i] = fIndex[i].fEventType;
+		i_flags[i] = fIndex[i].fFlags;
+	}
+	
+	ostringstream iTempFileName;
+	iTempFileName << fIndexFileName << "." << gSystem->GetPid() << ".tmp";
+	ofstream os( iTempFileName.str().c_str(), ios::out | ios::binary );
+	if( !os )
+	{
+		cout << "VBFPacketIndex: index file " << fIndexFileName << " not writable (index is not stored)" << endl;
+		return false;
+	}
+	Long64_t iF[2] = { iFileSize, ( Long64_t )iFileModTime };
+	UInt_t iN = n;
+	os.write( "EVNDVBI1", 8 );
+	os.write( ( const char* )iF, sizeof( iF ) );
+	os.write( ( const char* )&iN, sizeof( UInt_t ) );
+	if( n > 0 )
+	{
+		os.write( ( const char* )&i_packet[0], n * sizeof( uint32_t ) );
+		os.write( ( const char* )&i_eventnumber[0], n * sizeof( uint32_t ) );
+		os.write( ( const char* )&i_mask[0], n * sizeof( ULong64_t ) );
+		os.write( ( const char* )&i_type[0], n * sizeof( uint8_t ) );
+		os.write( ( const char* )&i_flags[0], n * sizeof( uint8_t ) );
+	}
+	os.close();
+	if( !os.good() || gSystem->Rename( iTempFileName.str().c_str(), fIndexFileName.c_str() ) != 0 )
+	{
+		cout << "VBFPacketIndex: error writing index file " << fIndexFileName << endl;
+		gSystem->Unlink( iTempFileName.str().c_str() );
+		return false;
+	}
+	cout << "VBFPacketIndex: packet index written to " << fIndexFileName << endl;
+	return true;
+}
+
+/*
+ * read index from index file
+ *
+ * returns false if the index file does not exist or does not match
+ * the VBF file
+ */
+bool VBFPacketIndex::readIndexFile( Long64_t iFileSize, Long_t iFileModTime )
+{
+	if( gSystem->AccessPathName( fIndexFileName.c_str() ) )
+	{
+		return false;
+	}
+	ifstream is( fIndexFileName.c_str(), ios::in | ios::binary );
+	if( !is )
+	{
+		return false;
+	}
+	char iMagic[8];
+	Long64_t iF[2] = { 0, 0 };
+	UInt_t n = 0;
+	is.read( iMagic, 8 );
+	is.read( ( char* )iF, sizeof( iF ) );
+	is.read( ( char* )&n, sizeof( UInt_t ) );
+	if( !is.good() || string( iMagic, 8 ) != "EVNDVBI1" )
+	{
+		cout << "VBFPacketIndex: invalid index file " << fIndexFileName << " (ignoring index file)" << endl;
+		return false;
+	}
+	if( iF[0] != iFileSize || iF[1] != ( Long64_t )iFileModTime )
+	{
+		if( fDebug )
+		{
+			cout << "VBFPacketIndex: outdated index file " << fIndexFileName << " (ignoring index file)" << endl;
+		}
+		return false;
+	}
+	vector< uint32_t > i_packet( n );
+	vector< uint32_t > i_eventnumber( n );
+	vector< ULong64_t > i_mask( n );
+	vector< uint8_t > i_type( n );
+	vector< uint8_t > i_flags( n );
+	if( n > 0 )
+	{
+		is.read( ( char* )&i_packet[0], n * sizeof( uint32_t ) );
+		is.read( ( char* )&i_eventnumber[0], n * sizeof( uint32_t ) );
+		is.read( ( char* )&i_mask[0], n * sizeof( ULong64_t ) );
+		is.read( ( char* )&i_type[0], n * sizeof( uint8_t ) );
+		is.read( ( char* )&i_flags[0], n * sizeof( uint8_t ) );
+	}
+	if( !is.good() )
+	{
+		cout << "VBFPacketIndex: corrupted index file " << fIndexFileName << " (ignoring index file)" << endl;
+		return false;
+	}
+	fIndex.resize( n );
+	for( unsigned int i = 0; i < n; i++ )
+	{
+		fIndex[i].fPacket = i_packet[i];
+		fIndex[i].fEventNumber = i_eventnumber[i];
+		fIndex[i].fTelescopeMask = i_mask[i];
+		fIndex[i].fEventType = i_type[i];
+		fIndex[i].fFlags = i_flags[i];
+	}
+	return true;
+}
+
+/*
+ * first packet with event number >= iEventNumber
+ *
+ * (returns number of packets if there is no such packet)
+ */
+unsigned int VBFPacketIndex::getFirstPacket( uint32_t iEventNumber )
+{
+	for( unsigned int i = 0; i < fIndex.size(); i++ )
+	{
+		if( ( fIndex[i].fFlags & eEventNumber ) && fIndex[i].fEventNumber >= iEventNumber )
+		{
+			return i;
+		}
+	}
+	return fIndex.size();
+}
+
+/*
+ * last packet with event number <= iEventNumber
+ *
+ * (returns number of packets if there is no such packet)
+ */
+unsigned int VBFPacketIndex::getLastPacket( uint32_t iEventNumber )
+{
+	for( unsigned int i = fIndex.size(); i > 0; i-- )
+	{
+		if( ( fIndex[i - 1].fFlags & eEventNumber ) && fIndex[i - 1].fEventNumber <= iEventNumber )
+		{
+			return i - 1;
+		}
+	}
+	return fIndex.size();
+}
+
+/*
+ * number of packets with array events or simulated events
+ *
+ */
+unsigned int VBFPacketIndex::getNEvents()
+{
+	unsigned int z = 0;
+	for( unsigned int i = 0; i < fIndex.size(); i++ )
+	{
+		if( fIndex[i].fFlags & ( eArrayEvent | eSimulationData ) )
+		{
+			z++;
+		}
+	}
+	return z;
+}
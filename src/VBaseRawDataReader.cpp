@@ -32,7 +32,9 @@ VBaseRawDataReader::VBaseRawDataReader( string sourcefile, int isourcetype, unsi
 	
 	// additional Gaussian noise
 	finjectGaussianNoise = -1.;
-	fRandomInjectGaussianNoise = 0;
+	finjectGaussianNoiseSeed = 0;
+	
+	fChecksum = 0;
 	
 	// source types
 	if( isourcetype == 2 )
@@ -80,10 +82,65 @@ VBaseRawDataReader::~VBaseRawDataReader()
 	{
 		cout << "VBaseRawDataReader::~VBaseRawDataReader()" << endl;
 	}
+	if( fChecksum )
+	{
+		delete fChecksum;
+	}
 	/*   delete fEvent; */
 }
 
 
+/*
+ * compute MD5 checksum of the raw data file while reading it
+ *
+ */
+bool VBaseRawDataReader::initChecksum()
+{
+	if( fChecksum )
+	{
+		delete fChecksum;
+	}
+	fChecksum = new VFileChecksum();
+	if( !fChecksum->open( fSourceFileName ) )
+	{
+		delete fChecksum;
+		fChecksum = 0;
+		return false;
+	}
+	return true;
+}
+
+/*
+ * add raw data file up to the given fraction to the checksum
+ * (called by the readers with the fraction of the file decoded so far)
+ */
+void VBaseRawDataReader::updateChecksum( double iFraction )
+{
+	if( fChecksum )
+	{
+		fChecksum->updateFraction( iFraction );
+	}
+}
+
+/*
+ * return checksum of the raw data file
+ *
+ * (returns empty string if no checksum is calculated or if the file
+ *  was not read completely; the remaining part is not read again)
+ */
+string VBaseRawDataReader::finishChecksum()
+{
+	if( !fChecksum )
+	{
+		return "";
+	}
+	string iChecksum = fChecksum->finish( false );
+	delete fChecksum;
+	fChecksum = 0;
+	return iChecksum;
+}
+
+
 /*!
     1 = rawdata
     3 = MCvbf
@@ -315,18 +372,76 @@ bool VBaseRawDataReader::initThroughputCorrection( double iMCPed,
  *
  * set std dev in units of dc
  *
+ * noise values are drawn from a counter-based generator keyed on
+ * (seed, run, event, telescope, channel, sample), i.e. the noise added
+ * to a sample does not depend on the order in which traces are read
+ *
  */
 
+/*
+ * inject Gaussian noise into traces
+ *
+ * seed == 0: draw a random base seed (noise differs between jobs)
+ *
+ */
 void VBaseRawDataReader::injectGaussianNoise( double injectGaussianNoise,  UInt_t seed )
 {
 	finjectGaussianNoise = injectGaussianNoise;
-	
-	if( !fRandomInjectGaussianNoise )
+	finjectGaussianNoiseSeed = seed;
+	if( finjectGaussianNoiseSeed == 0 )
 	{
-		fRandomInjectGaussianNoise = new TRandom3( seed );
+		TRandom3 iRandom( 0 );
+		finjectGaussianNoiseSeed = iRandom.Integer( kMaxUInt ) + 1;
+		if( finjectGaussianNoise > 0. )
+		{
+			cout << "VBaseRawDataReader::injectGaussianNoise: random seed " << finjectGaussianNoiseSeed << endl;
+		}
 	}
 }
 
+/*
+ * 64 bit mixing function (splitmix64 finalizer)
+ *
+ */
+uint64_t VBaseRawDataReader::hashCounter( uint64_t x )
+{
+	x += 0x9e3779b97f4a7c15ULL;
+	x = ( x ^ ( x >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+	x = ( x ^ ( x >> 27 ) ) * 0x94d049bb133111ebULL;
+	return x ^ ( x >> 31 );
+}
+
+/*
+ * key for Gaussian noise of the current event, telescope and given channel
+ *
+ */
+uint64_t VBaseRawDataReader::getGaussianNoiseKey( unsigned int channel )
+{
+	uint64_t iKey = hashCounter( ( uint64_t )finjectGaussianNoiseSeed );
+	iKey = hashCounter( iKey ^ ( uint64_t )getRunNumber() );
+	iKey = hashCounter( iKey ^ ( uint64_t )getEventNumber() );
+	iKey = hashCounter( iKey ^ ( uint64_t )fTelID );
+	iKey = hashCounter( iKey ^ ( uint64_t )channel );
+	return iKey;
+}
+
+/*
+ * pair of Gaussian distributed random numbers (mean 0, std dev 1)
+ * for samples 2*iPair and 2*iPair+1 (Box-Muller transformation)
+ *
+ */
+void VBaseRawDataReader::getGaussianNoisePair( uint64_t iKey, unsigned int iPair, double& z0, double& z1 )
+{
+	uint64_t iH1 = hashCounter( iKey ^ ( uint64_t )iPair );
+	uint64_t iH2 = hashCounter( iH1 );
+	// uniform random numbers in (0,1)
+	double u1 = ( ( double )( iH1 >> 11 ) + 0.5 ) * ( 1.0 / 9007199254740992.0 );
+	double u2 = ( ( double )( iH2 >> 11 ) + 0.5 ) * ( 1.0 / 9007199254740992.0 );
+	double r = sqrt( -2. * log( u1 ) );
+	z0 = r * cos( TMath::TwoPi() * u2 );
+	z1 = r * sin( TMath::TwoPi() * u2 );
+}
+
 
 bool VBaseRawDataReader::initTraceNoiseGenerator( unsigned int iType, string iT, VDetectorGeometry* iD, vector<int> iSW, bool iDebug, int iseed, double iDefaultPed, vector<double> iFADCCorrect )
 {
@@ -386,64 +501,188 @@ uint8_t VBaseRawDataReader::getSample( unsigned channel, unsigned sample, bool i
 		return 0;
 	}
 	
-	// add noise from external noise library to traces
-	// (e.g. VTS grisu MC are simulated without noise, noise is added here to the samples)
-	if( fNoiseFileReader && !getHiLo( channel ) )
+	postProcessTrace( channel, sample, 1, &iSampleValue, iNewNoiseTrace );
+	
+	return iSampleValue;
+}
+
+/*
+ * fill trace of iNSamples samples starting at iFirstSample
+ * (with noise and throughput corrections applied)
+ *
+ * on read errors, the samples read so far are returned without
+ * corrections (remaining samples are 0)
+ *
+ */
+void VBaseRawDataReader::getSamples_double( unsigned channel, unsigned iFirstSample, unsigned iNSamples, vector< double >& iTrace )
+{
+	iTrace.resize( iNSamples );
+	if( fTraceSampleBuffer.size() < iNSamples )
 	{
-		uint8_t iNoiseSampleValue = fNoiseFileReader->getNoiseSample( fTelID, channel, sample, iNewNoiseTrace );
-		if( iSampleValue > iNoiseSampleValue && iSampleValue > fNoiseFileFADCRange - iNoiseSampleValue + fNoiseFilePedestal )
+		fTraceSampleBuffer.resize( iNSamples );
+	}
+	unsigned int i = 0;
+	try
+	{
+		if( fEvent[fTelID] )
 		{
-			return fNoiseFileFADCRange;
+			for( i = 0; i < iNSamples; i++ )
+			{
+				fTraceSampleBuffer[i] = fEvent[fTelID]->getSample( channel, i + iFirstSample );
+			}
+		}
+		else
+		{
+			for( i = 0; i < iNSamples; i++ )
+			{
+				fTraceSampleBuffer[i] = 0;
+			}
 		}
-		return iSampleValue + iNoiseSampleValue - fNoiseFilePedestal;
 	}
-	// add gaussian noise
-	// (only important if this has been not added on the simulation level)
-	double iNoiseGaus = 0.;
-	if( finjectGaussianNoise > 0. && fRandomInjectGaussianNoise && !getHiLo( channel ) )
+	catch( ... )
 	{
-		// electronic noise is corrected for gain loss
-		if( fTraceAmplitudeCorrectionG.size() > 0 && fTelID < fTraceAmplitudeCorrectionG.size() )
+		cout << "VBaseRawDataReader::getSample error: failed for channel " << channel << " and sample " << i + iFirstSample << endl;
+		for( unsigned int j = 0; j < iNSamples; j++ )
 		{
-			iNoiseGaus = fRandomInjectGaussianNoise->Gaus( 0.,
-						 finjectGaussianNoise * fTraceAmplitudeCorrectionG[fTelID] );
+			iTrace[j] = ( j < i ? ( double )fTraceSampleBuffer[j] : 0. );
 		}
-		else
+		return;
+	}
+	
+	if( iNSamples > 0 )
+	{
+		postProcessTrace( channel, iFirstSample, iNSamples, &fTraceSampleBuffer[0], true );
+	}
+	
+	for( i = 0; i < iNSamples; i++ )
+	{
+		iTrace[i] = ( double )fTraceSampleBuffer[i];
+	}
+}
+
+/*
+ * apply noise and throughput corrections to a trace (in place)
+ *
+ * - add noise from external noise library to traces
+ *   (e.g. VTS grisu MC are simulated without noise, noise is added here to the samples)
+ * - add gaussian noise
+ *   (only important if this has been not added on the simulation level)
+ * - throughput correction
+ *
+ * iTrace[0] is sample iFirstSample of the FADC trace
+ *
+ */
+void VBaseRawDataReader::postProcessTrace( unsigned channel, unsigned iFirstSample, unsigned iNSamples,
+		uint8_t* iTrace, bool iNewNoiseTrace )
+{
+	// add noise from external noise library to traces
+	if( fNoiseFileReader && !getHiLo( channel ) )
+	{
+		for( unsigned int i = 0; i < iNSamples; i++ )
 		{
-			iNoiseGaus = fRandomInjectGaussianNoise->Gaus( 0., finjectGaussianNoise );
+			uint8_t iNoiseSampleValue = fNoiseFileReader->getNoiseSample( fTelID, channel, i + iFirstSample, ( iNewNoiseTrace && i == 0 ) );
+			if( iTrace[i] > iNoiseSampleValue && iTrace[i] > fNoiseFileFADCRange - iNoiseSampleValue + fNoiseFilePedestal )
+			{
+				iTrace[i] = fNoiseFileFADCRange;
+			}
+			else
+			{
+				iTrace[i] = iTrace[i] + iNoiseSampleValue - fNoiseFilePedestal;
+			}
 		}
+		return;
+	}
+	
+	bool bGaussianNoise = ( finjectGaussianNoise > 0. && !getHiLo( channel ) );
+	bool bThroughput = ( fTraceAmplitudeCorrectionS.size() > 0 && fTelID < fTraceAmplitudeCorrectionS.size() );
+	if( !bGaussianNoise && !bThroughput )
+	{
+		return;
 	}
+	
+	if( fTraceAmplitudeBuffer.size() < iNSamples )
+	{
+		fTraceAmplitudeBuffer.resize( iNSamples );
+	}
+	double* iA = &fTraceAmplitudeBuffer[0];
+	
 	// throughput correction
-	if( fTraceAmplitudeCorrectionS.size() > 0 && fTelID < fTraceAmplitudeCorrectionS.size() )
+	if( bThroughput )
 	{
-		double iS = fTraceAmplitudeCorrectionS[fTelID] * ( iSampleValue - fNoiseFilePedestal ) + fNoiseFilePedestal;
-		if( finjectGaussianNoise > 0. && fRandomInjectGaussianNoise && !getHiLo( channel ) )
+		float iS = fTraceAmplitudeCorrectionS[fTelID];
+		for( unsigned int i = 0; i < iNSamples; i++ )
 		{
-			iS += iNoiseGaus;
+			iA[i] = iS * ( iTrace[i] - fNoiseFilePedestal ) + fNoiseFilePedestal;
 		}
-		
-		if( iS < 256 )
+	}
+	else
+	{
+		for( unsigned int i = 0; i < iNSamples; i++ )
 		{
-			return iS;
+			iA[i] = iTrace[i];
 		}
-		else
+	}
+	
+	// add gaussian noise
+	if( bGaussianNoise )
+	{
+		// electronic noise is corrected for gain loss
+		double iSigma = finjectGaussianNoise;
+		if( fTraceAmplitudeCorrectionG.size() > 0 && fTelID < fTraceAmplitudeCorrectionG.size() )
+		{
+			iSigma *= fTraceAmplitudeCorrectionG[fTelID];
+		}
+		uint64_t iKey = getGaussianNoiseKey( channel );
+		double z[2];
+		unsigned int i = 0;
+		while( i < iNSamples )
 		{
-			return 255;
+			unsigned int iSample = i + iFirstSample;
+			getGaussianNoisePair( iKey, iSample >> 1, z[0], z[1] );
+			iA[i] += iSigma * z[iSample & 1];
+			i++;
+			if( !( iSample & 1 ) && i < iNSamples )
+			{
+				iA[i] += iSigma * z[1];
+				i++;
+			}
 		}
 	}
-	else if( finjectGaussianNoise > 0. && fRandomInjectGaussianNoise && !getHiLo( channel ) )
+	
+	// clamp to FADC range
+	if( bThroughput )
 	{
-		if( iSampleValue + iNoiseGaus < 256 )
+		for( unsigned int i = 0; i < iNSamples; i++ )
 		{
-			return iSampleValue + iNoiseGaus;
+			if( iA[i] < 0. )
+			{
+				iTrace[i] = 0;
+			}
+			else if( iA[i] < 256 )
+			{
+				iTrace[i] = ( uint8_t )iA[i];
+			}
+			else
+			{
+				iTrace[i] = 255;
+			}
 		}
-		else
+	}
+	else
+	{
+		// (samples exceeding the FADC range keep their original value)
+		for( unsigned int i = 0; i < iNSamples; i++ )
 		{
-			return iSampleValue;
+			if( iA[i] < 0. )
+			{
+				iTrace[i] = 0;
+			}
+			else if( iA[i] < 256 )
+			{
+				iTrace[i] = ( uint8_t )iA[i];
+			}
 		}
 	}
-	
-	return iSampleValue;
 }
 
 
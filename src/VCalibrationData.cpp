@@ -1084,3 +1084,246 @@ double VCalibrationData::getTelescopeAverageFADCtoPhe( bool iLowGain )
 	}
 	return 0.;
 }
+
+/*
+ * helper functions for binary calibration caches
+ * (see VCalibrationData::readCache() and writeCache())
+ */
+template< class T > void writeCalibrationCache_value( ostream& os, const T& v );
+template< class T > void writeCalibrationCache_value( ostream& os, const valarray< T >& v );
+template< class T > void writeCalibrationCache_value( ostream& os, const vector< T >& v );
+template< class T > bool readCalibrationCache_value( istream& is, T& v );
+template< class T > bool readCalibrationCache_value( istream& is, valarray< T >& v );
+template< class T > bool readCalibrationCache_value( istream& is, vector< T >& v );
+
+template< class T > void writeCalibrationCache_value( ostream& os, const T& v )
+{
+	os.write( ( const char* )&v, sizeof( T ) );
+}
+
+template< class T > void writeCalibrationCache_value( ostream& os, const valarray< T >& v )
+{
+	UInt_t n = v.size();
+	writeCalibrationCache_value( os, n );
+	for( unsigned int i = 0; i < n; i++ )
+	{
+		writeCalibrationCache_value( os, v[i] );
+	}
+}
+
+template< class T > void writeCalibrationCache_value( ostream& os, const vector< T >& v )
+{
+	UInt_t n = v.size();
+	writeCalibrationCache_value( os, n );
+	for( unsigned int i = 0; i < n; i++ )
+	{
+		writeCalibrationCache_value( os, v[i] );
+	}
+}
+
+template< class T > bool readCalibrationCache_value( istream& is, T& v )
+{
+	is.read( ( char* )&v, sizeof( T ) );
+	return is.good();
+}
+
+template< class T > bool readCalibrationCache_value( istream& is, valarray< T >& v )
+{
+	UInt_t n = 0;
+	// (sanity check against corrupted files)
+	if( !readCalibrationCache_value( is, n ) || n > 10000000 )
+	{
+		return false;
+	}
+	v.resize( n );
+	for( unsigned int i = 0; i < n; i++ )
+	{
+		if( !readCalibrationCache_value( is, v[i] ) )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+template< class T > bool readCalibrationCache_value( istream& is, vector< T >& v )
+{
+	UInt_t n = 0;
+	if( !readCalibrationCache_value( is, n ) || n > 10000000 )
+	{
+		return false;
+	}
+	v.resize( n );
+	for( unsigned int i = 0; i < n; i++ )
+	{
+		T iT;
+		if( !readCalibrationCache_value( is, iT ) )
+		{
+			return false;
+		}
+		v[i] = iT;
+	}
+	return true;
+}
+
+/*
+ * write all calibration values (as read from calibration files) in binary format
+ *
+ * (summary histograms and IPR graphs are not written)
+ */
+void VCalibrationData::writeCache( ostream& os )
+{
+	writeCalibrationCache_value( os, fTelID );
+	writeCalibrationCache_value( os, fPedFromPLine );
+	writeCalibrationCache_value( os, fUsePedestalsInTimeSlices );
+	writeCalibrationCache_value( os, fLowGainUsePedestalsInTimeSlices );
+	writeCalibrationCache_value( os, fChannelStatus );
+	// pedestals
+	writeCalibrationCache_value( os, fTS_MJD );
+	writeCalibrationCache_value( os, fTS_time );
+	writeCalibrationCache_value( os, fPeds );
+	writeCalibrationCache_value( os, fTS_Peds );
+	writeCalibrationCache_value( os, fVPedvars );
+	writeCalibrationCache_value( os, fTS_fVPedvars );
+	writeCalibrationCache_value( os, fTS_fVmeanPedvars );
+	writeCalibrationCache_value( os, fTS_fVmeanRMSPedvars );
+	writeCalibrationCache_value( os, fLowGainPeds );
+	writeCalibrationCache_value( os, fLowGainTS_Peds );
+	writeCalibrationCache_value( os, fVLowGainPedvars );
+	writeCalibrationCache_value( os, fLowGainTS_fVPedvars );
+	writeCalibrationCache_value( os, fLowGainTS_fVmeanPedvars );
+	writeCalibrationCache_value( os, fLowGainTS_fVmeanRMSPedvars );
+	writeCalibrationCache_value( os, fPedrms );
+	writeCalibrationCache_value( os, fVmeanPedvars );
+	writeCalibrationCache_value( os, fVmeanRMSPedvars );
+	// high gain gains and time offsets
+	writeCalibrationCache_value( os, fFADCStopOffsets );
+	writeCalibrationCache_value( os, fTOffsets );
+	writeCalibrationCache_value( os, fTOffsetvars );
+	writeCalibrationCache_value( os, fGains );
+	writeCalibrationCache_value( os, fGains_DefaultSetting );
+	writeCalibrationCache_value( os, fGainvars );
+	writeCalibrationCache_value( os, fAverageTzero );
+	writeCalibrationCache_value( os, fAverageTzerovars );
+	// low gain
+	writeCalibrationCache_value( os, fBoolLowGainPedestals );
+	writeCalibrationCache_value( os, fLowGainPedsrms );
+	writeCalibrationCache_value( os, fmeanLowGainPedvars );
+	writeCalibrationCache_value( os, fmeanRMSLowGainPedvars );
+	writeCalibrationCache_value( os, fVmeanLowGainPedvars );
+	writeCalibrationCache_value( os, fVmeanRMSLowGainPedvars );
+	writeCalibrationCache_value( os, fLowGainMultiplier_Trace );
+	UInt_t iNMult = fLowGainMultiplier_Sum.size();
+	writeCalibrationCache_value( os, iNMult );
+	for( map< pair< int, int >, double >::iterator it = fLowGainMultiplier_Sum.begin(); it != fLowGainMultiplier_Sum.end(); ++it )
+	{
+		writeCalibrationCache_value( os, it->first.first );
+		writeCalibrationCache_value( os, it->first.second );
+		writeCalibrationCache_value( os, it->second );
+	}
+	writeCalibrationCache_value( os, fLowGainMultiplier_Camera );
+	writeCalibrationCache_value( os, fLowGainDefaultSumWindows );
+	writeCalibrationCache_value( os, fAverageTZero_highgain );
+	writeCalibrationCache_value( os, fAverageTZero_lowgain );
+	writeCalibrationCache_value( os, fBoolLowGainTOff );
+	writeCalibrationCache_value( os, fLowGainTOffsets );
+	writeCalibrationCache_value( os, fLowGainTOffsetvars );
+	writeCalibrationCache_value( os, fLowGainAverageTzero );
+	writeCalibrationCache_value( os, fLowGainAverageTzerovars );
+	writeCalibrationCache_value( os, fLowGainGains );
+	writeCalibrationCache_value( os, fLowGainGains_DefaultSetting );
+	writeCalibrationCache_value( os, fBoolLowGainGains );
+	writeCalibrationCache_value( os, fLowGainGainvars );
+	writeCalibrationCache_value( os, fFADCtoPhe );
+	writeCalibrationCache_value( os, fLowGainFADCtoPhe );
+}
+
+/*
+ * read calibration values written with writeCache()
+ *
+ * returns false for inconsistent or corrupted cache files
+ */
+bool VCalibrationData::readCache( istream& is )
+{
+	unsigned int iTelID = 0;
+	if( !readCalibrationCache_value( is, iTelID ) || iTelID != fTelID )
+	{
+		return false;
+	}
+	bool iGood = true;
+	iGood = iGood && readCalibrationCache_value( is, fPedFromPLine );
+	iGood = iGood && readCalibrationCache_value( is, fUsePedestalsInTimeSlices );
+	iGood = iGood && readCalibrationCache_value( is, fLowGainUsePedestalsInTimeSlices );
+	iGood = iGood && readCalibrationCache_value( is, fChannelStatus );
+	// pedestals
+	iGood = iGood && readCalibrationCache_value( is, fTS_MJD );
+	iGood = iGood && readCalibrationCache_value( is, fTS_time );
+	iGood = iGood && readCalibrationCache_value( is, fPeds );
+	iGood = iGood && readCalibrationCache_value( is, fTS_Peds );
+	iGood = iGood && readCalibrationCache_value( is, fVPedvars );
+	iGood = iGood && readCalibrationCache_value( is, fTS_fVPedvars );
+	iGood = iGood && readCalibrationCache_value( is, fTS_fVmeanPedvars );
+	iGood = iGood && readCalibrationCache_value( is, fTS_fVmeanRMSPedvars );
+	iGood = iGood && readCalibrationCache_value( is, fLowGainPeds );
+	iGood = iGood && readCalibrationCache_value( is, fLowGainTS_Peds );
+	iGood = iGood && readCalibrationCache_value( is, fVLowGainPedvars );
+	iGood = iGood && readCalibrationCache_value( is, fLowGainTS_fVPedvars );
+	iGood = iGood && readCalibrationCache_value( is, fLowGainTS_fVmeanPedvars );
+	iGood = iGood && readCalibrationCache_value( is, fLowGainTS_fVmeanRMSPedvars );
+	iGood = iGood && readCalibrationCache_value( is, fPedrms );
+	iGood = iGood && readCalibrationCache_value( is, fVmeanPedvars );
+	iGood = iGood && readCalibrationCache_value( is, fVmeanRMSPedvars );
+	// high gain gains and time offsets
+	iGood = iGood && readCalibrationCache_value( is, fFADCStopOffsets );
+	iGood = iGood && readCalibrationCache_value( is, fTOffsets );
+	iGood = iGood && readCalibrationCache_value( is, fTOffsetvars );
+	iGood = iGood && readCalibrationCache_value( is, fGains );
+	iGood = iGood && readCalibrationCache_value( is, fGains_DefaultSetting );
+	iGood = iGood && readCalibrationCache_value( is, fGainvars );
+	iGood = iGood && readCalibrationCache_value( is, fAverageTzero );
+	iGood = iGood && readCalibrationCache_value( is, fAverageTzerovars );
+	// low gain
+	iGood = iGood && readCalibrationCache_value( is, fBoolLowGainPedestals );
+	iGood = iGood && readCalibrationCache_value( is, fLowGainPedsrms );
+	iGood = iGood && readCalibrationCache_value( is, fmeanLowGainPedvars );
+	iGood = iGood && readCalibrationCache_value( is, fmeanRMSLowGainPedvars );
+	iGood = iGood && readCalibrationCache_value( is, fVmeanLowGainPedvars );
+	iGood = iGood && readCalibrationCache_value( is, fVmeanRMSLowGainPedvars );
+	iGood = iGood && readCalibrationCache_value( is, fLowGainMultiplier_Trace );
+	UInt_t iNMult = 0;
+	iGood = iGood && readCalibrationCache_value( is, iNMult );
+	if( !iGood )
+	{
+		return false;
+	}
+	fLowGainMultiplier_Sum.clear();
+	for( unsigned int i = 0; i < iNMult; i++ )
+	{
+		int iSW1 = 0;
+		int iSW2 = 0;
+		double iM = 0.;
+		if( !readCalibrationCache_value( is, iSW1 ) || !readCalibrationCache_value( is, iSW2 )
+				|| !readCalibrationCache_value( is, iM ) )
+		{
+			return false;
+		}
+		fLowGainMultiplier_Sum[make_pair( iSW1, iSW2 )] = iM;
+	}
+	iGood = iGood && readCalibrationCache_value( is, fLowGainMultiplier_Camera );
+	iGood = iGood && readCalibrationCache_value( is, fLowGainDefaultSumWindows );
+	iGood = iGood && readCalibrationCache_value( is, fAverageTZero_highgain );
+	iGood = iGood && readCalibrationCache_value( is, fAverageTZero_lowgain );
+	iGood = iGood && readCalibrationCache_value( is, fBoolLowGainTOff );
+	iGood = iGood && readCalibrationCache_value( is, fLowGainTOffsets );
+	iGood = iGood && readCalibrationCache_value( is, fLowGainTOffsetvars );
+	iGood = iGood && readCalibrationCache_value( is, fLowGainAverageTzero );
+	iGood = iGood && readCalibrationCache_value( is, fLowGainAverageTzerovars );
+	iGood = iGood && readCalibrationCache_value( is, fLowGainGains );
+	iGood = iGood && readCalibrationCache_value( is, fLowGainGains_DefaultSetting );
+	iGood = iGood && readCalibrationCache_value( is, fBoolLowGainGains );
+	iGood = iGood && readCalibrationCache_value( is, fLowGainGainvars );
+	iGood = iGood && readCalibrationCache_value( is, fFADCtoPhe );
+	iGood = iGood && readCalibrationCache_value( is, fLowGainFADCtoPhe );
+	
+	return iGood;
+}
@@ -16,6 +16,7 @@ VCalibrator::VCalibrator()
 	fCalibrationfileVersion = 1;
 	
 	fPedSingleOutFile = 0;
+	fPedestalFillBufferSize = 0;
 	fPedPerTelescopeTypeMinCnt = 1.E5;  // minimal counter for IPR measurements
 	fIPRAverageTel = false;
 }
@@ -291,12 +292,12 @@ void VCalibrator::calculatePedestals( bool iLowGain )
 				{
 					if( fReader->getChannelHitIndex( j ).first )
 					{
-						hped_vec[iTelType][i][j]->Fill( getSums()[j] );
+						fillPedestalHistogram( iTelType, hped_vec[iTelType][i][j], getSums()[j] );
 					}
 				}
 				else
 				{
-					hped_vec[iTelType][i][j]->Fill( getSums()[j] );
+					fillPedestalHistogram( iTelType, hped_vec[iTelType][i][j], getSums()[j] );
 				}
 			}
 		}
@@ -339,12 +340,12 @@ void VCalibrator::calculatePedestals( bool iLowGain )
 				{
 					if( fReader->getChannelHitIndex( j ).first )
 					{
-						hpedPerTelescopeType[iTelType][i][j]->Fill( getSums()[j] );
+						fillPedestalHistogram( iTelType, hpedPerTelescopeType[iTelType][i][j], getSums()[j] );
 					}
 				}
 				else
 				{
-					hpedPerTelescopeType[iTelType][i][j]->Fill( getSums()[j] );
+					fillPedestalHistogram( iTelType, hpedPerTelescopeType[iTelType][i][j], getSums()[j] );
 				}
 			}
 		}
@@ -352,6 +353,93 @@ void VCalibrator::calculatePedestals( bool iLowGain )
 	}
 }
 
+/*
+
+   fill pedestal or IPR histogram
+
+   for more than one calibration thread, the fills are buffered per
+   telescope type and filled in parallel (one job per telescope type;
+   fill order per histogram is preserved)
+
+*/
+void VCalibrator::fillPedestalHistogram( ULong64_t iTelType, TH1F* h, double iValue )
+{
+	if( fRunPar->fCalibrationNThreads <= 1 )
+	{
+		h->Fill( iValue );
+		return;
+	}
+	fPedestalFillBuffer[iTelType].fHisto.push_back( h );
+	fPedestalFillBuffer[iTelType].fValue.push_back( iValue );
+	fPedestalFillBufferSize++;
+	// limit buffer size to ~64 MB
+	if( fPedestalFillBufferSize >= 4000000 )
+	{
+		flushPedestalFillBuffers();
+	}
+}
+
+/*
+
+   fill buffered histogram values for a list of telescope types
+
+   (histograms of different telescope types are independent)
+
+*/
+void VCalibrator::fillPedestalHistogramsJob( sPedestalFillJob* iJob )
+{
+	for( unsigned int b = 0; b < iJob->fBuffer.size(); b++ )
+	{
+		sPedestalFillBuffer* iB = iJob->fBuffer[b];
+		for( unsigned int i = 0; i < iB->fHisto.size(); i++ )
+		{
+			iB->fHisto[i]->Fill( iB->fValue[i] );
+		}
+		iB->fHisto.clear();
+		iB->fValue.clear();
+	}
+}
+
+/*
+
+   fill all buffered pedestal and IPR histogram values
+   (in parallel for more than one telescope type)
+
+*/
+void VCalibrator::flushPedestalFillBuffers()
+{
+	if( fPedestalFillBufferSize == 0 )
+	{
+		return;
+	}
+	unsigned int iNJobs = TMath::Max( 1u, TMath::Min( fRunPar->fCalibrationNThreads, ( unsigned int )fPedestalFillBuffer.size() ) );
+	vector< sPedestalFillJob > iJobs( iNJobs );
+	unsigned int z = 0;
+	for( map< ULong64_t, sPedestalFillBuffer >::iterator it = fPedestalFillBuffer.begin(); it != fPedestalFillBuffer.end(); ++it )
+	{
+		iJobs[z % iNJobs].fBuffer.push_back( &it->second );
+		z++;
+	}
+	if( iJobs.size() == 1 )
+	{
+		fillPedestalHistogramsJob( &iJobs[0] );
+	}
+	else
+	{
+		ROOT::EnableThreadSafety();
+		vector< thread > iThreads;
+		for( unsigned int j = 0; j < iJobs.size(); j++ )
+		{
+			iThreads.push_back( thread( VCalibrator::fillPedestalHistogramsJob, &iJobs[j] ) );
+		}
+		for( unsigned int j = 0; j < iThreads.size(); j++ )
+		{
+			iThreads[j].join();
+		}
+	}
+	fPedestalFillBufferSize = 0;
+}
+
 /*
 
    write pedestals to disk
@@ -366,6 +454,9 @@ void VCalibrator::writePeds( bool iLowGain, VPedestalCalculator* iPedestalCalcul
 		cout << "void VCalibrator::writePeds()" << endl;
 	}
 	
+	// fill all buffered pedestal and IPR values
+	flushPedestalFillBuffers();
+	
 	string ioutfile;
 	// boolean to keep track which files have been written
 	// (this is historically a mess)
@@ -1611,6 +1702,299 @@ void VCalibrator::terminate( VPedestalCalculator* iP )
 }
 
 
+/*
+ * name of binary calibration cache file for this run
+ * (empty string if caching is switched off)
+ */
+string VCalibrator::getCalibrationCacheFileName()
+{
+	if( getRunParameter()->fCalibrationCacheDirectory.size() == 0 )
+	{
+		return "";
+	}
+	// gains and time offsets from the VOFFLINE DB without a fixed version
+	// can change without any change in the calibration configuration
+	if( getRunParameter()->freadCalibfromDB && !getRunParameter()->useDBTextFiles()
+			&& getRunParameter()->freadCalibfromDB_versionquery <= 0 )
+	{
+		return "";
+	}
+	ostringstream iFileName;
+	iFileName << getRunParameter()->fCalibrationCacheDirectory << "/";
+	iFileName << getRunNumber() << ".evndisp.calibration.cache";
+	return iFileName.str();
+}
+
+/*
+ * key identifying the calibration configuration
+ *
+ * (MD5 sum of run number, telescopes, summation windows, calibration
+ *  settings, calibration run numbers (from DB or command line), DB settings,
+ *  low-gain multipliers from the detector configuration and of names, sizes
+ *  and modification times of all calibration files and DB text files)
+ */
+string VCalibrator::getCalibrationCacheKey()
+{
+	ostringstream iConfig;
+	iConfig << "version " << fCalibrationCacheVersion << endl;
+	iConfig << "run " << getRunNumber() << endl;
+	iConfig << "runmode " << getRunParameter()->frunmode << endl;
+	iConfig << "readCalibfromDB " << getRunParameter()->freadCalibfromDB;
+	iConfig << " " << getRunParameter()->freadCalibfromDB_versionquery << endl;
+	iConfig << "useDB " << getRunParameter()->fuseDB << " " << getRunParameter()->fDBRunType << endl;
+	iConfig << "DB " << getRunParameter()->getDBServer() << " " << getRunParameter()->getDBTextDirectory() << endl;
+	iConfig << "calibrationfile " << getRunParameter()->fcalibrationfile << endl;
+	iConfig << "nocalibnoproblem " << getRunParameter()->fNoCalibNoPb << endl;
+	iConfig << "lowgainpedestal " << getRunParameter()->fsimu_lowgain_pedestal_DefaultPed << endl;
+	iConfig << "lowgaincalibration " << getRunParameter()->fLowGainCalibrationFile << endl;
+	for( unsigned int i = 0; i < getRunParameter()->fGainCorrection.size(); i++ )
+	{
+		iConfig << "gaincorrection " << getRunParameter()->fGainCorrection[i] << endl;
+	}
+	
+	vector< string > iFiles;
+	for( unsigned int i = 0; i < getTeltoAna().size(); i++ )
+	{
+		unsigned int t = getTeltoAna()[i];
+		iConfig << "telescope " << t << " " << getDetectorGeometry()->getNChannels( t ) << " " << getSumWindow( t ) << " " << getSumWindow_2( t );
+		iConfig << " " << usePedestalsInTimeSlices( false ) << " " << usePedestalsInTimeSlices( true ) << endl;
+		// calibration run numbers
+		vector< vector< int >* > iRunNumbers;
+		iRunNumbers.push_back( &getRunParameter()->fPedFileNumber );
+		iRunNumbers.push_back( &getRunParameter()->fGainFileNumber );
+		iRunNumbers.push_back( &getRunParameter()->fTOffFileNumber );
+		iRunNumbers.push_back( &getRunParameter()->fTZeroFileNumber );
+		iRunNumbers.push_back( &getRunParameter()->fPixFileNumber );
+		iRunNumbers.push_back( &getRunParameter()->fPedLowGainFileNumber );
+		iRunNumbers.push_back( &getRunParameter()->fGainLowGainFileNumber );
+		iRunNumbers.push_back( &getRunParameter()->fTOffLowGainFileNumber );
+		iRunNumbers.push_back( &getRunParameter()->fTZeroLowGainFileNumber );
+		iRunNumbers.push_back( &getRunParameter()->fLowGainMultiplierFileNumber );
+		iConfig << "calibration runs";
+		for( unsigned int r = 0; r < iRunNumbers.size(); r++ )
+		{
+			if( t < iRunNumbers[r]->size() )
+			{
+				iConfig << " " << ( *iRunNumbers[r] )[t];
+			}
+			else
+			{
+				iConfig << " -";
+			}
+		}
+		iConfig << endl;
+		// low-gain multiplier from detector configuration
+		iConfig << "lowgainmultiplier " << getDetectorGeometry()->isLowGainSet();
+		if( t < getDetectorGeometry()->getLowGainMultiplier_Trace().size() )
+		{
+			iConfig << " " << getDetectorGeometry()->getLowGainMultiplier_Trace()[t];
+		}
+		iConfig << endl;
+		// gains and time offsets from DB text files
+		if( getRunParameter()->freadCalibfromDB && getRunParameter()->useDBTextFiles()
+				&& t < getRunParameter()->fGainFileNumber.size() )
+		{
+			int iRun = getRunParameter()->fGainFileNumber[t];
+			ostringstream iDBTextFile;
+			iDBTextFile << getRunParameter()->getDBTextDirectory() << "/" << iRun / 10000 << "/" << iRun << "/" << iRun;
+			iFiles.push_back( iDBTextFile.str() + ".gain_TEL" + to_string( t + 1 ) );
+			iFiles.push_back( iDBTextFile.str() + ".toffset_TEL" + to_string( t + 1 ) );
+		}
+		if( t < fPedFileNameC.size() )
+		{
+			iFiles.push_back( fPedFileNameC[t] );
+			iFiles.push_back( fGainFileNameC[t] );
+			iFiles.push_back( fToffFileNameC[t] );
+			iFiles.push_back( fPixFileNameC[t] );
+			iFiles.push_back( fTZeroFileNameC[t] );
+			iFiles.push_back( fNewLowGainPedFileNameC[t] );
+			iFiles.push_back( fLowGainPedFileNameC[t] );
+			iFiles.push_back( fLowGainGainFileNameC[t] );
+			iFiles.push_back( fLowGainTZeroFileNameC[t] );
+		}
+		if( t < fLowGainToffFileNameC.size() )
+		{
+			iFiles.push_back( fLowGainToffFileNameC[t] );
+		}
+		if( t < fLowGainMultiplierNameC.size() )
+		{
+			iFiles.push_back( fLowGainMultiplierNameC[t] );
+		}
+	}
+	iFiles.push_back( getRunParameter()->fLowGainCalibrationFile );
+	for( unsigned int i = 0; i < iFiles.size(); i++ )
+	{
+		iConfig << "file " << iFiles[i];
+		FileStat_t iStat;
+		if( iFiles[i].size() > 0 && gSystem->GetPathInfo( iFiles[i].c_str(), iStat ) == 0 )
+		{
+			iConfig << " " << iStat.fSize << " " << iStat.fMtime;
+		}
+		iConfig << endl;
+	}
+	
+	TMD5 iMD5;
+	string iC = iConfig.str();
+	iMD5.Update( ( const UChar_t* )iC.c_str(), iC.size() );
+	iMD5.Final();
+	return string( iMD5.AsString() );
+}
+
+/*
+ * read calibration values for all telescopes from binary cache file
+ *
+ * returns false if cache file does not exist or is not valid for
+ * the current run and calibration configuration
+ */
+bool VCalibrator::readCalibrationCache()
+{
+	string iFileName = getCalibrationCacheFileName();
+	if( iFileName.size() == 0 || gSystem->AccessPathName( iFileName.c_str() ) )
+	{
+		return false;
+	}
+	// pedestals from MC files are not cached
+	if( fReader->getDataFormat() == "grisu" || getRunParameter()->fsimu_pedestalfile.size() > 0 )
+	{
+		return false;
+	}
+	ifstream is( iFileName.c_str(), ios::in | ios::binary );
+	if( !is )
+	{
+		return false;
+	}
+	// cache header: key and list of telescopes
+	char iMagic[8];
+	is.read( iMagic, 8 );
+	if( !is.good() || string( iMagic, 8 ) != "EVNDCAL1" )
+	{
+		cout << "VCalibrator::readCalibrationCache: invalid cache file " << iFileName << endl;
+		return false;
+	}
+	char iKey[32];
+	is.read( iKey, 32 );
+	if( !is.good() || string( iKey, 32 ) != getCalibrationCacheKey() )
+	{
+		cout << "VCalibrator::readCalibrationCache: cache file " << iFileName;
+		cout << " does not match calibration configuration (ignoring cache file)" << endl;
+		return false;
+	}
+	unsigned int iNTel = 0;
+	is.read( ( char* )&iNTel, sizeof( unsigned int ) );
+	if( !is.good() || iNTel != getTeltoAna().size() )
+	{
+		return false;
+	}
+	// read calibration data for all telescopes
+	for( unsigned int i = 0; i < getTeltoAna().size(); i++ )
+	{
+		setTelID( getTeltoAna()[i] );
+		if( !getCalData()->readCache( is ) )
+		{
+			cout << "VCalibrator::readCalibrationCache: error reading cache file " << iFileName;
+			cout << " for telescope " << getTelID() + 1 << endl;
+			return false;
+		}
+	}
+	is.close();
+	
+	// fill settings depending on calibration values
+	for( unsigned int i = 0; i < getTeltoAna().size(); i++ )
+	{
+		setTelID( getTeltoAna()[i] );
+		if( getRunParameter()->fLowGainCalibrationFile.size() > 0 && getRunParameter()->frunmode != 6 )
+		{
+			getDetectorGeometry()->setLowGainMultiplier_Trace( getTelID(), getCalData()->getLowGainMultiplier_Trace() );
+		}
+		// summary distributions (for display)
+		for( unsigned int c = 0; c < getPeds().size(); c++ )
+		{
+			getPedDist()->Fill( getPeds()[c] );
+			if( c < getPedvars().size() )
+			{
+				getPedvarsDist()->Fill( getPedvars()[c] );
+			}
+		}
+		for( unsigned int c = 0; c < getPedsLowGain().size(); c++ )
+		{
+			getPedLowGainDist()->Fill( getPedsLowGain()[c] );
+			if( c < getPedvarsLowGain().size() )
+			{
+				getPedvarsLowGainDist()->Fill( getPedvarsLowGain()[c] );
+			}
+		}
+		if( getRunParameter()->frunmode != 2 && getRunParameter()->frunmode != 5 )
+		{
+			for( unsigned int c = 0; c < getGains().size(); c++ )
+			{
+				getGainDist()->Fill( getGains()[c] );
+				if( c < getGainvars().size() )
+				{
+					getGainVarsDist()->Fill( getGainvars()[c] );
+				}
+			}
+			for( unsigned int c = 0; c < getTOffsets().size(); c++ )
+			{
+				getToffsetDist()->Fill( getTOffsets()[c] );
+				if( c < getTOffsetvars().size() )
+				{
+					getToffsetVarsDist()->Fill( getTOffsetvars()[c] );
+				}
+			}
+		}
+		setCalibrated();
+	}
+	cout << "reading calibration data for all telescopes from cache file " << iFileName << endl;
+	
+	return true;
+}
+
+/*
+ * write calibration values for all telescopes into binary cache file
+ *
+ * (written to a temporary file first, as several jobs might use the
+ *  same cache directory)
+ */
+bool VCalibrator::writeCalibrationCache()
+{
+	string iFileName = getCalibrationCacheFileName();
+	if( iFileName.size() == 0 )
+	{
+		return false;
+	}
+	if( fReader->getDataFormat() == "grisu" || getRunParameter()->fsimu_pedestalfile.size() > 0 )
+	{
+		return false;
+	}
+	ostringstream iTempFileName;
+	iTempFileName << iFileName << "." << gSystem->GetPid() << ".tmp";
+	ofstream os( iTempFileName.str().c_str(), ios::out | ios::binary );
+	if( !os )
+	{
+		cout << "VCalibrator::writeCalibrationCache: error opening cache file " << iTempFileName.str() << endl;
+		return false;
+	}
+	os.write( "EVNDCAL1", 8 );
+	string iKey = getCalibrationCacheKey();
+	os.write( iKey.c_str(), 32 );
+	unsigned int iNTel = getTeltoAna().size();
+	os.write( ( const char* )&iNTel, sizeof( unsigned int ) );
+	for( unsigned int i = 0; i < getTeltoAna().size(); i++ )
+	{
+		setTelID( getTeltoAna()[i] );
+		getCalData()->writeCache( os );
+	}
+	os.close();
+	if( !os.good() || gSystem->Rename( iTempFileName.str().c_str(), iFileName.c_str() ) != 0 )
+	{
+		cout << "VCalibrator::writeCalibrationCache: error writing cache file " << iFileName << endl;
+		gSystem->Unlink( iTempFileName.str().c_str() );
+		return false;
+	}
+	cout << "calibration data written to cache file " << iFileName << endl;
+	return true;
+}
+
 /*!
 
    read calibration data from the different files or from the database
@@ -1623,6 +2007,12 @@ void VCalibrator::readCalibrationData()
 		cout << "VCalibrator::readCalibrationData " << endl;
 	}
 	
+	// calibration values from cache file
+	if( readCalibrationCache() )
+	{
+		return;
+	}
+	
 	for( unsigned int i = 0; i < getTeltoAna().size(); i++ )
 	{
 		setTelID( getTeltoAna()[i] );
@@ -1758,6 +2148,7 @@ void VCalibrator::readCalibrationData()
 		setCalibrated();
 	}                                             // end loop over all telescopes
 	
+	writeCalibrationCache();
 }
 
 /*
@@ -23,6 +23,8 @@ VCameraRead::VCameraRead()
 	fMaxNeighbour = 6;
 	// default directory for cfg files
 	fConfigDir = "../data/detector_geometry/";
+	// no geometry caching
+	fGeometryCacheDirectory = "";
 	// default pedestal
 	fDefPed = 20.;
 	fFADCRange = 256;
@@ -305,6 +307,19 @@ bool VCameraRead::readGrisucfg( string iFile, unsigned int iNTel )
 		return false;
 	}
 	
+	// fully resolved geometry from cache file
+	string iCacheKey = "";
+	string iCacheFile = "";
+	if( fGeometryCacheDirectory.size() > 0 )
+	{
+		iCacheKey = getGeometryCacheKey( iFile, iNTel );
+		iCacheFile = getGeometryCacheFileName( iFile, iCacheKey );
+		if( readGeometryCache( iCacheFile, iCacheKey ) )
+		{
+			return true;
+		}
+	}
+	
 	string iline = "";
 	string i_char = "";
 	unsigned int i_telID = 0;
@@ -718,6 +733,11 @@ bool VCameraRead::readGrisucfg( string iFile, unsigned int iNTel )
 	// set camera centre tube index
 	setCameraCentreTubeIndex();
 	
+	if( iCacheFile.size() > 0 )
+	{
+		writeGeometryCache( iCacheFile, iCacheKey );
+	}
+	
 	if( fDebug )
 	{
 		cout << "END: VCameraRead::readGrisucfg " << iFile << endl;
@@ -1238,9 +1258,13 @@ void VCameraRead::resetNeighbourLists( bool bMaxN )
 
      use positions and tupe radius to prepare a NN neighbour list
 
+     (neighbour lists are calculated only once for identical cameras)
+
 */
 bool VCameraRead::makeNeighbourList()
 {
+	vector< unsigned int > iCalculatedTel;
+	vector< vector< vector< int > > > iCalculatedNeighbour;
 	////////////////////////////////////
 	// loop over all telescopes in list
 	for( unsigned int i = 0; i < fNTel; i++ )
@@ -1268,53 +1292,154 @@ bool VCameraRead::makeNeighbourList()
 			continue;
 		}
 		//////////////////////////////////////
-		// get minimum distance between tubes
-		double iTubeDistance_min = 1.e5;
-		for( unsigned int j = 0; j < getTubeRadius_MM( i ).size(); j++ )
+		// same camera as a previous telescope?
+		unsigned int iN = iCalculatedTel.size();
+		for( unsigned int p = 0; p < iCalculatedTel.size(); p++ )
 		{
-			for( unsigned int k = 0; k < j; k++ )
+			unsigned int t = iCalculatedTel[p];
+			if( getX_MM( i ) == getX_MM( t ) && getY_MM( i ) == getY_MM( t )
+					&& getTubeRadius_MM( i ) == getTubeRadius_MM( t ) && getAnaPixel( i ) == getAnaPixel( t ) )
 			{
-				double itemp = sqrt( ( getX_MM( i )[j] - getX_MM( i )[k] ) * ( getX_MM( i )[j] - getX_MM( i )[k] )
-									 + ( getY_MM( i )[j] - getY_MM( i )[k] ) * ( getY_MM( i )[j] - getY_MM( i )[k] ) );
-				if( itemp < iTubeDistance_min )
-				{
-					iTubeDistance_min = itemp;
-				}
+				iN = p;
+				break;
 			}
 		}
-		iTubeDistance_min *= 0.5;
-		
-		// now find all tubes which less then 2*iTubeDistance_min*sqrt(2) away (should also work for grid)
-		// ignore all channels with
-		for( unsigned int j = 0; j < getTubeRadius_MM( i ).size(); j++ )
+		if( iN == iCalculatedTel.size() )
+		{
+			iCalculatedTel.push_back( i );
+			iCalculatedNeighbour.push_back( vector< vector< int > >() );
+			findNeighbours( i, iCalculatedNeighbour.back() );
+		}
+		//////////////////////////////////////
+		// fill neighbour lists
+		for( unsigned int j = 0; j < iCalculatedNeighbour[iN].size() && j < fNeighbour[i].size(); j++ )
+		{
+			for( unsigned int k = 0; k < iCalculatedNeighbour[iN][j].size(); k++ )
+			{
+				fNNeighbour[i][j]++;
+				fNeighbour[i][j].push_back( iCalculatedNeighbour[iN][j][k] );
+			}
+			if( fNeighbour[i][j].size() > fMaxNeighbour )
+			{
+				fMaxNeighbour = fNeighbour[i][j].size();
+			}
+		}
+	}
+	
+	return true;
+}
+
+/*
+ * find neighbours of all tubes of the given telescope
+ *
+ * neighbours are all tubes (used in the analysis) which are less then
+ * 2*sqrt(2)*(minimum tube distance / 2) away (should also work for grid)
+ *
+ * - minimum tube distance from a sweep over the tubes sorted in x
+ * - neighbour search on a grid with cell size >= search radius, i.e.
+ *   only tubes in the same or the adjacent cells are tested
+ *
+ * neighbour lists are sorted by tube index
+ */
+bool VCameraRead::findNeighbours( unsigned int iTelID, vector< vector< int > >& iNeighbour )
+{
+	vector< float >& x = getX_MM( iTelID );
+	vector< float >& y = getY_MM( iTelID );
+	vector< int >& iAna = getAnaPixel( iTelID );
+	unsigned int iNTubes = getTubeRadius_MM( iTelID ).size();
+	if( x.size() < iNTubes || y.size() < iNTubes || iAna.size() < iNTubes )
+	{
+		cout << "VCameraRead::findNeighbours error: invalid vector sizes for telescope " << iTelID + 1 << endl;
+		return false;
+	}
+	iNeighbour.assign( iNTubes, vector< int >() );
+	if( iNTubes < 2 )
+	{
+		return true;
+	}
+	
+	//////////////////////////////////////
+	// get minimum distance between tubes
+	vector< pair< float, unsigned int > > iXSorted( iNTubes );
+	for( unsigned int j = 0; j < iNTubes; j++ )
+	{
+		iXSorted[j] = make_pair( x[j], j );
+	}
+	sort( iXSorted.begin(), iXSorted.end() );
+	double iTubeDistance_min = 1.e5;
+	for( unsigned int a = 0; a < iNTubes; a++ )
+	{
+		unsigned int j = iXSorted[a].second;
+		for( unsigned int b = a + 1; b < iNTubes; b++ )
 		{
-			for( unsigned int k = 0; k < j; k++ )
+			// all remaining tubes are further away in x
+			if( iXSorted[b].first - iXSorted[a].first >= iTubeDistance_min )
+			{
+				break;
+			}
+			unsigned int k = iXSorted[b].second;
+			double itemp = sqrt( ( x[j] - x[k] ) * ( x[j] - x[k] ) + ( y[j] - y[k] ) * ( y[j] - y[k] ) );
+			if( itemp < iTubeDistance_min )
 			{
-				double itemp = sqrt( ( getX_MM( i )[j] - getX_MM( i )[k] ) * ( getX_MM( i )[j] - getX_MM( i )[k] )
-									 + ( getY_MM( i )[j] - getY_MM( i )[k] ) * ( getY_MM( i )[j] - getY_MM( i )[k] ) );
-				if( itemp < 2.1 * sqrt( 2. )*iTubeDistance_min )
+				iTubeDistance_min = itemp;
+			}
+		}
+	}
+	iTubeDistance_min *= 0.5;
+	double iSearchRadius = 2.1 * sqrt( 2. ) * iTubeDistance_min;
+	if( iSearchRadius <= 0. )
+	{
+		return true;
+	}
+	
+	//////////////////////////////////////
+	// sort tubes into grid cells
+	// (cell size slightly larger than search radius to be safe against rounding)
+	double iCellSize = 1.001 * iSearchRadius;
+	float x_min = *min_element( x.begin(), x.begin() + iNTubes );
+	float y_min = *min_element( y.begin(), y.begin() + iNTubes );
+	vector< Long64_t > iCellX( iNTubes, 0 );
+	vector< Long64_t > iCellY( iNTubes, 0 );
+	vector< pair< Long64_t, unsigned int > > iCell( iNTubes );
+	for( unsigned int j = 0; j < iNTubes; j++ )
+	{
+		iCellX[j] = ( Long64_t )floor( ( x[j] - x_min ) / iCellSize );
+		iCellY[j] = ( Long64_t )floor( ( y[j] - y_min ) / iCellSize );
+		iCell[j] = make_pair( ( iCellX[j] << 32 ) + iCellY[j], j );
+	}
+	sort( iCell.begin(), iCell.end() );
+	
+	//////////////////////////////////////
+	// find all tubes within search radius
+	for( unsigned int j = 0; j < iNTubes; j++ )
+	{
+		for( Long64_t cx = iCellX[j] - 1; cx <= iCellX[j] + 1; cx++ )
+		{
+			for( Long64_t cy = iCellY[j] - 1; cy <= iCellY[j] + 1; cy++ )
+			{
+				if( cx < 0 || cy < 0 )
 				{
-					if( getAnaPixel( i )[k] > 0 )
+					continue;
+				}
+				vector< pair< Long64_t, unsigned int > >::iterator c = lower_bound( iCell.begin(), iCell.end(),
+						make_pair( ( cx << 32 ) + cy, ( unsigned int )0 ) );
+				for( ; c != iCell.end() && c->first == ( cx << 32 ) + cy; ++c )
+				{
+					unsigned int k = c->second;
+					// ignore all channels not used in the analysis
+					if( k == j || iAna[k] <= 0 )
 					{
-						fNNeighbour[i][j]++;
-						fNeighbour[i][j].push_back( k );
-						if( fNeighbour[i][j].size() > fMaxNeighbour )
-						{
-							fMaxNeighbour = fNeighbour[i][j].size();
-						}
+						continue;
 					}
-					if( getAnaPixel( i )[j] > 0 )
+					double itemp = sqrt( ( x[j] - x[k] ) * ( x[j] - x[k] ) + ( y[j] - y[k] ) * ( y[j] - y[k] ) );
+					if( itemp < iSearchRadius )
 					{
-						fNNeighbour[i][k]++;
-						fNeighbour[i][k].push_back( j );
-						if( fNeighbour[i][k].size() > fMaxNeighbour )
-						{
-							fMaxNeighbour = fNeighbour[i][j].size();
-						}
+						iNeighbour[j].push_back( k );
 					}
 				}
 			}
 		}
+		sort( iNeighbour[j].begin(), iNeighbour[j].end() );
 	}
 	
 	return true;
@@ -1574,3 +1699,391 @@ vector< unsigned int > VCameraRead::getNumChannelVector()
 	}
 	return iN;
 }
+
+/*
+ * binary i/o of geometry values (scalars and (nested) vectors)
+ */
+void writeGeometryCache_value( ostream& os, const string& v );
+void writeGeometryCache_value( ostream& os, const map< unsigned int, unsigned int >& v );
+template< class T > void writeGeometryCache_value( ostream& os, const T& v );
+template< class T > void writeGeometryCache_value( ostream& os, const vector< T >& v );
+bool readGeometryCache_value( istream& is, string& v );
+bool readGeometryCache_value( istream& is, map< unsigned int, unsigned int >& v );
+template< class T > bool readGeometryCache_value( istream& is, T& v );
+template< class T > bool readGeometryCache_value( istream& is, vector< T >& v );
+
+template< class T > void writeGeometryCache_value( ostream& os, const T& v )
+{
+	os.write( ( const char* )&v, sizeof( T ) );
+}
+
+template< class T > void writeGeometryCache_value( ostream& os, const vector< T >& v )
+{
+	UInt_t n = v.size();
+	writeGeometryCache_value( os, n );
+	for( unsigned int i = 0; i < n; i++ )
+	{
+		writeGeometryCache_value( os, v[i] );
+	}
+}
+
+void writeGeometryCache_value( ostream& os, const string& v )
+{
+	UInt_t n = v.size();
+	writeGeometryCache_value( os, n );
+	os.write( v.c_str(), n );
+}
+
+void writeGeometryCache_value( ostream& os, const map< unsigned int, unsigned int >& v )
+{
+	UInt_t n = v.size();
+	writeGeometryCache_value( os, n );
+	for( map< unsigned int, unsigned int >::const_iterator i = v.begin(); i != v.end(); ++i )
+	{
+		writeGeometryCache_value( os, i->first );
+		writeGeometryCache_value( os, i->second );
+	}
+}
+
+template< class T > bool readGeometryCache_value( istream& is, T& v )
+{
+	is.read( ( char* )&v, sizeof( T ) );
+	return is.good();
+}
+
+template< class T > bool readGeometryCache_value( istream& is, vector< T >& v )
+{
+	UInt_t n = 0;
+	if( !readGeometryCache_value( is, n ) || n > 10000000 )
+	{
+		return false;
+	}
+	v.resize( n );
+	for( unsigned int i = 0; i < n; i++ )
+	{
+		T iT;
+		if( !readGeometryCache_value( is, iT ) )
+		{
+			return false;
+		}
+		v[i] = iT;
+	}
+	return true;
+}
+
+bool readGeometryCache_value( istream& is, string& v )
+{
+	UInt_t n = 0;
+	if( !readGeometryCache_value( is, n ) || n > 10000000 )
+	{
+		return false;
+	}
+	v.resize( n );
+	if( n > 0 )
+	{
+		is.read( &v[0], n );
+	}
+	return is.good();
+}
+
+bool readGeometryCache_value( istream& is, map< unsigned int, unsigned int >& v )
+{
+	UInt_t n = 0;
+	if( !readGeometryCache_value( is, n ) || n > 10000000 )
+	{
+		return false;
+	}
+	v.clear();
+	for( unsigned int i = 0; i < n; i++ )
+	{
+		unsigned int a = 0;
+		unsigned int b = 0;
+		if( !readGeometryCache_value( is, a ) || !readGeometryCache_value( is, b ) )
+		{
+			return false;
+		}
+		v[a] = b;
+	}
+	return true;
+}
+
+/*
+ * key identifying a geometry configuration
+ *
+ * (MD5 sum of the content of the cfg file and of all external pixel files,
+ *  and of all settings used while reading the cfg file)
+ *
+ * returns an empty string if one of the files cannot be read
+ */
+string VCameraRead::getGeometryCacheKey( string iFile, unsigned int iNTel )
+{
+	ostringstream iConfig;
+	iConfig << "version " << fGeometryCacheVersion << endl;
+	iConfig << "ntel " << iNTel << endl;
+	iConfig << "sourcetype " << fsourcetype << endl;
+	iConfig << setprecision( 9 ) << "transformer " << fCoordinateTransformerX << " " << fCoordinateTransformerY << endl;
+	
+	TMD5 iMD5;
+	string iC = iConfig.str();
+	iMD5.Update( ( const UChar_t* )iC.c_str(), iC.size() );
+	
+	vector< string > iFiles( 1, iFile );
+	for( unsigned int f = 0; f < iFiles.size(); f++ )
+	{
+		ifstream is( iFiles[f].c_str() );
+		if( !is )
+		{
+			return "";
+		}
+		string iline;
+		while( getline( is, iline ) )
+		{
+			iMD5.Update( ( const UChar_t* )iline.c_str(), iline.size() );
+			iMD5.Update( ( const UChar_t* )"\n", 1 );
+			// external pixel files (read as in readGrisucfg())
+			if( f == 0 && iline.find( "PIXFI" ) < iline.size()
+					&& iline.find_first_not_of( " \t" ) < iline.size() && iline[iline.find_first_not_of( " \t" )] == '*' )
+			{
+				istringstream i_stream( iline );
+				string i_char;
+				i_stream >> i_char;
+				i_stream >> i_char;
+				i_stream >> i_char;
+				iFiles.push_back( i_char );
+			}
+		}
+	}
+	iMD5.Final();
+	return string( iMD5.AsString() );
+}
+
+string VCameraRead::getGeometryCacheFileName( string iFile, string iKey )
+{
+	if( fGeometryCacheDirectory.size() == 0 || iKey.size() == 0 )
+	{
+		return "";
+	}
+	if( iFile.rfind( "/" ) < iFile.size() )
+	{
+		iFile = iFile.substr( iFile.rfind( "/" ) + 1, iFile.size() );
+	}
+	return fGeometryCacheDirectory + "/" + iFile + "." + iKey + ".evndisp.geometry.cache";
+}
+
+/*
+ * read fully resolved detector geometry from binary cache file
+ *
+ * (cache content is checked with a MD5 sum before any values are set)
+ *
+ * returns false if cache file does not exist or is not valid for
+ * the current geometry configuration
+ */
+bool VCameraRead::readGeometryCache( string iCacheFile, string iKey )
+{
+	if( iCacheFile.size() == 0 || gSystem->AccessPathName( iCacheFile.c_str() ) )
+	{
+		return false;
+	}
+	ifstream is( iCacheFile.c_str(), ios::in | ios::binary );
+	if( !is )
+	{
+		return false;
+	}
+	char iMagic[8];
+	is.read( iMagic, 8 );
+	if( !is.good() || string( iMagic, 8 ) != "EVNDGEO1" )
+	{
+		cout << "VCameraRead::readGeometryCache: invalid cache file " << iCacheFile << endl;
+		return false;
+	}
+	char iK[32];
+	is.read( iK, 32 );
+	if( !is.good() || string( iK, 32 ) != iKey )
+	{
+		cout << "VCameraRead::readGeometryCache: cache file " << iCacheFile;
+		cout << " does not match geometry configuration (ignoring cache file)" << endl;
+		return false;
+	}
+	UInt_t iSize = 0;
+	char iChecksum[32];
+	is.read( ( char* )&iSize, sizeof( UInt_t ) );
+	is.read( iChecksum, 32 );
+	if( !is.good() || iSize > 1000000000 )
+	{
+		cout << "VCameraRead::readGeometryCache: invalid cache file " << iCacheFile << endl;
+		return false;
+	}
+	string iPayload( iSize, ' ' );
+	if( iSize > 0 )
+	{
+		is.read( &iPayload[0], iSize );
+	}
+	TMD5 iMD5;
+	iMD5.Update( ( const UChar_t* )iPayload.c_str(), iPayload.size() );
+	iMD5.Final();
+	if( !is.good() || string( iChecksum, 32 ) != iMD5.AsString() )
+	{
+		cout << "VCameraRead::readGeometryCache: corrupted cache file " << iCacheFile << " (ignoring cache file)" << endl;
+		return false;
+	}
+	is.close();
+	
+	istringstream ip( iPayload );
+	bool bGood = readGeometryCache_value( ip, fGrIsuVersion );
+	bGood = bGood && readGeometryCache_value( ip, fCFGtype );
+	bGood = bGood && readGeometryCache_value( ip, fTelID );
+	bGood = bGood && readGeometryCache_value( ip, fNTel );
+	bGood = bGood && readGeometryCache_value( ip, fTelIDGrisu );
+	// telescopes
+	bGood = bGood && readGeometryCache_value( ip, fTelType );
+	bGood = bGood && readGeometryCache_value( ip, fTelXpos );
+	bGood = bGood && readGeometryCache_value( ip, fTelYpos );
+	bGood = bGood && readGeometryCache_value( ip, fTelZpos );
+	bGood = bGood && readGeometryCache_value( ip, fTelRad );
+	bGood = bGood && readGeometryCache_value( ip, fMirFocalLength );
+	bGood = bGood && readGeometryCache_value( ip, fNMirrors );
+	bGood = bGood && readGeometryCache_value( ip, fMirrorArea );
+	// cameras
+	bGood = bGood && readGeometryCache_value( ip, fCameraName );
+	bGood = bGood && readGeometryCache_value( ip, fCameraScaleFactor );
+	bGood = bGood && readGeometryCache_value( ip, fCameraCentreOffset );
+	bGood = bGood && readGeometryCache_value( ip, fCameraRotation );
+	bGood = bGood && readGeometryCache_value( ip, fCameraFieldofView );
+	bGood = bGood && readGeometryCache_value( ip, fPixelType );
+	bGood = bGood && readGeometryCache_value( ip, fCNChannels );
+	bGood = bGood && readGeometryCache_value( ip, fCNSamples );
+	bGood = bGood && readGeometryCache_value( ip, fSample_time_slice );
+	// pixels
+	bGood = bGood && readGeometryCache_value( ip, fXTube );
+	bGood = bGood && readGeometryCache_value( ip, fYTube );
+	bGood = bGood && readGeometryCache_value( ip, fRTube );
+	bGood = bGood && readGeometryCache_value( ip, fRotXTube );
+	bGood = bGood && readGeometryCache_value( ip, fRotYTube );
+	bGood = bGood && readGeometryCache_value( ip, fXTubeMM );
+	bGood = bGood && readGeometryCache_value( ip, fYTubeMM );
+	bGood = bGood && readGeometryCache_value( ip, fRTubeMM );
+	bGood = bGood && readGeometryCache_value( ip, fTrigTube );
+	bGood = bGood && readGeometryCache_value( ip, fAnaTube );
+	bGood = bGood && readGeometryCache_value( ip, fNNeighbour );
+	bGood = bGood && readGeometryCache_value( ip, fNeighbour );
+	bGood = bGood && readGeometryCache_value( ip, fMaxNeighbour );
+	bGood = bGood && readGeometryCache_value( ip, fCameraCentreTubeIndex );
+	bGood = bGood && readGeometryCache_value( ip, fNPatches );
+	bGood = bGood && readGeometryCache_value( ip, fPatch );
+	bGood = bGood && readGeometryCache_value( ip, fMix );
+	bGood = bGood && readGeometryCache_value( ip, fXim );
+	// calibration and electronics
+	bGood = bGood && readGeometryCache_value( ip, fDefPed );
+	bGood = bGood && readGeometryCache_value( ip, fFADCRange );
+	bGood = bGood && readGeometryCache_value( ip, fGain );
+	bGood = bGood && readGeometryCache_value( ip, fTOff );
+	bGood = bGood && readGeometryCache_value( ip, fLowGainIsSet );
+	bGood = bGood && readGeometryCache_value( ip, fLowGainMultiplier_Trace );
+	bGood = bGood && readGeometryCache_value( ip, fLowGainActivator );
+	// (content is checksummed, a failure here leaves an inconsistent geometry)
+	if( !bGood )
+	{
+		cout << "VCameraRead::readGeometryCache error reading cache file " << iCacheFile << endl;
+		cout << "exiting..." << endl;
+		exit( EXIT_FAILURE );
+	}
+	cout << endl;
+	cout << "reading detector configuration from cache file " << iCacheFile;
+	cout << " (GrIsu version " << fGrIsuVersion << ")" << endl;
+	
+	return true;
+}
+
+/*
+ * write fully resolved detector geometry into binary cache file
+ *
+ * (written to a temporary file first, as several jobs might use the
+ *  same cache directory)
+ */
+bool VCameraRead::writeGeometryCache( string iCacheFile, string iKey )
+{
+	if( iCacheFile.size() == 0 || iKey.size() != 32 )
+	{
+		return false;
+	}
+	ostringstream op;
+	writeGeometryCache_value( op, fGrIsuVersion );
+	writeGeometryCache_value( op, fCFGtype );
+	writeGeometryCache_value( op, fTelID );
+	writeGeometryCache_value( op, fNTel );
+	writeGeometryCache_value( op, fTelIDGrisu );
+	// telescopes
+	writeGeometryCache_value( op, fTelType );
+	writeGeometryCache_value( op, fTelXpos );
+	writeGeometryCache_value( op, fTelYpos );
+	writeGeometryCache_value( op, fTelZpos );
+	writeGeometryCache_value( op, fTelRad );
+	writeGeometryCache_value( op, fMirFocalLength );
+	writeGeometryCache_value( op, fNMirrors );
+	writeGeometryCache_value( op, fMirrorArea );
+	// cameras
+	writeGeometryCache_value( op, fCameraName );
+	writeGeometryCache_value( op, fCameraScaleFactor );
+	writeGeometryCache_value( op, fCameraCentreOffset );
+	writeGeometryCache_value( op, fCameraRotation );
+	writeGeometryCache_value( op, fCameraFieldofView );
+	writeGeometryCache_value( op, fPixelType );
+	writeGeometryCache_value( op, fCNChannels );
+	writeGeometryCache_value( op, fCNSamples );
+	writeGeometryCache_value( op, fSample_time_slice );
+	// pixels
+	writeGeometryCache_value( op, fXTube );
+	writeGeometryCache_value( op, fYTube );
+	writeGeometryCache_value( op, fRTube );
+	writeGeometryCache_value( op, fRotXTube );
+	writeGeometryCache_value( op, fRotYTube );
+	writeGeometryCache_value( op, fXTubeMM );
+	writeGeometryCache_value( op, fYTubeMM );
+	writeGeometryCache_value( op, fRTubeMM );
+	writeGeometryCache_value( op, fTrigTube );
+	writeGeometryCache_value( op, fAnaTube );
+	writeGeometryCache_value( op, fNNeighbour );
+	writeGeometryCache_value( op, fNeighbour );
+	writeGeometryCache_value( op, fMaxNeighbour );
+	writeGeometryCache_value( op, fCameraCentreTubeIndex );
+	writeGeometryCache_value( op, fNPatches );
+	writeGeometryCache_value( op, fPatch );
+	writeGeometryCache_value( op, fMix );
+	writeGeometryCache_value( op, fXim );
+	// calibration and electronics
+	writeGeometryCache_value( op, fDefPed );
+	writeGeometryCache_value( op, fFADCRange );
+	writeGeometryCache_value( op, fGain );
+	writeGeometryCache_value( op, fTOff );
+	writeGeometryCache_value( op, fLowGainIsSet );
+	writeGeometryCache_value( op, fLowGainMultiplier_Trace );
+	writeGeometryCache_value( op, fLowGainActivator );
+	string iPayload = op.str();
+	UInt_t iSize = iPayload.size();
+	TMD5 iMD5;
+	iMD5.Update( ( const UChar_t* )iPayload.c_str(), iPayload.size() );
+	iMD5.Final();
+	
+	ostringstream iTempFileName;
+	iTempFileName << iCacheFile << "." << gSystem->GetPid() << ".tmp";
+	ofstream os( iTempFileName.str().c_str(), ios::out | ios::binary );
+	if( !os )
+	{
+		cout << "VCameraRead::writeGeometryCache: error opening cache file " << iTempFileName.str() << endl;
+		return false;
+	}
+	os.write( "EVNDGEO1", 8 );
+	os.write( iKey.c_str(), 32 );
+	os.write( ( const char* )&iSize, sizeof( UInt_t ) );
+	os.write( iMD5.AsString(), 32 );
+	os.write( iPayload.c_str(), iPayload.size() );
+	os.close();
+	if( !os.good() || gSystem->Rename( iTempFileName.str().c_str(), iCacheFile.c_str() ) != 0 )
+	{
+		cout << "VCameraRead::writeGeometryCache: error writing cache file " << iCacheFile << endl;
+		gSystem->Unlink( iTempFileName.str().c_str() );
+		return false;
+	}
+	cout << "detector configuration written to cache file " << iCacheFile << endl;
+	return true;
+}
@@ -0,0 +1,449 @@
+/*! \class VDL3FITSWriter
+    \brief streaming writer for DL3 event lists, good time intervals and effective areas (GADF FITS format)
+
+    writes one FITS file per run with the HDUs
+    EVENTS, GTI and EFFECTIVE AREA (point-like, one offset bin)
+
+    energy dispersion, PSF and background HDUs are not written
+    (see docs/ANASUM.md)
+
+    events are buffered and written with multi-row column writes
+    (memory requirement bound by buffer size, not by number of events)
+
+    time reference is MJDREFI=51910 (UTC); TIME is given in seconds since MJDREF
+
+*/
+
+#include "VDL3FITSWriter.h"
+
+VDL3FITSWriter::VDL3FITSWriter( unsigned int iBufferSize )
+{
+	fFitsFile = 0;
+	fFileName = "";
+	fRunNumber = 0;
+	fEventsHDU = 0;
+	fNRowsWritten = 0;
+	fTStart = 0.;
+	fTStop = 0.;
+	fOnTime = 0.;
+	
+	fBufferSize = iBufferSize;
+	if( fBufferSize == 0 )
+	{
+		fBufferSize = 1;
+	}
+	fEVENT_ID.reserve( fBufferSize );
+	fTIME.reserve( fBufferSize );
+	fRA.reserve( fBufferSize );
+	fDEC.reserve( fBufferSize );
+	fENERGY.reserve( fBufferSize );
+	fALT.reserve( fBufferSize );
+	fAZ.reserve( fBufferSize );
+	fMULTIP.reserve( fBufferSize );
+	fCOREX.reserve( fBufferSize );
+	fCOREY.reserve( fBufferSize );
+	fHIL_MSW.reserve( fBufferSize );
+	fHIL_MSL.reserve( fBufferSize );
+}
+
+VDL3FITSWriter::~VDL3FITSWriter()
+{
+	if( fFitsFile )
+	{
+		close();
+	}
+}
+
+bool VDL3FITSWriter::printerror( int status )
+{
+	if( status )
+	{
+		cout << "VDL3FITSWriter: error writing " << fFileName << endl;
+		fits_report_error( stderr, status );
+	}
+	return false;
+}
+
+void VDL3FITSWriter::clearBuffers()
+{
+	fEVENT_ID.clear();
+	fTIME.clear();
+	fRA.clear();
+	fDEC.clear();
+	fENERGY.clear();
+	fALT.clear();
+	fAZ.clear();
+	fMULTIP.clear();
+	fCOREX.clear();
+	fCOREY.clear();
+	fHIL_MSW.clear();
+	fHIL_MSL.clear();
+}
+
+/*
+ * open a new FITS file for the given run
+ *
+ * writes primary HDU and an empty EVENTS table
+ * (existing files are overwritten)
+ */
+bool VDL3FITSWriter::open( string iFileName, int iRunNumber, string iObject, double iRA_PNT, double iDec_PNT )
+{
+	if( fFitsFile )
+	{
+		close();
+	}
+	fFileName = iFileName;
+	fRunNumber = iRunNumber;
+	fNRowsWritten = 0;
+	fTStart = 0.;
+	fTStop = 0.;
+	fOnTime = 0.;
+	clearBuffers();
+	
+	int status = 0;
+	string iFITSFileName = "!" + fFileName;
+	if( fits_create_file( &fFitsFile, iFITSFileName.c_str(), &status ) )
+	{
+		fFitsFile = 0;
+		return printerror( status );
+	}
+	// empty primary HDU
+	fits_create_img( fFitsFile, BYTE_IMG, 0, 0, &status );
+	fits_update_key( fFitsFile, TSTRING, ( char* )"TELESCOP", ( char* )"VERITAS", ( char* )"Telescope name", &status );
+	fits_update_key( fFitsFile, TSTRING, ( char* )"CREATOR", ( char* )"Eventdisplay anasum", ( char* )"Software package creating file", &status );
+	
+	// EVENTS table (rows are added with each flush of the event buffer)
+	char* ttype[] = { ( char* )"EVENT_ID", ( char* )"TIME", ( char* )"RA", ( char* )"DEC", ( char* )"ENERGY",
+					  ( char* )"ALT", ( char* )"AZ", ( char* )"MULTIP", ( char* )"COREX", ( char* )"COREY",
+					  ( char* )"HIL_MSW", ( char* )"HIL_MSL"
+					};
+	char* tform[] = { ( char* )"1K", ( char* )"1D", ( char* )"1E", ( char* )"1E", ( char* )"1E",
+					  ( char* )"1E", ( char* )"1E", ( char* )"1I", ( char* )"1E", ( char* )"1E",
+					  ( char* )"1E", ( char* )"1E"
+					};
+	char* tunit[] = { ( char* )"", ( char* )"s", ( char* )"deg", ( char* )"deg", ( char* )"TeV",
+					  ( char* )"deg", ( char* )"deg", ( char* )"", ( char* )"m", ( char* )"m",
+					  ( char* )"", ( char* )""
+					};
+	fits_create_tbl( fFitsFile, BINARY_TBL, 0, 12, ttype, tform, tunit, ( char* )"EVENTS", &status );
+	fits_get_hdu_num( fFitsFile, &fEventsHDU );
+	if( status )
+	{
+		return printerror( status );
+	}
+	if( !writeHDUClassKeys( "EVENTS" ) )
+	{
+		return false;
+	}
+	
+	int iMJDREFI = fMJDREFI;
+	double iMJDREFF = 0.;
+	double iEquinox = 2000.;
+	fits_update_key( fFitsFile, TINT, ( char* )"OBS_ID", &fRunNumber, ( char* )"Run number", &status );
+	fits_update_key( fFitsFile, TSTRING, ( char* )"TELESCOP", ( char* )"VERITAS", ( char* )"Telescope name", &status );
+	fits_update_key( fFitsFile, TSTRING, ( char* )"OBJECT", ( char* )iObject.c_str(), ( char* )"Name of the object", &status );
+	fits_update_key( fFitsFile, TDOUBLE, ( char* )"RA_PNT", &iRA_PNT, ( char* )"Pointing RA (J2000) [deg]", &status );
+	fits_update_key( fFitsFile, TDOUBLE, ( char* )"DEC_PNT", &iDec_PNT, ( char* )"Pointing Dec (J2000) [deg]", &status );
+	fits_update_key( fFitsFile, TDOUBLE, ( char* )"EQUINOX", &iEquinox, ( char* )"Epoch of coordinate system", &status );
+	fits_update_key( fFitsFile, TSTRING, ( char* )"RADECSYS", ( char* )"FK5", ( char* )"Coordinate system", &status );
+	fits_update_key( fFitsFile, TINT, ( char* )"MJDREFI", &iMJDREFI, ( char* )"Reference time (integer part, MJD)", &status );
+	fits_update_key( fFitsFile, TDOUBLE, ( char* )"MJDREFF", &iMJDREFF, ( char* )"Reference time (fractional part, MJD)", &status );
+	fits_update_key( fFitsFile, TSTRING, ( char* )"TIMEUNIT", ( char* )"s", ( char* )"Time unit", &status );
+	fits_update_key( fFitsFile, TSTRING, ( char* )"TIMESYS", ( char* )"UTC", ( char* )"Time system", &status );
+	fits_update_key( fFitsFile, TSTRING, ( char* )"TIMEREF", ( char* )"LOCAL", ( char* )"Time reference frame", &status );
+	if( status )
+	{
+		return printerror( status );
+	}
+	
+	return true;
+}
+
+/*
+ * write HDU class keywords (GADF format) to current HDU
+ */
+bool VDL3FITSWriter::writeHDUClassKeys( string iClass1, string iClass2, string iClass3, string iClass4 )
+{
+	int status = 0;
+	fits_update_key( fFitsFile, TSTRING, ( char* )"HDUCLASS", ( char* )"GADF", ( char* )"FITS file following the GADF format", &status );
+	fits_update_key( fFitsFile, TSTRING, ( char* )"HDUDOC", ( char* )"https://gamma-astro-data-formats.readthedocs.io", ( char* )"", &status );
+	fits_update_key( fFitsFile, TSTRING, ( char* )"HDUVERS", ( char* )"0.2", ( char* )"", &status );
+	fits_update_key( fFitsFile, TSTRING, ( char* )"HDUCLAS1", ( char* )iClass1.c_str(), ( char* )"", &status );
+	if( iClass2.size() > 0 )
+	{
+		fits_update_key( fFitsFile, TSTRING, ( char* )"HDUCLAS2", ( char* )iClass2.c_str(), ( char* )"", &status );
+	}
+	if( iClass3.size() > 0 )
+	{
+		fits_update_key( fFitsFile, TSTRING, ( char* )"HDUCLAS3", ( char* )iClass3.c_str(), ( char* )"", &status );
+	}
+	if( iClass4.size() > 0 )
+	{
+		fits_update_key( fFitsFile, TSTRING, ( char* )"HDUCLAS4", ( char* )iClass4.c_str(), ( char* )"", &status );
+	}
+	if( status )
+	{
+		return printerror( status );
+	}
+	return true;
+}
+
+/*
+ * add an event to the event buffer
+ *
+ * buffer is written to disk when full
+ *
+ * iMJD, iTime: MJD and seconds of day (UTC)
+ */
+void VDL3FITSWriter::fillEvent( int iEventNumber, int iMJD, double iTime, double iRA, double iDec, double iEnergy,
+								double iAlt, double iAz, int iMultiplicity, double iCoreX, double iCoreY,
+								double iMSCW, double iMSCL )
+{
+	if( !fFitsFile )
+	{
+		return;
+	}
+	fEVENT_ID.push_back( ( LONGLONG )iEventNumber );
+	fTIME.push_back( ( double )( iMJD - fMJDREFI ) * 86400. + iTime );
+	fRA.push_back( ( float )iRA );
+	fDEC.push_back( ( float )iDec );
+	fENERGY.push_back( ( float )iEnergy );
+	fALT.push_back( ( float )iAlt );
+	fAZ.push_back( ( float )iAz );
+	fMULTIP.push_back( ( short )iMultiplicity );
+	fCOREX.push_back( ( float )iCoreX );
+	fCOREY.push_back( ( float )iCoreY );
+	fHIL_MSW.push_back( ( float )iMSCW );
+	fHIL_MSL.push_back( ( float )iMSCL );
+	
+	if( fTIME.size() >= fBufferSize )
+	{
+		flushEvents();
+	}
+}
+
+/*
+ * write all buffered events to the EVENTS table (one call per column)
+ */
+bool VDL3FITSWriter::flushEvents()
+{
+	if( !fFitsFile )
+	{
+		return false;
+	}
+	if( fTIME.size() == 0 )
+	{
+		return true;
+	}
+	int status = 0;
+	int hdutype = 0;
+	LONGLONG n = ( LONGLONG )fTIME.size();
+	LONGLONG r = ( LONGLONG )fNRowsWritten + 1;
+	fits_movabs_hdu( fFitsFile, fEventsHDU, &hdutype, &status );
+	fits_write_col( fFitsFile, TLONGLONG, 1, r, 1, n, &fEVENT_ID[0], &status );
+	fits_write_col( fFitsFile, TDOUBLE, 2, r, 1, n, &fTIME[0], &status );
+	fits_write_col( fFitsFile, TFLOAT, 3, r, 1, n, &fRA[0], &status );
+	fits_write_col( fFitsFile, TFLOAT, 4, r, 1, n, &fDEC[0], &status );
+	fits_write_col( fFitsFile, TFLOAT, 5, r, 1, n, &fENERGY[0], &status );
+	fits_write_col( fFitsFile, TFLOAT, 6, r, 1, n, &fALT[0], &status );
+	fits_write_col( fFitsFile, TFLOAT, 7, r, 1, n, &fAZ[0], &status );
+	fits_write_col( fFitsFile, TSHORT, 8, r, 1, n, &fMULTIP[0], &status );
+	fits_write_col( fFitsFile, TFLOAT, 9, r, 1, n, &fCOREX[0], &status );
+	fits_write_col( fFitsFile, TFLOAT, 10, r, 1, n, &fCOREY[0], &status );
+	fits_write_col( fFitsFile, TFLOAT, 11, r, 1, n, &fHIL_MSW[0], &status );
+	fits_write_col( fFitsFile, TFLOAT, 12, r, 1, n, &fHIL_MSL[0], &status );
+	fNRowsWritten += ( long )n;
+	clearBuffers();
+	if( status )
+	{
+		return printerror( status );
+	}
+	return true;
+}
+
+/*
+ * write good time intervals from time mask (open seconds of the mask)
+ *
+ * updates TSTART, TSTOP and ONTIME of the EVENTS table
+ */
+bool VDL3FITSWriter::writeGTI( VTimeMask* iMask )
+{
+	if( !fFitsFile || !iMask )
+	{
+		return false;
+	}
+	if( !flushEvents() )
+	{
+		return false;
+	}
+	
+	// convert open seconds of mask into time intervals
+	vector< double > iStart;
+	vector< double > iStop;
+	double t0 = ( double )( iMask->getMaskStartMJD() - fMJDREFI ) * 86400. + iMask->getMaskStartTime();
+	vector< Bool_t > iM = iMask->getMask();
+	unsigned int i = 0;
+	while( i < iM.size() )
+	{
+		if( !iM[i] )
+		{
+			i++;
+			continue;
+		}
+		unsigned int j = i;
+		while( j < iM.size() && iM[j] )
+		{
+			j++;
+		}
+		iStart.push_back( t0 + ( double )i );
+		iStop.push_back( t0 + ( double )j );
+		i = j;
+	}
+	if( iStart.size() == 0 )
+	{
+		cout << "VDL3FITSWriter::writeGTI warning: no good time intervals for run " << fRunNumber << endl;
+	}
+	fOnTime = 0.;
+	for( unsigned int g = 0; g < iStart.size(); g++ )
+	{
+		fOnTime += iStop[g] - iStart[g];
+	}
+	fTStart = ( iStart.size() > 0 ? iStart.front() : t0 );
+	fTStop  = ( iStop.size() > 0 ? iStop.back() : t0 );
+	
+	int status = 0;
+	int hdutype = 0;
+	fits_movabs_hdu( fFitsFile, fEventsHDU, &hdutype, &status );
+	fits_update_key( fFitsFile, TDOUBLE, ( char* )"TSTART", &fTStart, ( char* )"Start time of observations [s]", &status );
+	fits_update_key( fFitsFile, TDOUBLE, ( char* )"TSTOP", &fTStop, ( char* )"End time of observations [s]", &status );
+	fits_update_key( fFitsFile, TDOUBLE, ( char* )"ONTIME", &fOnTime, ( char* )"Sum of good time intervals [s]", &status );
+	
+	// GTI table is appended after the last HDU
+	int iNHDU = 0;
+	fits_get_num_hdus( fFitsFile, &iNHDU, &status );
+	fits_movabs_hdu( fFitsFile, iNHDU, &hdutype, &status );
+	char* ttype[] = { ( char* )"START", ( char* )"STOP" };
+	char* tform[] = { ( char* )"1D", ( char* )"1D" };
+	char* tunit[] = { ( char* )"s", ( char* )"s" };
+	fits_create_tbl( fFitsFile, BINARY_TBL, 0, 2, ttype, tform, tunit, ( char* )"GTI", &status );
+	if( status )
+	{
+		return printerror( status );
+	}
+	if( !writeHDUClassKeys( "GTI" ) )
+	{
+		return false;
+	}
+	int iMJDREFI = fMJDREFI;
+	double iMJDREFF = 0.;
+	fits_update_key( fFitsFile, TINT, ( char* )"MJDREFI", &iMJDREFI, ( char* )"Reference time (integer part, MJD)", &status );
+	fits_update_key( fFitsFile, TDOUBLE, ( char* )"MJDREFF", &iMJDREFF, ( char* )"Reference time (fractional part, MJD)", &status );
+	fits_update_key( fFitsFile, TSTRING, ( char* )"TIMEUNIT", ( char* )"s", ( char* )"Time unit", &status );
+	fits_update_key( fFitsFile, TSTRING, ( char* )"TIMESYS", ( char* )"UTC", ( char* )"Time system", &status );
+	fits_update_key( fFitsFile, TSTRING, ( char* )"TIMEREF", ( char* )"LOCAL", ( char* )"Time reference frame", &status );
+	if( iStart.size() > 0 )
+	{
+		fits_write_col( fFitsFile, TDOUBLE, 1, 1, 1, ( LONGLONG )iStart.size(), &iStart[0], &status );
+		fits_write_col( fFitsFile, TDOUBLE, 2, 1, 1, ( LONGLONG )iStop.size(), &iStop[0], &status );
+	}
+	if( status )
+	{
+		return printerror( status );
+	}
+	return true;
+}
+
+/*
+ * write run-averaged effective area (point-like IRF, single offset bin)
+ *
+ * g:          effective area vs log10 true energy [TeV]
+ *             (ENERG_LO/ENERG_HI are true energies; never pass an
+ *              effective area vs reconstructed energy)
+ * iOffsetMax: maximum offset of the offset bin [deg]
+ * iRadMax:    direction cut [deg]
+ */
+bool VDL3FITSWriter::writeEffectiveArea( TGraphAsymmErrors* g, double iOffsetMax, double iRadMax )
+{
+	if( !fFitsFile || !g || g->GetN() < 2 )
+	{
+		return false;
+	}
+	int nE = g->GetN();
+	vector< float > iELo( nE, 0. );
+	vector< float > iEHi( nE, 0. );
+	vector< float > iArea( nE, 0. );
+	// bin edges are half way between neighbouring energies
+	for( int i = 0; i < nE; i++ )
+	{
+		double x_lo = ( i > 0 ? 0.5 * ( g->GetX()[i - 1] + g->GetX()[i] ) : 1.5 * g->GetX()[0] - 0.5 * g->GetX()[1] );
+		double x_hi = ( i < nE - 1 ? 0.5 * ( g->GetX()[i] + g->GetX()[i + 1] ) : 1.5 * g->GetX()[nE - 1] - 0.5 * g->GetX()[nE - 2] );
+		iELo[i] = ( float )TMath::Power( 10., x_lo );
+		iEHi[i] = ( float )TMath::Power( 10., x_hi );
+		iArea[i] = ( float )g->GetY()[i];
+	}
+	float iThetaLo = 0.;
+	float iThetaHi = ( float )iOffsetMax;
+	
+	char iForm[100];
+	sprintf( iForm, "%dE", nE );
+	char* ttype[] = { ( char* )"ENERG_LO", ( char* )"ENERG_HI", ( char* )"THETA_LO", ( char* )"THETA_HI", ( char* )"EFFAREA" };
+	char* tform[] = { iForm, iForm, ( char* )"1E", ( char* )"1E", iForm };
+	char* tunit[] = { ( char* )"TeV", ( char* )"TeV", ( char* )"deg", ( char* )"deg", ( char* )"m2" };
+	
+	int status = 0;
+	int hdutype = 0;
+	int iNHDU = 0;
+	fits_get_num_hdus( fFitsFile, &iNHDU, &status );
+	fits_movabs_hdu( fFitsFile, iNHDU, &hdutype, &status );
+	fits_create_tbl( fFitsFile, BINARY_TBL, 0, 5, ttype, tform, tunit, ( char* )"EFFECTIVE AREA", &status );
+	long naxes[] = { nE, 1 };
+	fits_write_tdim( fFitsFile, 5, 2, naxes, &status );
+	if( status )
+	{
+		return printerror( status );
+	}
+	if( !writeHDUClassKeys( "RESPONSE", "EFF_AREA", "POINT-LIKE", "AEFF_2D" ) )
+	{
+		return false;
+	}
+	fits_update_key( fFitsFile, TDOUBLE, ( char* )"RAD_MAX", &iRadMax, ( char* )"Direction cut [deg]", &status );
+	fits_write_col( fFitsFile, TFLOAT, 1, 1, 1, nE, &iELo[0], &status );
+	fits_write_col( fFitsFile, TFLOAT, 2, 1, 1, nE, &iEHi[0], &status );
+	fits_write_col( fFitsFile, TFLOAT, 3, 1, 1, 1, &iThetaLo, &status );
+	fits_write_col( fFitsFile, TFLOAT, 4, 1, 1, 1, &iThetaHi, &status );
+	fits_write_col( fFitsFile, TFLOAT, 5, 1, 1, nE, &iArea[0], &status );
+	if( status )
+	{
+		return printerror( status );
+	}
+	return true;
+}
+
+/*
+ * write remaining events, live time keywords and close file
+ */
+bool VDL3FITSWriter::close( double iDeadTimeFraction )
+{
+	if( !fFitsFile )
+	{
+		return false;
+	}
+	bool bSuccess = flushEvents();
+	
+	int status = 0;
+	int hdutype = 0;
+	double iDeadC = 1. - iDeadTimeFraction;
+	double iLiveTime = fOnTime * iDeadC;
+	fits_movabs_hdu( fFitsFile, fEventsHDU, &hdutype, &status );
+	fits_update_key( fFitsFile, TDOUBLE, ( char* )"LIVETIME", &iLiveTime, ( char* )"Dead time corrected on time [s]", &status );
+	fits_update_key( fFitsFile, TDOUBLE, ( char* )"DEADC", &iDeadC, ( char* )"Dead time correction factor", &status );
+	fits_close_file( fFitsFile, &status );
+	fFitsFile = 0;
+	if( status )
+	{
+		return printerror( status );
+	}
+	cout << "DL3 FITS file written: " << fFileName << " (" << fNRowsWritten << " events)" << endl;
+	
+	return bSuccess;
+}
@@ -8,7 +8,7 @@
 
 VDetectorGeometry::VDetectorGeometry( unsigned int iNTel, vector< string > iCamera, string iDir,
 									  bool iDebug, float iCoordinateTransformerX, float iCoordinateTransformerY,
-									  int iSourceType )
+									  int iSourceType, string iGeometryCacheDirectory )
 {
 	fDebug = iDebug;
 	if( fDebug )
@@ -26,6 +26,8 @@ VDetectorGeometry::VDetectorGeometry( unsigned int iNTel, vector< string > iCame
 	
 	// set directory with all configuration files
 	setConfigDir( iDir );
+	// directory with binary geometry caches
+	setGeometryCacheDirectory( iGeometryCacheDirectory );
 	
 	// detector configuration file from GrIsu (.cfg)
 	if( iCamera[0].find( ".cfg" ) < iCamera[0].size() || iCamera[0].find( ".txt" ) < iCamera[0].size() )
@@ -1,7 +1,9 @@
 /*! \file VDispTable.cpp
     \brief fill and read tables for angular reconstruction with disp method
 
-
+    tables are filled from mergeable statistics (sums, sums of squares
+    and counts per bin, see VDispTableStatistics); entry ranges of a MC
+    file are processed in parallel and merged at the end
 
 
 */
@@ -13,6 +15,7 @@ VDispTable::VDispTable()
 	fDebug = false;
 	
 	fNTel = 0;
+	fNThreads = 1;
 	fTableFile = 0;
 	fData = 0;
 	
@@ -26,6 +29,7 @@ VDispTable::VDispTable( unsigned int iNTel, string ioutFile )
 	fDebug = false;
 	
 	fNTel = iNTel;
+	fNThreads = 1;
 	
 	fTableFile = 0;
 	fData = 0;
@@ -88,90 +92,77 @@ void VDispTable::addAzBin( float iMin, float iMax, bool iPe )
 	char htitle[500];
 	
 	// 2D disp tables
-	if( fData->h2D_DispTable )
+	if( fData->h2D_DispTable && fData->h2D_DispTableN && fData->h2D_DispPhiTable && fData->h2D_DispMissTable )
 	{
 		sprintf( hname, "h2D_DispTable_%d", ( int )fAz_min.size() );
 		sprintf( htitle, "az bin (%f < az < %f; %d)", fAz_min.back(), fAz_max.back(), ( int )fAz_min.size() );
-		h2D_AzDispTable.push_back( new TProfile2D( hname, htitle, fData->h2D_DispTable->GetNbinsX(), fData->h2D_DispTable->GetXaxis()->GetXmin(), fData->h2D_DispTable->GetXaxis()->GetXmax(), fData->h2D_DispTable->GetNbinsY(), fData->h2D_DispTable->GetYaxis()->GetXmin(), fData->h2D_DispTable->GetYaxis()->GetXmax(), 0., 100. ) );
+		h2D_AzDispTable.push_back( ( TH2F* )fData->h2D_DispTable->Clone( hname ) );
+		h2D_AzDispTable.back()->SetTitle( htitle );
 		h2D_AzDispTable.back()->SetXTitle( "width/length" );
 		h2D_AzDispTable.back()->SetYTitle( "log_{10} size" );
 		h2D_AzDispTable.back()->SetZTitle( "disp [deg]" );
-	}
-	if( fData->h2D_DispTableN )
-	{
+		
 		sprintf( hname, "h2D_DispTableN_%d", ( int )fAz_min.size() );
 		h2D_AzDispTableN.push_back( ( TH2F* )fData->h2D_DispTableN->Clone( hname ) );
 		h2D_AzDispTableN.back()->SetTitle( "" );
 		h2D_AzDispTableN.back()->SetXTitle( "width/length" );
 		h2D_AzDispTableN.back()->SetYTitle( "log_{10} size" );
 		h2D_AzDispTableN.back()->SetZTitle( "number of events/bin" );
-	}
-	if( fData->h2D_DispPhiTable )
-	{
+		
 		sprintf( hname, "h2D_DispPhiTable_%d", ( int )fAz_min.size() );
-		sprintf( htitle, "az bin (%f < az < %f; %d)", fAz_min.back(), fAz_max.back(), ( int )fAz_min.size() );
-		h2D_AzDispPhiTable.push_back( new TProfile2D( hname, htitle, fData->h2D_DispPhiTable->GetNbinsX(), fData->h2D_DispPhiTable->GetXaxis()->GetXmin(), fData->h2D_DispPhiTable->GetXaxis()->GetXmax(), fData->h2D_DispPhiTable->GetNbinsY(), fData->h2D_DispPhiTable->GetYaxis()->GetXmin(), fData->h2D_DispPhiTable->GetYaxis()->GetXmax(), 0., 100. ) );
+		h2D_AzDispPhiTable.push_back( ( TH2F* )fData->h2D_DispPhiTable->Clone( hname ) );
+		h2D_AzDispPhiTable.back()->SetTitle( htitle );
 		h2D_AzDispPhiTable.back()->SetXTitle( "width/length" );
 		h2D_AzDispPhiTable.back()->SetYTitle( "log_{10} size" );
 		h2D_AzDispPhiTable.back()->SetZTitle( "phi [deg]" );
-	}
-	if( fData->h2D_DispMissTable )
-	{
+		
 		sprintf( hname, "h2D_DispMiss_%d", ( int )fAz_min.size() );
 		sprintf( htitle, "error in reconstruction (%f < az < %f; %d)", fAz_min.back(), fAz_max.back(), ( int )fAz_min.size() );
-		h2D_AzDispMissTable.push_back( new TProfile2D( hname, htitle, fData->h2D_DispMissTable->GetNbinsX(), fData->h2D_DispMissTable->GetXaxis()->GetXmin(), fData->h2D_DispMissTable->GetXaxis()->GetXmax(), fData->h2D_DispMissTable->GetNbinsY(), fData->h2D_DispMissTable->GetYaxis()->GetXmin(), fData->h2D_DispMissTable->GetYaxis()->GetXmax(), 0., 100. ) );
+		h2D_AzDispMissTable.push_back( ( TH2F* )fData->h2D_DispMissTable->Clone( hname ) );
 		h2D_AzDispMissTable.back()->SetTitle( htitle );
 		h2D_AzDispMissTable.back()->SetXTitle( "width/length" );
 		h2D_AzDispMissTable.back()->SetYTitle( "log_{10} size" );
 		h2D_AzDispMissTable.back()->SetZTitle( "miss" );
+		
+		// values outside of [0,100] are ignored (as for the profile histograms used before)
+		f2D_AzStatistics.push_back( new VDispTableStatistics( fData->h2D_DispTable, 0., 100. ) );
 	}
 	
 	// 3D disp tables
-	if( fData->h3D_DispTable )
+	if( fData->h3D_DispTable && fData->h3D_DispTableN && fData->h3D_DispPhiTable && fData->h3D_DispMissTable )
 	{
 		sprintf( hname, "h3D_DispTable_%d", ( int )fAz_min.size() );
 		sprintf( htitle, "az bin (%f < az < %f; %d)", fAz_min.back(), fAz_max.back(), ( int )fAz_min.size() );
-		h3D_AzDispTable.push_back( new TProfile3D( hname, htitle, fData->h3D_DispTable->GetNbinsX(), fData->h3D_DispTable->GetXaxis()->GetXmin(), fData->h3D_DispTable->GetXaxis()->GetXmax(), fData->h3D_DispTable->GetNbinsY(), fData->h3D_DispTable->GetYaxis()->GetXmin(), fData->h3D_DispTable->GetYaxis()->GetXmax(), fData->h3D_DispTable->GetNbinsZ(), fData->h3D_DispTable->GetZaxis()->GetXmin(), fData->h3D_DispTable->GetZaxis()->GetXmax() ) );
+		h3D_AzDispTable.push_back( ( TH3F* )fData->h3D_DispTable->Clone( hname ) );
+		h3D_AzDispTable.back()->SetTitle( htitle );
 		h3D_AzDispTable.back()->SetXTitle( "f(width)" );
-		h3D_AzDispTable.back()->SetXTitle( "f(length)" );
-		h3D_AzDispTable.back()->SetYTitle( "log_{10} size" );
-		h3D_AzDispTable.back()->SetZTitle( "disp [deg]" );
-	}
-	
-	if( fData->h3D_DispTableN )
-	{
+		h3D_AzDispTable.back()->SetYTitle( "f(length)" );
+		h3D_AzDispTable.back()->SetZTitle( "log_{10} size" );
+		
 		sprintf( hname, "h3D_DispTableN_%d", ( int )fAz_min.size() );
 		h3D_AzDispTableN.push_back( ( TH3F* )fData->h3D_DispTableN->Clone( hname ) );
 		h3D_AzDispTableN.back()->SetTitle( "" );
 		h3D_AzDispTableN.back()->SetXTitle( "f(width)" );
-		h3D_AzDispTableN.back()->SetXTitle( "f(length)" );
-		h3D_AzDispTableN.back()->SetYTitle( "log_{10} size" );
-		h3D_AzDispTableN.back()->SetZTitle( "number of events/bin" );
-	}
-	
-	if( fData->h3D_DispPhiTable )
-	{
+		h3D_AzDispTableN.back()->SetYTitle( "f(length)" );
+		h3D_AzDispTableN.back()->SetZTitle( "log_{10} size" );
+		
 		sprintf( hname, "h3D_DispPhiTable_%d", ( int )fAz_min.size() );
-		sprintf( htitle, "az bin (%f < az < %f; %d)", fAz_min.back(), fAz_max.back(), ( int )fAz_min.size() );
-		h3D_AzDispPhiTable.push_back( new TProfile3D( hname, htitle, fData->h3D_DispPhiTable->GetNbinsX(), fData->h3D_DispPhiTable->GetXaxis()->GetXmin(), fData->h3D_DispPhiTable->GetXaxis()->GetXmax(), fData->h3D_DispPhiTable->GetNbinsY(), fData->h3D_DispPhiTable->GetYaxis()->GetXmin(), fData->h3D_DispPhiTable->GetYaxis()->GetXmax(), fData->h3D_DispPhiTable->GetNbinsZ(), fData->h3D_DispPhiTable->GetZaxis()->GetXmin(), fData->h3D_DispPhiTable->GetZaxis()->GetXmax() ) );
+		h3D_AzDispPhiTable.push_back( ( TH3F* )fData->h3D_DispPhiTable->Clone( hname ) );
+		h3D_AzDispPhiTable.back()->SetTitle( htitle );
 		h3D_AzDispPhiTable.back()->SetXTitle( "f(width)" );
-		h3D_AzDispPhiTable.back()->SetXTitle( "f(length)" );
-		h3D_AzDispPhiTable.back()->SetYTitle( "log_{10} size" );
-		h3D_AzDispPhiTable.back()->SetZTitle( "phi [deg]" );
-	}
-	
-	if( fData->h3D_DispMissTable )
-	{
+		h3D_AzDispPhiTable.back()->SetYTitle( "f(length)" );
+		h3D_AzDispPhiTable.back()->SetZTitle( "log_{10} size" );
+		
 		sprintf( hname, "h3D_DispMiss_%d", ( int )fAz_min.size() );
 		sprintf( htitle, "error in reconstruction (%f < az < %f; %d)", fAz_min.back(), fAz_max.back(), ( int )fAz_min.size() );
-		h3D_AzDispMissTable.push_back( new TProfile3D( hname, htitle, fData->h3D_DispMissTable->GetNbinsX(), fData->h3D_DispMissTable->GetXaxis()->GetXmin(), fData->h3D_DispMissTable->GetXaxis()->GetXmax(), fData->h3D_DispMissTable->GetNbinsY(), fData->h3D_DispMissTable->GetYaxis()->GetXmin(), fData->h3D_DispMissTable->GetYaxis()->GetXmax(), fData->h3D_DispMissTable->GetNbinsZ(), fData->h3D_DispMissTable->GetZaxis()->GetXmin(), fData->h3D_DispMissTable->GetZaxis()->GetXmax() ) );
-		//       h3D_AzDispMissTable.push_back( new TProfile3D( hname, htitle, iScaleWidth_bin, 0., 1., iScaleLength_bin, 0., 1., iSize_bin, iSize_min, iSize_max ) );
+		h3D_AzDispMissTable.push_back( ( TH3F* )fData->h3D_DispMissTable->Clone( hname ) );
+		h3D_AzDispMissTable.back()->SetTitle( htitle );
 		h3D_AzDispMissTable.back()->SetXTitle( "f(width)" );
-		h3D_AzDispMissTable.back()->SetXTitle( "f(length)" );
-		h3D_AzDispMissTable.back()->SetYTitle( "log_{10} size" );
-		h3D_AzDispMissTable.back()->SetZTitle( "miss" );
+		h3D_AzDispMissTable.back()->SetYTitle( "f(length)" );
+		h3D_AzDispMissTable.back()->SetZTitle( "log_{10} size" );
+		
+		f3D_AzStatistics.push_back( new VDispTableStatistics( fData->h3D_DispTable ) );
 	}
-	
 }
 
 
@@ -225,110 +216,305 @@ bool VDispTable::isGoodEvent( Ctpars* c )
 
 /*!
    loop over MC data and fill disp tables for given ze, woff
+
+   entries are split into fNThreads ranges which are processed in parallel;
+   two passes:
+   1. disp and dispPhi tables
+   2. miss tables (error in reconstruction using the disp tables from the first pass)
 */
 bool VDispTable::fillTable( string iMCFile, float i_ze, float i_woff, int iNentries )
 {
-	char hname[600];
+	if( !fData || h2D_AzDispTable.size() != fAz_min.size() || h3D_AzDispTable.size() != fAz_min.size() )
+	{
+		cout << "VDispTable::fillTable error: tables not initialized" << endl;
+		return false;
+	}
 	
 	/////////////////////////////////////////////////////////////////////////////////////
-	// reset variables
+	// reset histograms and statistics
 	/////////////////////////////////////////////////////////////////////////////////////
-	float disp = 0.;
-	float dispPhi = 0.;
-	unsigned int azBin = 0;
+	fData->reset();
+	for( unsigned int i = 0; i < fAz_min.size(); i++ )
+	{
+		f2D_AzStatistics[i]->reset();
+		f3D_AzStatistics[i]->reset();
+	}
+	
+	/////////////////////////////////////////////////////////////////////////////////////
+	// number of entries in MC file
+	/////////////////////////////////////////////////////////////////////////////////////
+	Long64_t iNTot = 0;
+	{
+		TFile iFile( iMCFile.c_str() );
+		if( iFile.IsZombie() )
+		{
+			cout << "VDispTable::fillTable error reading MC file " << iMCFile << endl;
+			return false;
+		}
+		TTree* s = ( TTree* )iFile.Get( "showerpars" );
+		if( !s )
+		{
+			cout << "VDispTable::fillTable error finding tree showerpars" << endl;
+			return false;
+		}
+		iNTot = s->GetEntries();
+		iFile.Close();
+	}
+	if( iNentries < 0 || iNentries > iNTot )
+	{
+		iNentries = ( int )iNTot;
+	}
+	
+	/////////////////////////////////////////////////////////////////////////////////////
+	// prepare fill jobs (one per thread)
+	/////////////////////////////////////////////////////////////////////////////////////
+	unsigned int iNJobs = fNThreads;
+	if( iNJobs < 1 )
+	{
+		iNJobs = 1;
+	}
+	if( iNentries > 0 && iNJobs > ( unsigned int )iNentries )
+	{
+		iNJobs = ( unsigned int )iNentries;
+	}
+	cout << "filling tables for " << iMCFile << endl;
+	cout << "\t (looping over " << iNentries << " entries";
+	if( iNJobs > 1 )
+	{
+		cout << " using " << iNJobs << " threads";
+	}
+	cout << ")" << endl;
+	
+	vector< sDispTableFillJob > iJobs( iNJobs );
+	for( unsigned int j = 0; j < iJobs.size(); j++ )
+	{
+		iJobs[j].fTable = this;
+		iJobs[j].fMCFile = iMCFile;
+		iJobs[j].fFirstEntry = ( Long64_t )iNentries * j / iNJobs;
+		iJobs[j].fLastEntry  = ( Long64_t )iNentries * ( j + 1 ) / iNJobs;
+		iJobs[j].bMissPass = false;
+		iJobs[j].fPedvarSum = 0.;
+		iJobs[j].fPedvarN = 0.;
+		iJobs[j].bSuccess = false;
+		for( unsigned int i = 0; i < fAz_min.size(); i++ )
+		{
+			iJobs[j].f2D.push_back( new VDispTableStatistics( fData->h2D_DispTable, 0., 100. ) );
+			iJobs[j].f3D.push_back( new VDispTableStatistics( fData->h3D_DispTable ) );
+		}
+	}
+	
+	/////////////////////////////////////////////////////////////////////////////////////
+	// first pass: disp and dispPhi tables
+	bool bSuccess = runFillJobs( iJobs );
 	
 	// assume same pedvars for all telescopes (is this true in the simulations?)
 	float i_meanPedvars = 0.;
 	float i_meanPedvarsN = 0.;
-	
-	// reset histograms
-	fData->reset();
-	for( unsigned int i = 0; i < h2D_AzDispTable.size(); i++ )
+	for( unsigned int j = 0; j < iJobs.size() && bSuccess; j++ )
 	{
-		h2D_AzDispTable[i]->Reset();
-		h2D_AzDispPhiTable[i]->Reset();
-		h2D_AzDispTableN[i]->Reset();
-		h2D_AzDispMissTable[i]->Reset();
-		
-		h3D_AzDispTable[i]->Reset();
-		h3D_AzDispPhiTable[i]->Reset();
-		h3D_AzDispTableN[i]->Reset();
-		h3D_AzDispMissTable[i]->Reset();
+		i_meanPedvars  += iJobs[j].fPedvarSum;
+		i_meanPedvarsN += iJobs[j].fPedvarN;
+		for( unsigned int i = 0; i < fAz_min.size(); i++ )
+		{
+			f2D_AzStatistics[i]->add( iJobs[j].f2D[i] );
+			f3D_AzStatistics[i]->add( iJobs[j].f3D[i] );
+			iJobs[j].f2D[i]->reset();
+			iJobs[j].f3D[i]->reset();
+		}
+		iJobs[j].bMissPass = true;
 	}
-	
+	if( i_meanPedvarsN > 0. )
+	{
+		i_meanPedvars /= i_meanPedvarsN;
+	}
+	cout << "\t mean pedvars: " << i_meanPedvars << endl;
 	
 	/////////////////////////////////////////////////////////////////////////////////////
-	// prepare MC data files and trees
+	// second pass: estimate error in reconstruction
+	if( bSuccess )
+	{
+		cout << endl << "second loop for error estimation..." << endl;
+		bSuccess = runFillJobs( iJobs );
+	}
+	for( unsigned int j = 0; j < iJobs.size(); j++ )
+	{
+		for( unsigned int i = 0; i < iJobs[j].f2D.size(); i++ )
+		{
+			if( bSuccess )
+			{
+				f2D_AzStatistics[i]->add( iJobs[j].f2D[i] );
+				f3D_AzStatistics[i]->add( iJobs[j].f3D[i] );
+			}
+			delete iJobs[j].f2D[i];
+			delete iJobs[j].f3D[i];
+		}
+	}
+	if( !bSuccess )
+	{
+		return false;
+	}
+	
 	/////////////////////////////////////////////////////////////////////////////////////
+	// fill data carrier
+	for( unsigned int i = 0; i < fAz_min.size(); i++ )
+	{
+		f2D_AzStatistics[i]->fillHistogram( VDispTableStatistics::E_DISP, h2D_AzDispTable[i] );
+		f2D_AzStatistics[i]->fillEventHistogram( h2D_AzDispTableN[i] );
+		f2D_AzStatistics[i]->fillHistogram( VDispTableStatistics::E_PHI, h2D_AzDispPhiTable[i] );
+		f2D_AzStatistics[i]->fillHistogram( VDispTableStatistics::E_MISS, h2D_AzDispMissTable[i] );
+		f3D_AzStatistics[i]->fillHistogram( VDispTableStatistics::E_DISP, h3D_AzDispTable[i] );
+		f3D_AzStatistics[i]->fillEventHistogram( h3D_AzDispTableN[i] );
+		f3D_AzStatistics[i]->fillHistogram( VDispTableStatistics::E_PHI, h3D_AzDispPhiTable[i] );
+		f3D_AzStatistics[i]->fillHistogram( VDispTableStatistics::E_MISS, h3D_AzDispMissTable[i] );
+		// sums per bin (for exact merging of tables, see combineDISPTables)
+		f2D_AzStatistics[i]->getSparseStatistics( fData->f2D_StatisticsBin, fData->f2D_Statistics );
+		f3D_AzStatistics[i]->getSparseStatistics( fData->f3D_StatisticsBin, fData->f3D_Statistics );
+		
+		fData->fill( i_ze, i, fAz_min[i], fAz_max[i], i_woff, i_meanPedvars, ( TH2* )h2D_AzDispTable[i], ( TH2* )h2D_AzDispTableN[i], ( TH2* )h2D_AzDispPhiTable[i], ( TH2* )h2D_AzDispMissTable[i], ( TH3* )h3D_AzDispTable[i], ( TH3* )h3D_AzDispTableN[i], ( TH3* )h3D_AzDispPhiTable[i], ( TH3* )h3D_AzDispMissTable[i] );
+	}
 	
-	// data file with MC input
-	TFile iFile( iMCFile.c_str() );
-	if( iFile.IsZombie() )
+	return true;
+}
+
+/*
+ * run fill jobs (in parallel for more than one job)
+ */
+bool VDispTable::runFillJobs( vector< sDispTableFillJob >& iJobs )
+{
+	if( iJobs.size() == 1 )
 	{
-		cout << "VDispTable::fillTable error reading MC file " << iMCFile << endl;
-		return false;
+		fillTableJob( &iJobs[0] );
 	}
+	else
+	{
+		ROOT::EnableThreadSafety();
+		vector< thread > iThreads;
+		for( unsigned int j = 0; j < iJobs.size(); j++ )
+		{
+			iThreads.push_back( thread( VDispTable::fillTableJob, &iJobs[j] ) );
+		}
+		for( unsigned int j = 0; j < iThreads.size(); j++ )
+		{
+			iThreads[j].join();
+		}
+	}
+	for( unsigned int j = 0; j < iJobs.size(); j++ )
+	{
+		if( !iJobs[j].bSuccess )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+ * fill disp table statistics for one range of entries
+ *
+ * each job reads its own copy of the MC file;
+ * tables of the first pass (f2D_AzStatistics, f3D_AzStatistics) are
+ * only read during the second pass
+ */
+void VDispTable::fillTableJob( sDispTableFillJob* iJob )
+{
+	if( !iJob || !iJob->fTable || !iJob->fTable->fData )
+	{
+		return;
+	}
+	iJob->bSuccess = false;
+	VDispTable* iT = iJob->fTable;
+	// print only for first job
+	bool bPrint = ( iJob->fFirstEntry == 0 );
 	
-	cout << "filling tables for " << iMCFile << endl;
+	char hname[600];
 	
+	TFile* iFile = new TFile( iJob->fMCFile.c_str() );
+	if( iFile->IsZombie() )
+	{
+		cout << "VDispTable::fillTable error reading MC file " << iJob->fMCFile << endl;
+		delete iFile;
+		return;
+	}
 	// get showerpars tree
-	TTree* s = ( TTree* )iFile.Get( "showerpars" );
+	TTree* s = ( TTree* )iFile->Get( "showerpars" );
 	if( !s )
 	{
 		cout << "VDispTable::fillTable error finding tree showerpars" << endl;
-		return false;
+		delete iFile;
+		return;
 	}
 	Cshowerpars* m = new Cshowerpars( s, true, true );
-	if( !m )
-	{
-		return false;
-	}
+	
+	float disp = 0.;
+	float dispPhi = 0.;
+	unsigned int azBin = 0;
+	double miss = 0.;
+	double x_s = 0.;
+	double y_s = 0.;
 	
 	// get tpars trees (fNTel times)
-	for( unsigned int i = 0; i < fNTel; i++ )
+	for( unsigned int i = 0; i < iT->fNTel; i++ )
 	{
 		sprintf( hname, "Tel_%d/tpars", i + 1 );
-		TTree* t = ( TTree* )iFile.Get( hname );
+		TTree* t = ( TTree* )iFile->Get( hname );
 		if( !t )
 		{
-			cout << "VDispTable::fillTable error finding tree tpars for telescope " << i + 1 << endl;
+			if( bPrint )
+			{
+				cout << "VDispTable::fillTable error finding tree tpars for telescope " << i + 1 << endl;
+			}
 			continue;
 		}
 		Ctpars* c = new Ctpars( t, true, 1 );
-		if( !c )
-		{
-			continue;
-		}
 		
 		if( m->fChain->GetEntries() != c->fChain->GetEntries() )
 		{
-			cout << "\t error: different number of events in showerpars and tpars trees for telescope " << i + 1 << endl;
-			cout << "...ignore this telescope" << endl;
+			if( bPrint )
+			{
+				cout << "\t error: different number of events in showerpars and tpars trees for telescope " << i + 1 << endl;
+				cout << "...ignore this telescope" << endl;
+			}
+			// (file is closed below, not by the Ctpars destructor)
+			c->fChain = 0;
+			delete c;
 			continue;
 		}
-		cout << "\t telescope " << i + 1 << ", " << c->fChain->GetEntries() << " entries in data tree" << endl;
+		if( bPrint )
+		{
+			cout << "\t telescope " << i + 1 << ", " << c->fChain->GetEntries() << " entries in data tree" << endl;
+		}
 		
 		/////////////////////////////////////////////////////////////////////////////////////
 		// loop over all events for this telescope
-		if( iNentries < 0 )
-		{
-			iNentries = c->fChain->GetEntries();
-		}
-		if( iNentries > c->fChain->GetEntries() )
-		{
-			iNentries = c->fChain->GetEntries();
-		}
-		cout << "\t (looping over " << iNentries << " entries)" << endl;
-		for( int n = 0; n < iNentries; n++ )
+		Long64_t iLastEntry = TMath::Min( iJob->fLastEntry, ( Long64_t )c->fChain->GetEntries() );
+		for( Long64_t n = iJob->fFirstEntry; n < iLastEntry; n++ )
 		{
 			c->GetEntry( n );
 			m->GetEntry( n );
 			
 			// apply quality cuts
-			if( isGoodEvent( c ) )
+			if( !iT->isGoodEvent( c ) )
 			{
-				i_meanPedvars += c->meanPedvar_Image;
-				i_meanPedvarsN++;
+				continue;
+			}
+			azBin = iT->fData->getAzBin( m->MCaz );
+			if( azBin >= iJob->f2D.size() || azBin >= iJob->f3D.size() )
+			{
+				continue;
+			}
+			double iWidthOLength = c->width / c->length;
+			double iLogSize = log10( c->size );
+			double iScaleWidth = iT->fData->scaleWidthParameter( c->width );
+			double iScaleLength = iT->fData->scaleLengthParameter( c->length );
+			int i2DBin = iJob->f2D[azBin]->getBin( iWidthOLength, iLogSize );
+			int i3DBin = iJob->f3D[azBin]->getBin( iScaleWidth, iScaleLength, iLogSize );
+			
+			////////////////////////////////////////////////////////////////////////////////////////////////////////
+			// first pass: fill disp tables
+			if( !iJob->bMissPass )
+			{
+				iJob->fPedvarSum += c->meanPedvar_Image;
+				iJob->fPedvarN++;
 				
 				// calculate disp (observe sign convention for MCyoff)
 				disp  = sqrt( ( c->cen_y + m->MCyoff ) * ( c->cen_y + m->MCyoff ) + ( c->cen_x - m->MCxoff ) * ( c->cen_x - m->MCxoff ) );
@@ -348,119 +534,300 @@ bool VDispTable::fillTable( string iMCFile, float i_ze, float i_woff, int iNentr
 					dispPhi  = TMath::Pi() - dispPhi;
 				}
 				
-				////////////////////////////////////////////////////////////////////////////////////////////////////////
-				// fill tables
-				azBin = fData->getAzBin( m->MCaz );
-				if( azBin < h2D_AzDispTable.size() )
-				{
-					// 2D tables
-					h2D_AzDispTable[azBin]->Fill( c->width / c->length, log10( c->size ), disp );
-					h2D_AzDispTableN[azBin]->Fill( c->width / c->length, log10( c->size ) );
-					h2D_AzDispPhiTable[azBin]->Fill( c->width / c->length, log10( c->size ), dispPhi );
-					// 3D tables
-					h3D_AzDispTable[azBin]->Fill( fData->scaleWidthParameter( c->width ), fData->scaleLengthParameter( c->length ), log10( c->size ), disp );
-					h3D_AzDispTableN[azBin]->Fill( fData->scaleWidthParameter( c->width ), fData->scaleLengthParameter( c->length ), log10( c->size ) );
-					h3D_AzDispPhiTable[azBin]->Fill( fData->scaleWidthParameter( c->width ), fData->scaleLengthParameter( c->length ), log10( c->size ), dispPhi );
-				}
-				////////////////////////////////////////////////////////////////////////////////////////////////////////
+				// 2D tables
+				iJob->f2D[azBin]->fillEvent( i2DBin );
+				iJob->f2D[azBin]->fill( VDispTableStatistics::E_DISP, i2DBin, disp );
+				iJob->f2D[azBin]->fill( VDispTableStatistics::E_PHI, i2DBin, dispPhi );
+				// 3D tables
+				iJob->f3D[azBin]->fillEvent( i3DBin );
+				iJob->f3D[azBin]->fill( VDispTableStatistics::E_DISP, i3DBin, disp );
+				iJob->f3D[azBin]->fill( VDispTableStatistics::E_PHI, i3DBin, dispPhi );
+			}
+			////////////////////////////////////////////////////////////////////////////////////////////////////////
+			// second pass: estimate error in reconstruction
+			else
+			{
+				//////////////////////////////////////////////////////////////////////////////////////
+				// 2D
+				// get disp values from tables of first pass
+				disp = iT->f2D_AzStatistics[azBin]->getMean( VDispTableStatistics::E_DISP, i2DBin );
+				// calculate reconstructed shower direction
+				x_s = c->cen_x - disp * c->cosphi;
+				y_s = c->cen_y - disp * c->sinphi;
+				// calculate deviation from true shower direction
+				miss = sqrt( ( m->MCxoff - x_s ) * ( m->MCxoff - x_s ) + ( m->MCyoff + y_s ) * ( m->MCyoff + y_s ) );
+				iJob->f2D[azBin]->fill( VDispTableStatistics::E_MISS, i2DBin, miss );
+				//////////////////////////////////////////////////////////////////////////////////////
+				// 3D
+				disp = iT->f3D_AzStatistics[azBin]->getMean( VDispTableStatistics::E_DISP, i3DBin );
+				x_s = c->cen_x - disp * c->cosphi;
+				y_s = c->cen_y - disp * c->sinphi;
+				miss = sqrt( ( m->MCxoff - x_s ) * ( m->MCxoff - x_s ) + ( m->MCyoff + y_s ) * ( m->MCyoff + y_s ) );
+				iJob->f3D[azBin]->fill( VDispTableStatistics::E_MISS, i3DBin, miss );
 			}
 		}
+		c->fChain = 0;
+		delete c;
 	}
-	if( i_meanPedvarsN > 0. )
+	m->fChain = 0;
+	delete m;
+	// closes file and deletes all trees
+	delete iFile;
+	
+	iJob->bSuccess = true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VDispTableStatistics::VDispTableStatistics( TH1* iH, double iValueMin, double iValueMax )
+{
+	fValueMin = iValueMin;
+	fValueMax = iValueMax;
+	
+	unsigned int iNCells = 1;
+	if( iH )
 	{
-		i_meanPedvars /= i_meanPedvarsN;
+		TAxis* iAxis[3] = { iH->GetXaxis(), iH->GetYaxis(), iH->GetZaxis() };
+		for( int i = 0; i < iH->GetDimension() && i < 3; i++ )
+		{
+			fNBins.push_back( iAxis[i]->GetNbins() );
+			fMin.push_back( iAxis[i]->GetXmin() );
+			fMax.push_back( iAxis[i]->GetXmax() );
+			iNCells *= ( unsigned int )( iAxis[i]->GetNbins() + 2 );
+		}
 	}
-	cout << "\t mean pedvars: " << i_meanPedvars << endl;
-	
-	///////////////////////////////////////////////////////////////////////////////////////////////
-	///////////////////////////////////////////////////////////////////////////////////////////////
-	///////////////////////////////////////////////////////////////////////////////////////////////
-	// loop a second time over all events to estimate error in reconstruction
-	cout << endl << "second loop for error estimation..." << endl;
-	for( unsigned int i = 0; i < fNTel; i++ )
+	fEvents.assign( iNCells, 0. );
+	fN.assign( 3, fEvents );
+	fSum.assign( 3, fEvents );
+	fSum2.assign( 3, fEvents );
+}
+
+void VDispTableStatistics::reset()
+{
+	fEvents.assign( fEvents.size(), 0. );
+	for( unsigned int v = 0; v < fN.size(); v++ )
 	{
-		sprintf( hname, "Tel_%d/tpars", i + 1 );
-		TTree* t = ( TTree* )iFile.Get( hname );
-		if( !t )
+		fN[v].assign( fEvents.size(), 0. );
+		fSum[v].assign( fEvents.size(), 0. );
+		fSum2[v].assign( fEvents.size(), 0. );
+	}
+}
+
+/*
+ * get bin number (as TH1::FindBin() for fixed bin widths)
+ */
+int VDispTableStatistics::getBin( double x, double y, double z )
+{
+	double v[3] = { x, y, z };
+	int iBin = 0;
+	int iStride = 1;
+	for( unsigned int i = 0; i < fNBins.size(); i++ )
+	{
+		int b = 0;
+		if( v[i] < fMin[i] )
 		{
-			cout << "VDispTable::fillTable error finding tree tpars for telescope " << i + 1 << endl;
-			continue;
+			b = 0;
 		}
-		Ctpars* c = new Ctpars( t, true, 1 );
-		if( !c )
+		else if( !( v[i] < fMax[i] ) )
 		{
-			continue;
+			b = fNBins[i] + 1;
 		}
-		
-		if( m->fChain->GetEntries() != c->fChain->GetEntries() )
+		else
 		{
-			cout << "\t error: different number of events in showerpars and tpars trees for telescope " << i + 1 << endl;
-			cout << "...ignore this telescope" << endl;
-			continue;
+			b = 1 + ( int )( fNBins[i] * ( v[i] - fMin[i] ) / ( fMax[i] - fMin[i] ) );
 		}
-		cout << "\t telescope " << i + 1 << ", " << c->fChain->GetEntries() << " entries in data tree" << endl;
-		
-		// loop over all events for this telescope
-		double miss = 0.;
-		int x_bin = 0;
-		int y_bin = 0;
-		int z_bin = 0;
-		double x_s = 0.;
-		double y_s = 0.;
-		if( iNentries < 0 )
+		iBin += b * iStride;
+		iStride *= fNBins[i] + 2;
+	}
+	return iBin;
+}
+
+void VDispTableStatistics::fill( unsigned int iValue, int iBin, double iV )
+{
+	if( fValueMin < fValueMax && ( iV < fValueMin || iV > fValueMax ) )
+	{
+		return;
+	}
+	fN[iValue][iBin]++;
+	fSum[iValue][iBin]  += iV;
+	fSum2[iValue][iBin] += iV * iV;
+}
+
+/*
+ * add statistics from a partial fill (exact)
+ */
+bool VDispTableStatistics::add( VDispTableStatistics* iS )
+{
+	if( !iS || iS->getNBins() != getNBins() )
+	{
+		cout << "VDispTableStatistics::add error: inconsistent binning" << endl;
+		return false;
+	}
+	for( unsigned int b = 0; b < fEvents.size(); b++ )
+	{
+		fEvents[b] += iS->fEvents[b];
+	}
+	for( unsigned int v = 0; v < fN.size(); v++ )
+	{
+		for( unsigned int b = 0; b < fEvents.size(); b++ )
 		{
-			iNentries = c->fChain->GetEntries();
+			fN[v][b]    += iS->fN[v][b];
+			fSum[v][b]  += iS->fSum[v][b];
+			fSum2[v][b] += iS->fSum2[v][b];
 		}
-		if( iNentries > c->fChain->GetEntries() )
+	}
+	return true;
+}
+
+/*
+ * fill mean and error of mean into histogram
+ * (histogram must have the same binning)
+ */
+bool VDispTableStatistics::fillHistogram( unsigned int iValue, TH1* iH )
+{
+	if( !iH || iValue >= fN.size() || ( unsigned int )iH->GetNcells() != getNBins() )
+	{
+		return false;
+	}
+	for( unsigned int b = 0; b < fEvents.size(); b++ )
+	{
+		double iMean = 0.;
+		double iError = 0.;
+		if( fN[iValue][b] > 0. )
 		{
-			iNentries = c->fChain->GetEntries();
+			iMean = fSum[iValue][b] / fN[iValue][b];
+			iError = sqrt( TMath::Max( fSum2[iValue][b] / fN[iValue][b] - iMean * iMean, 0. ) / fN[iValue][b] );
 		}
-		for( int n = 0; n < iNentries; n++ )
+		iH->SetBinContent( b, iMean );
+		iH->SetBinError( b, iError );
+	}
+	return true;
+}
+
+bool VDispTableStatistics::fillEventHistogram( TH1* iH )
+{
+	if( !iH || ( unsigned int )iH->GetNcells() != getNBins() )
+	{
+		return false;
+	}
+	for( unsigned int b = 0; b < fEvents.size(); b++ )
+	{
+		iH->SetBinContent( b, fEvents[b] );
+	}
+	return true;
+}
+
+/*
+ * get sums per bin for all bins with entries (for storage with the disp tables)
+ *
+ * per bin: number of events, followed by number of values, sum and
+ * sum of squares for disp, dispPhi and miss
+ */
+void VDispTableStatistics::getSparseStatistics( vector< int >* iBin, vector< double >* iValue )
+{
+	if( !iBin || !iValue )
+	{
+		return;
+	}
+	iBin->clear();
+	iValue->clear();
+	for( unsigned int b = 0; b < fEvents.size(); b++ )
+	{
+		bool bFilled = ( fEvents[b] > 0. );
+		for( unsigned int v = 0; v < fN.size(); v++ )
 		{
-			c->GetEntry( n );
-			m->GetEntry( n );
-			
-			// quality cuts
-			if( isGoodEvent( c ) )
+			if( fN[v][b] > 0. )
 			{
-				azBin = fData->getAzBin( m->MCaz );
-				if( azBin < h2D_AzDispTable.size() )
-				{
-					//////////////////////////////////////////////////////////////////////////////////////
-					// 2D
-					// get disp values from histograms
-					x_bin = h2D_AzDispTable[azBin]->GetXaxis()->FindBin( c->width / c->length );
-					y_bin = h2D_AzDispTable[azBin]->GetYaxis()->FindBin( log10( c->size ) );
-					disp =  h2D_AzDispTable[azBin]->GetBinContent( x_bin, y_bin );
-					// calculate reconstructed shower direction
-					x_s = c->cen_x - disp * c->cosphi;
-					y_s = c->cen_y - disp * c->sinphi;
-					// calculate deviation from true shower direction and fill this into a tree
-					miss = sqrt( ( m->MCxoff - x_s ) * ( m->MCxoff - x_s ) + ( m->MCyoff + y_s ) * ( m->MCyoff + y_s ) );
-					h2D_AzDispMissTable[azBin]->Fill( c->width / c->length, log10( c->size ), miss );
-					//////////////////////////////////////////////////////////////////////////////////////
-					// 3D
-					// get disp values from histograms
-					x_bin = h3D_AzDispTable[azBin]->GetXaxis()->FindBin( fData->scaleWidthParameter( c->width ) );
-					y_bin = h3D_AzDispTable[azBin]->GetXaxis()->FindBin( fData->scaleLengthParameter( c->length ) );
-					z_bin = h3D_AzDispTable[azBin]->GetYaxis()->FindBin( log10( c->size ) );
-					disp =  h3D_AzDispTable[azBin]->GetBinContent( x_bin, y_bin, z_bin );
-					// calculate reconstructed shower direction
-					x_s = c->cen_x - disp * c->cosphi;
-					y_s = c->cen_y - disp * c->sinphi;
-					// calculate deviation from true shower direction and fill this into a tree
-					miss = sqrt( ( m->MCxoff - x_s ) * ( m->MCxoff - x_s ) + ( m->MCyoff + y_s ) * ( m->MCyoff + y_s ) );
-					h3D_AzDispMissTable[azBin]->Fill( fData->scaleWidthParameter( c->width ), fData->scaleLengthParameter( c->length ), log10( c->size ), miss );
-				}
+				bFilled = true;
 			}
 		}
+		if( !bFilled )
+		{
+			continue;
+		}
+		iBin->push_back( ( int )b );
+		iValue->push_back( fEvents[b] );
+		for( unsigned int v = 0; v < fN.size(); v++ )
+		{
+			iValue->push_back( fN[v][b] );
+			iValue->push_back( fSum[v][b] );
+			iValue->push_back( fSum2[v][b] );
+		}
 	}
-	
-	// fill data carrier
-	for( unsigned int i = 0; i < fAz_min.size(); i++ )
+}
+
+/*
+ * add sums per bin stored with a disp table (exact; see getSparseStatistics())
+ */
+bool VDispTableStatistics::addSparseStatistics( vector< int >* iBin, vector< double >* iValue )
+{
+	unsigned int iNValues = 1 + 3 * fN.size();
+	if( !iBin || !iValue || iValue->size() != iBin->size() * iNValues )
 	{
-		fData->fill( i_ze, i, fAz_min[i], fAz_max[i], i_woff, i_meanPedvars, ( TH2* )h2D_AzDispTable[i], ( TH2* )h2D_AzDispTableN[i], ( TH2* )h2D_AzDispPhiTable[i], ( TH2* )h2D_AzDispMissTable[i], ( TH3* )h3D_AzDispTable[i], ( TH3* )h3D_AzDispTableN[i], ( TH3* )h3D_AzDispPhiTable[i], ( TH3* )h3D_AzDispMissTable[i] );
+		cout << "VDispTableStatistics::addSparseStatistics error: inconsistent table statistics" << endl;
+		return false;
+	}
+	for( unsigned int k = 0; k < iBin->size(); k++ )
+	{
+		int b = ( *iBin )[k];
+		if( b < 0 || b >= ( int )fEvents.size() )
+		{
+			cout << "VDispTableStatistics::addSparseStatistics error: inconsistent binning" << endl;
+			return false;
+		}
+		unsigned int z = k * iNValues;
+		fEvents[b] += ( *iValue )[z];
+		for( unsigned int v = 0; v < fN.size(); v++ )
+		{
+			fN[v][b]    += ( *iValue )[z + 1 + 3 * v];
+			fSum[v][b]  += ( *iValue )[z + 2 + 3 * v];
+			fSum2[v][b] += ( *iValue )[z + 3 + 3 * v];
+		}
+	}
+	return true;
+}
+
+/*
+ * add statistics from a table histogram (mean and error of mean per bin)
+ * (for tables without stored statistics only)
+ *
+ * sums are reconstructed from mean, error and number of entries (iHN);
+ * this is the inverse of fillHistogram(), but only approximately:
+ * - tables are stored with single precision (TH2F/TH3F)
+ * - iHN counts all events in a bin, including values outside of the
+ *   accepted range which did not enter mean and error
+ */
+bool VDispTableStatistics::addHistogram( unsigned int iValue, TH1* iH, TH1* iHN )
+{
+	if( !iH || !iHN || iValue >= fN.size() || ( unsigned int )iH->GetNcells() != getNBins() || iHN->GetNcells() != iH->GetNcells() )
+	{
+		return false;
+	}
+	for( unsigned int b = 0; b < fEvents.size(); b++ )
+	{
+		double n = iHN->GetBinContent( b );
+		if( n <= 0. )
+		{
+			continue;
+		}
+		double iMean = iH->GetBinContent( b );
+		double iError = iH->GetBinError( b );
+		fN[iValue][b]    += n;
+		fSum[iValue][b]  += iMean * n;
+		fSum2[iValue][b] += n * ( iError * iError * n + iMean * iMean );
+	}
+	return true;
+}
+
+bool VDispTableStatistics::addEventHistogram( TH1* iHN )
+{
+	if( !iHN || ( unsigned int )iHN->GetNcells() != getNBins() )
+	{
+		return false;
+	}
+	for( unsigned int b = 0; b < fEvents.size(); b++ )
+	{
+		fEvents[b] += iHN->GetBinContent( b );
 	}
-	
 	return true;
 }
@@ -18,6 +18,11 @@ VDispTableAnalyzer::VDispTableAnalyzer( string iFile )
 	f_disp_PhiE = 0.;
 	f_disp_Miss = 0.;
 	
+	f2DTable.bFilled = false;
+	f2DTable.fNCells = 0;
+	f3DTable.bFilled = false;
+	f3DTable.fNCells = 0;
+	
 	// open file with disp tables
 	fFile = new TFile( iFile.c_str() );
 	cout << "opening disp table file: " << fFile->GetName() << endl;
@@ -48,39 +53,77 @@ VDispTableAnalyzer::VDispTableAnalyzer( string iFile )
 
        interpolate only in zenith angles (not in azimuth and pedvar)
 
+       values are read from the resident disp tables (no I/O per image)
+
 */
 float VDispTableAnalyzer::evaluate( float iWidth, float iLength, float iSize, float iPedvar, float iZe, float iAz, bool b2D )
 {
-	// get lower bound ze
-	float i_ze_low = fData->getLowerZe( iZe );
+	sDispTableCache* iC = &f3DTable;
+	if( b2D )
+	{
+		iC = &f2DTable;
+	}
+	if( !iC->bFilled )
+	{
+		fillTableCache( b2D );
+	}
 	
-	float disp_low      = calculateDisp( iWidth, iLength, iSize, iPedvar, i_ze_low, iAz, b2D );
-	float dispE_low     = f_dispE;
-	float disp_Phi_low  = f_disp_Phi;
-	float disp_PhiE_low = f_disp_PhiE;
-	float disp_Miss_low = f_disp_Miss;
+	// reset parameter values
+	f_disp = -99.;
+	f_dispE = 1.e3;
+	f_disp_Phi = 0.;
+	f_disp_PhiE = 1.e3;
+	f_disp_Miss = 0.;
 	
-	// get upper bound ze
-	float i_ze_upp = fData->getUpperZe( iZe );
+	if( iC->fData.size() == 0 || fData->f_ze.size() == 0 )
+	{
+		return f_disp;
+	}
 	
-	float disp_upp      = calculateDisp( iWidth, iLength, iSize, iPedvar, i_ze_upp, iAz, b2D );
-	float dispE_upp     = f_dispE;
-	float disp_Phi_upp  = f_disp_Phi;
-	float disp_PhiE_upp = f_disp_PhiE;
-	float disp_Miss_upp = f_disp_Miss;
+	// table bin (same for all zenith angles, azimuth and noise bins)
+	int iCell = getTableCell( iC, iWidth, iLength, iSize, b2D );
+	if( iCell < 0 )
+	{
+		return f_disp;
+	}
 	
-	// interpolate
+	// lower and upper bound ze
+	unsigned int i_ze_up  = 0;
+	unsigned int i_ze_low = 0;
+	fData->getIndexBoundary( &i_ze_up, &i_ze_low, fData->f_ze, iZe );
+	
+	// azimuth bin
+	unsigned int i_az = fData->getAzBin( iAz );
+	
+	// noise bin (closest value)
+	unsigned int i_noise = 0;
+	float i_diff = 1.e9;
+	for( unsigned int i = 0; i < fData->f_noise.size(); i++ )
+	{
+		if( TMath::Abs( iPedvar - fData->f_noise[i] ) < i_diff )
+		{
+			i_noise = i;
+			i_diff = TMath::Abs( iPedvar - fData->f_noise[i] );
+		}
+	}
 	
-	f_disp      = interpolate( disp_low, i_ze_low, disp_upp, i_ze_upp, iZe, true );
-	f_dispE     = interpolate( dispE_low, i_ze_low, dispE_upp, i_ze_upp, iZe, true );
-	f_disp_Phi  = interpolate( disp_Phi_low, i_ze_low, disp_Phi_upp, i_ze_upp, iZe, true );
-	f_disp_PhiE = interpolate( disp_PhiE_low, i_ze_low, disp_PhiE_upp, i_ze_upp, iZe, true );
-	f_disp_Miss = interpolate( disp_Miss_low, i_ze_low, disp_Miss_upp, i_ze_upp, iZe, true );
+	unsigned int nAz = fData->f_az_min.size();
+	unsigned int nNoise = fData->f_noise.size();
+	const float* v_low = &iC->fData[( ( ( i_ze_low * nAz + i_az ) * nNoise + i_noise ) * iC->fNCells + iCell ) * 5];
+	const float* v_upp = &iC->fData[( ( ( i_ze_up * nAz + i_az ) * nNoise + i_noise ) * iC->fNCells + iCell ) * 5];
+	float i_ze_low_value = fData->f_ze[i_ze_low];
+	float i_ze_upp_value = fData->f_ze[i_ze_up];
+	
+	// interpolate
+	f_disp      = interpolate( v_low[0], i_ze_low_value, v_upp[0], i_ze_upp_value, iZe, true );
+	f_dispE     = interpolate( v_low[1], i_ze_low_value, v_upp[1], i_ze_upp_value, iZe, true );
+	f_disp_Phi  = interpolate( v_low[2], i_ze_low_value, v_upp[2], i_ze_upp_value, iZe, true );
+	f_disp_PhiE = interpolate( v_low[3], i_ze_low_value, v_upp[3], i_ze_upp_value, iZe, true );
+	f_disp_Miss = interpolate( v_low[4], i_ze_low_value, v_upp[4], i_ze_upp_value, iZe, true );
 	
 	return f_disp;
 }
 
-
 double VDispTableAnalyzer::interpolate( double w1, double ze1, double w2, double ze2, double ze, bool iCos )
 {
 	// don't interpolate if one or two values are not valid
@@ -139,119 +182,207 @@ double VDispTableAnalyzer::interpolate( double w1, double ze1, double w2, double
 }
 
 /*!
-    calculate disp as function of width, length, size, pedvar, ze, az
+    read all disp tables from the data tree into resident arrays
+
+    one table per zenith angle, azimuth bin and noise level (wobble offset
+    closest to 0); each table bin holds (disp, dispE, dispPhi, dispPhiE, dispMiss).
+    Bins with less than 5 events are marked as invalid (disp = -99)
+
+    ordering: ( ( ( ze * nAz + az ) * nNoise + noise ) * nCells + cell ) * 5 + value
 */
-float VDispTableAnalyzer::calculateDisp( float iWidth, float iLength, float iSize, float iPedvar, float iZe, float iAz, bool b2D )
+bool VDispTableAnalyzer::fillTableCache( bool b2D )
 {
-	// check for valid size
-	if( iSize > 0. )
+	sDispTableCache* iC = &f3DTable;
+	if( b2D )
 	{
-		iSize = log10( iSize );
+		iC = &f2DTable;
+	}
+	iC->bFilled = true;
+	iC->fData.clear();
+	iC->fBinEdges.clear();
+	iC->fNCells = 0;
+	
+	if( !fData || !fData->getTree() || fData->getTree()->GetEntries() == 0 )
+	{
+		cout << "VDispTableAnalyzer::fillTableCache: error: no data tree for disp analysis" << endl;
+		return false;
+	}
+	
+	// read first entry to get table binning
+	fData->getTree()->GetEntry( 0 );
+	vector< TAxis* > iAxis;
+	if( b2D && fData->h2D_DispTable && fData->h2D_DispTableN && fData->h2D_DispPhiTable && fData->h2D_DispMissTable )
+	{
+		iAxis.push_back( fData->h2D_DispTable->GetXaxis() );
+		iAxis.push_back( fData->h2D_DispTable->GetYaxis() );
+	}
+	else if( !b2D && fData->h3D_DispTable && fData->h3D_DispTableN && fData->h3D_DispPhiTable && fData->h3D_DispMissTable )
+	{
+		iAxis.push_back( fData->h3D_DispTable->GetXaxis() );
+		iAxis.push_back( fData->h3D_DispTable->GetYaxis() );
+		iAxis.push_back( fData->h3D_DispTable->GetZaxis() );
 	}
 	else
 	{
-		return -99.;
+		cout << "VDispTableAnalyzer::fillTableCache: error no data histograms found" << endl;
+		return false;
+	}
+	iC->fNCells = 1;
+	for( unsigned int a = 0; a < iAxis.size(); a++ )
+	{
+		vector< double > iEdges;
+		for( int i = 1; i <= iAxis[a]->GetNbins() + 1; i++ )
+		{
+			iEdges.push_back( iAxis[a]->GetBinLowEdge( i ) );
+		}
+		iC->fBinEdges.push_back( iEdges );
+		iC->fNCells *= ( unsigned int )( iAxis[a]->GetNbins() + 2 );
 	}
 	
-	// check for valid length
-	float iWidthOLenght = -99.;
-	if( iLength > 0. )
+	// wobble offset closest to 0
+	unsigned int i_woff = 0;
+	float i_diff = 1.e9;
+	for( unsigned int i = 0; i < fData->f_woff.size(); i++ )
 	{
-		iWidthOLenght = iWidth / iLength;
+		if( TMath::Abs( fData->f_woff[i] ) < i_diff )
+		{
+			i_woff = i;
+			i_diff = TMath::Abs( fData->f_woff[i] );
+		}
 	}
 	
-	// get corresponding tree entry (ignore wobble offsets)
-	int iEntry = fData->getTreeEntryFinder( iZe, iAz, 0., iPedvar, 0 );
+	unsigned int nZe = fData->f_ze.size();
+	unsigned int nAz = fData->f_az_min.size();
+	unsigned int nNoise = fData->f_noise.size();
+	iC->fData.assign( ( size_t )nZe * nAz * nNoise * iC->fNCells * 5, 0. );
 	
-	// reset parameter values
-	f_disp = 0.;
-	f_dispE = 1.e3;
-	f_disp_Phi = 0.;
-	f_disp_PhiE = 1.e3;
-	f_disp_Miss = 0.;
-	
-	// read disp from tree
-	if( fData->getTree() )
+	int iEntry_last = -1;
+	for( unsigned int z = 0; z < nZe; z++ )
 	{
-		if( iEntry <= fData->getTree()->GetEntries() )
+		for( unsigned int a = 0; a < nAz; a++ )
 		{
-			fData->getTree()->GetEntry( iEntry );
-			
-			////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-			// use width/length histograms
-			////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-			if( b2D )
+			for( unsigned int n = 0; n < nNoise; n++ )
 			{
-				if( fData->h2D_DispTable && fData->h2D_DispTableN )
+				int iEntry = fData->getTreeEntryFinder( fData->getTreeEntryID( z, a, i_woff, n ) );
+				if( iEntry != iEntry_last )
 				{
-					// find disp bin
-					int x_bin = fData->h2D_DispTable->GetXaxis()->FindBin( iWidthOLenght );
-					int y_bin = fData->h2D_DispTable->GetYaxis()->FindBin( iSize );
-					// require at least 5 events per bin
-					if( fData->h2D_DispTableN->GetBinContent( x_bin, y_bin ) > 5. )
+					fData->getTree()->GetEntry( iEntry );
+					iEntry_last = iEntry;
+				}
+				float* v = &iC->fData[( ( z * nAz + a ) * nNoise + n ) * iC->fNCells * 5];
+				for( unsigned int c = 0; c < iC->fNCells; c++ )
+				{
+					double iN = 0.;
+					if( b2D )
 					{
-						f_disp = fData->h2D_DispTable->GetBinContent( x_bin, y_bin );
-						f_dispE = fData->h2D_DispTable->GetBinError( x_bin, y_bin );
-						f_disp_Phi = fData->h2D_DispPhiTable->GetBinContent( x_bin, y_bin );
-						f_disp_PhiE = fData->h2D_DispPhiTable->GetBinError( x_bin, y_bin );
-						f_disp_Miss = fData->h2D_DispMissTable->GetBinContent( x_bin, y_bin );
-						return f_disp;
+						iN = fData->h2D_DispTableN->GetBinContent( c );
 					}
 					else
 					{
-						return -99.;
+						iN = fData->h3D_DispTableN->GetBinContent( c );
 					}
-				}
-				else
-				{
-					cout << "VDispTableAnalyzer::evaluate: error no data histograms found" << endl;
-				}
-			}
-			////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-			// use width and length histograms
-			////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-			else
-			{
-				if( fData->h3D_DispTable && fData->h3D_DispTableN )
-				{
-					// find disp bin
-					int x_bin = fData->h3D_DispTable->GetXaxis()->FindBin( fData->scaleWidthParameter( iWidth ) );
-					int y_bin = fData->h3D_DispTable->GetYaxis()->FindBin( fData->scaleLengthParameter( iLength ) );
-					int z_bin = fData->h3D_DispTable->GetZaxis()->FindBin( iSize );
 					// require at least 5 events per bin
-					if( fData->h3D_DispTableN->GetBinContent( x_bin, y_bin, z_bin ) > 5. )
+					if( iN > 5. )
 					{
-						f_disp = fData->h3D_DispTable->GetBinContent( x_bin, y_bin, z_bin );
-						f_dispE = fData->h3D_DispTable->GetBinError( x_bin, y_bin, z_bin );
-						f_disp_Phi = fData->h3D_DispPhiTable->GetBinContent( x_bin, y_bin, z_bin );
-						f_disp_PhiE = fData->h3D_DispPhiTable->GetBinError( x_bin, y_bin, z_bin );
-						f_disp_Miss = fData->h3D_DispMissTable->GetBinContent( x_bin, y_bin, z_bin );
-						return f_disp;
+						if( b2D )
+						{
+							v[c * 5]     = fData->h2D_DispTable->GetBinContent( c );
+							v[c * 5 + 1] = fData->h2D_DispTable->GetBinError( c );
+							v[c * 5 + 2] = fData->h2D_DispPhiTable->GetBinContent( c );
+							v[c * 5 + 3] = fData->h2D_DispPhiTable->GetBinError( c );
+							v[c * 5 + 4] = fData->h2D_DispMissTable->GetBinContent( c );
+						}
+						else
+						{
+							v[c * 5]     = fData->h3D_DispTable->GetBinContent( c );
+							v[c * 5 + 1] = fData->h3D_DispTable->GetBinError( c );
+							v[c * 5 + 2] = fData->h3D_DispPhiTable->GetBinContent( c );
+							v[c * 5 + 3] = fData->h3D_DispPhiTable->GetBinError( c );
+							v[c * 5 + 4] = fData->h3D_DispMissTable->GetBinContent( c );
+						}
 					}
 					else
 					{
-						return -99.;
+						v[c * 5]     = -99.;
+						v[c * 5 + 1] = 1.e3;
+						v[c * 5 + 2] = 0.;
+						v[c * 5 + 3] = 1.e3;
+						v[c * 5 + 4] = 0.;
 					}
 				}
-				else
-				{
-					cout << "VDispTableAnalyzer::evaluate: error no data histograms found" << endl;
-				}
 			}
 		}
-		else
+	}
+	cout << "VDispTableAnalyzer: " << ( b2D ? "2D" : "3D" ) << " disp tables loaded (";
+	cout << nZe * nAz * nNoise << " tables, " << iC->fData.size() * sizeof( float ) / 1024. / 1024. << " MB)" << endl;
+	
+	return true;
+}
+
+/*!
+    get table bin for given image parameters
+
+    (bin numbering as in TH1::GetBin(), under/overflow bins are included)
+
+    returns -1 for invalid size
+*/
+int VDispTableAnalyzer::getTableCell( sDispTableCache* iC, float iWidth, float iLength, float iSize, bool b2D )
+{
+	// check for valid size
+	if( iSize > 0. )
+	{
+		iSize = log10( iSize );
+	}
+	else
+	{
+		return -1;
+	}
+	
+	double x[3] = { 0., 0., 0. };
+	unsigned int nDim = 0;
+	if( b2D )
+	{
+		// check for valid length
+		float iWidthOLenght = -99.;
+		if( iLength > 0. )
 		{
-			cout << "VDispTableAnalyzer::evaluate: error in entries counting (" << iEntry << ", " << fData->getTree()->GetEntries() << ")" << endl;
+			iWidthOLenght = iWidth / iLength;
 		}
+		x[nDim++] = iWidthOLenght;
 	}
 	else
 	{
-		cout << "VDispTableAnalyzer::evaluate: error: no data  tree for disp analysis" << endl;
+		x[nDim++] = fData->scaleWidthParameter( iWidth );
+		x[nDim++] = fData->scaleLengthParameter( iLength );
+	}
+	x[nDim++] = iSize;
+	if( nDim != iC->fBinEdges.size() )
+	{
+		return -1;
 	}
 	
-	cout << "VDispTableAnalyzer::evaluate: error, no results for this event (" << iSize << ", " << iWidthOLenght << ")" << endl;
-	
-	return -99.;
+	int iCell = 0;
+	int iStride = 1;
+	for( unsigned int a = 0; a < iC->fBinEdges.size(); a++ )
+	{
+		int nBins = ( int )iC->fBinEdges[a].size() - 1;
+		int iBin = 0;
+		if( x[a] < iC->fBinEdges[a][0] )
+		{
+			iBin = 0;
+		}
+		else if( x[a] >= iC->fBinEdges[a][nBins] )
+		{
+			iBin = nBins + 1;
+		}
+		else
+		{
+			iBin = 1 + TMath::BinarySearch( nBins + 1, &iC->fBinEdges[a][0], x[a] );
+		}
+		iCell += iBin * iStride;
+		iStride *= nBins + 2;
+	}
+	return iCell;
 }
 
 
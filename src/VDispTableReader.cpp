@@ -30,6 +30,12 @@ VDispTableReader::VDispTableReader()
 	h3D_DispTableN = 0;
 	h3D_DispMissTable = 0;
 	
+	f2D_StatisticsBin = new vector< int >();
+	f2D_Statistics = new vector< double >();
+	f3D_StatisticsBin = new vector< int >();
+	f3D_Statistics = new vector< double >();
+	bStatistics = false;
+	
 	fHisto_ListOfVariables.push_back( "WidthOverLength" );
 	fHisto_ListOfVariables.push_back( "ScaleLength" );
 	fHisto_ListOfVariables.push_back( "ScaleWidth" );
@@ -175,7 +181,13 @@ bool VDispTableReader::plot( int iEntry )
 }
 
 
-bool VDispTableReader::initialize( bool iRead )
+/*
+ * prepare data tree for writing (iRead = false) or reading
+ *
+ * iReadStatistics: read in addition the double precision table statistics
+ *                  (needed for merging of tables only)
+ */
+bool VDispTableReader::initialize( bool iRead, bool iReadStatistics )
 {
 	//////////////////////////////////////////////////////////////////////////////////////////////
 	//
@@ -257,6 +269,11 @@ bool VDispTableReader::initialize( bool iRead )
 		{
 			fData->Branch( hisList, 32000, 0 );
 		}
+		fData->Branch( "stat2D_bin", &f2D_StatisticsBin );
+		fData->Branch( "stat2D", &f2D_Statistics );
+		fData->Branch( "stat3D_bin", &f3D_StatisticsBin );
+		fData->Branch( "stat3D", &f3D_Statistics );
+		bStatistics = true;
 	}
 	//////////////////////////////////////////////////////////////////////////////////////////////
 	//
@@ -284,6 +301,18 @@ bool VDispTableReader::initialize( bool iRead )
 			fData->SetBranchAddress( "h3D_DispMissTable", &h3D_DispMissTable );
 			fData->SetBranchAddress( "h3D_DispTableN", &h3D_DispTableN );
 			
+			// table statistics (not available in older tables)
+			bStatistics = false;
+			if( iReadStatistics && fData->GetBranch( "stat2D_bin" ) && fData->GetBranch( "stat2D" )
+					&& fData->GetBranch( "stat3D_bin" ) && fData->GetBranch( "stat3D" ) )
+			{
+				fData->SetBranchAddress( "stat2D_bin", &f2D_StatisticsBin );
+				fData->SetBranchAddress( "stat2D", &f2D_Statistics );
+				fData->SetBranchAddress( "stat3D_bin", &f3D_StatisticsBin );
+				fData->SetBranchAddress( "stat3D", &f3D_Statistics );
+				bStatistics = true;
+			}
+			
 			// fill data vectors
 			f_ze.clear();
 			f_az_min.clear();
@@ -389,6 +418,26 @@ void VDispTableReader::reset()
 	{
 		h2D_DispTableN->Reset();
 	}
+	if( h3D_DispTable )
+	{
+		h3D_DispTable->Reset();
+	}
+	if( h3D_DispPhiTable )
+	{
+		h3D_DispPhiTable->Reset();
+	}
+	if( h3D_DispMissTable )
+	{
+		h3D_DispMissTable->Reset();
+	}
+	if( h3D_DispTableN )
+	{
+		h3D_DispTableN->Reset();
+	}
+	f2D_StatisticsBin->clear();
+	f2D_Statistics->clear();
+	f3D_StatisticsBin->clear();
+	f3D_Statistics->clear();
 }
 
 
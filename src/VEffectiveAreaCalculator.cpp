@@ -1230,22 +1230,33 @@ void VEffectiveAreaCalculator::setAngularResolutionGraph( unsigned int i_az, TGr
 }
 
 vector< double > VEffectiveAreaCalculator::interpolate_effectiveArea( double iV, double iVLower, double iVupper,
-		vector< double > iElower, vector< double > iEupper, bool iCos )
+		const vector< double >& iElower, const vector< double >& iEupper, bool iCos )
 {
 	vector< double > i_temp;
-	if( iElower.size() == iEupper.size() )
-	{
-		i_temp.assign( iElower.size(), 0. );
-		for( unsigned int i = 0; i < iElower.size(); i++ )
-		{
-			i_temp[i] = VStatistics::interpolate( iElower[i], iVLower, iEupper[i], iVupper, iV, iCos, 0.5, -90. );
-		}
-		return i_temp;
-	}
+	interpolate_effectiveArea( iV, iVLower, iVupper, iElower, iEupper, i_temp, iCos );
 	
 	return i_temp;
 }
 
+/*
+ * interpolate between two effective area curves
+ * (result is written into iEResult; avoids reallocation if size is unchanged)
+ */
+void VEffectiveAreaCalculator::interpolate_effectiveArea( double iV, double iVLower, double iVupper,
+		const vector< double >& iElower, const vector< double >& iEupper, vector< double >& iEResult, bool iCos )
+{
+	if( iElower.size() != iEupper.size() )
+	{
+		iEResult.clear();
+		return;
+	}
+	iEResult.resize( iElower.size() );
+	for( unsigned int i = 0; i < iElower.size(); i++ )
+	{
+		iEResult[i] = VStatistics::interpolate( iElower[i], iVLower, iEupper[i], iVupper, iV, iCos, 0.5, -90. );
+	}
+}
+
 
 
 // Interpolating between two response matrices
@@ -1775,6 +1786,7 @@ bool VEffectiveAreaCalculator::initializeEffectiveAreasFromHistograms(
 	{
 		smoothEffectiveAreas( fEffArea_map );
 	}
+	fEffAreaInterpolation.bValid = false;
 	///////////////////////////////////////////////////
 	return true;
 }
@@ -1838,6 +1850,11 @@ void VEffectiveAreaCalculator::reset()
 	
 	fCuts = 0;
 	
+	fFill_EnergyReconstructionMethod = 0;
+	fFill_FirstEntry = 0;
+	fFill_AzBinIndex = 0;
+	fFill_EventsAfterCuts = 0;
+	
 	fTNoise = 0;
 	fTNoisePE = 0.;
 	fTPedvar = 0.;
@@ -1925,6 +1942,7 @@ void VEffectiveAreaCalculator::reset()
 	fEffectiveAreas_meanPedVar = 0.;
 	fEffectiveAreas_meanIndex = 0.;
 	fEffectiveAreas_meanN = 0.;
+	fEffAreaInterpolation.bValid = false;
 	
 	gMeanSystematicErrorGraph = 0;
 	
@@ -2039,12 +2057,38 @@ bool VEffectiveAreaCalculator::getMonteCarloSpectra( VEffectiveAreaCalculatorMCH
  *
  *  CALLED FOR CALCULATION OF EFFECTIVE AREAS
  *
+ *  loop over all events in the data tree and fill effective areas
+ *  (single pass; see makeEffectiveArea for the combined loop with
+ *   the resolution functions)
+ *
  */
 bool VEffectiveAreaCalculator::fill( TH1D* hE0mc, CData* d,
 									 VEffectiveAreaCalculatorMCHistograms* iMC_histo, unsigned int iMethod )
 {
-	bool bDebugCuts = false;          // lots of debug output
+	if( !initializeFill( d, iMC_histo, iMethod ) )
+	{
+		return false;
+	}
+	
+	sEffectiveAreaCutDecision iCut;
+	Long64_t d_nentries = d->fChain->GetEntries();
+	for( Long64_t i = fFill_FirstEntry; i < d_nentries; i++ )
+	{
+		d->GetEntry( i );
+		
+		evaluateCuts( d, i, iCut );
+		fillEvent( d, iCut );
+	}
 	
+	return terminateFill();
+}
+
+/*
+ * prepare histograms, MC spectra and cut statistics for the event loop
+ *
+ */
+bool VEffectiveAreaCalculator::initializeFill( CData* d, VEffectiveAreaCalculatorMCHistograms* iMC_histo, unsigned int iMethod )
+{
 	// make sure that vectors are initialized
 	unsigned int ize = 0;      // should always be zero
 	if( ize >= fZe.size() )
@@ -2059,6 +2103,7 @@ bool VEffectiveAreaCalculator::fill( TH1D* hE0mc, CData* d,
 	{
 		iMethod = 100;
 	}
+	fFill_EnergyReconstructionMethod = iMethod;
 	
 	//////////////////////////////////////////////////////////////////
 	// total Monte Carlo core scatter area (depends on CORSIKA shower core scatter mode)
@@ -2078,7 +2123,7 @@ bool VEffectiveAreaCalculator::fill( TH1D* hE0mc, CData* d,
 	}
 	// reset unique event counter
 	fUniqueEventCounter.clear();
-	Long64_t iSuccessfullEventStatistics = 0;
+	fFill_EventsAfterCuts = 0;
 	
 	//////////////////////////////////////////////////////////////////
 	// print some run information
@@ -2119,14 +2164,6 @@ bool VEffectiveAreaCalculator::fill( TH1D* hE0mc, CData* d,
 		return false;
 	}
 	
-	// spectral weight
-	double i_weight = 1.;
-	// reconstructed energy (TeV, log10)
-	double eRec = 0.;
-	double eRecLin = 0.;
-	// MC energy (TeV, log10)
-	double eMC = 0.;
-	
 	////////////////////////////////////////////////////////////////////////////
 	// get MC histograms
 	if( !getMonteCarloSpectra( iMC_histo ) )
@@ -2140,233 +2177,247 @@ bool VEffectiveAreaCalculator::fill( TH1D* hE0mc, CData* d,
 	fCuts->resetCutStatistics();
 	
 	///////////////////////////////////////////////////////
-	// get full data set and loop over all entries
+	// get full data set
 	///////////////////////////////////////////////////////
 	Long64_t d_nentries = d->fChain->GetEntries();
-	Long64_t i_start = 0;
+	fFill_FirstEntry = 0;
 	if( fRunPara && fRunPara->fIgnoreFractionOfEvents > 0. )
 	{
-		i_start = ( Long64_t )( fRunPara->fIgnoreFractionOfEvents * d_nentries );
+		fFill_FirstEntry = ( Long64_t )( fRunPara->fIgnoreFractionOfEvents * d_nentries );
 	}
-	cout << "\t total number of data events: " << d_nentries << " (start at event " << i_start << ")" << endl;
+	cout << "\t total number of data events: " << d_nentries << " (start at event " << fFill_FirstEntry << ")" << endl;
 	
 	//--- for the CR normalisation filling Acceptance tree total number of simulated is needed
 	//-- WARNING if the rule for the azimuth bin changes in VInstrumentResponseFunctionRunParameter the following line must be adapted!!!!
 	unsigned int number_of_az_bin = fRunPara->fAzMin.size();
-	int az_bin_index = 0;// if no azimuth bin, all events are in bin 0. if azimuth bin, all event are in the last bin.
+	fFill_AzBinIndex = 0;// if no azimuth bin, all events are in bin 0. if azimuth bin, all event are in the last bin.
 	if( number_of_az_bin > 0 )
 	{
-		az_bin_index = ( int ) number_of_az_bin - 1;
+		fFill_AzBinIndex = ( int ) number_of_az_bin - 1;
 	}
 	
-	for( Long64_t i = i_start; i < d_nentries; i++ )
+	return true;
+}
+
+/*
+ * get reconstructed energy (log10 and linear) according to reconstruction method
+ *
+ * returns false if no energy has been reconstructed
+ */
+bool VEffectiveAreaCalculator::getReconstructedEnergy( CData* d, double& eRec, double& eRecLin )
+{
+	if( fFill_EnergyReconstructionMethod == 0 && d->Erec > 0. )
+	{
+		eRec = log10( d->Erec );
+		eRecLin = d->Erec;
+	}
+	else if( fFill_EnergyReconstructionMethod == 1 && d->ErecS > 0. )
+	{
+		eRec = log10( d->ErecS );
+		eRecLin = d->ErecS;
+	}
+	else if( fIgnoreEnergyReconstruction )
+	{
+		eRec = log10( d->MCe0 );
+		eRecLin = d->MCe0;
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+/*
+ * evaluate all cuts for the current event (entry i of the data tree)
+ *
+ * cuts are applied in the order of the effective area calculation and
+ * evaluation stops at the first failing cut (as in the event loop before).
+ * Cut statistics are only updated for effective area events.
+ *
+ * bIRF: evaluate in addition the cuts required for the resolution functions
+ *       (using energy reconstruction method iIRFMethod); results are reused
+ *       from the effective area cuts whenever possible
+ *
+ */
+void VEffectiveAreaCalculator::evaluateCuts( CData* d, Long64_t i, sEffectiveAreaCutDecision& iCut,
+		bool bEffectiveAreas, bool bIRF, unsigned int iIRFMethod )
+{
+	iCut.bMCXYoff = false;
+	iCut.bFiducialArea = false;
+	iCut.bStereoQuality = false;
+	iCut.bStereoQualityIRF = false;
+	iCut.bTelType = false;
+	iCut.bDirection = false;
+	iCut.bEnergyQuality = false;
+	iCut.bEnergyReconstructed = false;
+	iCut.bGamma = false;
+	
+	if( !d || !fCuts )
+	{
+		return;
+	}
+	
+	bool bGammaEvaluated = false;
+	if( bEffectiveAreas )
 	{
-		d->GetEntry( i );
-		
 		// update cut statistics
 		fCuts->newEvent();
 		
-		if( bDebugCuts )
-		{
-			cout << "============================== " << endl;
-			cout << "EVENT entry number " << i << endl;
-		}
-		
 		// apply MC cuts
-		if( bDebugCuts )
-		{
-			cout << "#0 CUT MC " << fCuts->applyMCXYoffCut( d->MCxoff, d->MCyoff, false ) << endl;
-		}
-		
-		if( !fCuts->applyMCXYoffCut( d->MCxoff, d->MCyoff, true ) )
-		{
-			continue;
-		}
-		
-		// log of MC energy
-		eMC = log10( d->MCe0 );
-		
-		// fill trigger cuts
-		hEcutSub[0]->Fill( eMC, 1. );
-		
-		////////////////////////////////
-		// apply general quality and gamma/hadron separation cuts
-		
-		// apply reconstruction cuts
-		if( bDebugCuts )
-		{
-			cout << "#1 CUT applyInsideFiducialAreaCut ";
-			cout << fCuts->applyInsideFiducialAreaCut();
-			cout << "\t" << fCuts->applyStereoQualityCuts( iMethod, false, i, true ) << endl;
-		}
-		
+		iCut.bMCXYoff = fCuts->applyMCXYoffCut( d->MCxoff, d->MCyoff, true );
 		// apply fiducial area cuts
-		if( !fCuts->applyInsideFiducialAreaCut( true ) )
+		if( iCut.bMCXYoff )
 		{
-			continue;
+			iCut.bFiducialArea = fCuts->applyInsideFiducialAreaCut( true );
 		}
-		hEcutSub[1]->Fill( eMC, 1. );
-		
 		// apply reconstruction quality cuts
-		if( !fCuts->applyStereoQualityCuts( iMethod, true, i, true ) )
+		if( iCut.bFiducialArea )
 		{
-			continue;
+			iCut.bStereoQuality = fCuts->applyStereoQualityCuts( fFill_EnergyReconstructionMethod, true, i, true );
 		}
-		hEcutSub[2]->Fill( eMC, 1. );
-		
 		// apply telescope type cut (e.g. for CTA simulations)
-		if( fTelescopeTypeCutsSet )
+		if( iCut.bStereoQuality )
 		{
-			if( bDebugCuts )
-			{
-				cout << "#2 Cut NTELType " << fCuts->applyTelTypeTest( false ) << endl;
-			}
-			if( !fCuts->applyTelTypeTest( true ) )
-			{
-				continue;
-			}
-		}
-		hEcutSub[3]->Fill( eMC, 1. );
-		
-		
-		//////////////////////////////////////
-		// apply direction cut
-		//
-		// point source cut; use MC shower direction as reference direction
-		bool bDirectionCut = false;
-		if( !fIsotropicArrivalDirections )
-		{
-			if( !fCuts->applyDirectionCuts( iMethod, true ) )
-			{
-				bDirectionCut = true;
-			}
+			iCut.bTelType = ( !fTelescopeTypeCutsSet || fCuts->applyTelTypeTest( true ) );
 		}
-		// background cut; use (0,0) as reference direction
-		// (command line option -d)
-		else
+		if( iCut.bTelType )
 		{
-			if( !fCuts->applyDirectionCuts( iMethod, true, 0., 0. ) )
+			// point source cut; use MC shower direction as reference direction
+			if( !fIsotropicArrivalDirections )
 			{
-				bDirectionCut = true;
+				iCut.bDirection = fCuts->applyDirectionCuts( fFill_EnergyReconstructionMethod, true );
 			}
-		}
-		
-		
-		if( !bDirectionCut )
-		{
-			hEcutSub[4]->Fill( eMC, 1. );
-		}
-		
-		//////////////////////////////////////
-		// apply energy reconstruction quality cut
-		if( !fIgnoreEnergyReconstruction )
-		{
-			if( bDebugCuts )
-			{
-				cout << "#4 EnergyReconstructionQualityCuts " << fCuts->applyEnergyReconstructionQualityCuts( iMethod ) << endl;
-			}
-			if( !fCuts->applyEnergyReconstructionQualityCuts( iMethod, true ) )
+			// background cut; use (0,0) as reference direction
+			// (command line option -d)
+			else
 			{
-				continue;
+				iCut.bDirection = fCuts->applyDirectionCuts( fFill_EnergyReconstructionMethod, true, 0., 0. );
 			}
+			// apply energy reconstruction quality cut
+			iCut.bEnergyQuality = ( fIgnoreEnergyReconstruction
+									|| fCuts->applyEnergyReconstructionQualityCuts( fFill_EnergyReconstructionMethod, true ) );
 		}
-		
-		if( !bDirectionCut )
-		{
-			hEcutSub[5]->Fill( eMC, 1. );
-		}
-		
 		// skip event if no energy has been reconstructed
-		// get energy according to which reconstruction method
-		if( iMethod == 0 && d->Erec > 0. )
+		if( iCut.bEnergyQuality )
 		{
-			eRec = log10( d->Erec );
-			eRecLin = d->Erec;
+			double eRec = 0.;
+			double eRecLin = 0.;
+			iCut.bEnergyReconstructed = getReconstructedEnergy( d, eRec, eRecLin );
 		}
-		else if( iMethod == 1 && d->ErecS > 0. )
-		{
-			eRec = log10( d->ErecS );
-			eRecLin = d->ErecS;
-		}
-		else if( fIgnoreEnergyReconstruction )
-		{
-			eRec = log10( d->MCe0 );
-			eRecLin = d->MCe0;
-		}
-		else
+		// apply gamma hadron cuts
+		if( iCut.bEnergyReconstructed )
 		{
-			continue;
+			iCut.bGamma = fCuts->isGamma( i, true );
+			bGammaEvaluated = true;
 		}
-		
-		///////////////////////////////////////////
-		// fill response matrix after quality cuts
-		
-		if( !bDirectionCut )
+	}
+	
+	if( bIRF )
+	{
+		if( !bEffectiveAreas )
 		{
-			// loop over all az bins
-			for( unsigned int i_az = 0; i_az < fVMinAz.size(); i_az++ )
+			iCut.bMCXYoff = fCuts->applyMCXYoffCut( d->MCxoff, d->MCyoff, false );
+			if( iCut.bMCXYoff )
 			{
-				// check at what azimuth bin we are
-				if( fZe[ize] > 3. )
-				{
-					// confine MC az to -180., 180.
-					if( d->MCaz > 180. )
-					{
-						d->MCaz -= 360.;
-					}
-					// expect bin like [135,-135]
-					if( fVMinAz[i_az] > fVMaxAz[i_az] )
-					{
-						if( d->MCaz < fVMinAz[i_az] && d->MCaz > fVMaxAz[i_az] )
-						{
-							continue;
-						}
-					}
-					// expect bin like [-135,-45.]
-					else
-					{
-						if( d->MCaz < fVMinAz[i_az] || d->MCaz > fVMaxAz[i_az] )
-						{
-							continue;
-						}
-					}
-				}
-				// loop over all spectral index
-				for( unsigned int s = 0; s < fVSpectralIndex.size(); s++ )
-				{
-					if( hVResponseMatrixQC[s][i_az] )
-					{
-						hVResponseMatrixQC[s][i_az]->Fill( eRec, eMC );
-					}
-					if( hVResponseMatrixFineQC[s][i_az] )
-					{
-						hVResponseMatrixFineQC[s][i_az]->Fill( eRec, eMC );
-					}
-				}
+				iCut.bFiducialArea = fCuts->applyInsideFiducialAreaCut( false );
 			}
 		}
-		
-		//////////////////////////////////////
-		// apply gamma hadron cuts
-		if( bDebugCuts )
-		{
-			cout << "#3 CUT ISGAMMA " << fCuts->isGamma( i ) << endl;
-		}
-		if( !fCuts->isGamma( i, true ) )
+		// stereo quality cuts depend on energy reconstruction method
+		if( bEffectiveAreas && iIRFMethod == fFill_EnergyReconstructionMethod )
 		{
-			continue;
+			iCut.bStereoQualityIRF = iCut.bStereoQuality;
 		}
-		if( !bDirectionCut )
+		else if( iCut.bFiducialArea )
 		{
-			hEcutSub[6]->Fill( eMC, 1. );
+			iCut.bStereoQualityIRF = fCuts->applyStereoQualityCuts( iIRFMethod, false, i, true );
 		}
-		
-		// unique event counter
-		if( !bDirectionCut )
+		if( iCut.bStereoQualityIRF && !bGammaEvaluated )
 		{
-			iSuccessfullEventStatistics++;
+			iCut.bGamma = fCuts->isGamma( i, false );
 		}
-		
+	}
+}
+
+/*
+ * fill effective area histograms for the current event
+ * (cuts are evaluated before with evaluateCuts())
+ *
+ */
+void VEffectiveAreaCalculator::fillEvent( CData* d, sEffectiveAreaCutDecision& iCut )
+{
+	unsigned int ize = 0;
+	
+	// spectral weight
+	double i_weight = 1.;
+	// reconstructed energy (TeV, log10)
+	double eRec = 0.;
+	double eRecLin = 0.;
+	// MC energy (TeV, log10)
+	double eMC = 0.;
+	
+	if( !iCut.bMCXYoff )
+	{
+		return;
+	}
+	
+	// log of MC energy
+	eMC = log10( d->MCe0 );
+	
+	// fill trigger cuts
+	hEcutSub[0]->Fill( eMC, 1. );
+	
+	if( !iCut.bFiducialArea )
+	{
+		return;
+	}
+	hEcutSub[1]->Fill( eMC, 1. );
+	
+	if( !iCut.bStereoQuality )
+	{
+		return;
+	}
+	hEcutSub[2]->Fill( eMC, 1. );
+	
+	if( !iCut.bTelType )
+	{
+		return;
+	}
+	hEcutSub[3]->Fill( eMC, 1. );
+	
+	//////////////////////////////////////
+	// direction cut
+	bool bDirectionCut = !iCut.bDirection;
+	
+	if( !bDirectionCut )
+	{
+		hEcutSub[4]->Fill( eMC, 1. );
+	}
+	
+	//////////////////////////////////////
+	// energy reconstruction quality cut
+	if( !iCut.bEnergyQuality )
+	{
+		return;
+	}
+	
+	if( !bDirectionCut )
+	{
+		hEcutSub[5]->Fill( eMC, 1. );
+	}
+	
+	// skip event if no energy has been reconstructed
+	// get energy according to which reconstruction method
+	if( !iCut.bEnergyReconstructed || !getReconstructedEnergy( d, eRec, eRecLin ) )
+	{
+		return;
+	}
+	
+	///////////////////////////////////////////
+	// fill response matrix after quality cuts
+	
+	if( !bDirectionCut )
+	{
 		// loop over all az bins
 		for( unsigned int i_az = 0; i_az < fVMinAz.size(); i_az++ )
 		{
@@ -2395,161 +2446,224 @@ bool VEffectiveAreaCalculator::fill( TH1D* hE0mc, CData* d,
 					}
 				}
 			}
-			
-			//fill tree with acceptance information after cuts (needed to construct background model in ctools)
-			if( !bDirectionCut && fRunPara->fgetXoff_Yoff_afterCut )
-			{
-				fXoff_aC = d->Xoff;
-				fYoff_aC = d->Yoff;
-				fXoff_derot_aC = d->Xoff_derot;
-				fYoff_derot_aC = d->Yoff_derot;
-				fErec = eRecLin;
-				fEMC  = d->MCe0;
-				fCRweight = getCRWeight( d->MCe0, hVEmc[0][az_bin_index], true );  //So that the acceptance can be normalised to the CR spectrum.
-				// when running on gamma, this should return 1.
-				fAcceptance_AfterCuts_tree->Fill();
-			}
-			
-			
 			// loop over all spectral index
 			for( unsigned int s = 0; s < fVSpectralIndex.size(); s++ )
 			{
-				// weight by spectral index
-				if( fSpectralWeight )
-				{
-					fSpectralWeight->setSpectralIndex( fVSpectralIndex[s] );
-					i_weight = fSpectralWeight->getSpectralWeight( d->MCe0 );
-				}
-				else
-				{
-					i_weight = 0.;
-				}
-				
-				////////////////////////////////////////////
-				// fill effective areas before direction cut
-				if( hVEcutNoTh2[s][i_az] )
-				{
-					hVEcutNoTh2[s][i_az]->Fill( eMC, i_weight );
-				}
-				if( hVEcutRecNoTh2[s][i_az] )
+				if( hVResponseMatrixQC[s][i_az] )
 				{
-					hVEcutRecNoTh2[s][i_az]->Fill( eRec, i_weight );
+					hVResponseMatrixQC[s][i_az]->Fill( eRec, eMC );
 				}
-				// fill response matrix (migration matrix) before
-				// direction cut
-				if( hVResponseMatrixNoDirectionCut[s][i_az] )
+				if( hVResponseMatrixFineQC[s][i_az] )
 				{
-					hVResponseMatrixNoDirectionCut[s][i_az]->Fill( eRec, eMC, i_weight );
+					hVResponseMatrixFineQC[s][i_az]->Fill( eRec, eMC );
 				}
-				if( hVResponseMatrixFineNoDirectionCut[s][i_az] )
-				{
-					hVResponseMatrixFineNoDirectionCut[s][i_az]->Fill( eRec, eMC, i_weight );
-				}
-				if( hVEsysMCRelative2DNoDirectionCut[s][i_az] )
-				{
-					hVEsysMCRelative2DNoDirectionCut[s][i_az]->Fill( eMC, eRecLin / d->MCe0, i_weight );
-				}
-				
-				/////////////////////////
-				// apply direction cut
-				if( bDirectionCut )
+			}
+		}
+	}
+	
+	//////////////////////////////////////
+	// gamma hadron cuts
+	if( !iCut.bGamma )
+	{
+		return;
+	}
+	if( !bDirectionCut )
+	{
+		hEcutSub[6]->Fill( eMC, 1. );
+	}
+	
+	// unique event counter
+	if( !bDirectionCut )
+	{
+		fFill_EventsAfterCuts++;
+	}
+	
+	// loop over all az bins
+	for( unsigned int i_az = 0; i_az < fVMinAz.size(); i_az++ )
+	{
+		// check at what azimuth bin we are
+		if( fZe[ize] > 3. )
+		{
+			// confine MC az to -180., 180.
+			if( d->MCaz > 180. )
+			{
+				d->MCaz -= 360.;
+			}
+			// expect bin like [135,-135]
+			if( fVMinAz[i_az] > fVMaxAz[i_az] )
+			{
+				if( d->MCaz < fVMinAz[i_az] && d->MCaz > fVMaxAz[i_az] )
 				{
 					continue;
 				}
-				
-				/////////////////////////////////////////////
-				// after gamma/hadron and after direction cut
-				
-				// fill true MC energy (hVEmc is in true MC energies)
-				if( hVEcut[s][i_az] )
-				{
-					hVEcut[s][i_az]->Fill( eMC, i_weight );
-				}
-				if( hVEcutUW[s][i_az] )
-				{
-					hVEcutUW[s][i_az]->Fill( eMC, 1. );
-				}
-				if( hVEcut500[s][i_az] )
-				{
-					hVEcut500[s][i_az]->Fill( eMC, i_weight );
-				}
-				if( hVEcutLin[s][i_az] )
-				{
-					hVEcutLin[s][i_az]->Fill( eMC, i_weight );
-				}
-				if( hVEcutRec[s][i_az] )
-				{
-					hVEcutRec[s][i_az]->Fill( eRec, i_weight );
-				}
-				if( hVEcutRecUW[s][i_az] )
-				{
-					hVEcutRecUW[s][i_az]->Fill( eRec, 1. );
-				}
-				if( hVEsysRec[s][i_az] )
-				{
-					hVEsysRec[s][i_az]->Fill( eRec, eRec - eMC );
-				}
-				if( hVEsysMC[s][i_az] )
-				{
-					hVEsysMC[s][i_az]->Fill( eMC, eRec - eMC );
-				}
-				if( hVEsysMCRelative[s][i_az] )
-				{
-					hVEsysMCRelative[s][i_az]->Fill( eMC, ( eRecLin - d->MCe0 ) / d->MCe0 );
-				}
-				if( hVEsysMCRelativeRMS[s][i_az] )
-				{
-					hVEsysMCRelativeRMS[s][i_az]->Fill( eMC, ( eRecLin - d->MCe0 ) / d->MCe0 );
-				}
-				if( hVEsysMCRelative2D[s][i_az] )
-				{
-					hVEsysMCRelative2D[s][i_az]->Fill( eMC, eRecLin / d->MCe0 );
-				}
-				if( hVEsys2D[s][i_az] )
-				{
-					hVEsys2D[s][i_az]->Fill( eMC, eRec - eMC );
-				}
-				if( hVEmcCutCTA[s][i_az] )
-				{
-					hVEmcCutCTA[s][i_az]->Fill( eRec, eMC );
-				}
-				// migration matrix (coarse binning)
-				if( hVResponseMatrix[s][i_az] )
-				{
-					hVResponseMatrix[s][i_az]->Fill( eRec, eMC );
-				}
-				// migration matrix (fine binning)
-				if( hVResponseMatrixFine[s][i_az] )
-				{
-					hVResponseMatrixFine[s][i_az]->Fill( eRec, eMC, i_weight );
-				}
-				
-				if( hVResponseMatrixProfile[s][i_az] )
-				{
-					hVResponseMatrixProfile[s][i_az]->Fill( eRec, eMC );
-				}
-				// events weighted by CR spectra
-				if( hVWeightedRate[s][i_az] )
-				{
-					hVWeightedRate[s][i_az]->Fill( eRec, getCRWeight( d->MCe0, hVEmc[s][i_az] ) );
-				}
-				if( hVWeightedRate005[s][i_az] )
+			}
+			// expect bin like [-135,-45.]
+			else
+			{
+				if( d->MCaz < fVMinAz[i_az] || d->MCaz > fVMaxAz[i_az] )
 				{
-					hVWeightedRate005[s][i_az]->Fill( eRec, getCRWeight( d->MCe0, hVEmc[s][i_az] ) );
+					continue;
 				}
 			}
 		}
-		// don't do anything between here and the end of the loop! Never!
-	}                                             // end of loop
-	/////////////////////////////////////////////////////////////////////////////
-	
-	
-	
-	/////////////////////////////////////////////////////////////////////////////
-	//
-	// calculate effective areas and fill output trees
-	//
-	/////////////////////////////////////////////////////////////////////////////
+		
+		//fill tree with acceptance information after cuts (needed to construct background model in ctools)
+		if( !bDirectionCut && fRunPara->fgetXoff_Yoff_afterCut )
+		{
+			fXoff_aC = d->Xoff;
+			fYoff_aC = d->Yoff;
+			fXoff_derot_aC = d->Xoff_derot;
+			fYoff_derot_aC = d->Yoff_derot;
+			fErec = eRecLin;
+			fEMC  = d->MCe0;
+			fCRweight = getCRWeight( d->MCe0, hVEmc[0][fFill_AzBinIndex], true );  //So that the acceptance can be normalised to the CR spectrum.
+			// when running on gamma, this should return 1.
+			fAcceptance_AfterCuts_tree->Fill();
+		}
+		
+		
+		// loop over all spectral index
+		for( unsigned int s = 0; s < fVSpectralIndex.size(); s++ )
+		{
+			// weight by spectral index
+			if( fSpectralWeight )
+			{
+				fSpectralWeight->setSpectralIndex( fVSpectralIndex[s] );
+				i_weight = fSpectralWeight->getSpectralWeight( d->MCe0 );
+			}
+			else
+			{
+				i_weight = 0.;
+			}
+			
+			////////////////////////////////////////////
+			// fill effective areas before direction cut
+			if( hVEcutNoTh2[s][i_az] )
+			{
+				hVEcutNoTh2[s][i_az]->Fill( eMC, i_weight );
+			}
+			if( hVEcutRecNoTh2[s][i_az] )
+			{
+				hVEcutRecNoTh2[s][i_az]->Fill( eRec, i_weight );
+			}
+			// fill response matrix (migration matrix) before
+			// direction cut
+			if( hVResponseMatrixNoDirectionCut[s][i_az] )
+			{
+				hVResponseMatrixNoDirectionCut[s][i_az]->Fill( eRec, eMC, i_weight );
+			}
+			if( hVResponseMatrixFineNoDirectionCut[s][i_az] )
+			{
+				hVResponseMatrixFineNoDirectionCut[s][i_az]->Fill( eRec, eMC, i_weight );
+			}
+			if( hVEsysMCRelative2DNoDirectionCut[s][i_az] )
+			{
+				hVEsysMCRelative2DNoDirectionCut[s][i_az]->Fill( eMC, eRecLin / d->MCe0, i_weight );
+			}
+			
+			/////////////////////////
+			// apply direction cut
+			if( bDirectionCut )
+			{
+				continue;
+			}
+			
+			/////////////////////////////////////////////
+			// after gamma/hadron and after direction cut
+			
+			// fill true MC energy (hVEmc is in true MC energies)
+			if( hVEcut[s][i_az] )
+			{
+				hVEcut[s][i_az]->Fill( eMC, i_weight );
+			}
+			if( hVEcutUW[s][i_az] )
+			{
+				hVEcutUW[s][i_az]->Fill( eMC, 1. );
+			}
+			if( hVEcut500[s][i_az] )
+			{
+				hVEcut500[s][i_az]->Fill( eMC, i_weight );
+			}
+			if( hVEcutLin[s][i_az] )
+			{
+				hVEcutLin[s][i_az]->Fill( eMC, i_weight );
+			}
+			if( hVEcutRec[s][i_az] )
+			{
+				hVEcutRec[s][i_az]->Fill( eRec, i_weight );
+			}
+			if( hVEcutRecUW[s][i_az] )
+			{
+				hVEcutRecUW[s][i_az]->Fill( eRec, 1. );
+			}
+			if( hVEsysRec[s][i_az] )
+			{
+				hVEsysRec[s][i_az]->Fill( eRec, eRec - eMC );
+			}
+			if( hVEsysMC[s][i_az] )
+			{
+				hVEsysMC[s][i_az]->Fill( eMC, eRec - eMC );
+			}
+			if( hVEsysMCRelative[s][i_az] )
+			{
+				hVEsysMCRelative[s][i_az]->Fill( eMC, ( eRecLin - d->MCe0 ) / d->MCe0 );
+			}
+			if( hVEsysMCRelativeRMS[s][i_az] )
+			{
+				hVEsysMCRelativeRMS[s][i_az]->Fill( eMC, ( eRecLin - d->MCe0 ) / d->MCe0 );
+			}
+			if( hVEsysMCRelative2D[s][i_az] )
+			{
+				hVEsysMCRelative2D[s][i_az]->Fill( eMC, eRecLin / d->MCe0 );
+			}
+			if( hVEsys2D[s][i_az] )
+			{
+				hVEsys2D[s][i_az]->Fill( eMC, eRec - eMC );
+			}
+			if( hVEmcCutCTA[s][i_az] )
+			{
+				hVEmcCutCTA[s][i_az]->Fill( eRec, eMC );
+			}
+			// migration matrix (coarse binning)
+			if( hVResponseMatrix[s][i_az] )
+			{
+				hVResponseMatrix[s][i_az]->Fill( eRec, eMC );
+			}
+			// migration matrix (fine binning)
+			if( hVResponseMatrixFine[s][i_az] )
+			{
+				hVResponseMatrixFine[s][i_az]->Fill( eRec, eMC, i_weight );
+			}
+			
+			if( hVResponseMatrixProfile[s][i_az] )
+			{
+				hVResponseMatrixProfile[s][i_az]->Fill( eRec, eMC );
+			}
+			// events weighted by CR spectra
+			if( hVWeightedRate[s][i_az] )
+			{
+				hVWeightedRate[s][i_az]->Fill( eRec, getCRWeight( d->MCe0, hVEmc[s][i_az] ) );
+			}
+			if( hVWeightedRate005[s][i_az] )
+			{
+				hVWeightedRate005[s][i_az]->Fill( eRec, getCRWeight( d->MCe0, hVEmc[s][i_az] ) );
+			}
+		}
+	}
+}
+
+/*
+ * calculate effective areas and fill output trees
+ * (after all events have been filled with fillEvent())
+ *
+ */
+bool VEffectiveAreaCalculator::terminateFill()
+{
+	unsigned int ize = 0;
+	if( ize >= fZe.size() )
+	{
+		return false;
+	}
 	
 	ze = fZe[ize];
 	fTNoise = fNoise[ize];
@@ -2791,7 +2905,7 @@ bool VEffectiveAreaCalculator::fill( TH1D* hE0mc, CData* d,
 	}
 	
 	fCuts->printCutStatistics();
-	cout << "\t total number of events after cuts: " << iSuccessfullEventStatistics << endl;
+	cout << "\t total number of events after cuts: " << fFill_EventsAfterCuts << endl;
 	
 	return true;
 }
@@ -2902,7 +3016,7 @@ void VEffectiveAreaCalculator::getEffectiveAreasFromFitFunction( unsigned int iz
 /*
       this function always returns a vector of size 2
 */
-vector< unsigned int > VEffectiveAreaCalculator::getUpperLowBins( vector< double > i_values, double d )
+vector< unsigned int > VEffectiveAreaCalculator::getUpperLowBins( const vector< double >& i_values, double d )
 {
 	vector< unsigned int > i_temp( 2, 0 );
 	
@@ -3008,6 +3122,24 @@ double VEffectiveAreaCalculator::getEffectiveAreasFromHistograms( double erec, d
 	fEffectiveAreas_meanIndex   = iSpectralIndex;
 	fEffectiveAreas_meanN++;
 	
+	////////////////////////////////////////////////////////
+	// interpolated effective area (bins and curves are cached
+	// between calls, see getInterpolatedEffectiveArea())
+	//
+	// the likelihood analysis requires in addition the
+	// interpolated MC effective areas and response matrices
+	// (full interpolation below)
+	////////////////////////////////////////////////////////
+	if( !bLikelihoodAnalysis )
+	{
+		const vector< double >* i_eff = getInterpolatedEffectiveArea( ze, woff, iPedVar, iSpectralIndex );
+		if( !i_eff )
+		{
+			return -1.;
+		}
+		return getEffectiveAreaAtEnergy( lerec, *i_eff, bAddtoMeanEffectiveArea );
+	}
+	
 	////////////////////////////////////////////////////////
 	// get upper and lower zenith angle bins
 	////////////////////////////////////////////////////////
@@ -3207,27 +3339,6 @@ double VEffectiveAreaCalculator::getEffectiveAreasFromHistograms( double erec, d
 		return -1.;
 	}
 	
-	// mean effective area calculation
-	if( bAddtoMeanEffectiveArea && fVMeanEffectiveArea.size() == i_eff_temp.size() )
-	{
-		for( unsigned int i = 0; i < i_eff_temp.size(); i++ )
-		{
-			fVMeanEffectiveArea[i] += i_eff_temp[i];
-		}
-		fNMeanEffectiveArea++;
-	}
-	
-	if( bAddtoMeanEffectiveArea && fVTimeBinnedMeanEffectiveArea.size() == i_eff_temp.size() )
-	{
-		for( unsigned int i = 0; i < i_eff_temp.size(); i++ )
-		{
-			fVTimeBinnedMeanEffectiveArea[i] += i_eff_temp[i];
-		}
-		fNTimeBinnedMeanEffectiveArea++;
-		
-	}
-	
-	
 	// Setting Mean MC EffectiveAreas and Response Matrix
 	if( bLikelihoodAnalysis )
 	{
@@ -3248,6 +3359,42 @@ double VEffectiveAreaCalculator::getEffectiveAreasFromHistograms( double erec, d
 		
 	}
 	
+	return getEffectiveAreaAtEnergy( lerec, i_eff_temp, bAddtoMeanEffectiveArea );
+}
+
+/*!
+ *  CALLED TO USE EFFECTIVE AREAS
+ *
+ *  add effective area curve to mean effective areas and
+ *  return 1/effective area at the given energy (log10 TeV)
+ *
+ */
+double VEffectiveAreaCalculator::getEffectiveAreaAtEnergy( double lerec, const vector< double >& i_eff_temp, bool bAddtoMeanEffectiveArea )
+{
+	if( fEff_E0.size() == 0 || i_eff_temp.size() < fEff_E0.size() )
+	{
+		return -1.;
+	}
+	
+	// mean effective area calculation
+	if( bAddtoMeanEffectiveArea && fVMeanEffectiveArea.size() == i_eff_temp.size() )
+	{
+		for( unsigned int i = 0; i < i_eff_temp.size(); i++ )
+		{
+			fVMeanEffectiveArea[i] += i_eff_temp[i];
+		}
+		fNMeanEffectiveArea++;
+	}
+	
+	if( bAddtoMeanEffectiveArea && fVTimeBinnedMeanEffectiveArea.size() == i_eff_temp.size() )
+	{
+		for( unsigned int i = 0; i < i_eff_temp.size(); i++ )
+		{
+			fVTimeBinnedMeanEffectiveArea[i] += i_eff_temp[i];
+		}
+		fNTimeBinnedMeanEffectiveArea++;
+		
+	}
 	
 	/////////////////////////////////////////
 	// effective area for a specific energy
@@ -3290,6 +3437,169 @@ double VEffectiveAreaCalculator::getEffectiveAreasFromHistograms( double erec, d
 	return -1.;
 }
 
+/*!
+ *  CALLED TO USE EFFECTIVE AREAS
+ *
+ *  get lower and upper bins in zenith angle, wobble offset and noise
+ *  (same bin search as in the full interpolation; includes all range checks)
+ *
+ *  iZeBins[2], iWoffBins[4] = [ze*2+woff], iNoiseBins[8] = [(ze*2+woff)*2+noise]
+ *
+ */
+bool VEffectiveAreaCalculator::resolveEffectiveAreaBins( double ze, double woff, double iPedVar,
+		unsigned int* iZeBins, unsigned int* iWoffBins, unsigned int* iNoiseBins )
+{
+	vector< unsigned int > i_ze_bins = getUpperLowBins( fZe, ze );
+	for( unsigned int i = 0; i < 2; i++ )
+	{
+		iZeBins[i] = i_ze_bins[i];
+		if( iZeBins[i] >= fEff_WobbleOffsets.size() )
+		{
+			cout << "VEffectiveAreaCalculator::getEffectiveAreasFromHistograms error: woff index out of range: ";
+			cout << iZeBins[i] << " " << fEff_WobbleOffsets.size() << endl;
+			return false;
+		}
+		vector< unsigned int > i_woff_bins = getUpperLowBins( fEff_WobbleOffsets[iZeBins[i]], woff );
+		for( unsigned int w = 0; w < 2; w++ )
+		{
+			unsigned int iW = i * 2 + w;
+			iWoffBins[iW] = i_woff_bins[w];
+			if( iZeBins[i] >= fEff_Noise.size() || iWoffBins[iW] >= fEff_Noise[iZeBins[i]].size() )
+			{
+				cout << "VEffectiveAreaCalculator::getEffectiveAreasFromHistograms error: noise index out of range: " << iZeBins[i] << " " << fEff_Noise.size();
+				if( iZeBins[i] < fEff_Noise.size() )
+				{
+					cout << " " << iWoffBins[iW] << " " << fEff_Noise[iZeBins[i]].size() << endl;
+				}
+				cout << endl;
+				return false;
+			}
+			vector< unsigned int > i_noise_bins = getUpperLowBins( fEff_Noise[iZeBins[i]][iWoffBins[iW]], iPedVar );
+			for( unsigned int n = 0; n < 2; n++ )
+			{
+				iNoiseBins[iW * 2 + n] = i_noise_bins[n];
+				if( iZeBins[i] >= fEff_SpectralIndex.size()
+						|| iWoffBins[iW] >= fEff_SpectralIndex[iZeBins[i]].size()
+						|| i_noise_bins[n] >= fEff_SpectralIndex[iZeBins[i]][iWoffBins[iW]].size() )
+				{
+					cout << "VEffectiveAreaCalculator::getEffectiveAreasFromHistograms error: spectral index index out of range: ";
+					cout << iZeBins[i] << " " << fEff_SpectralIndex.size() << endl;
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+/*!
+ *  CALLED TO USE EFFECTIVE AREAS
+ *
+ *  interpolate effective area curve for the given query point
+ *  (zenith angle, wobble offset, noise, spectral index)
+ *
+ *  - curve is reused without any calculation for an identical query point
+ *  - curves interpolated in spectral index (lowest level; spectral index is
+ *    constant during the analysis) are recalculated only if the query moves
+ *    to different bins
+ *
+ *  returns 0 if bins are out of range
+ *
+ */
+const vector< double >* VEffectiveAreaCalculator::getInterpolatedEffectiveArea( double ze, double woff, double iPedVar, double iSpectralIndex )
+{
+	sEffectiveAreaInterpolation& c = fEffAreaInterpolation;
+	
+	// same query point
+	if( c.bValid && ze == c.fZe && woff == c.fWoff && iPedVar == c.fPedVar && iSpectralIndex == c.fSpectralIndex )
+	{
+		return &c.fEff;
+	}
+	
+	unsigned int iZeBins[2];
+	unsigned int iWoffBins[4];
+	unsigned int iNoiseBins[8];
+	if( !resolveEffectiveAreaBins( ze, woff, iPedVar, iZeBins, iWoffBins, iNoiseBins ) )
+	{
+		c.bValid = false;
+		return 0;
+	}
+	
+	bool bSameBins = ( c.bValid && iSpectralIndex == c.fSpectralIndex );
+	for( unsigned int i = 0; i < 2 && bSameBins; i++ )
+	{
+		bSameBins = ( iZeBins[i] == c.fZeBins[i] );
+	}
+	for( unsigned int i = 0; i < 4 && bSameBins; i++ )
+	{
+		bSameBins = ( iWoffBins[i] == c.fWoffBins[i] );
+	}
+	for( unsigned int i = 0; i < 8 && bSameBins; i++ )
+	{
+		bSameBins = ( iNoiseBins[i] == c.fNoiseBins[i] );
+	}
+	
+	////////////////////////////////////////////////////////
+	// interpolate in spectral index
+	// (for each of the 8 bracketing ze/woff/noise bins)
+	////////////////////////////////////////////////////////
+	if( !bSameBins )
+	{
+		c.fIndexCurves.resize( 8 );
+		for( unsigned int k = 0; k < 8; k++ )
+		{
+			unsigned int i_ze = iZeBins[k / 4];
+			unsigned int i_woff = iWoffBins[k / 2];
+			unsigned int i_noise = iNoiseBins[k];
+			const vector< double >& i_index = fEff_SpectralIndex[i_ze][i_woff][i_noise];
+			vector< unsigned int > i_index_bins = getUpperLowBins( i_index, iSpectralIndex );
+			unsigned int i_ID_0 = i_index_bins[0] + 100 * ( i_noise + 100 * ( i_woff + 100 * i_ze ) );
+			unsigned int i_ID_1 = i_index_bins[1] + 100 * ( i_noise + 100 * ( i_woff + 100 * i_ze ) );
+			interpolate_effectiveArea( iSpectralIndex, i_index[i_index_bins[0]], i_index[i_index_bins[1]],
+									   fEffArea_map[i_ID_0], fEffArea_map[i_ID_1], c.fIndexCurves[k], false );
+		}
+		for( unsigned int i = 0; i < 2; i++ )
+		{
+			c.fZeBins[i] = iZeBins[i];
+		}
+		for( unsigned int i = 0; i < 4; i++ )
+		{
+			c.fWoffBins[i] = iWoffBins[i];
+		}
+		for( unsigned int i = 0; i < 8; i++ )
+		{
+			c.fNoiseBins[i] = iNoiseBins[i];
+		}
+	}
+	
+	////////////////////////////////////////////////////////
+	// interpolate in noise, wobble offset and zenith angle
+	////////////////////////////////////////////////////////
+	c.fNoiseCurves.resize( 4 );
+	for( unsigned int k = 0; k < 4; k++ )
+	{
+		const vector< double >& i_noise = fEff_Noise[iZeBins[k / 2]][iWoffBins[k]];
+		interpolate_effectiveArea( iPedVar, i_noise[iNoiseBins[k * 2]], i_noise[iNoiseBins[k * 2 + 1]],
+								   c.fIndexCurves[k * 2], c.fIndexCurves[k * 2 + 1], c.fNoiseCurves[k], false );
+	}
+	c.fWoffCurves.resize( 2 );
+	for( unsigned int k = 0; k < 2; k++ )
+	{
+		const vector< double >& i_woff = fEff_WobbleOffsets[iZeBins[k]];
+		interpolate_effectiveArea( woff, i_woff[iWoffBins[k * 2]], i_woff[iWoffBins[k * 2 + 1]],
+								   c.fNoiseCurves[k * 2], c.fNoiseCurves[k * 2 + 1], c.fWoffCurves[k], false );
+	}
+	interpolate_effectiveArea( ze, fZe[iZeBins[0]], fZe[iZeBins[1]], c.fWoffCurves[0], c.fWoffCurves[1], c.fEff, true );
+	
+	c.fZe = ze;
+	c.fWoff = woff;
+	c.fPedVar = iPedVar;
+	c.fSpectralIndex = iSpectralIndex;
+	c.bValid = true;
+	
+	return &c.fEff;
+}
+
 // reset the sum of effective areas
 
 void VEffectiveAreaCalculator::resetTimeBin()
@@ -14,6 +14,8 @@ VEmissionHeightCalculator::VEmissionHeightCalculator()
 	fEmissionHeight = 0.;
 	fEmissionHeightChi2 = 0.;
 	fEmissionHeightT.assign( 1000, -99. );
+	fPointingAz = -999.;
+	fPointingEl = -999.;
 }
 
 
@@ -22,6 +24,13 @@ VEmissionHeightCalculator::~VEmissionHeightCalculator()
 }
 
 
+/*!
+    emission height from all pairs of images
+
+    distance between telescopes in shower coordinates is calculated from
+    projected telescope positions (see updatePointing()); the pair loop
+    runs over the images of this event only
+*/
 double VEmissionHeightCalculator::getEmissionHeight( double* cen_x, double* cen_y, double* size, double az, double el )
 {
 	double iEmissionHeight = 0.;
@@ -39,38 +48,57 @@ double VEmissionHeightCalculator::getEmissionHeight( double* cen_x, double* cen_
 	// reset emission heights
 	fEmissionHeight = 0.;
 	fEmissionHeightChi2 = 0.;
+	
+	// images in this event
+	// (require elevation > 0. and size > 0 (test if telescope is present in analysis))
+	fImgTel.clear();
+	fImgX.clear();
+	fImgY.clear();
+	fImgInvLogSize.clear();
+	if( el > 0. )
+	{
+		updatePointing( az, el );
+		for( unsigned int i = 0; i < fNTel && i < fTelXSC.size(); i++ )
+		{
+			if( size[i] > 0. )
+			{
+				fImgTel.push_back( i );
+				fImgX.push_back( cen_x[i] );
+				fImgY.push_back( cen_y[i] );
+				fImgInvLogSize.push_back( 1. / log10( size[i] ) );
+			}
+		}
+	}
+	
 	// loop over all telescope pairs
-	for( unsigned int i = 0; i < fNTel; i++ )
+	unsigned int nImg = fImgTel.size();
+	for( unsigned int i = 0; i < nImg; i++ )
 	{
-		for( unsigned int j = i; j < fNTel; j++ )
+		for( unsigned int j = i + 1; j < nImg; j++ )
 		{
-			// require elevation > 0. (test if telescope is present in analysis)
-			if( i != j )
+			// get tangens of distance between the two image centroids
+			fImageDistance = TMath::Tan( imageDistance( fImgX[i], fImgX[j], fImgY[i], fImgY[j] ) / TMath::RadToDeg() );
+			if( fImageDistance > 0. )
 			{
-				if( el > 0. && size[i] > 0. && size[j] > 0. )
+				// get distance between the two telescopes in shower coordinates
+				double dx = fTelXSC[fImgTel[i]] - fTelXSC[fImgTel[j]];
+				double dy = fTelYSC[fImgTel[i]] - fTelYSC[fImgTel[j]];
+				double dz = fTelZSC[fImgTel[i]] - fTelZSC[fImgTel[j]];
+				fTelescopeDistanceSC = sqrt( dx * dx + dy * dy + dz * dz );
+				// calculate emission height [km]
+				iEmissionHeightTemp = fTelescopeDistanceSC / fImageDistance / 1.e3;
+				// weight for pairwise emission height calculation
+				iEmissionHeightWeightTemp = 1. / ( fImgInvLogSize[i] + fImgInvLogSize[j] );
+				iEmissionHeightWeight    += iEmissionHeightWeightTemp;
+				iEmissionHeight          += iEmissionHeightTemp * iEmissionHeightWeightTemp;
+				iEmissionHeight2         += iEmissionHeightTemp * iEmissionHeightTemp * iEmissionHeightWeightTemp;
+				iNEM_pairs++;
+				if( nTPair < 1000 )
 				{
-					// get tangens of distance between the two image centroids
-					fImageDistance = TMath::Tan( imageDistance( cen_x[i], cen_x[j], cen_y[i], cen_y[j] ) / TMath::RadToDeg() );
-					if( fImageDistance > 0. )
-					{
-						// get distance between the two telescopes in shower coordinates
-						fTelescopeDistanceSC = getTelescopeDistanceSC( i, j, az, el );
-						// calculate emission height [km]
-						iEmissionHeightTemp = fTelescopeDistanceSC / fImageDistance / 1.e3;
-						// weight for pairwise emission height calculation
-						iEmissionHeightWeightTemp = 1. / ( ( 1. / log10( size[i] ) ) + ( 1. / log10( size[j] ) ) );
-						iEmissionHeightWeight    += iEmissionHeightWeightTemp;
-						iEmissionHeight          += iEmissionHeightTemp * iEmissionHeightWeightTemp;
-						iEmissionHeight2         += iEmissionHeightTemp * iEmissionHeightTemp * iEmissionHeightWeightTemp;
-						iNEM_pairs++;
-						if( nTPair < 1000 )
-						{
-							fEmissionHeightT[nTPair] = iEmissionHeightTemp;
-						}
-					}
-					nTPair++;
+					fEmissionHeightT[nTPair] = iEmissionHeightTemp;
 				}
 			}
+			nTPair++;
 		}
 	}
 	// return mean correction factor (mean of values from all telescope pairs)
@@ -100,6 +128,10 @@ double VEmissionHeightCalculator::getEmissionHeight( double* cen_x, double* cen_
 void VEmissionHeightCalculator::setTelescopePositions( vector< float > x, vector< float > y, vector< float > z )
 {
 	fNTel = x.size();
+	fTelX.clear();
+	fTelY.clear();
+	fTelZ.clear();
+	fPointingAz = -999.;
 	if( x.size() != y.size()
 			|| x.size() != z.size() )
 	{
@@ -121,6 +153,10 @@ void VEmissionHeightCalculator::setTelescopePositions( vector< float > x, vector
 void VEmissionHeightCalculator::setTelescopePositions( unsigned int ntel, double* x, double* y, double* z )
 {
 	fNTel = ntel;
+	fTelX.clear();
+	fTelY.clear();
+	fTelZ.clear();
+	fPointingAz = -999.;
 	for( unsigned int i = 0; i < ntel; i++ )
 	{
 		fTelX.push_back( x[i] );
@@ -135,30 +171,37 @@ void VEmissionHeightCalculator::setTelescopePositions( unsigned int ntel, double
 
 
 /*!
-    get distance between telescopes in shower coordinates
+    project telescope positions onto the plane perpendicular to the pointing direction
+
+    distance between two projected positions is the distance between the
+    telescopes in shower coordinates (see VUtilities::line_point_distance())
+
+    recalculated only if pointing direction changed
 */
-double VEmissionHeightCalculator::getTelescopeDistanceSC( unsigned int iTel1, unsigned int iTel2, double az, double z )
+void VEmissionHeightCalculator::updatePointing( double az, double el )
 {
-	if( iTel1 >= fTelX.size() || iTel2 >= fTelX.size() )
+	if( az == fPointingAz && el == fPointingEl && fTelXSC.size() == fTelX.size() )
 	{
-		cout << "VEmissionHeightCalculator::getTelescopeDistanceSC error: telescope identifier out of range: " << fTelX.size() << "\t" << iTel1 << "\t" << iTel2 << endl;
-		return -999.;
+		return;
 	}
+	fPointingAz = az;
+	fPointingEl = el;
 	
-	double t1[3], t2[3];
+	// direction cosines of pointing direction
+	double cx = -1.*cos( el * TMath::DegToRad() ) * cos( ( 180. - az ) * TMath::DegToRad() );
+	double cy = -1.*cos( el * TMath::DegToRad() ) * sin( ( 180. - az ) * TMath::DegToRad() );
+	double cz = sin( el * TMath::DegToRad() );
 	
-	az /= TMath::RadToDeg();
-	z  /= TMath::RadToDeg();
-	
-	t1[0] = fTelX[iTel1];
-	t1[1] = fTelY[iTel1];
-	t1[2] = fTelZ[iTel1];
-	
-	t2[0] = fTelX[iTel2];
-	t2[1] = fTelY[iTel2];
-	t2[2] = fTelZ[iTel2];
-	
-	return VUtilities::line_point_distance( t1[0], t1[1], t1[2], 90. - z * TMath::RadToDeg(), az * TMath::RadToDeg(), t2[0], t2[1], t2[2] );
+	fTelXSC.resize( fTelX.size() );
+	fTelYSC.resize( fTelX.size() );
+	fTelZSC.resize( fTelX.size() );
+	for( unsigned int i = 0; i < fTelX.size(); i++ )
+	{
+		double d = fTelX[i] * cx + fTelY[i] * cy + fTelZ[i] * cz;
+		fTelXSC[i] = fTelX[i] - d * cx;
+		fTelYSC[i] = fTelY[i] - d * cy;
+		fTelZSC[i] = fTelZ[i] - d * cz;
+	}
 }
 
 
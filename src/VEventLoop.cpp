@@ -86,6 +86,7 @@ VEventLoop::VEventLoop( VEvndispRunParameter* irunparameter )
 		}
 		fFitTraceHandler = new VFitTraceHandler( fRunPar->ftracefitfunction );
 		fFitTraceHandler->setFitThresh( fRunPar->ftracefit );
+		fFitTraceHandler->setMinuitFit( fRunPar->ftracefitMinuit );
 		fTraceHandler = ( VTraceHandler* )fFitTraceHandler;
 	}
 	if( getRunParameter()->fTraceIntegrationMethod.size() > 0 )
@@ -263,6 +264,24 @@ bool VEventLoop::initEventLoop( string iFileName )
 			else
 			{
 				fRawDataReader = new VBFDataReader( fRunPar->fsourcefile, fRunPar->fsourcetype, fRunPar->fNTelescopes, fDebug, fRunPar->fPrintGrisuHeader );
+				// restrict analysis to an event range (skip packets using the VBF packet index stored
+				// in the index directory; without stored index, packets are read sequentially and the
+				// index is filled during reading; without index directory and last event,
+				// the first event is searched by reading events, see gotoEvent())
+				if( fRunPar->fLastEvent > 0 || fRunPar->fVBFPacketIndexDirectory.size() > 0 )
+				{
+					uint32_t i_firstEvent = 0;
+					uint32_t i_lastEvent = UINT_MAX;
+					if( fRunPar->fFirstEvent > 0 )
+					{
+						i_firstEvent = ( uint32_t )fRunPar->fFirstEvent;
+					}
+					if( fRunPar->fLastEvent > 0 )
+					{
+						i_lastEvent = ( uint32_t )fRunPar->fLastEvent;
+					}
+					( ( VBFDataReader* )fRawDataReader )->setEventRange( i_firstEvent, i_lastEvent, fRunPar->fVBFPacketIndexDirectory );
+				}
 				/////////////////////////////////////////////////////////////////////
 				// open temporary file (do make sure that event numbering is correct)
 				// get number of samples
@@ -343,6 +362,20 @@ bool VEventLoop::initEventLoop( string iFileName )
 				cout << endl;
 				///////////////////////////////////////////////////////////////
 			}
+			// compute checksum of raw data file while reading
+			// (VBF files only: VRawDataFileRead gives no information on the position in the file,
+			//  the checksum would require an additional pass over the file)
+			if( fRawDataReader && fRunPar->fComputeChecksum && fRunPar->fsourcetype == 0 )
+			{
+				cout << "VEventLoop warning: checksum not computed for raw data files of this format (VBF files only)" << endl;
+			}
+			else if( fRawDataReader && fRunPar->fComputeChecksum )
+			{
+				if( !fRawDataReader->initChecksum() )
+				{
+					cout << "VEventLoop warning: unable to compute checksum of " << fRunPar->fsourcefile << endl;
+				}
+			}
 			// sourcefile is MC vbf file; noise is read from separate file
 			if( fRawDataReader && fRunPar->fsourcetype == 2 && fRunPar->fsimu_pedestalfile.size() > 0 )
 			{
@@ -717,6 +750,21 @@ void VEventLoop::shutdown()
 	{
 		cout << "VEventLoop::shutdown: Error accessing output file" << endl;
 	}
+#ifndef NOVBF
+	// checksum of raw data file (only if the file was read completely)
+	if( fRawDataReader && fRunPar->fComputeChecksum )
+	{
+		fRunPar->fSourceFileChecksum = fRawDataReader->finishChecksum();
+		if( fRunPar->fSourceFileChecksum.size() > 0 )
+		{
+			cout << "MD5 checksum of " << fRunPar->fsourcefile << ": " << fRunPar->fSourceFileChecksum << endl;
+		}
+		else
+		{
+			cout << "VEventLoop: no MD5 checksum of " << fRunPar->fsourcefile << " (file not read completely)" << endl;
+		}
+	}
+#endif
 	// write run parameter to disk
 	if( fRunPar->frunmode != R_PED && fRunPar->frunmode != R_GTO && fRunPar->frunmode != R_GTOLOW
 			&& fRunPar->frunmode != R_PEDLOW && fRunPar->frunmode != R_TZERO && fRunPar->frunmode != R_TZEROLOW )
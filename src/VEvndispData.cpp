@@ -227,7 +227,7 @@ void VEvndispData::setDetectorGeometry( unsigned int iNTel, vector< string > iCa
 	{
 		fDetectorGeo = new VDetectorGeometry( iNTel, iCamera, iDir, fDebug,
 											  getRunParameter()->fCameraCoordinateTransformX, getRunParameter()->fCameraCoordinateTransformY,
-											  getRunParameter()->fsourcetype );
+											  getRunParameter()->fsourcetype, getRunParameter()->fGeometryCacheDirectory );
 		// get camera rotations from the DB
 		if( getRunParameter()->fDBCameraRotationMeasurements )
 		{
@@ -283,6 +283,29 @@ TTree* VEvndispData::getDetectorTree()
 	return fDetectorTree->getTree();
 }
 
+/*
+ * I/O settings for output trees (compression, basket sizes, etc)
+ * (initialized from run parameters at first call)
+ */
+VTreeIOPolicy* VEvndispData::getTreeIOPolicy()
+{
+	if( fTreeIOPolicy )
+	{
+		return fTreeIOPolicy;
+	}
+	fTreeIOPolicy = new VTreeIOPolicy();
+	if( !fTreeIOPolicy->set( fRunPar->fTreeCompression, fRunPar->fTreeAutoFlush,
+							 fRunPar->fTreeBasketSize, fRunPar->fTreeBranchBasketSize,
+							 fRunPar->fTreeIOThreads ) )
+	{
+		cout << "VEvndispData::getTreeIOPolicy error: invalid I/O settings for output trees" << endl;
+		cout << "exiting..." << endl;
+		exit( EXIT_FAILURE );
+	}
+	fTreeIOPolicy->print();
+	return fTreeIOPolicy;
+}
+
 
 
 
@@ -1203,6 +1226,7 @@ vector< TDirectory* > VEvndispData::fAnaDir;
 vector< VImageAnalyzerData* > VEvndispData::fAnaData;
 VShowerParameters* VEvndispData::fShowerParameters = 0;
 VMCParameters* VEvndispData::fMCParameters = 0;
+VTreeIOPolicy* VEvndispData::fTreeIOPolicy = 0;
 VEvndispReconstructionParameter* VEvndispData::fEvndispReconstructionParameter = 0;
 //vector< VFrogImageData* > VEvndispData::fFrogData;
 
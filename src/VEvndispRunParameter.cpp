@@ -46,6 +46,8 @@ VEvndispRunParameter::VEvndispRunParameter( bool bSetGlobalParameter ) : VGlobal
 	// 3 = rawdata in VBF, 4 = DST (data), 5 = multiple GrIsu file,
 	// 6 = PE file, 7 = DST (MC)
 	fsourcefile = "";
+	fComputeChecksum = false;
+	fSourceFileChecksum = "";
 	
 	fDBRunType = "";
 	fDBDataStartTimeMJD = 0.;
@@ -63,6 +65,8 @@ VEvndispRunParameter::VEvndispRunParameter( bool bSetGlobalParameter ) : VGlobal
 	fPedestalSingleRootFile = false;
 	fnevents = -10000;
 	fFirstEvent = -10000;
+	fLastEvent = -10000;
+	fVBFPacketIndexDirectory = "";
 	fTimeCutsMin_min = -99;
 	fTimeCutsMin_max = -99;
 	fIsMC = 0;
@@ -83,6 +87,9 @@ VEvndispRunParameter::VEvndispRunParameter( bool bSetGlobalParameter ) : VGlobal
 	fCalibrationDataType = 1;  // should be 0 for e.g. CTA DSTs
 	fcalibrationfile = "";
 	fLowGainCalibrationFile = "calibrationlist.LowGain.dat";
+	fCalibrationCacheDirectory = "";
+	fCalibrationNThreads = 1;
+	fGeometryCacheDirectory = "";
 	fcalibrationrun = false;
 	fNCalibrationEvents = -1;
 	fLaserSumMin = 50000.;
@@ -197,6 +204,7 @@ VEvndispRunParameter::VEvndispRunParameter( bool bSetGlobalParameter ) : VGlobal
 	ftraceamplitudecorrectionFile = "";
 	ftracefit = -1.;
 	ftracefitfunction = "ev";
+	ftracefitMinuit = false;
 	freconstructionparameterfile = "EVNDISP.reconstruction.runparameter.AP.v4x";
 	
 	////////////////////////////////////////////////////////////////////////////////
@@ -222,6 +230,10 @@ VEvndispRunParameter::VEvndispRunParameter( bool bSetGlobalParameter ) : VGlobal
 	fShortTree = 1;
 	fwriteMCtree = 1;
 	fFillMCHistos = true;
+	fTreeCompression = "";
+	fTreeAutoFlush = 0;
+	fTreeBasketSize = 0;
+	fTreeIOThreads = 0;
 	
 	// muon parameters
 	fmuonmode = false;
@@ -390,6 +402,14 @@ void VEvndispRunParameter::print( int iEv )
 	cout << endl;
 	cout << "File: " << fsourcefile << " (sourcetype " << fsourcetype;
 	cout << ")" << endl;
+	if( fSourceFileChecksum.size() > 0 )
+	{
+		cout << "MD5 checksum of source file: " << fSourceFileChecksum << endl;
+	}
+	else if( fComputeChecksum )
+	{
+		cout << "computing MD5 checksum of source file" << endl;
+	}
 	if( useDBTextFiles() )
 	{
 		cout << "Using database files for slow control data from " << fDBTextDirectory << endl;
@@ -505,6 +525,10 @@ void VEvndispRunParameter::print( int iEv )
 	{
 		cout << "\t using number of FADC samples from cfg file" << endl;
 	}
+	if( fGeometryCacheDirectory.size() > 0 )
+	{
+		cout << "\t geometry cache directory: " << fGeometryCacheDirectory << endl;
+	}
 	cout << endl;
 	cout << "runmode: " << frunmode << endl;
 	if( fnevents > 0 )
@@ -515,6 +539,14 @@ void VEvndispRunParameter::print( int iEv )
 	{
 		cout << "starting analysis at event:  " << fFirstEvent << endl;
 	}
+	if( fLastEvent > 0 )
+	{
+		cout << "stopping analysis after event:  " << fLastEvent << endl;
+	}
+	if( fVBFPacketIndexDirectory.size() > 0 && ( fFirstEvent > 0 || fLastEvent > 0 ) )
+	{
+		cout << "VBF packet index directory: " << fVBFPacketIndexDirectory << endl;
+	}
 	if( fTimeCutsMin_min > 0 )
 	{
 		cout << "start analysing at minute " << fTimeCutsMin_min << endl;
@@ -544,6 +576,10 @@ void VEvndispRunParameter::print( int iEv )
 	{
 		cout << "reading laser/flasher run numbers from database" << endl;
 	}
+	if( fCalibrationCacheDirectory.size() > 0 )
+	{
+		cout << "calibration cache directory: " << fCalibrationCacheDirectory << endl;
+	}
 	if( frunmode == 2 )
 	{
 		cout << "Minimum size required for laser events (lasermin): " << fLaserSumMin << " [dc]" << endl;
@@ -574,10 +610,21 @@ void VEvndispRunParameter::print( int iEv )
 			cout << "using pedestal events for pedestal calculation" << endl;
 		}
 	}
+	if( ( frunmode == 1 || frunmode == 6 ) && fCalibrationNThreads > 1 )
+	{
+		cout << "filling pedestal histograms with " << fCalibrationNThreads << " threads" << endl;
+	}
 	if( finjectGaussianNoise > 0. )
 	{
 		cout << "Injecting Gaussian noise with standard deviation " << finjectGaussianNoise;
-		cout << " (seed " << finjectGaussianNoiseSeed << ")";
+		if( finjectGaussianNoiseSeed > 0 )
+		{
+			cout << " (seed " << finjectGaussianNoiseSeed << ")";
+		}
+		else
+		{
+			cout << " (random seed)";
+		}
 		cout << endl;
 	}
 	if( fsimu_HILO_from_simFile )
@@ -684,7 +731,12 @@ void VEvndispRunParameter::print( int iEv )
 		}
 		if( ftracefit > -1. )
 		{
-			cout << "trace fitting: " << ftracefit << " with " << ftracefitfunction << endl;
+			cout << "trace fitting: " << ftracefit << " with " << ftracefitfunction;
+			if( ftracefitMinuit )
+			{
+				cout << " (Minuit)";
+			}
+			cout << endl;
 		}
 		if( fSmoothDead )
 		{
@@ -744,6 +796,23 @@ void VEvndispRunParameter::print( int iEv )
 	{
 		cout << "(add image/border pixel list to output tree)" << endl;
 	}
+	if( fTreeCompression.size() > 0 )
+	{
+		cout << "output tree compression: " << fTreeCompression << endl;
+	}
+	if( fTreeAutoFlush != 0 || fTreeBasketSize > 0 || fTreeBranchBasketSize.size() > 0 )
+	{
+		cout << "output tree auto flush: " << fTreeAutoFlush << ", basket size: " << fTreeBasketSize;
+		for( unsigned int i = 0; i < fTreeBranchBasketSize.size(); i++ )
+		{
+			cout << ", " << fTreeBranchBasketSize[i];
+		}
+		cout << endl;
+	}
+	if( fTreeIOThreads > 0 )
+	{
+		cout << "parallel basket compression with " << fTreeIOThreads << " threads" << endl;
+	}
 	
 	// print analysis parameters
 	if( iEv == 2 )
@@ -7,6 +7,9 @@
 */
 
 #include "VExposure.h"
+#include "VFileChecksum.h"
+
+#include "TDatime.h"
 
 
 ClassImp( VExposure )
@@ -25,6 +28,9 @@ VExposure::VExposure( int nBinsL, int nBinsB )
 	fStopDate_SQL =  "2009-12-31";
 	
 	fAcceptance = 0;
+	fAcceptance_MaxDistance = 1.e9;
+	
+	fNThreads = 1;
 	
 	fPlotExtendedSources = true;
 	fPlotSourceNames = true;
@@ -990,6 +996,17 @@ void VExposure::fillElevationPlot( int iYear, int iMonth, int ze_max_deg )
 }
 
 
+/*
+ * fill exposure maps (galactic coordinates and aitoff projection)
+ *
+ * the radial acceptance is tabulated once as a kernel in bins of
+ * equal solid angle (1-cos(r)) and stamped for each run onto the maps;
+ * the kernel and the map geometry (sin/cos of bin centres) are
+ * independent of the run pointing and calculated once
+ *
+ * map rows are distributed over fNThreads threads (each thread fills
+ * all runs overlapping with its rows)
+ */
 void VExposure::fillExposureMap()
 {
 	cout << "fill exposure" << endl;
@@ -999,105 +1016,245 @@ void VExposure::fillExposureMap()
 	fMapGal2D_aitoff->Reset();
 	fRadAccMapGal2D_aitoff->Reset();
 	
-	int    i_r_b = ( int )( fMaximumIntegrationRadius / fMapGal2D->GetYaxis()->GetBinWidth( 2 ) + 0.5 );
-	
-	double r_dist = 0.;
+	const int nBinsL = fMapGal2D->GetNbinsX();
+	const int nBinsB = fMapGal2D->GetNbinsY();
+	const double iDegToRad = TMath::Pi() / 180.;
 	
 	//////////////////////////////////////////////////////////////////////
-	// loop over all runs and fill the map
+	// acceptance kernel and map geometry
+	// (acceptance is linearly interpolated in 1-cos(r) between the kernel nodes;
+	//  the last node is at the acceptance cutoff, the acceptance is 0 beyond)
+	sExposureMapKernel iKernel;
+	const unsigned int nKernel = 1000;
+	double iRAcc = TMath::Min( fAcceptance_MaxDistance, fMaximumIntegrationRadius );
+	iKernel.fCosRMax = cos( fMaximumIntegrationRadius * iDegToRad );
+	iKernel.fCosRAcc = cos( iRAcc * iDegToRad );
+	iKernel.fStep = ( 1. - iKernel.fCosRAcc ) / ( double )nKernel;
+	for( unsigned int k = 0; k <= nKernel; k++ )
+	{
+		if( k == nKernel )
+		{
+			iKernel.fAcceptance.push_back( getAcceptance( iRAcc ) );
+			break;
+		}
+		double iCosR = 1. - ( double )k * iKernel.fStep;
+		if( iCosR < -1. )
+		{
+			iCosR = -1.;
+		}
+		iKernel.fAcceptance.push_back( getAcceptance( acos( iCosR ) / iDegToRad ) );
+	}
+	iKernel.fWindowB = ( int )( fMaximumIntegrationRadius / fMapGal2D->GetYaxis()->GetBinWidth( 2 ) + 0.5 );
+	for( int l = 1; l <= nBinsL; l++ )
+	{
+		double l_pos = fMapGal2D->GetXaxis()->GetBinCenter( l ) * iDegToRad;
+		iKernel.fSinL.push_back( sin( l_pos ) );
+		iKernel.fCosL.push_back( cos( l_pos ) );
+	}
+	for( int b = 1; b <= nBinsB; b++ )
+	{
+		double b_pos = fMapGal2D->GetYaxis()->GetBinCenter( b );
+		iKernel.fSinB.push_back( sin( b_pos * iDegToRad ) );
+		iKernel.fCosB.push_back( cos( b_pos * iDegToRad ) );
+		// extension in longitude
+		if( iKernel.fCosB.back() > 0. )
+		{
+			iKernel.fWindowL.push_back( ( int )( fMaximumIntegrationRadius / iKernel.fCosB.back()
+												 / fMapGal2D->GetXaxis()->GetBinWidth( 2 ) + 0.5 ) );
+		}
+		else
+		{
+			iKernel.fWindowL.push_back( 0 );
+		}
+	}
 	for( unsigned int i = 0; i < fRunGalLong1958.size(); i++ )
 	{
+		if( fRunDuration[i] <= 0. )
+		{
+			continue;
+		}
 		double l = fRunGalLong1958[i];
 		if( l > 180. )
 		{
 			l -= 360.;
 		}
-		int i_l = fMapGal2D->GetXaxis()->FindBin( l );
-		int i_b = fMapGal2D->GetYaxis()->FindBin( fRunGalLat1958[i] );
-		
-		int i_b_start = i_b - i_r_b;
-		if( i_b_start < 1 )
+		iKernel.fRunBinL.push_back( fMapGal2D->GetXaxis()->FindBin( l ) );
+		iKernel.fRunBinB.push_back( fMapGal2D->GetYaxis()->FindBin( fRunGalLat1958[i] ) );
+		iKernel.fRunSinL.push_back( sin( fRunGalLong1958[i] * iDegToRad ) );
+		iKernel.fRunCosL.push_back( cos( fRunGalLong1958[i] * iDegToRad ) );
+		iKernel.fRunSinB.push_back( sin( fRunGalLat1958[i] * iDegToRad ) );
+		iKernel.fRunCosB.push_back( cos( fRunGalLat1958[i] * iDegToRad ) );
+		iKernel.fRunWeight.push_back( fRunDuration[i] / 3600. );
+	}
+	
+	//////////////////////////////////////////////////////////////////////
+	// fill maps (directly into the histogram arrays)
+	if( fMapGal2D->GetSumw2N() == 0 )
+	{
+		fMapGal2D->Sumw2();
+	}
+	if( fRadAccMapGal2D->GetSumw2N() == 0 )
+	{
+		fRadAccMapGal2D->Sumw2();
+	}
+	unsigned int iNJobs = fNThreads;
+	if( iNJobs < 1 )
+	{
+		iNJobs = 1;
+	}
+	if( iNJobs > ( unsigned int )nBinsB )
+	{
+		iNJobs = nBinsB;
+	}
+	vector< sExposureMapFillJob > iJobs( iNJobs );
+	for( unsigned int j = 0; j < iJobs.size(); j++ )
+	{
+		iJobs[j].fKernel = &iKernel;
+		iJobs[j].fNBinsL = nBinsL;
+		iJobs[j].fNBinsB = nBinsB;
+		iJobs[j].fMap = fMapGal2D->GetArray();
+		iJobs[j].fMapW2 = fMapGal2D->GetSumw2()->GetArray();
+		iJobs[j].fAccMap = fRadAccMapGal2D->GetArray();
+		iJobs[j].fAccMapW2 = fRadAccMapGal2D->GetSumw2()->GetArray();
+		iJobs[j].fFirstRow = j + 1;
+		iJobs[j].fRowStep = iNJobs;
+		iJobs[j].fNEntries = 0;
+	}
+	if( iJobs.size() == 1 )
+	{
+		fillExposureMapJob( &iJobs[0] );
+	}
+	else
+	{
+		vector< thread > iThreads;
+		for( unsigned int j = 0; j < iJobs.size(); j++ )
 		{
-			i_b_start = 1;
+			iThreads.push_back( thread( VExposure::fillExposureMapJob, &iJobs[j] ) );
 		}
-		int i_b_stop = i_b + i_r_b;
-		if( i_b_stop > fMapGal2D->GetNbinsY() )
+		for( unsigned int j = 0; j < iThreads.size(); j++ )
 		{
-			i_b_stop = fMapGal2D->GetNbinsY();
+			iThreads[j].join();
 		}
-		
-		for( int b = i_b_start; b <= i_b_stop; b++ )
+	}
+	Long64_t iNEntries = 0;
+	for( unsigned int j = 0; j < iJobs.size(); j++ )
+	{
+		iNEntries += iJobs[j].fNEntries;
+	}
+	fMapGal2D->SetEntries( ( double )iNEntries );
+	fRadAccMapGal2D->SetEntries( ( double )iNEntries );
+	cout << "entries " << fMapGal2D->GetEntries() << endl;
+	
+	/////////////////////////////////
+	// calculate aitoff projection
+	// (bin mapping is calculated only once)
+	if( fAitoffBin.size() != ( unsigned int )( nBinsL * nBinsB ) )
+	{
+		fAitoffBin.assign( nBinsL * nBinsB, 0 );
+		double al = 0.;
+		double ab = 0.;
+		for( int i = 1; i <= nBinsL; i++ )
 		{
-			double b_pos = fMapGal2D->GetYaxis()->GetBinCenter( b );
-			
-			// calculate extension in longitude
-			int i_r_l = 1;
-			if( cos( b_pos * TMath::Pi() / 180. ) > 0. )
+			double xl = fMapGal2D->GetXaxis()->GetBinCenter( i );
+			for( int j = 1; j <= nBinsB; j++ )
 			{
-				i_r_l = ( int )( fMaximumIntegrationRadius / cos( b_pos * TMath::Pi() / 180. ) / fMapGal2D->GetXaxis()->GetBinWidth( 2 ) + 0.5 );
+				double xb = fMapGal2D->GetYaxis()->GetBinCenter( j );
+				aitoff2xy( -1.*xl, xb, al, ab );
+				fAitoffBin[( j - 1 ) * nBinsL + i - 1] = fMapGal2D_aitoff->GetBin( fMapGal2D_aitoff->GetXaxis()->FindBin( al ),
+						fMapGal2D_aitoff->GetYaxis()->FindBin( ab ) );
 			}
-			else
-			{
-				i_r_l = 0;
-			}
-			int i_l_start = i_l - i_r_l;
+		}
+	}
+	for( int i = 1; i <= nBinsL; i++ )
+	{
+		for( int j = 1; j <= nBinsB; j++ )
+		{
+			int iBin = fAitoffBin[( j - 1 ) * nBinsL + i - 1];
+			fMapGal2D_aitoff->SetBinContent( iBin, fMapGal2D->GetBinContent( i, j ) );
+			fRadAccMapGal2D_aitoff->SetBinContent( iBin, fRadAccMapGal2D->GetBinContent( i, j ) );
+		}
+	}
+	// now plot everything
+	gStyle->SetPalette( 1 );
+	set_plot_style();
+	
+}
+
+/*
+ * stamp acceptance kernel for all runs onto the rows of this job
+ *
+ * (galactic longitudes of the maps are from 180. to -180.)
+ */
+void VExposure::fillExposureMapJob( sExposureMapFillJob* iJob )
+{
+	if( !iJob || !iJob->fKernel )
+	{
+		return;
+	}
+	const sExposureMapKernel* k = iJob->fKernel;
+	const int nKernel = ( int )k->fAcceptance.size() - 1;
+	// number of bins per row in the histogram arrays (including under/overflow)
+	const int nBinsRow = iJob->fNBinsL + 2;
+	
+	for( unsigned int i = 0; i < k->fRunWeight.size(); i++ )
+	{
+		int i_b_start = k->fRunBinB[i] - k->fWindowB;
+		if( i_b_start < 1 )
+		{
+			i_b_start = 1;
+		}
+		int i_b_stop = k->fRunBinB[i] + k->fWindowB;
+		if( i_b_stop > iJob->fNBinsB )
+		{
+			i_b_stop = iJob->fNBinsB;
+		}
+		// first row of this job in the integration window
+		int b = i_b_start + ( ( iJob->fFirstRow - i_b_start ) % iJob->fRowStep + iJob->fRowStep ) % iJob->fRowStep;
+		for( ; b <= i_b_stop; b += iJob->fRowStep )
+		{
+			int i_l_start = k->fRunBinL[i] - k->fWindowL[b - 1];
 			if( i_l_start < 1 )
 			{
 				i_l_start = 1;
 			}
-			int i_l_stop = i_l + i_r_l;
-			if( i_l_stop > fMapGal2D->GetNbinsX() )
+			int i_l_stop = k->fRunBinL[i] + k->fWindowL[b - 1];
+			if( i_l_stop > iJob->fNBinsL )
 			{
-				i_l_stop = fMapGal2D->GetNbinsX();
+				i_l_stop = iJob->fNBinsL;
 			}
-			
+			double iSinSin = k->fSinB[b - 1] * k->fRunSinB[i];
+			double iCosCos = k->fCosB[b - 1] * k->fRunCosB[i];
 			for( int l = i_l_start; l <= i_l_stop; l++ )
 			{
-				double l_pos = fMapGal2D->GetXaxis()->GetBinCenter( l );
-				
-				r_dist = VAstronometry::vlaDsep( l_pos * TMath::Pi() / 180., b_pos * TMath::Pi() / 180., fRunGalLong1958[i] * TMath::Pi() / 180.,
-												 fRunGalLat1958[i] * TMath::Pi() / 180. ) * 180. / TMath::Pi();
-				if( r_dist < fMaximumIntegrationRadius && fRunDuration[i] > 0. )
+				// angular distance between bin centre and run direction
+				double iCosR = iSinSin + iCosCos * ( k->fCosL[l - 1] * k->fRunCosL[i] + k->fSinL[l - 1] * k->fRunSinL[i] );
+				if( iCosR <= k->fCosRMax )
 				{
-					// galactic longitudes are from 180. to -180.
-					l_pos *= -1.;
-					fMapGal2D->Fill( l_pos, b_pos, fRunDuration[i] / 3600. );
-					fRadAccMapGal2D->Fill( l_pos, b_pos, fRunDuration[i] / 3600. * getAcceptance( r_dist ) );
+					continue;
 				}
+				// acceptance kernel (linear interpolation; 0 beyond acceptance cutoff)
+				double iAcc = 0.;
+				if( iCosR >= k->fCosRAcc && k->fStep > 0. )
+				{
+					double iU = ( 1. - iCosR ) / k->fStep;
+					int iK = ( int )iU;
+					iAcc = k->fAcceptance[nKernel];
+					if( iK < nKernel )
+					{
+						iAcc = k->fAcceptance[iK] + ( iU - ( double )iK ) * ( k->fAcceptance[iK + 1] - k->fAcceptance[iK] );
+					}
+				}
+				// mirrored longitude bin
+				int iBin = b * nBinsRow + ( iJob->fNBinsL + 1 - l );
+				double w = k->fRunWeight[i];
+				iJob->fMap[iBin] += w;
+				iJob->fMapW2[iBin] += w * w;
+				iJob->fAccMap[iBin] += w * iAcc;
+				iJob->fAccMapW2[iBin] += w * iAcc * w * iAcc;
+				iJob->fNEntries++;
 			}
 		}
 	}
-	cout << "entries " << fMapGal2D->GetEntries() << endl;
-	
-	/////////////////////////////////
-	// calculate aitoff projection
-	double al = 0.;
-	double ab = 0.;
-	double xl = 0.;
-	double xb = 0.;
-	int bl = 0;
-	int bb = 0;
-	
-	for( int i = 1; i <= fMapGal2D->GetNbinsX(); i++ )
-	{
-		xl = fMapGal2D->GetXaxis()->GetBinCenter( i );
-		for( int j = 1; j <= fMapGal2D->GetNbinsY(); j++ )
-		{
-			xb = fMapGal2D->GetYaxis()->GetBinCenter( j );
-			
-			aitoff2xy( -1.*xl, xb, al, ab );
-			
-			bl = fMapGal2D_aitoff->GetXaxis()->FindBin( al );
-			bb = fMapGal2D_aitoff->GetYaxis()->FindBin( ab );
-			
-			fMapGal2D_aitoff->SetBinContent( bl, bb, fMapGal2D->GetBinContent( i, j ) );
-			fRadAccMapGal2D_aitoff->SetBinContent( bl, bb, fRadAccMapGal2D->GetBinContent( i, j ) );
-		}
-	}
-	// now plot everything
-	gStyle->SetPalette( 1 );
-	set_plot_style();
-	
 }
 
 
@@ -2933,62 +3090,57 @@ TString VExposure::readMD5sumFromFile( TString filename, int run, bool warn )
 	
 }
 
+/*
+ * calculate MD5 checksum of a raw data file
+ *
+ * (in-process, same implementation as used by evndisp with the -checksum option;
+ *  result is appended to LOCAL_sumd<date>)
+ */
 TString VExposure::calcMD5sum( int date, int run )
 {
-
-	//check if md5sum utility is available
-	if( system( "which md5sum" ) != 0 )
-	{
-		cout << "VExposure::calcMD5sum Error: \"which md5sum\" shows no match; will not calculate checksum." << endl;
-		return "";
-	}
-	
 	TString datafilename;
 	TString resultfilename;
-	TString tempfilename;
-	TString filepath;
 	char* ENVIR_VAR;
 	
 	ENVIR_VAR = getenv( "VERITAS_DATA_DIR" );
 	
 	datafilename.Form( "%s/data/d%d/%d.cvbf", ENVIR_VAR, date, run );
 	resultfilename.Form( "%s/data/d%d/LOCAL_sumd%d", ENVIR_VAR, date, date );
-	tempfilename.Form( "%s/data/d%d/TEMP_sum_%d_%d", ENVIR_VAR, date, run, ( int )time( 0 ) );
-	filepath.Form( "%s/data/d%d/", ENVIR_VAR, date );
 	
 	//check if input file exists
-	ifstream itemp( datafilename.Data() );
-	if( ! itemp.good() )
+	if( gSystem->AccessPathName( datafilename.Data() ) )
 	{
-		itemp.close();
 		cout << "VExposure::calcMD5sum Error: File " << datafilename.Data() << " not available. "  << endl;
 		return "";
 	}
-	itemp.close();
 	
 	//now do the checksum.
-	TString command = TString::Format( "md5sum %s | tr \"\\n\" \" \" > %s ; date >> %s", datafilename.Data(), tempfilename.Data(), tempfilename.Data() );
-	cout << command << endl;
-	if( system( command.Data() ) != 0 )
+	cout << "VExposure::calcMD5sum: calculating checksum for " << datafilename << endl;
+	TString checksum = VFileChecksum::calcMD5sum( datafilename.Data() ).c_str();
+	if( checksum == "" )
 	{
-		cout << "VExposure::calcMD5sum Error: Unable to execute command: " << command << endl;
+		cout << "VExposure::calcMD5sum Error: Unable to calculate checksum for " << datafilename << endl;
 		return "";
 	}
 	
-	//read in checksum
-	TString checksum = readMD5sumFromFile( tempfilename, run );
-	
-	if( checksum != "" )
+	// write checksum in md5sum format (plus date)
+	ofstream os( resultfilename.Data(), ios::app );
+	if( os )
 	{
-		command.Form( "cat %s >> %s", tempfilename.Data(), resultfilename.Data() );
-		if( system( command.Data() ) == 0 )
+		TDatime iDate;
+		os << checksum << "  " << datafilename << " " << iDate.AsString() << endl;
+		os.close();
+		// group write permission
+		FileStat_t iStat;
+		if( gSystem->GetPathInfo( resultfilename.Data(), iStat ) == 0 )
 		{
-			command.Form( "rm %s", tempfilename.Data() );
-			system( command.Data() );
-			command.Form( "chmod g+w %s", resultfilename.Data() );
-			system( command.Data() );
+			gSystem->Chmod( resultfilename.Data(), ( iStat.fMode & 07777 ) | 020 );
 		}
 	}
+	else
+	{
+		cout << "VExposure::calcMD5sum Warning: unable to write checksum to " << resultfilename << endl;
+	}
 	return checksum;
 }
 
@@ -0,0 +1,189 @@
+/*! \class VFileChecksum
+    \brief streaming MD5 checksum of a file
+
+    The checksum is identical to the one of the md5sum utility.
+
+    Bytes are added to the checksum strictly in file order and in large
+    blocks. The VBF data reader calls updateFraction() while decoding a
+    file, so that the checksum is computed from data which was just read
+    (page cache) instead of an additional pass over the file at the end.
+
+    Note that the file is still read a second time (from the page cache):
+    the VBF reader (VBankFileReader) does its own file I/O and does not
+    expose the buffers handed to the decoder, so these bytes cannot be
+    hashed directly.
+
+    calcMD5sum() calculates the checksum of a file in one go.
+
+*/
+
+#include "VFileChecksum.h"
+
+VFileChecksum::VFileChecksum( unsigned int iBufferSize )
+{
+	fFileName = "";
+	fFile = 0;
+	fFileSize = 0;
+	fNBytesDone = 0;
+	fError = false;
+	fMD5 = 0;
+	if( iBufferSize == 0 )
+	{
+		iBufferSize = 4194304;
+	}
+	fBuffer.resize( iBufferSize );
+}
+
+VFileChecksum::~VFileChecksum()
+{
+	close();
+	if( fMD5 )
+	{
+		delete fMD5;
+	}
+}
+
+void VFileChecksum::close()
+{
+	if( fFile )
+	{
+		fclose( fFile );
+	}
+	fFile = 0;
+}
+
+bool VFileChecksum::open( string iFileName )
+{
+	close();
+	if( fMD5 )
+	{
+		delete fMD5;
+	}
+	fMD5 = new TMD5();
+	fFileName = iFileName;
+	fFileSize = 0;
+	fNBytesDone = 0;
+	fError = false;
+	
+	Long_t iID = 0;
+	Long_t iFlags = 0;
+	Long_t iModTime = 0;
+	if( gSystem->GetPathInfo( fFileName.c_str(), &iID, &fFileSize, &iFlags, &iModTime ) != 0 )
+	{
+		cout << "VFileChecksum::open error: file not found: " << fFileName << endl;
+		fError = true;
+		return false;
+	}
+	fFile = fopen( fFileName.c_str(), "rb" );
+	if( !fFile )
+	{
+		cout << "VFileChecksum::open error: cannot open file " << fFileName << endl;
+		fError = true;
+		return false;
+	}
+	return true;
+}
+
+/*
+ * add bytes to checksum up to byte iNBytes of the file
+ *
+ * (reading in blocks of buffer size; last incomplete block is
+ *  only read when end of file is requested)
+ */
+bool VFileChecksum::update( Long64_t iNBytes )
+{
+	if( !fFile || fError )
+	{
+		return false;
+	}
+	if( iNBytes > fFileSize )
+	{
+		iNBytes = fFileSize;
+	}
+	Long64_t iBlock = ( Long64_t )fBuffer.size();
+	while( fNBytesDone < iNBytes && ( iNBytes - fNBytesDone >= iBlock || iNBytes == fFileSize ) )
+	{
+		size_t n = fread( &fBuffer[0], 1, fBuffer.size(), fFile );
+		if( n == 0 )
+		{
+			if( ferror( fFile ) )
+			{
+				cout << "VFileChecksum::update error reading file " << fFileName << endl;
+				fError = true;
+				return false;
+			}
+			break;
+		}
+		fMD5->Update( &fBuffer[0], ( UInt_t )n );
+		fNBytesDone += n;
+	}
+	return true;
+}
+
+/*
+ * add bytes to checksum up to the given fraction of the file
+ */
+bool VFileChecksum::updateFraction( double iFraction )
+{
+	if( iFraction >= 1. )
+	{
+		return update( fFileSize );
+	}
+	return update( ( Long64_t )( iFraction * ( double )fFileSize ) );
+}
+
+/*
+ * add all remaining bytes of the file and return checksum
+ *
+ * iReadRemaining = false: no checksum if bytes are missing (avoids
+ * an additional pass over the part of the file not yet added)
+ *
+ * (returns empty string on error)
+ */
+string VFileChecksum::finish( bool iReadRemaining )
+{
+	if( !fFile || fError )
+	{
+		return "";
+	}
+	if( !iReadRemaining && fNBytesDone < fFileSize )
+	{
+		close();
+		return "";
+	}
+	// read until end of file (file size might have changed)
+	update( fFileSize );
+	for( ;; )
+	{
+		size_t n = fread( &fBuffer[0], 1, fBuffer.size(), fFile );
+		if( n == 0 )
+		{
+			break;
+		}
+		fMD5->Update( &fBuffer[0], ( UInt_t )n );
+		fNBytesDone += n;
+	}
+	if( fError || ferror( fFile ) )
+	{
+		close();
+		return "";
+	}
+	close();
+	fMD5->Final();
+	return string( fMD5->AsString() );
+}
+
+/*
+ * calculate MD5 checksum of a file in one pass
+ *
+ * (returns empty string on error)
+ */
+string VFileChecksum::calcMD5sum( string iFileName )
+{
+	VFileChecksum iChecksum;
+	if( !iChecksum.open( iFileName ) )
+	{
+		return "";
+	}
+	return iChecksum.finish();
+}
@@ -3,8 +3,9 @@
 
      Fit function is VFitTraceHandler_tracefunction()
 
-     Some work should be invested to make it faster:
-     (just now, it's a factor 90 slower than simple trace summing)
+     Traces are fitted by default with VPulseFitter (Levenberg-Marquardt
+     with analytic derivatives); fits with Minuit are used if requested
+     with setMinuitFit( true ) (slow: factor 90 slower than simple trace summing)
 */
 
 #include "VFitTraceHandler.h"
@@ -112,6 +113,10 @@ double VFitTraceHandler_tracefunction_Grisu( double* x, double* par )
 VFitTraceHandler::VFitTraceHandler( string iFit )
 {
 	fMinuitPrint = false;
+	fMinuitFit = false;
+	fPulseFitter = 0;
+	fPulseFitterValid = false;
+	fnstat = 0;
 	fMaxSamples = 64;
 	fpTrace.reserve( fMaxSamples );
 	fpTrazeSize = 0;
@@ -158,6 +163,10 @@ VFitTraceHandler::~VFitTraceHandler()
 	delete fHxbar;
 	delete fHsigma;
 	delete fHalpha;
+	if( fPulseFitter )
+	{
+		delete fPulseFitter;
+	}
 }
 
 
@@ -173,19 +182,8 @@ void VFitTraceHandler::setTrace( VVirtualDataReader* iReader, unsigned int iNSam
 	}
 	
 	// copy trace
-	if( iNSamples != fpTrace.size() )
-	{
-		fpTrace.clear();
-		for( unsigned int i = 0; i < iNSamples; i++ )
-		{
-			fpTrace.push_back( iReader->getSample_double( iHitID, i + fMC_FADCTraceStart, ( i == 0 ) ) );
-		}
-	}
-	else for( unsigned int i = 0; i < iNSamples; i++ )
-		{
-			fpTrace[i] = iReader->getSample_double( iHitID, i + fMC_FADCTraceStart, ( i == 0 ) );
-		}
-		
+	iReader->getSamples_double( iHitID, fMC_FADCTraceStart, iNSamples, fpTrace );
+	
 	fpTrazeSize = int( fpTrace.size() );
 	apply_lowgain( iHiLo );
 	
@@ -268,25 +266,13 @@ void VFitTraceHandler::fitTrace( unsigned int chanID )
 {
 
 	fFitted = false;
+	fPulseFitterValid = false;
 	fChi2 = 0.;
 	fRT = 0.;
 	fFT = 0.;
 	fTraceNorm = 0.;
 	
-	fH1TraceData->Reset();
 	fH1Trace->SetLineStyle( 1 );
-	// check if histogram size is still correct
-	if( ( int )fpTrace.size() != ( int )fH1TraceData->GetNbinsX() )
-	{
-		fH1TraceData->SetBins( ( int )fpTrace.size(), 0., ( double )fpTrace.size() );
-	}
-	// fill histogram
-	for( unsigned int i = 0; i < fpTrace.size(); i++ )
-	{
-		fH1TraceData->SetBinContent( i + 1, -1. * fpTrace[i] );
-		// errors are signal+rms of pedestal
-		fH1TraceData->SetBinError( i + 1, sqrt( fabs( fpTrace[i] - fPed ) + fPedrms * fPedrms ) / 2. );
-	}
 	
 	// find start parameters
 	double ipeak = 0.;
@@ -296,61 +282,19 @@ void VFitTraceHandler::fitTrace( unsigned int chanID )
 	// fit only if peak value of trace is above threshold
 	if( ipeak > fFitThresh * fPedrms )
 	{
-		if( fFitFunction == "ev" )
+		if( fMinuitFit || !fPulseFitter )
 		{
-			// fit in samples
-			fF1Trace->SetParameters( -1.*ipeak, ipeakpos, 0.6, 1.6, -1.*fPed );
-			// fit in ns
-			//	 fF1Trace->SetParameters( -1.*ipeak, ipeakpos*2, 1.2, 3.0, -1.*fPed );
-			fF1Trace->SetParNames( "Constant", "Mean", "Sigma", "Alpha", "Pedestal" );
-			fF1Trace->FixParameter( 4, -1.*fPed );
-			// constant always negative
-			fF1Trace->SetParLimits( 0, -5.e5, 0. );
-			// fit in samples
-			fF1Trace->SetParLimits( 2, 0.01, 20. );
-			// fit in ns
-			//	 fF1Trace->SetParLimits( 2, 0.1, 20. );
-			fF1Trace->SetParLimits( 3, 0., 20. );
-		}
-		else if( fFitFunction == "grisu" )
-		{
-			// fit in samples
-			fF1Trace->SetParameters( 2.4, 8.0, 0., ipeakpos, -1.*ipeak,  -1.*fPed );
-			// fit in ns
-			//         fF1Trace->SetParameters( 2.4, 8.0, 0., 2.*ipeakpos, -1.*ipeak,  -1.*fPed );
-			fF1Trace->SetParNames( "RT", "FT", "RC", "T0", "Constant", "Pedestal" );
-			fF1Trace->FixParameter( 2, 0. );
-			fF1Trace->SetParLimits( 0, 0., 20. );
-			fF1Trace->SetParLimits( 1, 0., 2000. );
-		}
-		
-		// now fit everything
-		if( !fMinuitPrint )
-		{
-			//         fH1TraceData->Fit( fF1Trace, "0Q" );
-			fH1TraceData->Fit( fF1Trace, "E" );
+			fitTrace_Minuit( ipeak, ipeakpos );
 		}
 		else
 		{
-			fH1TraceData->Fit( fF1Trace, "E" );
+			fitTrace_PulseFitter( ipeak, ipeakpos );
 		}
-		// pulse maximum
-		fTraceMax =  fF1Trace->GetMinimum( ( double )0., ( double )fMaxSamples );
-		fTraceMaxX = fF1Trace->GetMinimumX( ( double )0., ( double )fMaxSamples );
-		// status of the error matrix
-		double edm = 0.;
-		double amin = 0.;
-		double errdef = 0.;
-		int nvpar = 0;
-		int nparx = 0;
-		gMinuit->mnstat( amin, edm, errdef, nvpar, nparx, fnstat );
 		if( fnstat < 3 )
 		{
 			fH1Trace->SetLineStyle( 2 );
 		}
 		fHfitstat->Fill( fnstat );
-		// chi2
-		fChi2 = fF1Trace->GetChisquare() / ( fH1TraceData->GetNbinsX() - fF1Trace->GetNumberFreeParameters() );
 		fHchi2->Fill( fChi2 );
 		// parameters
 		if( fnstat > 0 )
@@ -384,6 +328,148 @@ void VFitTraceHandler::fitTrace( unsigned int chanID )
 }
 
 
+/*
+ * fit trace with Minuit (TH1::Fit)
+ */
+void VFitTraceHandler::fitTrace_Minuit( double ipeak, int ipeakpos )
+{
+	fH1TraceData->Reset();
+	// check if histogram size is still correct
+	if( ( int )fpTrace.size() != ( int )fH1TraceData->GetNbinsX() )
+	{
+		fH1TraceData->SetBins( ( int )fpTrace.size(), 0., ( double )fpTrace.size() );
+	}
+	// fill histogram
+	for( unsigned int i = 0; i < fpTrace.size(); i++ )
+	{
+		fH1TraceData->SetBinContent( i + 1, -1. * fpTrace[i] );
+		// errors are signal+rms of pedestal
+		fH1TraceData->SetBinError( i + 1, sqrt( fabs( fpTrace[i] - fPed ) + fPedrms * fPedrms ) / 2. );
+	}
+	
+	if( fFitFunction == "ev" )
+	{
+		// fit in samples
+		fF1Trace->SetParameters( -1.*ipeak, ipeakpos, 0.6, 1.6, -1.*fPed );
+		// fit in ns
+		//	 fF1Trace->SetParameters( -1.*ipeak, ipeakpos*2, 1.2, 3.0, -1.*fPed );
+		fF1Trace->SetParNames( "Constant", "Mean", "Sigma", "Alpha", "Pedestal" );
+		fF1Trace->FixParameter( 4, -1.*fPed );
+		// constant always negative
+		fF1Trace->SetParLimits( 0, -5.e5, 0. );
+		// fit in samples
+		fF1Trace->SetParLimits( 2, 0.01, 20. );
+		// fit in ns
+		//	 fF1Trace->SetParLimits( 2, 0.1, 20. );
+		fF1Trace->SetParLimits( 3, 0., 20. );
+	}
+	else if( fFitFunction == "grisu" )
+	{
+		// fit in samples
+		fF1Trace->SetParameters( 2.4, 8.0, 0., ipeakpos, -1.*ipeak,  -1.*fPed );
+		// fit in ns
+		//         fF1Trace->SetParameters( 2.4, 8.0, 0., 2.*ipeakpos, -1.*ipeak,  -1.*fPed );
+		fF1Trace->SetParNames( "RT", "FT", "RC", "T0", "Constant", "Pedestal" );
+		fF1Trace->FixParameter( 2, 0. );
+		fF1Trace->SetParLimits( 0, 0., 20. );
+		fF1Trace->SetParLimits( 1, 0., 2000. );
+	}
+	
+	// now fit everything
+	if( !fMinuitPrint )
+	{
+		//         fH1TraceData->Fit( fF1Trace, "0Q" );
+		fH1TraceData->Fit( fF1Trace, "E" );
+	}
+	else
+	{
+		fH1TraceData->Fit( fF1Trace, "E" );
+	}
+	// pulse maximum
+	fTraceMax =  fF1Trace->GetMinimum( ( double )0., ( double )fMaxSamples );
+	fTraceMaxX = fF1Trace->GetMinimumX( ( double )0., ( double )fMaxSamples );
+	// status of the error matrix
+	double edm = 0.;
+	double amin = 0.;
+	double errdef = 0.;
+	int nvpar = 0;
+	int nparx = 0;
+	gMinuit->mnstat( amin, edm, errdef, nvpar, nparx, fnstat );
+	// chi2
+	fChi2 = fF1Trace->GetChisquare() / ( fH1TraceData->GetNbinsX() - fF1Trace->GetNumberFreeParameters() );
+}
+
+
+/*
+ * fit trace with VPulseFitter
+ *
+ * (Levenberg-Marquardt minimisation with analytic derivatives;
+ *  start values from trace maximum and sliding window integration)
+ *
+ * fit results are copied to the fit function (for plotting)
+ */
+void VFitTraceHandler::fitTrace_PulseFitter( double ipeak, int ipeakpos )
+{
+	// start value for pulse integral (sliding window of 9 samples)
+	// (keep integration window and arrival time of trace handler unchanged)
+	unsigned int iSumWindowFirst = fSumWindowFirst;
+	unsigned int iSumWindowLast = fSumWindowLast;
+	double iTraceAverageTime = fTraceAverageTime;
+	int iWindow = TMath::Min( 9, ( int )fpTrace.size() );
+	double icharge = calculateTraceSum_slidingWindow( 0, fpTrace.size(), iWindow, false );
+	// start value for pulse position: trace maximum inside the sliding window
+	if( fSumWindowLast > fSumWindowFirst
+			&& ( ipeakpos < ( int )fSumWindowFirst || ipeakpos >= ( int )fSumWindowLast ) )
+	{
+		double iWindowPeak = ipeak;
+		int iWindowPeakPos = -1;
+		getQuickMax( fSumWindowFirst, fSumWindowLast, iWindowPeak, iWindowPeakPos );
+		if( iWindowPeakPos >= 0 && iWindowPeak > 0. )
+		{
+			ipeak = iWindowPeak;
+			ipeakpos = iWindowPeakPos;
+		}
+	}
+	fSumWindowFirst = iSumWindowFirst;
+	fSumWindowLast = iSumWindowLast;
+	fTraceAverageTime = iTraceAverageTime;
+	
+	fnstat = fPulseFitter->fit( fpTrace, fPed, fPedrms, ipeak, ( double )ipeakpos + 0.5, icharge );
+	if( fPulseFitter->getNDF() > 0 )
+	{
+		fChi2 = fPulseFitter->getChi2() / ( double )fPulseFitter->getNDF();
+	}
+	else
+	{
+		fChi2 = 0.;
+	}
+	// fit function parameters (trace fit functions are negative)
+	if( fFitFunction == "ev" )
+	{
+		fF1Trace->SetParameters( -1.*fPulseFitter->getParameter( 0 ), fPulseFitter->getParameter( 1 ),
+								 fPulseFitter->getParameter( 2 ), fPulseFitter->getParameter( 3 ), -1.*fPed );
+	}
+	else if( fFitFunction == "grisu" )
+	{
+		fF1Trace->SetParameters( fPulseFitter->getParameter( 0 ), fPulseFitter->getParameter( 1 ), 0.,
+								 fPulseFitter->getParameter( 2 ), -1.*fPulseFitter->getParameter( 3 ), -1.*fPed );
+	}
+	// pulse maximum (limited to trace length as for the Minuit fit)
+	fTraceMaxX = fPulseFitter->getPeakPosition();
+	if( fTraceMaxX < 0. || fTraceMaxX > ( double )fMaxSamples )
+	{
+		fTraceMaxX = TMath::Max( 0., TMath::Min( ( double )fMaxSamples, fTraceMaxX ) );
+		fTraceMax = -1.*fPulseFitter->eval( fTraceMaxX ) - fPed;
+		fPulseFitterValid = false;
+	}
+	else
+	{
+		fTraceMax = -1.*fPulseFitter->getAmplitude() - fPed;
+		fPulseFitterValid = ( fnstat > 0 );
+	}
+}
+
+
 /*!
     for successful fits return integral, otherwise quicksum
 
@@ -391,7 +477,15 @@ void VFitTraceHandler::fitTrace( unsigned int chanID )
 double VFitTraceHandler::getTraceSum( int iFirst, int iLast, bool iRaw )
 {
 	double isum = 0.;
-	if( fnstat > 0 && fFitted )
+	if( usePulseFitter() )
+	{
+		isum = fPulseFitter->getIntegral( ( double )iFirst, ( double )iLast );
+		if( iRaw )
+		{
+			isum += fPed * ( iLast - iFirst );
+		}
+	}
+	else if( fnstat > 0 && fFitted )
 	{
 		isum = -1. * fF1Trace->Integral( iFirst, iLast );
 		if( !iRaw )
@@ -410,7 +504,22 @@ double VFitTraceHandler::getTraceSum( int iFirst, int iLast, bool iRaw )
 
 void VFitTraceHandler::getTraceMax( int iFirst, int iLast, double& max, int& maxpos )
 {
-	if( fFitted )
+	if( usePulseFitter() )
+	{
+		// pulse maximum (or value at the closest edge of the search window)
+		double x = fPulseFitter->getPeakPosition();
+		if( x < ( double )iFirst )
+		{
+			x = ( double )iFirst;
+		}
+		else if( x > ( double )iLast )
+		{
+			x = ( double )iLast;
+		}
+		max = fPulseFitter->eval( x );
+		maxpos = ( int )x;
+	}
+	else if( fFitted )
 	{
 		max = -1.*fF1Trace->GetMinimum( ( double )iFirst, ( double )iLast ) - fPed;
 		maxpos = ( int )fF1Trace->GetMinimumX( ( double )iFirst, ( double )iLast );
@@ -438,6 +547,11 @@ double VFitTraceHandler::getTraceTZero( int iFirst, int iLast )
 	{
 		return getQuickTZero( iFirst, iLast );
 	}
+	if( usePulseFitter() && fPulseFitter->getPeakPosition() >= ( double )iFirst
+			&& fPulseFitter->getPeakPosition() <= ( double )iLast )
+	{
+		return fPulseFitter->getTime( 0.5, true );
+	}
 	getTraceMax( iFirst, iLast, imax, maxpos );
 	return fF1Trace->GetX( -1.* ( imax / 2 + fPed ), 0., ( double )maxpos );
 }
@@ -498,6 +612,20 @@ bool VFitTraceHandler::setFitFunction( string iFunc )
 	fF1Trace->SetTitle( iFunc.c_str() );
 	fF1Trace->SetLineWidth( 2 );
 	fF1Trace->SetNpx( 500 );
+	
+	// fast pulse fitter (same pulse shapes)
+	if( !fPulseFitter )
+	{
+		fPulseFitter = new VPulseFitter();
+	}
+	if( iFunc == "grisu" )
+	{
+		fPulseFitter->setShape( VPulseFitter::GRISU );
+	}
+	else
+	{
+		fPulseFitter->setShape( VPulseFitter::EV );
+	}
 	return true;
 }
 
@@ -517,6 +645,11 @@ double VFitTraceHandler::getTraceWidth( int fFirst, int fLast, double fPed )
 	fFirst = 0;
 	fLast  = 0;
 	
+	if( usePulseFitterMaximum() )
+	{
+		return fPulseFitter->getTime( 0.5, false ) - fPulseFitter->getTime( 0.5, true );
+	}
+	
 	return ( fF1Trace->GetX( iMax, fTraceMaxX, ( double )fMaxSamples ) - fF1Trace->GetX( iMax, 0., fTraceMaxX ) );
 }
 
@@ -538,6 +671,11 @@ double VFitTraceHandler::getTraceRiseTime( double fPed, double ystart, double ys
 	double t1 = 0.;
 	double t2 = 0.;
 	
+	if( usePulseFitterMaximum() )
+	{
+		return fPulseFitter->getTime( ystop, true ) - fPulseFitter->getTime( ystart, true );
+	}
+	
 	double iMax = fTraceMax;
 	t1 = fF1Trace->GetX( -1.*( fPed + ystart * ( -1.*iMax - fPed ) ), 0., fTraceMaxX );
 	t2 = fF1Trace->GetX( -1.*( fPed + ystop * ( -1.*iMax - fPed ) ), 0., fTraceMaxX );
@@ -563,6 +701,11 @@ double VFitTraceHandler::getTraceFallTime( double fPed, double ystart, double ys
 	double t1 = 0.;
 	double t2 = 0.;
 	
+	if( usePulseFitterMaximum() )
+	{
+		return fPulseFitter->getTime( ystop, false ) - fPulseFitter->getTime( ystart, false );
+	}
+	
 	double iMax = fTraceMax;
 	t1 = fF1Trace->GetX( -1.*( fPed + ystart * ( -1.*iMax - fPed ) ), fTraceMaxX, ( double )fMaxSamples );
 	t2 = fF1Trace->GetX( -1.*( fPed + ystop * ( -1.*iMax - fPed ) ), fTraceMaxX, ( double )fMaxSamples );
@@ -79,6 +79,7 @@ VGammaHadronCuts::VGammaHadronCuts()
 	{
 		fProbabilityCut_SelectionCut[i] = -1.;
 	}
+	fProbabilityCut_Table_Stride = 0;
 	
 	// phase cuts
 	fOrbitalPhase_min = -1.;
@@ -116,6 +117,8 @@ VGammaHadronCuts::VGammaHadronCuts()
 	fAngRes_AbsoluteMinimum = 0.;
 	fAngRes_AbsoluteMaximum = 1.e10;
 	fAngResContainmentProbability = 0;
+	fAngResTable_F1 = false;
+	fAngResTable_InvBinWidth = 0.;
 	
 	setArrayCentre();
 }
@@ -1422,41 +1425,19 @@ bool VGammaHadronCuts::applyTMVACut( int i )
 */
 bool VGammaHadronCuts::applyProbabilityCut( int i, bool fIsOn )
 {
-	// tree exists and has the requested entry
-	if( fProbabilityCut_Tree && fProbabilityCut_Tree->GetEntry( i ) )
+	// table has the requested entry
+	if( i < 0 || i >= ( int )fProbabilityCut_Table_Decision.size() )
 	{
-		// check cut quality
-		if( fProbabilityCut_QualityFlag > 0 )
-		{
-			if( fProbabilityCutRangeLower.size() != fProbabilityCutRangeUpper.size() )
-			{
-				cout << "Error in definitions of RF probablity ranges" << endl
-					 << "RFCutLowerVals and  RFCutLowerVals have different numbers of entries in cut file" << endl;
-				exit( -1 );
-			}
-			else
-			{
-				if( fProbabilityCut_ProbID < fProbabilityCut_NSelectors && fProbabilityCut_NSelectors < VANACUTS_PROBSELECTIONCUTS_MAX )
-				{
-					for( unsigned int dex = 0; dex < fProbabilityCutRangeLower.size(); dex++ )
-					{
-						if( fIsOn && fProbabilityCut_SelectionCut[fProbabilityCut_ProbID] >= fProbabilityCutRangeLower[dex]
-								&& fProbabilityCut_SelectionCut[fProbabilityCut_ProbID] <  fProbabilityCutRangeUpper[dex] )
-						{
-							return true;
-						}
-						if( !fIsOn && fProbabilityCut_SelectionCut[fProbabilityCut_ProbID] >= -fProbabilityCutRangeLower[dex]
-								&& fProbabilityCut_SelectionCut[fProbabilityCut_ProbID] <  -fProbabilityCutRangeUpper[dex] )
-						{
-							return true;
-						}
-					}
-				}
-			}
-		}
+		return false;
+	}
+	// selectors of this event (see getProbabilityCut_Selector())
+	fProbabilityCut_NSelectors = fProbabilityCut_Table_NSelectors[i];
+	for( unsigned int s = 0; s < fProbabilityCut_Table_Stride; s++ )
+	{
+		fProbabilityCut_SelectionCut[s] = fProbabilityCut_Table_SelectionCut[( unsigned int )i * fProbabilityCut_Table_Stride + s];
 	}
 	
-	return false;
+	return ( fProbabilityCut_Table_Decision[i] & ( fIsOn ? 1 : 2 ) );
 }
 
 /*!
@@ -1687,6 +1668,8 @@ void VGammaHadronCuts::initializeCuts( int irun, string iFile )
 			exit( EXIT_FAILURE );
 		}
 	}
+	// lookup table for energy dependent direction cut
+	initAngularResolutionTable();
 }
 
 /*
@@ -1812,11 +1795,95 @@ bool VGammaHadronCuts::initProbabilityCuts( string iFile )
 	}
 	fProbabilityCut_Tree->SetBranchAddress( "g", fProbabilityCut_SelectionCut );
 	
+	bool bTable = initProbabilityCutTable();
+	
 	if( cDir )
 	{
 		cDir->cd();
 	}
 	
+	return bTable;
+}
+
+/*
+ * read all entries of the probability cut tree and precompile
+ * the cut decisions (on and off) and the selector values
+ *
+ * (tree is read only once; applyProbabilityCut() is a table lookup)
+ */
+bool VGammaHadronCuts::initProbabilityCutTable()
+{
+	fProbabilityCut_Table_Decision.clear();
+	fProbabilityCut_Table_NSelectors.clear();
+	fProbabilityCut_Table_SelectionCut.clear();
+	fProbabilityCut_Table_Stride = 0;
+	if( !fProbabilityCut_Tree )
+	{
+		return false;
+	}
+	if( fProbabilityCutRangeLower.size() != fProbabilityCutRangeUpper.size() )
+	{
+		cout << "Error in definitions of RF probablity ranges" << endl
+			 << "RFCutLowerVals and  RFCutLowerVals have different numbers of entries in cut file" << endl;
+		exit( -1 );
+	}
+	
+	// number of selectors stored per entry
+	if( fProbabilityCut_Tree->GetBranchStatus( "Ng" ) )
+	{
+		fProbabilityCut_Table_Stride = ( unsigned int )fProbabilityCut_Tree->GetMaximum( "Ng" );
+	}
+	else
+	{
+		fProbabilityCut_Table_Stride = fProbabilityCut_NSelectors;
+	}
+	if( fProbabilityCut_Table_Stride > VANACUTS_PROBSELECTIONCUTS_MAX )
+	{
+		fProbabilityCut_Table_Stride = VANACUTS_PROBSELECTIONCUTS_MAX;
+	}
+	
+	Long64_t n = fProbabilityCut_Tree->GetEntries();
+	fProbabilityCut_Table_Decision.assign( n, 0 );
+	fProbabilityCut_Table_NSelectors.assign( n, 0 );
+	fProbabilityCut_Table_SelectionCut.assign( n * fProbabilityCut_Table_Stride, -1. );
+	for( Long64_t i = 0; i < n; i++ )
+	{
+		for( unsigned int s = 0; s < fProbabilityCut_Table_Stride; s++ )
+		{
+			fProbabilityCut_SelectionCut[s] = -1.;
+		}
+		if( fProbabilityCut_Tree->GetEntry( i ) <= 0 )
+		{
+			continue;
+		}
+		fProbabilityCut_Table_NSelectors[i] = fProbabilityCut_NSelectors;
+		for( unsigned int s = 0; s < fProbabilityCut_Table_Stride; s++ )
+		{
+			fProbabilityCut_Table_SelectionCut[i * fProbabilityCut_Table_Stride + s] = fProbabilityCut_SelectionCut[s];
+		}
+		// check cut quality
+		if( fProbabilityCut_QualityFlag <= 0 )
+		{
+			continue;
+		}
+		if( fProbabilityCut_ProbID < fProbabilityCut_NSelectors && fProbabilityCut_NSelectors < VANACUTS_PROBSELECTIONCUTS_MAX )
+		{
+			double iSel = fProbabilityCut_SelectionCut[fProbabilityCut_ProbID];
+			for( unsigned int dex = 0; dex < fProbabilityCutRangeLower.size(); dex++ )
+			{
+				if( iSel >= fProbabilityCutRangeLower[dex] && iSel <  fProbabilityCutRangeUpper[dex] )
+				{
+					fProbabilityCut_Table_Decision[i] |= 1;
+				}
+				if( iSel >= -fProbabilityCutRangeLower[dex] && iSel <  -fProbabilityCutRangeUpper[dex] )
+				{
+					fProbabilityCut_Table_Decision[i] |= 2;
+				}
+			}
+		}
+	}
+	cout << "\t probability cuts precompiled for " << n << " events" << endl;
+	
 	return true;
 }
 
@@ -2100,53 +2167,13 @@ bool VGammaHadronCuts::applyDirectionCuts( unsigned int fEnergyReconstructionMet
 	return false;
 }
 
-double VGammaHadronCuts::getEnergyDependentCut( double energy_TeV, TGraph* iG, bool bUseEvalue, bool bMaxCut )
-{
-	double i_cut_value = 99999;
-	if( !bMaxCut )
-	{
-		i_cut_value = -1;
-	}
-	if( !iG )
-	{
-		return i_cut_value;
-	}
-	// use TGraph::Eval
-	if( bUseEvalue )
-	{
-		i_cut_value  = iG->Eval( energy_TeV );
-	}
-	// return value at this point without interpolation
-	else
-	{
-		for( int i = 0; i < iG->GetN() - 1; i++ )
-		{
-			if( energy_TeV >= iG->GetX()[i] && energy_TeV < iG->GetX()[i + 1 ] )
-			{
-				i_cut_value = iG->GetY()[i + 1 ];
-			}
-		}
-	}
-	
-	// for e outside of graph range, return edge values
-	if( iG->GetN() > 0 && iG->GetX() && iG->GetY() )
-	{
-		if( energy_TeV < iG->GetX()[0] )
-		{
-			i_cut_value = iG->GetY()[0];
-		}
-		if( energy_TeV > iG->GetX()[iG->GetN() - 1] )
-		{
-			i_cut_value = iG->GetY()[iG->GetN() - 1];
-		}
-	}
-	return i_cut_value;
-}
-
 /*
    fetch theta2 cut (might be energy dependent)
 
    e      :   [TeV] energy (linear)
+
+   angular resolution functions and graphs are read from a lookup table
+   (see initAngularResolutionTable(); filled in initializeCuts())
 */
 double VGammaHadronCuts::getTheta2Cut_max( double e )
 {
@@ -2170,26 +2197,50 @@ double VGammaHadronCuts::getTheta2Cut_max( double e )
 		// use a function to get the angular resolution
 		if( fDirectionCutSelector == 1 && fF1AngRes )
 		{
-			// energy outside of functions range:, return edge values
-			if( e < fF1AngRes->GetXmin() )
+			if( fAngResTable_F1 )
 			{
-				e = fF1AngRes->GetXmin();
+				theta_cut_max = getAngularResolutionFromTable( e );
 			}
-			else if( e > fF1AngRes->GetXmax() )
+			// table not filled (cuts not initialized, e.g. read from file)
+			else
 			{
-				e = fF1AngRes->GetXmax();
+				// energy outside of functions range:, return edge values
+				if( e < fF1AngRes->GetXmin() )
+				{
+					e = fF1AngRes->GetXmin();
+				}
+				else if( e > fF1AngRes->GetXmax() )
+				{
+					e = fF1AngRes->GetXmax();
+				}
+				
+				// get angular resolution and apply scaling factor
+				theta_cut_max  = fF1AngRes->Eval( e );
 			}
-			
-			// get angular resolution and apply scaling factor
-			theta_cut_max  = fF1AngRes->Eval( e );
 		}
 		/////////////////////////////////////////////
 		// use IRF graph for angular resolution
 		else if( ( fDirectionCutSelector == 1 || fDirectionCutSelector == 2 ) && getTheta2Cut_IRF_Max() )
 		{
-			// get theta2 cut
-			
-			theta_cut_max  = getEnergyDependentCut( e, getTheta2Cut_IRF_Max(), true );
+			if( fAngResTable_X.size() > 0 && !fAngResTable_F1 )
+			{
+				theta_cut_max = getAngularResolutionFromTable( e );
+			}
+			// table not filled (cuts not initialized, e.g. read from file)
+			else
+			{
+				TGraph* iG = getTheta2Cut_IRF_Max();
+				theta_cut_max = iG->Eval( e );
+				// for e outside of graph range, return edge values
+				if( iG->GetN() > 0 && e < iG->GetX()[0] )
+				{
+					theta_cut_max = iG->GetY()[0];
+				}
+				else if( iG->GetN() > 0 && e > iG->GetX()[iG->GetN() - 1] )
+				{
+					theta_cut_max = iG->GetY()[iG->GetN() - 1];
+				}
+			}
 		}
 	}
 	
@@ -2206,6 +2257,128 @@ double VGammaHadronCuts::getTheta2Cut_max( double e )
 	return theta_cut_max * theta_cut_max;
 }
 
+/*
+   fill lookup table for the energy dependent direction cut
+   from the angular resolution function or graph (IRF)
+
+   Angular resolution functions (TF1) are tabulated on a uniform grid
+   of 4001 nodes in log10 energy over the function range (linear
+   interpolation between the nodes; edge values outside of the range).
+
+   Graph points are sorted in log10 energy; the table gives the
+   same linear interpolation as TGraph::Eval (edge values outside
+   of the graph range).
+
+   Nodes are found with a uniformly binned index array.
+   The table is filled in initializeCuts() and whenever the
+   function or graph is replaced; it is not modified during event processing.
+*/
+void VGammaHadronCuts::initAngularResolutionTable()
+{
+	fAngResTable_X.clear();
+	fAngResTable_Y.clear();
+	fAngResTable_Segment.clear();
+	fAngResTable_InvBinWidth = 0.;
+	fAngResTable_F1 = false;
+	
+	unsigned int iNBins = 1000;
+	
+	// angular resolution function
+	if( fDirectionCutSelector == 1 && fF1AngRes )
+	{
+		const unsigned int iNNodes = 4001;
+		double iXmin = fF1AngRes->GetXmin();
+		double iXmax = fF1AngRes->GetXmax();
+		if( iXmax <= iXmin )
+		{
+			return;
+		}
+		for( unsigned int i = 0; i < iNNodes; i++ )
+		{
+			double x = iXmin + ( double )i * ( iXmax - iXmin ) / ( double )( iNNodes - 1 );
+			if( i == iNNodes - 1 )
+			{
+				x = iXmax;
+			}
+			fAngResTable_X.push_back( x );
+			fAngResTable_Y.push_back( fF1AngRes->Eval( x ) );
+		}
+		fAngResTable_F1 = true;
+		iNBins = iNNodes - 1;
+	}
+	// angular resolution graph
+	else if( getTheta2Cut_IRF_Max() )
+	{
+		TGraph* iG = getTheta2Cut_IRF_Max();
+		vector< pair< double, double > > iP;
+		for( int i = 0; i < iG->GetN(); i++ )
+		{
+			iP.push_back( make_pair( iG->GetX()[i], iG->GetY()[i] ) );
+		}
+		sort( iP.begin(), iP.end() );
+		for( unsigned int i = 0; i < iP.size(); i++ )
+		{
+			fAngResTable_X.push_back( iP[i].first );
+			fAngResTable_Y.push_back( iP[i].second );
+		}
+		// TGraph::Eval returns 0 for empty graphs
+		if( fAngResTable_X.size() == 0 )
+		{
+			fAngResTable_X.push_back( 0. );
+			fAngResTable_Y.push_back( 0. );
+		}
+	}
+	if( fAngResTable_X.size() < 2 || fAngResTable_X.back() <= fAngResTable_X.front() )
+	{
+		return;
+	}
+	
+	// index of first node of the segment containing the lower edge of each bin
+	fAngResTable_InvBinWidth = ( double )iNBins / ( fAngResTable_X.back() - fAngResTable_X.front() );
+	fAngResTable_Segment.assign( iNBins, 0 );
+	unsigned int k = 0;
+	for( unsigned int b = 0; b < iNBins; b++ )
+	{
+		double x = fAngResTable_X.front() + ( double )b / fAngResTable_InvBinWidth;
+		while( k + 2 < fAngResTable_X.size() && x >= fAngResTable_X[k + 1] )
+		{
+			k++;
+		}
+		fAngResTable_Segment[b] = k;
+	}
+}
+
+/*
+   angular resolution from lookup table
+
+   log10e : log10 energy [TeV]
+
+   (edge values for energies outside of table range)
+*/
+double VGammaHadronCuts::getAngularResolutionFromTable( double log10e )
+{
+	if( log10e <= fAngResTable_X.front() || fAngResTable_Segment.size() == 0 )
+	{
+		return fAngResTable_Y.front();
+	}
+	if( log10e >= fAngResTable_X.back() )
+	{
+		return fAngResTable_Y.back();
+	}
+	unsigned int b = ( unsigned int )( ( log10e - fAngResTable_X.front() ) * fAngResTable_InvBinWidth );
+	if( b >= fAngResTable_Segment.size() )
+	{
+		b = fAngResTable_Segment.size() - 1;
+	}
+	unsigned int k = fAngResTable_Segment[b];
+	while( k + 2 < fAngResTable_X.size() && log10e >= fAngResTable_X[k + 1] )
+	{
+		k++;
+	}
+	return fAngResTable_Y[k] + ( log10e - fAngResTable_X[k] )
+		   * ( fAngResTable_Y[k + 1] - fAngResTable_Y[k] ) / ( fAngResTable_X[k + 1] - fAngResTable_X[k] );
+}
+
 /*
 
    read angular resolution from root file
@@ -2316,6 +2489,7 @@ bool VGammaHadronCuts::initAngularResolutionFile()
 	{
 		fFileAngRes->Close();
 	}
+	initAngularResolutionTable();
 	
 	return true;
 }
@@ -2340,6 +2514,7 @@ bool VGammaHadronCuts::setIRFGraph( TGraphErrors* g )
 	}
 	iG->SetName( "IRFAngRes" );
 	fEnergyDependentCut[ "IRFAngRes" ] = iG;
+	initAngularResolutionTable();
 	
 	// print results
 	cout << "replaced IRF graph for direction cut" << endl;
@@ -2658,6 +2833,7 @@ bool VGammaHadronCuts::getEnergyDependentCutFromFile( string iFileName, string i
 		TGraph* iG = ( TGraph* )g->Clone();
 		iG->SetName( iVariable.c_str() );
 		fEnergyDependentCut[iVariable] = iG;
+		initAngularResolutionTable();
 	}
 	i_f->Close();
 	return true;
@@ -224,7 +224,7 @@ void VGrIsuAnalyzer::mtxmlt( float a[3][3], float b[3], float c[3] )
 /**/
 //:Reconst:rcs_perpendicular_fit
 /***************** rcs_perpendicular_fit *********************************/
-int VGrIsuAnalyzer::rcs_perpendicular_fit( vector<float> x, vector<float> y, vector<float> w, vector<float> m,
+int VGrIsuAnalyzer::rcs_perpendicular_fit( const vector<float>& x, const vector<float>& y, const vector<float>& w, const vector<float>& m,
 		unsigned int num_images, float* sx, float* sy, float* std )
 /*
 RETURN= 0 if no faults
@@ -323,6 +323,139 @@ passes through the point (x[i],y[i]) and has slope m[i].
 
 /*=============== end of rcs_perpendicular_fit ==========================*/
 
+/*!
+    weighted intersection of all pairs of image axes
+    (Hofmann et al 1999, Method 1 (HEGRA method) with modified weights)
+
+    x, y:  image centroids
+    w:     image weights (size)
+    m:     slope of image axes
+    l:     width/length of images
+    iAxesAngles_min: minimum angle between image axes [rad]
+
+    all per-image quantities (axis angle, line offset, weight factors) are
+    calculated once; the pair loop works on these arrays only
+
+    sx, sy:         weighted mean of all pairwise intersection points
+    iMeanAngDiff:   mean angle between image axes [deg]
+    iDispDiff:      mean squared distance between pairwise intersection points
+
+    returns sum of weights (<= 0 if no valid pair of images)
+*/
+float VGrIsuAnalyzer::rcs_pairwise_intersection( const vector<float>& x, const vector<float>& y, const vector<float>& w,
+		const vector<float>& m, const vector<float>& l,
+		double iAxesAngles_min, float* sx, float* sy, float* iMeanAngDiff, float* iDispDiff )
+{
+	unsigned int n = m.size();
+	fPair_phi.resize( n );
+	fPair_b.resize( n );
+	fPair_wInv.resize( n );
+	fPair_lFac.resize( n );
+	for( unsigned int i = 0; i < n; i++ )
+	{
+		fPair_phi[i] = atan( m[i] );
+		fPair_b[i] = y[i] - m[i] * x[i];
+		fPair_wInv[i] = 1. / w[i];
+		fPair_lFac[i] = 1. - l[i];
+	}
+	
+	float itotweight = 0.;
+	float iweight = 1.;
+	float ixs = 0.;
+	float iys = 0.;
+	float xs = 0.;
+	float ys = 0.;
+	float iangdiff = 0.;
+	float imean_iangdiff = 0.;
+	float imean_iangdiffN = 0.;
+	// moments of intersection points (for iDispDiff)
+	double iN = 0.;
+	double iSx = 0.;
+	double iSy = 0.;
+	double iSxx = 0.;
+	double iSyy = 0.;
+	
+	for( unsigned int ii = 0; ii < n; ii++ )
+	{
+		for( unsigned int jj = ii + 1; jj < n; jj++ )
+		{
+			// check minimum angle between image lines; ignore if too small
+			iangdiff = fabs( fPair_phi[jj] - fPair_phi[ii] );
+			if( iangdiff < iAxesAngles_min ||
+					fabs( 180. * TMath::DegToRad() - iangdiff ) < iAxesAngles_min )
+			{
+				continue;
+			}
+			// mean angle between images
+			if( iangdiff < 90. * TMath::DegToRad() )
+			{
+				imean_iangdiff += iangdiff * TMath::RadToDeg();
+			}
+			else
+			{
+				imean_iangdiff += ( 180. - iangdiff * TMath::RadToDeg() );
+			}
+			imean_iangdiffN++;
+			
+			// weight is sin of angle between image lines
+			iangdiff = fabs( sin( iangdiff ) );
+			
+			// line intersection
+			if( m[ii] != m[jj] )
+			{
+				xs = ( fPair_b[jj] - fPair_b[ii] )  / ( m[ii] - m[jj] );
+			}
+			else
+			{
+				xs = 0.;
+			}
+			ys = m[ii] * xs + fPair_b[ii];
+			
+			iweight  = 1. / ( fPair_wInv[ii] + fPair_wInv[jj] ); // weight 1: size of images
+			iweight *= fPair_lFac[ii] * fPair_lFac[jj];        // weight 2: elongation of images (width/length)
+			iweight *= iangdiff;                                // weight 3: angular differences between the two image axis
+			iweight *= iweight;                                 // use squared value
+			
+			ixs += xs * iweight;
+			iys += ys * iweight;
+			itotweight += iweight;
+			
+			iN++;
+			iSx += xs;
+			iSy += ys;
+			iSxx += ( double )xs * xs;
+			iSyy += ( double )ys * ys;
+		}
+	}
+	if( iMeanAngDiff )
+	{
+		*iMeanAngDiff = ( imean_iangdiffN > 0. ? imean_iangdiff / imean_iangdiffN : 0. );
+	}
+	if( itotweight > 0. )
+	{
+		*sx = ixs / itotweight;
+		*sy = iys / itotweight;
+	}
+	else
+	{
+		*sx = -99999.;
+		*sy = -99999.;
+	}
+	// mean squared distance between all pairs of intersection points
+	// sum_{i<j} (x_i-x_j)^2 = N * sum_i x_i^2 - ( sum_i x_i )^2
+	if( iDispDiff )
+	{
+		*iDispDiff = 0.;
+		if( iN > 1. )
+		{
+			double iD = iN * ( iSxx + iSyy ) - iSx * iSx - iSy * iSy;
+			*iDispDiff = ( iD > 0. ? iD / ( 0.5 * iN * ( iN - 1. ) ) : 0. );
+		}
+	}
+	
+	return itotweight;
+}
+
 ///:~
 /**/
 //:Reconst:rcs_rotate_delta
@@ -35,6 +35,8 @@ VGrIsuReader::VGrIsuReader( VDetectorGeometry* iDetGeo, unsigned int intel, stri
 	fLastWithData = false;
 	fSourceFileName = "";
 	fTraceFileName = "";
+	fTraceFile = 0;
+	fTraceLibrary = 0;
 	fExternalPedFile = iExtPed;
 	setEventStatus( 1 );
 	fMultiGrIsuReader = false;
@@ -91,6 +93,8 @@ VGrIsuReader::VGrIsuReader( VDetectorGeometry* iDetGeo, unsigned int intel, stri
 	fLastWithData = false;
 	fSourceFileName = i_sourcefile;
 	fTraceFileName = "";
+	fTraceFile = 0;
+	fTraceLibrary = 0;
 	fExternalPedFile = iExtPed;
 	setEventStatus( 1 );
 	fMultiGrIsuReader = false;
@@ -188,6 +192,10 @@ VGrIsuReader::~VGrIsuReader()
 		i_com += fSourceFileName;
 		gSystem->Exec( i_com.c_str() );
 	}
+	if( fTraceLibrary )
+	{
+		delete fTraceLibrary;
+	}
 }
 
 
@@ -1222,16 +1230,15 @@ bool VGrIsuReader::openTraceLibrary()
 			exit( -1 );
 		}
 		cout << "VGrIsuReader::VGrIsuReader(): reading tracefile: " << fTraceFileName << endl;
-		char itree[200];
-		for( unsigned int i = 0; i < fNTel; i++ )
+		// background traces are read once into a contiguous buffer
+		if( !fTraceLibrary )
 		{
-			sprintf( itree, "trace_%d", i );
-			fTraceTree.push_back( ( TTree* )gDirectory->Get( itree ) );
-			if( fTraceTree.back() == 0 )
-			{
-				cout << "VGrIsuReader::VGrIsuReader(): warning, trace tree not found: " << itree << endl;
-			}
-			fTraceTree.back()->SetBranchAddress( "fTrace", fTrace );
+			fTraceLibrary = new VNoiseTraceLibrary( fDebug );
+		}
+		if( !fTraceLibrary->open( fTraceFileName, fNTel ) )
+		{
+			cout << "VGrIsuReader::VGrIsuReader(): error reading trace library " << fTraceFileName << endl;
+			exit( -1 );
 		}
 	}
 	return true;
@@ -1303,78 +1310,69 @@ void VGrIsuReader::initVectors()
 }
 
 
+/*
+    add background traces from trace library
+
+    hit pixels:    trace = sample - default pedestal + library trace
+    silent pixels: trace = library trace
+
+    (traces are clamped to [0,255])
+*/
 void VGrIsuReader::fillBackgroundfromTraceLibrary()
 {
 	if( fDebug )
 	{
 		cout << "void VGrIsuReader::fillBackgroundfromTraceLibrary()" << endl;
 	}
-	int i_traceValue = 0;
-	double i_newPed = 0.;
-	int i_newPedN = 0;
-	cout << "void VGrIsuReader::fillBackgroundfromTraceLibrary()" << endl;
+	if( !fTraceLibrary || !fTraceLibrary->isValid() )
+	{
+		return;
+	}
+	// sample value minus default pedestal (same conversion for all samples)
+	for( int k = 0; k < 256; k++ )
+	{
+		fTracePedShift[k] = ( int )( k - fdefaultPed );
+	}
 	
 	for( unsigned int h = 0; h < fNTel; h++ )
 	{
 		// get randomly a event from the trace library
-		fTraceTree[h]->GetEntry( fRandomGen->Integer( ( int )fTraceTree[h]->GetEntries() ) );
+		Long64_t iEntry = fRandomGen->Integer( ( int )fTraceLibrary->getNEntries( h ) );
+		unsigned int iNSamples = fNumSamples[h];
+		if( iNSamples > VNoiseTraceLibrary::fNSamples )
+		{
+			iNSamples = VNoiseTraceLibrary::fNSamples;
+		}
 		// loop over all tubes (MC camera file tube numbering)
 		for( unsigned int i = 0; i < fMaxChannels[h]; i++ )
 		{
-			i_newPed = 0.;
-			i_newPedN = 0;
-			for( unsigned int j = 0; j < fNumSamples[h]; j++ )
+			if( fSamplesVec[h][i].size() == 0 )
 			{
-				i_traceValue = 0;
-				if( fFullHitVec[h][i] && fFullAnaVec[h][i] == 1 )
-				{
-					// hit pixel -> only add noise
-					if( fFullTrigVec[h][i] )
-					{
-						// use pedestals from data file -> first subtract the pedestal from Grisu (fdefaultped),
-						// then add the real one
-						i_traceValue = ( int )( fSamplesVec[h][i][j] - fdefaultPed );
-						i_traceValue += fTrace[fPixelConvertVecR[h][i]][j];
-						if( i_traceValue < 0 )
-						{
-							cout << "VGrIsuReader::fillBackgroundfromTraceLibrary() warning trace value < 0: (a)";
-							cout << h << "\t" << i << "\t" << j << "\t";
-							cout << i_traceValue << "\t" << fFullTrigVec[h][i] << "\t" << fSamplesVec[h][i][j] << "\t";
-							cout << fEventNumber << "\t" << fTraceTree[h]->GetReadEvent() << "\t";
-							cout << fdefaultPed << "\t" << fPeds[h][i] << endl;
-						}
-						fSamplesVec[h][i][j] = ( uint8_t )i_traceValue;
-						if( i_traceValue != 0 )
-						{
-							i_newPed += ( double )i_traceValue;
-							i_newPedN++;
-						}
-					}
-					// silent pixel -> set pedestal and add noise
-					else
-					{
-						i_traceValue = ( int )( fTrace[fPixelConvertVecR[h][i]][j] );
-						if( i_traceValue < 0 )
-						{
-							cout << "VGrIsuReader::fillBackgroundfromTraceLibrary() warning trace value < 0: (b) ";
-							cout << h << "\t" << i << "\t" << j << "\t";
-							cout << i_traceValue << "\t" << fFullTrigVec[h][i] << "\t" << fSamplesVec[h][i][j] << "\t";
-							cout << fEventNumber << "\t" << fTraceTree[h]->GetReadEvent() << "\t";
-							cout << fdefaultPed << "\t" << fPeds[h][i] << endl;
-						}
-						fSamplesVec[h][i][j] = ( uint8_t )i_traceValue;
-						if( i_traceValue != 0 )
-						{
-							i_newPed += ( double )i_traceValue;
-							i_newPedN++;
-						}
-					}
-				}
-				else
+				continue;
+			}
+			uint8_t* iS = &fSamplesVec[h][i][0];
+			if( !fFullHitVec[h][i] || fFullAnaVec[h][i] != 1 || fPixelConvertVecR[h][i] >= VNoiseTraceLibrary::fNPixel )
+			{
+				memset( iS, 0, fSamplesVec[h][i].size() );
+				continue;
+			}
+			const uint8_t* iT = fTraceLibrary->getTrace( h, iEntry, fPixelConvertVecR[h][i] );
+			// hit pixel -> only add noise
+			// (use pedestals from data file -> first subtract the pedestal from Grisu (fdefaultped),
+			//  then add the real one)
+			if( fFullTrigVec[h][i] )
+			{
+				for( unsigned int j = 0; j < iNSamples; j++ )
 				{
-					fSamplesVec[h][i][j] = 0;
+					int v = fTracePedShift[iS[j]] + ( int )iT[j];
+					iS[j] = ( uint8_t )( v < 0 ? 0 : ( v > 255 ? 255 : v ) );
 				}
 			}
+			// silent pixel -> set pedestal and add noise
+			else
+			{
+				memcpy( iS, iT, iNSamples );
+			}
 		}
 	}
 }
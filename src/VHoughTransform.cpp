@@ -64,6 +64,10 @@ VHoughTransform::VHoughTransform( VDetectorGeometry* fDetectorGeo )
 		fAccumulatorArray.push_back( initAccumulatorArray( fRMinDpmt[iTelescopeIndex], fRMaxDpmt[iTelescopeIndex],
 									 fStepsPerPMTDiameter[iTelescopeIndex], iTelescopeIndex ) );
 									 
+		//Set up the integer accumulator (one entry for each bin of the accumulator array, including under- and overflow bins)
+		fAccumulator.push_back( vector <unsigned int>( fAccumulatorArray.back()->GetNcells(), 0 ) );
+		fAccumulatorFilledBins.push_back( vector <unsigned int>() );
+		
 		//Print this when the accumulator array is initialized.
 		//cout << "Accumulator array for telescope " << iTelescopeIndex + 1 << " initialized." << endl;
 		
@@ -71,8 +75,8 @@ VHoughTransform::VHoughTransform( VDetectorGeometry* fDetectorGeo )
 		//cout << "Initializing the lookup table for telescope " << iTelescopeIndex + 1 << "..." << endl;
 		
 		//Set up the lookup table for a given telescope
-		fHTLookupTableTree.push_back( initLookupTable( fRMinDpmt[iTelescopeIndex], fRMaxDpmt[iTelescopeIndex],
-									  fStepsPerPMTDiameter[iTelescopeIndex], iTelescopeIndex ) );
+		initLookupTable( fRMinDpmt[iTelescopeIndex], fRMaxDpmt[iTelescopeIndex],
+						 fStepsPerPMTDiameter[iTelescopeIndex], iTelescopeIndex );
 									  
 		//Print this when the lookup table is initialized
 		//cout << "Lookup table for telescope " << iTelescopeIndex + 1 << " initialized." << endl;
@@ -104,17 +108,10 @@ void VHoughTransform::analysis( VEvndispData* fData, VImageParameter* fParGeo )
 	double fPixelXCoordinate = 0; //The X coordinate of a pixel
 	double fPixelYCoordinate = 0; //The Y coordinate of a pixel
 	
-	char fBranchName[100]; //Name of the branch in the lookup table tree
-	
 	double fSumOfAllBins = 0; //Sum of all the bins in the accumulator array
 	
 	int fNumberOfNonZeroBins = 0; //Number of non-zero bins in the accumulator array
 	
-	double fCircleCoordinates[3]; 	//Coordinates of a template circle associated with a particular pixel
-	fCircleCoordinates[0] = 0; 		//x coordinate
-	fCircleCoordinates[1] = 0; 		//y coordinate
-	fCircleCoordinates[2] = 0; 		//r coordinate.
-	
 	//Best parameterized circles
 	
 	double fBestParametrization[3];  		//Best parametrization
@@ -134,11 +131,10 @@ void VHoughTransform::analysis( VEvndispData* fData, VImageParameter* fParGeo )
 	
 	int fAccumulatorBins[3]; //Bins of the accumulator array
 	
-	double fMaxBinValue = 0; //Value of the bin of the accumulator array with the highest value
-	double fSecondMaxBinValue = 0; //Value of the bin of the accumulator array with the second highest value
+	int fPeakBins[3]; //Global bin numbers of the three highest bins of the accumulator array
+	double fPeakBinValues[3]; //Values of the three highest bins of the accumulator array
 	
-	int fMaxBin = 0; //Bin number of the max bin of the accumulator array
-	int fSecondMaxBin = 0; //Bin number of the second max bin of the accumulator array
+	double fMaxBinValue = 0; //Value of the bin of the accumulator array with the highest value
 	
 	double fDistance1 = 0; //Hyper-distance between the best and second best parametrizations
 	double fDistance2 = 0; //Hyper-distance between the best and third best parametrizations
@@ -159,8 +155,18 @@ void VHoughTransform::analysis( VEvndispData* fData, VImageParameter* fParGeo )
 	
 	double fContained = 0; // Distance from the center of the ring to the center of the camera plus the ring radius in mm
 	
-	//Reset the accumulator array
-	fAccumulatorArray[ fData->getTelID() ]->Reset();
+	//Integer accumulator and lookup table for this telescope
+	vector <unsigned int>& iAccumulator = fAccumulator[ fData->getTelID() ];
+	vector <unsigned int>& iAccumulatorFilledBins = fAccumulatorFilledBins[ fData->getTelID() ];
+	const vector <unsigned int>& iLookupTableOffset = fHTLookupTableOffset[ fData->getTelID() ];
+	const vector <unsigned int>& iLookupTableBins = fHTLookupTableBins[ fData->getTelID() ];
+	
+	//Reset the accumulator array (only the bins filled in the previous event)
+	for( unsigned int iBinIndex = 0 ; iBinIndex < iAccumulatorFilledBins.size() ; iBinIndex++ )
+	{
+		iAccumulator[ iAccumulatorFilledBins[iBinIndex] ] = 0;
+	}
+	iAccumulatorFilledBins.clear();
 	
 	
 	for( int iChannelIndex = 0 ; iChannelIndex < fNumberOfChannels[ fData->getTelID() ] ; iChannelIndex++ ) // Loop over all the pixels
@@ -174,41 +180,26 @@ void VHoughTransform::analysis( VEvndispData* fData, VImageParameter* fParGeo )
 			
 			//Fill the Accumulator array here.
 			
-			sprintf( fBranchName, "Pixel %d", iChannelIndex ); //Set the branch name for ith channel
-			
-			TBranch* fBranch = fHTLookupTableTree[ fData->getTelID() ]->GetBranch( fBranchName ); //Grab the branch for the ith channel
-			
-			fBranch->SetAddress( &fCircleCoordinates ); //Map the arrays in the branch to circle coordinates array
-			
-			
-			//Loop over all circle coordinates for that pixel and fill the appropriate bins of the accumulator array
-			
-			//Set fCircleCoordinates[2] to a non-zero value to get into for the loop. The last entries in the lookup table are ( 0, 0, 0)
-			fCircleCoordinates[2] = 99;
-			
-			for( int iCircleParametrizationIndex = 0 ; fCircleCoordinates[2] != 0 ; iCircleParametrizationIndex++ ) //Loop over circle parametrizations until the r coordinate is zero (Last entries are 0,0,0)
+			//Loop over all circle parametrizations for that pixel and fill the appropriate bins of the accumulator array
+			for( unsigned int iCircleParametrizationIndex = iLookupTableOffset[iChannelIndex] ; iCircleParametrizationIndex < iLookupTableOffset[iChannelIndex + 1] ; iCircleParametrizationIndex++ )
 			{
 			
-				fBranch->GetEntry( iCircleParametrizationIndex ); // Get the jth circle parametrization for that pixel. Sets the values of fCircleCoordinates
+				unsigned int iBin = iLookupTableBins[iCircleParametrizationIndex];
 				
-				if( fCircleCoordinates[2] != 0 )// If the r coordinate is not zero (end of list), do this
+				//If bin content is zero and is filled, increment the number of non zero bins variable
+				if( iAccumulator[iBin] == 0 )
 				{
 				
-					//If bin content is zero and is filled, increment the number of non zero bins variable
-					if( ( fAccumulatorArray[ fData->getTelID() ]->GetBinContent( fAccumulatorArray[ fData->getTelID() ]->FindBin( fCircleCoordinates[0], fCircleCoordinates[1], fCircleCoordinates[2] ) ) ) == 0 )
-					{
+					fNumberOfNonZeroBins++;
+					iAccumulatorFilledBins.push_back( iBin );
 					
-						fNumberOfNonZeroBins++;
-						
-					}
-					
-					//Fill the appropriate bin of accumulator array with 1.0 (Binary image). For images with charge values, add the charge instead of 1.0.
-					fAccumulatorArray[ fData->getTelID() ]->Fill( fCircleCoordinates[0], fCircleCoordinates[1], fCircleCoordinates[2], 1.0 );
-					
-					//Add 1.0 to the sum of all bins variable.
-					fSumOfAllBins = fSumOfAllBins + 1.0;
-					
-				}//End of (if r coordinate is non zero) statement
+				}
+				
+				//Fill the appropriate bin of accumulator array with 1 (Binary image).
+				iAccumulator[iBin]++;
+				
+				//Add 1.0 to the sum of all bins variable.
+				fSumOfAllBins = fSumOfAllBins + 1.0;
 				
 			}//End of loop over circle parametrizations
 			
@@ -220,41 +211,33 @@ void VHoughTransform::analysis( VEvndispData* fData, VImageParameter* fParGeo )
 	//End of accumulator array filling.
 	
 	
-	//Get the best circle parametrizations from the accumulator array
+	//Get the three best circle parametrizations from the accumulator array (single scan over the non-zero bins)
+	findAccumulatorPeaks( fData->getTelID(), fPeakBins, fPeakBinValues );
 	
 	//Get best parameterized circle
 	
-	fMaxBin = fAccumulatorArray[ fData->getTelID() ]->GetMaximumBin( fAccumulatorBins[0], fAccumulatorBins[1], fAccumulatorBins[2] ); //Get the max bin of the accumulator array
+	fAccumulatorArray[ fData->getTelID() ]->GetBinXYZ( fPeakBins[0], fAccumulatorBins[0], fAccumulatorBins[1], fAccumulatorBins[2] ); //Get the max bin of the accumulator array
 	fBestParametrization[0] = fAccumulatorArray[ fData->getTelID() ]->GetXaxis()->GetBinCenter( fAccumulatorBins[0] ); //Get the x coordinate of the max bin
 	fBestParametrization[1] = fAccumulatorArray[ fData->getTelID() ]->GetYaxis()->GetBinCenter( fAccumulatorBins[1] ); //Get the y coordinate of the max bin
 	fBestParametrization[2] = fAccumulatorArray[ fData->getTelID() ]->GetZaxis()->GetBinCenter( fAccumulatorBins[2] ); //Get the r coordinate of the max bin
-	fMaxBinValue = fAccumulatorArray[ fData->getTelID() ]->GetBinContent( fAccumulatorBins[0], fAccumulatorBins[1], fAccumulatorBins[2] ); //Get the value of the max bin
+	fMaxBinValue = fPeakBinValues[0]; //Get the value of the max bin
 	
 	
 	//Get second best parametrized circle
 	
-	//Set the value of the max bin of the accumulator array to zero. Do this to use the GetMaximumBin() method.
-	fAccumulatorArray[ fData->getTelID() ]->SetBinContent( fAccumulatorBins[0], fAccumulatorBins[1], fAccumulatorBins[2], 0 );
-	
-	fSecondMaxBin = fAccumulatorArray[ fData->getTelID() ]->GetMaximumBin( fAccumulatorBins[0], fAccumulatorBins[1], fAccumulatorBins[2] ); //Get the second max bin of the accumulator array
+	fAccumulatorArray[ fData->getTelID() ]->GetBinXYZ( fPeakBins[1], fAccumulatorBins[0], fAccumulatorBins[1], fAccumulatorBins[2] ); //Get the second max bin of the accumulator array
 	fSecondBestParametrization[0] = fAccumulatorArray[ fData->getTelID() ]->GetXaxis()->GetBinCenter( fAccumulatorBins[0] ); //Get the x coordinate of the second max bin
 	fSecondBestParametrization[1] = fAccumulatorArray[ fData->getTelID() ]->GetYaxis()->GetBinCenter( fAccumulatorBins[1] ); //Get the y coordinate of the second max bin
 	fSecondBestParametrization[2] = fAccumulatorArray[ fData->getTelID() ]->GetZaxis()->GetBinCenter( fAccumulatorBins[2] ); //Get the r coordinate of the second max bin
-	fSecondMaxBinValue = fAccumulatorArray[ fData->getTelID() ]->GetBinContent( fAccumulatorBins[0], fAccumulatorBins[1], fAccumulatorBins[2] ); //Get the value of the second max bin
 	
 	
 	//Get the third best parametrized circle
-	
-	//Set the value of the second max bin of the accumulator array to zero. Do this to use the GetMaximumBin() method.
-	fAccumulatorArray[ fData->getTelID() ]->SetBinContent( fAccumulatorBins[0], fAccumulatorBins[1], fAccumulatorBins[2], 0 );
+	//(uses the bin of the second best parametrization, as in previous versions;
+	// the muon identification cut parameters alpha and beta are tuned on this TD)
 	
 	fThirdBestParametrization[0] = fAccumulatorArray[ fData->getTelID() ]->GetXaxis()->GetBinCenter( fAccumulatorBins[0] ); //Get the x coordinate of the third max bin
-	fThirdBestParametrization[1] = fAccumulatorArray[ fData->getTelID() ]->GetYaxis()->GetBinCenter( fAccumulatorBins[1] ); //Get the x coordinate of the third max bin
-	fThirdBestParametrization[2] = fAccumulatorArray[ fData->getTelID() ]->GetZaxis()->GetBinCenter( fAccumulatorBins[2] ); //Get the x coordinate of the third max bin
-	
-	//Refill the bins of the accumulator that were set to zero.
-	fAccumulatorArray[ fData->getTelID() ]->SetBinContent( fMaxBin, fMaxBinValue ); //Replace the bin content of the max bin
-	fAccumulatorArray[ fData->getTelID() ]->SetBinContent( fSecondMaxBin, fSecondMaxBinValue ); //Replace the bin content of the second max bin
+	fThirdBestParametrization[1] = fAccumulatorArray[ fData->getTelID() ]->GetYaxis()->GetBinCenter( fAccumulatorBins[1] ); //Get the y coordinate of the third max bin
+	fThirdBestParametrization[2] = fAccumulatorArray[ fData->getTelID() ]->GetZaxis()->GetBinCenter( fAccumulatorBins[2] ); //Get the r coordinate of the third max bin
 	
 	
 	//Calculate discriminating variables
@@ -516,6 +499,100 @@ void VHoughTransform::analysis( VEvndispData* fData, VImageParameter* fParGeo )
 
 
 
+//Method for finding the three highest bins of the accumulator array
+//Bins are ordered by content and (for equal content) by global bin number, as in successive calls of TH3D::GetMaximumBin()
+void VHoughTransform::findAccumulatorPeaks( unsigned int iTelescopeIndex, int* fPeakBins, double* fPeakBinValues )
+{
+
+	vector <unsigned int>& iAccumulator = fAccumulator[ iTelescopeIndex ];
+	vector <unsigned int>& iAccumulatorFilledBins = fAccumulatorFilledBins[ iTelescopeIndex ];
+	
+	//Number of bins (with and without under- and overflow bins)
+	int iNBinsX = fAccumulatorArray[ iTelescopeIndex ]->GetNbinsX();
+	int iNBinsY = fAccumulatorArray[ iTelescopeIndex ]->GetNbinsY();
+	int iNBinsZ = fAccumulatorArray[ iTelescopeIndex ]->GetNbinsZ();
+	int iNCellsX = iNBinsX + 2;
+	int iNCellsY = iNBinsY + 2;
+	
+	//Peaks not found yet
+	for( unsigned int iPeakIndex = 0 ; iPeakIndex < 3 ; iPeakIndex++ )
+	{
+		fPeakBins[iPeakIndex] = -1;
+		fPeakBinValues[iPeakIndex] = -1.;
+	}
+	
+	//Single scan over the non-zero bins
+	for( unsigned int iBinIndex = 0 ; iBinIndex < iAccumulatorFilledBins.size() ; iBinIndex++ )
+	{
+	
+		int iBin = ( int )iAccumulatorFilledBins[iBinIndex];
+		
+		//Ignore under- and overflow bins
+		int iBinX = iBin % iNCellsX;
+		int iBinY = ( iBin / iNCellsX ) % iNCellsY;
+		int iBinZ = iBin / ( iNCellsX * iNCellsY );
+		if( iBinX < 1 || iBinX > iNBinsX || iBinY < 1 || iBinY > iNBinsY || iBinZ < 1 || iBinZ > iNBinsZ )
+		{
+			continue;
+		}
+		
+		double iBinValue = ( double )iAccumulator[iBin];
+		
+		//Insert the bin into the list of peaks
+		for( unsigned int iPeakIndex = 0 ; iPeakIndex < 3 ; iPeakIndex++ )
+		{
+		
+			if( fPeakBins[iPeakIndex] < 0 || iBinValue > fPeakBinValues[iPeakIndex]
+					|| ( iBinValue == fPeakBinValues[iPeakIndex] && iBin < fPeakBins[iPeakIndex] ) )
+			{
+			
+				for( unsigned int iShiftIndex = 2 ; iShiftIndex > iPeakIndex ; iShiftIndex-- )
+				{
+					fPeakBins[iShiftIndex] = fPeakBins[iShiftIndex - 1];
+					fPeakBinValues[iShiftIndex] = fPeakBinValues[iShiftIndex - 1];
+				}
+				fPeakBins[iPeakIndex] = iBin;
+				fPeakBinValues[iPeakIndex] = iBinValue;
+				break;
+				
+			}
+			
+		}//End of inserting the bin into the list of peaks
+		
+	}//End of scan over the non-zero bins
+	
+	
+	//Less than three non-zero bins: use the first empty bins of the accumulator array
+	for( int iBinZ = 1 ; iBinZ <= iNBinsZ && fPeakBins[2] < 0 ; iBinZ++ )
+	{
+		for( int iBinY = 1 ; iBinY <= iNBinsY && fPeakBins[2] < 0 ; iBinY++ )
+		{
+			for( int iBinX = 1 ; iBinX <= iNBinsX && fPeakBins[2] < 0 ; iBinX++ )
+			{
+			
+				int iBin = iBinX + iNCellsX * ( iBinY + iNCellsY * iBinZ );
+				if( iAccumulator[iBin] == 0 )
+				{
+					for( unsigned int iPeakIndex = 0 ; iPeakIndex < 3 ; iPeakIndex++ )
+					{
+						if( fPeakBins[iPeakIndex] < 0 )
+						{
+							fPeakBins[iPeakIndex] = iBin;
+							fPeakBinValues[iPeakIndex] = 0.;
+							break;
+						}
+					}
+				}
+				
+			}
+		}
+	}//End of filling peaks with empty bins
+	
+	
+}//End of method for finding the three highest bins of the accumulator array
+
+
+
 //Method for initializing the accumulator array
 TH3D* VHoughTransform::initAccumulatorArray( int fRMinDpmt, int fRMaxDpmt, int fStepsPerPMTDiameter, unsigned int iTelescopeIndex )
 {
@@ -636,12 +713,9 @@ TH3D* VHoughTransform::initAccumulatorArray( int fRMinDpmt, int fRMaxDpmt, int f
 
 
 //Method for initializing the Hough transform lookup table
-TTree* VHoughTransform::initLookupTable( int fRMinDpmt, int fRMaxDpmt, int fStepsPerPMTDiameter, unsigned int iTelescopeIndex )
+void VHoughTransform::initLookupTable( int fRMinDpmt, int fRMaxDpmt, int fStepsPerPMTDiameter, unsigned int iTelescopeIndex )
 {
 
-	//Lookup table name
-	char fLookupTableName[100];
-	
 	//The number of circle templates used in the lookup table
 	int fNumberOfCircleTemplates = 0;
 	
@@ -655,9 +729,8 @@ TTree* VHoughTransform::initLookupTable( int fRMinDpmt, int fRMaxDpmt, int fStep
 		fTemplateCircle[iChannelIndex] = 0;
 	}
 	
-	char fHTBranchName[100]; //Names of the branches in the HT lookup table tree
-	
-	char fHTLeafName[100]; //Leaf names
+	//Accumulator bins of the circle parametrizations hitting each pixel
+	vector < vector <unsigned int> > iPixelCircleBins( fNumberOfChannels[ iTelescopeIndex ] );
 	
 	double fTemplateCircleCoordinates[3]; //Template circle parametrization coordinates
 	fTemplateCircleCoordinates[0] = 0; //x coordinate
@@ -669,29 +742,6 @@ TTree* VHoughTransform::initLookupTable( int fRMinDpmt, int fRMaxDpmt, int fStep
 	fTestPixel[1] = 0; //Y coordinate
 	
 	
-	//Set the tbale of the lookup table tree
-	sprintf( fLookupTableName, "Templates Tel%d", iTelescopeIndex );
-	
-	//Instantiate Hough transform lookup table tree.
-	TTree* iHTLookupTableTree = new TTree( fLookupTableName, fLookupTableName );
-	
-	
-	//Set up the branches in the tree. One brach for each pixel. Each brach will have circle parametrizations that hit that pixel.
-	for( int iChannelIndex = 0 ; iChannelIndex < fNumberOfChannels[ iTelescopeIndex ] ; iChannelIndex++ )
-	{
-	
-		//Sets the branch name
-		sprintf( fHTBranchName, "Pixel %d", iChannelIndex );
-		
-		//Sets the leaf name
-		sprintf( fHTLeafName, "Pixel %d Circle Coordinates[3]/D", iChannelIndex );
-		
-		//Setup the branch for that pixel
-		iHTLookupTableTree->Branch( fHTBranchName, &fTemplateCircleCoordinates, fHTLeafName );
-		
-	}// End of setting up the pixel branches in the HT lookup table tree
-	
-	
 	//Loop over the pixels for tempalte generation. (The center of the circle tempaltes is the center of the pixels)
 	for( int iPixelCenterIndex = 0 ; iPixelCenterIndex < fNumberOfChannels[ iTelescopeIndex ] ; iPixelCenterIndex++ )
 	{
@@ -777,31 +827,30 @@ TTree* VHoughTransform::initLookupTable( int fRMinDpmt, int fRMaxDpmt, int fStep
 			
 			
 			
-			//Fill the tree here
+			//Fill the lookup table here
 			
 			
-			//Add the circle coordinates to the nonzero pixels if the template is not a duplicate.
+			//Add the accumulator bin of the circle coordinates to the nonzero pixels if the template is not a duplicate.
 			if( !iIsDuplicate )
 			
 			{
 			
+				//Accumulator bin of the template circle (same binning as TH3D::Fill)
+				unsigned int iCircleBin = ( unsigned int )fAccumulatorArray[ iTelescopeIndex ]->FindBin( fTemplateCircleCoordinates[0],
+										  fTemplateCircleCoordinates[1],
+										  fTemplateCircleCoordinates[2] );
+										  
 				//Loop over the channels in the template
 				for( int iChannelIndex = 0 ; iChannelIndex < fNumberOfChannels[ iTelescopeIndex ] ; iChannelIndex++ )
 				
 				{
 				
-					//If the charge is non zero, fill the appropriate branch with the circle coordinates.
+					//If the charge is non zero, add the circle parametrization to the list of this pixel.
 					if( fTemplateCircle[iChannelIndex] != 0 )
 					
 					{
 					
-						//Fill the tree
-						
-						//Set the branch name
-						sprintf( fHTBranchName, "Pixel %d", iChannelIndex );
-						
-						//Fill the branch
-						iHTLookupTableTree->GetBranch( fHTBranchName )->Fill();
+						iPixelCircleBins[iChannelIndex].push_back( iCircleBin );
 						
 					}//End of checking if chargeval is non zero
 					
@@ -821,28 +870,20 @@ TTree* VHoughTransform::initLookupTable( int fRMinDpmt, int fRMaxDpmt, int fStep
 	}//End of loop over the centers of the pixels for template generation.
 	
 	
-	//Write an array of zeros at the end of the branches of the lookup table
-	
-	//Set the template circle coordinates to zero.
-	fTemplateCircleCoordinates[0] = 0.0;
-	fTemplateCircleCoordinates[1] = 0.0;
-	fTemplateCircleCoordinates[2] = 0.0;
-	
-	
-	//For each pixel, write (0,0,0) at the end of the branch)
+	//Pack the lookup table into one contiguous array (circle parametrizations for pixel i are
+	//stored between fHTLookupTableOffset[i] and fHTLookupTableOffset[i+1])
+	vector <unsigned int> iOffset( 1, 0 );
+	vector <unsigned int> iBins;
 	for( int iChannelIndex = 0 ; iChannelIndex < fNumberOfChannels[ iTelescopeIndex ] ; iChannelIndex++ )
 	{
 	
-		//Set the branch name
-		sprintf( fHTBranchName, "Pixel %d", iChannelIndex );
+		iBins.insert( iBins.end(), iPixelCircleBins[iChannelIndex].begin(), iPixelCircleBins[iChannelIndex].end() );
+		iOffset.push_back( iBins.size() );
 		
-		//Fill the branch with zeros
-		iHTLookupTableTree->GetBranch( fHTBranchName )->Fill();
-		
-	} //End of writing zeros.
-	
+	}//End of packing the lookup table
 	
-	return iHTLookupTableTree;
+	fHTLookupTableOffset.push_back( iOffset );
+	fHTLookupTableBins.push_back( iBins );
 	
 	
 }//End of method for initializing the Hough transform lookup table
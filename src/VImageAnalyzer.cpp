@@ -505,6 +505,7 @@ void VImageAnalyzer::initOutput()
 			cout << endl;
 			exit( EXIT_FAILURE );
 		}
+		getTreeIOPolicy()->apply( fOutputfile );
 	}
 	
 	// creating the directories in the root output file
@@ -565,6 +566,7 @@ void VImageAnalyzer::initTrees()
 		iSTRText << " (short tree)";
 	}
 	fVImageParameterCalculation->getParameters()->initTree( i_text, iSTRText.str().c_str(), fReader->isMC(), false, fRunPar->fmuonmode, fRunPar->fhoughmuonmode );
+	getTreeIOPolicy()->apply( fVImageParameterCalculation->getParameters()->getTree() );
 	
 	// for log likelihood method, book a second image parameter tree
 	if( fRunPar->fImageLL )
@@ -573,6 +575,7 @@ void VImageAnalyzer::initTrees()
 		char i_textTitle[300];
 		sprintf( i_textTitle, "Event Parameters, loglikelihood (Telescope %d)", getTelID() + 1 );
 		fVImageParameterCalculation->getLLParameters()->initTree( i_text, i_textTitle, fReader->isMC(), true, fRunPar->fmuonmode, fRunPar->fhoughmuonmode );
+		getTreeIOPolicy()->apply( fVImageParameterCalculation->getLLParameters()->getTree() );
 	}
 }
 
@@ -0,0 +1,418 @@
+/*! \class VImageLLFitter
+    \brief loglikelihood fit of a 2D Gaussian to the pixels of an image
+
+    Same model and loglikelihood as in get_LL_imageParameter_2DGauss()
+    (Poisson, parameters rho, meanX, sigmaX, meanY, sigmaY, signal).
+
+    Gradient and Hessian of the loglikelihood are calculated analytically
+    in one pass over the pixels; minimisation with Levenberg-Marquardt
+    steps (parameters at their limits are fixed for a step if the gradient
+    points outwards). Errors are calculated from the inverse Hessian
+    (corresponds to UP = 0.5 in Minuit).
+
+    Fit status as in Minuit: 3 = converged, full accurate covariance matrix;
+    2 = converged, covariance matrix not positive definite (errors from
+    diagonal only); 0 = fit failed
+
+*/
+
+#include "VImageLLFitter.h"
+
+VImageLLFitter::VImageLLFitter( unsigned int iMaxIterations )
+{
+	fDebug = false;
+	fMaxIterations = iMaxIterations;
+	fEDM_max = 1.e-5;
+	
+	for( unsigned int i = 0; i < fNPar; i++ )
+	{
+		fPar[i] = 0.;
+		fParMin[i] = -1.e99;
+		fParMax[i] =  1.e99;
+		fParErr[i] = 0.;
+	}
+	fLL = 0.;
+	fEDM = 0.;
+	fFitStat = 0;
+	fNIterations = 0;
+}
+
+/*
+ * remove all pixels (memory is kept for next image)
+ */
+void VImageLLFitter::clear()
+{
+	fX.clear();
+	fY.clear();
+	fN.clear();
+}
+
+/*
+ * set start value and limits of a parameter (no limits for iMin >= iMax)
+ */
+void VImageLLFitter::setParameter( unsigned int i, double iPar, double iMin, double iMax )
+{
+	if( i >= fNPar )
+	{
+		return;
+	}
+	if( iMin >= iMax )
+	{
+		iMin = -1.e99;
+		iMax =  1.e99;
+	}
+	fParMin[i] = iMin;
+	fParMax[i] = iMax;
+	fPar[i] = TMath::Min( TMath::Max( iPar, iMin ), iMax );
+	fParErr[i] = 0.;
+}
+
+void VImageLLFitter::getParameter( unsigned int i, double& iPar, double& iParErr )
+{
+	if( i >= fNPar )
+	{
+		return;
+	}
+	iPar = fPar[i];
+	iParErr = fParErr[i];
+}
+
+/*
+ * -log likelihood (as in get_LL_imageParameter_2DGauss) with
+ * gradient g and Hessian H (fNPar x fNPar, optional)
+ *
+ * derivatives are calculated from the derivatives of log S,
+ *    d(-LL)/da = sum (S-n) dlogS/da
+ *    d2(-LL)/dadb = sum S dlogS/da dlogS/db + (S-n) d2logS/dadb
+ *
+ */
+double VImageLLFitter::getLL( const double* p, double* g, double* H )
+{
+	if( g )
+	{
+		for( unsigned int i = 0; i < fNPar; i++ )
+		{
+			g[i] = 0.;
+		}
+	}
+	if( H )
+	{
+		for( unsigned int i = 0; i < fNPar * fNPar; i++ )
+		{
+			H[i] = 0.;
+		}
+	}
+	const double rho = p[0];
+	const double a = 1. - rho * rho;
+	if( a <= 0. || p[2] <= 0. || p[4] <= 0. || p[5] <= 0. )
+	{
+		return 1.e99;
+	}
+	// w = 1/2/(1-rho^2) and derivatives
+	const double w  = 0.5 / a;
+	const double w1 = rho / ( a * a );
+	const double w2 = 1. / ( a * a ) + 4. * rho * rho / ( a * a * a );
+	const double iLogNorm = log( p[5] / ( 2. * TMath::Pi() * p[2] * p[4] * sqrt( a ) ) );
+	const double sx2 = p[2] * p[2];
+	const double sy2 = p[4] * p[4];
+	
+	double LL = 0.;
+	double L[fNPar];
+	double LH[fNPar * fNPar];
+	for( unsigned int i = 0; i < fNPar * fNPar; i++ )
+	{
+		LH[i] = 0.;
+	}
+	const unsigned int nPixel = fN.size();
+	for( unsigned int i = 0; i < nPixel; i++ )
+	{
+		double u = ( fX[i] - p[1] ) / p[2];
+		double v = ( fY[i] - p[3] ) / p[4];
+		double q = u * u + v * v - 2. * rho * u * v;
+		double logS = iLogNorm - w * q;
+		double S = exp( logS );
+		double n = fN[i];
+		// assume Poisson fluctuations (neglecting background noise)
+		if( n > 0. && S > 0. )
+		{
+			LL += n * logS - S - n * log( n ) + n;
+		}
+		else
+		{
+			LL += -1. * S;
+			n = 0.;
+		}
+		if( !g )
+		{
+			continue;
+		}
+		
+		// derivatives of q with respect to u, v, rho
+		double q_u = 2. * ( u - rho * v );
+		double q_v = 2. * ( v - rho * u );
+		double q_r = -2. * u * v;
+		// derivatives of u (v) with respect to meanX, sigmaX (meanY, sigmaY)
+		double u_c = -1. / p[2];
+		double u_s = -u / p[2];
+		double v_c = -1. / p[4];
+		double v_s = -v / p[4];
+		
+		// first derivatives of log S
+		L[0] = rho / a - w1 * q - w * q_r;
+		L[1] = -w * q_u * u_c;
+		L[2] = -1. / p[2] - w * q_u * u_s;
+		L[3] = -w * q_v * v_c;
+		L[4] = -1. / p[4] - w * q_v * v_s;
+		L[5] = 1. / p[5];
+		
+		double iD = S - n;
+		for( unsigned int k = 0; k < fNPar; k++ )
+		{
+			g[k] += iD * L[k];
+		}
+		if( !H )
+		{
+			continue;
+		}
+		
+		// second derivatives of log S (upper triangle)
+		LH[0 * fNPar + 0] = ( 1. + rho * rho ) / ( a * a ) - w2 * q - 2. * w1 * q_r;
+		LH[0 * fNPar + 1] = -( w1 * q_u - 2. * w * v ) * u_c;
+		LH[0 * fNPar + 2] = -( w1 * q_u - 2. * w * v ) * u_s;
+		LH[0 * fNPar + 3] = -( w1 * q_v - 2. * w * u ) * v_c;
+		LH[0 * fNPar + 4] = -( w1 * q_v - 2. * w * u ) * v_s;
+		LH[1 * fNPar + 1] = -w * 2. * u_c * u_c;
+		LH[1 * fNPar + 2] = -w * ( 2. * u_c * u_s + q_u / sx2 );
+		LH[2 * fNPar + 2] = -w * ( 2. * u_s * u_s + q_u * 2. * u / sx2 ) + 1. / sx2;
+		LH[1 * fNPar + 3] = 2. * w * rho * u_c * v_c;
+		LH[1 * fNPar + 4] = 2. * w * rho * u_c * v_s;
+		LH[2 * fNPar + 3] = 2. * w * rho * u_s * v_c;
+		LH[2 * fNPar + 4] = 2. * w * rho * u_s * v_s;
+		LH[3 * fNPar + 3] = -w * 2. * v_c * v_c;
+		LH[3 * fNPar + 4] = -w * ( 2. * v_c * v_s + q_v / sy2 );
+		LH[4 * fNPar + 4] = -w * ( 2. * v_s * v_s + q_v * 2. * v / sy2 ) + 1. / sy2;
+		LH[5 * fNPar + 5] = -1. / ( p[5] * p[5] );
+		
+		for( unsigned int j = 0; j < fNPar; j++ )
+		{
+			for( unsigned int k = j; k < fNPar; k++ )
+			{
+				H[j * fNPar + k] += S * L[j] * L[k] + iD * LH[j * fNPar + k];
+			}
+		}
+	}
+	if( H )
+	{
+		for( unsigned int j = 0; j < fNPar; j++ )
+		{
+			for( unsigned int k = 0; k < j; k++ )
+			{
+				H[j * fNPar + k] = H[k * fNPar + j];
+			}
+		}
+	}
+	return -1. * LL;
+}
+
+/*
+ * solve A x = b for the free parameters (Cholesky decomposition)
+ *
+ * returns false if A is not positive definite
+ */
+bool VImageLLFitter::solve( const double* A, const double* b, double* x, const bool* iFree )
+{
+	unsigned int iIndex[fNPar];
+	unsigned int n = 0;
+	for( unsigned int i = 0; i < fNPar; i++ )
+	{
+		x[i] = 0.;
+		if( iFree[i] )
+		{
+			iIndex[n++] = i;
+		}
+	}
+	if( n == 0 )
+	{
+		return false;
+	}
+	double C[fNPar * fNPar];
+	for( unsigned int j = 0; j < n; j++ )
+	{
+		double s = A[iIndex[j] * fNPar + iIndex[j]];
+		for( unsigned int k = 0; k < j; k++ )
+		{
+			s -= C[j * fNPar + k] * C[j * fNPar + k];
+		}
+		if( !( s > 0. ) || !TMath::Finite( s ) )
+		{
+			return false;
+		}
+		C[j * fNPar + j] = sqrt( s );
+		for( unsigned int i = j + 1; i < n; i++ )
+		{
+			double t = A[iIndex[i] * fNPar + iIndex[j]];
+			for( unsigned int k = 0; k < j; k++ )
+			{
+				t -= C[i * fNPar + k] * C[j * fNPar + k];
+			}
+			C[i * fNPar + j] = t / C[j * fNPar + j];
+		}
+	}
+	double z[fNPar];
+	for( unsigned int i = 0; i < n; i++ )
+	{
+		double t = b[iIndex[i]];
+		for( unsigned int k = 0; k < i; k++ )
+		{
+			t -= C[i * fNPar + k] * z[k];
+		}
+		z[i] = t / C[i * fNPar + i];
+	}
+	for( int i = ( int )n - 1; i >= 0; i-- )
+	{
+		double t = z[i];
+		for( unsigned int k = i + 1; k < n; k++ )
+		{
+			t -= C[k * fNPar + i] * z[k];
+		}
+		z[i] = t / C[i * fNPar + i];
+	}
+	for( unsigned int i = 0; i < n; i++ )
+	{
+		x[iIndex[i]] = z[i];
+	}
+	return true;
+}
+
+/*
+ * minimise -log likelihood starting from the current parameter values
+ *
+ * returns false if the fit did not converge
+ */
+bool VImageLLFitter::fit()
+{
+	fFitStat = 0;
+	fNIterations = 0;
+	fEDM = -1.;
+	for( unsigned int i = 0; i < fNPar; i++ )
+	{
+		fParErr[i] = 0.;
+	}
+	if( fN.size() < fNPar )
+	{
+		return false;
+	}
+	
+	double g[fNPar];
+	double H[fNPar * fNPar];
+	double A[fNPar * fNPar];
+	double d[fNPar];
+	double mg[fNPar];
+	double p[fNPar];
+	bool   iFree[fNPar];
+	
+	fLL = getLL( fPar, g, H );
+	if( fLL >= 1.e99 )
+	{
+		return false;
+	}
+	double lambda = 1.e-3;
+	bool bConverged = false;
+	for( fNIterations = 0; fNIterations < fMaxIterations; fNIterations++ )
+	{
+		// parameters at limits are fixed if gradient points outwards
+		for( unsigned int i = 0; i < fNPar; i++ )
+		{
+			iFree[i] = !( ( fPar[i] <= fParMin[i] && g[i] > 0. ) || ( fPar[i] >= fParMax[i] && g[i] < 0. ) );
+			mg[i] = -1. * g[i];
+		}
+		// estimated distance to minimum (from Newton step)
+		if( solve( H, mg, d, iFree ) )
+		{
+			fEDM = 0.;
+			for( unsigned int i = 0; i < fNPar; i++ )
+			{
+				fEDM += 0.5 * mg[i] * d[i];
+			}
+			if( fEDM < fEDM_max )
+			{
+				bConverged = true;
+				break;
+			}
+		}
+		// Levenberg-Marquardt step
+		bool bStep = false;
+		while( lambda < 1.e10 )
+		{
+			for( unsigned int i = 0; i < fNPar * fNPar; i++ )
+			{
+				A[i] = H[i];
+			}
+			for( unsigned int i = 0; i < fNPar; i++ )
+			{
+				A[i * fNPar + i] += lambda * ( H[i * fNPar + i] != 0. ? fabs( H[i * fNPar + i] ) : 1. );
+			}
+			if( solve( A, mg, d, iFree ) )
+			{
+				for( unsigned int i = 0; i < fNPar; i++ )
+				{
+					p[i] = TMath::Min( TMath::Max( fPar[i] + d[i], fParMin[i] ), fParMax[i] );
+				}
+				double iLL = getLL( p );
+				if( iLL < fLL )
+				{
+					for( unsigned int i = 0; i < fNPar; i++ )
+					{
+						fPar[i] = p[i];
+					}
+					fLL = getLL( fPar, g, H );
+					lambda = TMath::Max( 0.1 * lambda, 1.e-9 );
+					bStep = true;
+					break;
+				}
+			}
+			lambda *= 10.;
+		}
+		if( !bStep )
+		{
+			break;
+		}
+	}
+	if( fDebug )
+	{
+		cout << "VImageLLFitter: converged " << bConverged << ", iterations " << fNIterations;
+		cout << ", -LL " << fLL << ", EDM " << fEDM << endl;
+	}
+	if( !bConverged )
+	{
+		return false;
+	}
+	
+	// errors from inverse Hessian
+	for( unsigned int i = 0; i < fNPar; i++ )
+	{
+		iFree[i] = true;
+	}
+	fFitStat = 3;
+	for( unsigned int k = 0; k < fNPar; k++ )
+	{
+		for( unsigned int i = 0; i < fNPar; i++ )
+		{
+			mg[i] = ( i == k ? 1. : 0. );
+		}
+		if( !solve( H, mg, d, iFree ) )
+		{
+			fFitStat = 2;
+			break;
+		}
+		fParErr[k] = ( d[k] > 0. ? sqrt( d[k] ) : 0. );
+	}
+	if( fFitStat == 2 )
+	{
+		for( unsigned int i = 0; i < fNPar; i++ )
+		{
+			fParErr[i] = ( H[i * fNPar + i] > 0. ? 1. / sqrt( H[i * fNPar + i] ) : 0. );
+		}
+	}
+	return true;
+}
@@ -22,6 +22,7 @@ VImageParameterCalculation::VImageParameterCalculation( unsigned int iShortTree,
 	fboolCalcTiming = false;
 	fDetectorGeometry = 0;
 	fHoughTransform = 0;
+	fLLImageFitter = new VImageLLFitter();
 	
 }
 
@@ -35,6 +36,7 @@ VImageParameterCalculation::~VImageParameterCalculation()
 	delete fParGeo;
 	delete fParLL;
 	delete fLLFitter;
+	delete fLLImageFitter;
 }
 
 
@@ -1350,7 +1352,9 @@ void VImageParameterCalculation::calcParameters()
 /*!
     The loglikelihood fit is thought to estimate signals in dead channels.
 
-    FCN is get_LL_imageParameter_2DGauss()
+    Fit with analytic gradient and Hessian (VImageLLFitter), start values
+    from the geometrical analysis. Minuit (FCN is get_LL_imageParameter_2DGauss())
+    is used only if this fit does not converge.
 
     Only signals in image/border pixels are taken into account, all other are set to zero.
 
@@ -1398,6 +1402,7 @@ vector<bool> VImageParameterCalculation::calcLL( bool iUseSums2 )
 	fll_X.clear();
 	fll_Y.clear();
 	fll_Sums.clear();
+	fLLImageFitter->clear();
 	// will be true if sum in pixel is estimated by fit
 	fLLEst.assign( fData->getSums().size(), false );
 	// maximum size of the camera (for fit parameter limits)
@@ -1458,6 +1463,7 @@ vector<bool> VImageParameterCalculation::calcLL( bool iUseSums2 )
 			{
 				i_sumMax = fll_Sums.back();
 			}
+			fLLImageFitter->addPixel( xi, yi, fll_Sums.back() );
 		}
 	}
 	if( fLLDebug )
@@ -1506,10 +1512,6 @@ vector<bool> VImageParameterCalculation::calcLL( bool iUseSums2 )
 	{
 		sigmaX = sigmaY = 0.1;
 	}
-	fLLFitter->Release( 0 );
-	fLLFitter->Release( 1 );
-	fLLFitter->Release( 3 );
-	fLLFitter->DefineParameter( 0, "rho", rho, step, 0., 0. );
 	if( fParGeo->sigmaX > 0. )
 	{
 		fdistXmin = cen_x - 2.*fParGeo->sigmaX;
@@ -1554,8 +1556,6 @@ vector<bool> VImageParameterCalculation::calcLL( bool iUseSums2 )
 			fdistXmax = 5.;
 		}
 	}
-	fLLFitter->DefineParameter( 1, "meanX", cen_x, step, fdistXmin, fdistXmax );
-	fLLFitter->DefineParameter( 2, "sigmaX", sigmaX, step, 0., 2.*fParGeo->sigmaX + 1. );
 	if( fParGeo->sigmaY > 0. )
 	{
 		fdistYmin = cen_y - 2.*fParGeo->sigmaY;
@@ -1600,42 +1600,76 @@ vector<bool> VImageParameterCalculation::calcLL( bool iUseSums2 )
 			fdistYmax = 5.;
 		}
 	}
-	fLLFitter->DefineParameter( 3, "meanY", cen_y, step, fdistYmin, fdistYmax );
-	fLLFitter->DefineParameter( 4, "sigmaY", sigmaY, step, 0., 2.*fParGeo->sigmaY + 1. );
-	fLLFitter->DefineParameter( 5, "signal", signal, step, 0., 1.e6 );
-	
 	if( fLLDebug )
 	{
 		cout << "FLLFITTER START " << rho << "\t" << cen_x << "\t" << sigmaX << "\t" << cen_y << "\t" << sigmaY << "\t" << signal << endl;
 	}
 	
-	// now do the minimization
-	fLLFitter->Command( "MIGRAD" );
-	// don't call HESS, trouble with migrad in the error calculation means usually to not use the errors and LL results
-	//    fLLFitter->Command( "HESSE" );
-	
-	// get fit statistics
+	// fit statistics
 	double edm = 0.;
 	double amin = 0.;
 	double errdef = 0.;
 	int nvpar = 0;
 	int nparx = 0;
 	int nstat = 0;
-	fLLFitter->mnstat( amin, edm, errdef, nvpar, nparx, nstat );
-	fParLL->Fitstat = nstat;
 	
-	if( fLLDebug )
+	// fit with analytic derivatives
+	// (signal start value: peak of 2D Gaussian at largest pixel sum)
+	double iRhoStart = TMath::Min( TMath::Max( rho, -0.99 ), 0.99 );
+	double iSignalStart = i_sumMax * 2. * TMath::Pi() * sigmaX * sigmaY * sqrt( 1. - iRhoStart * iRhoStart );
+	fLLImageFitter->setDebug( fLLDebug );
+	fLLImageFitter->setParameter( 0, iRhoStart, -0.999, 0.999 );
+	fLLImageFitter->setParameter( 1, cen_x, fdistXmin, fdistXmax );
+	fLLImageFitter->setParameter( 2, sigmaX, 1.e-4, 2.*fParGeo->sigmaX + 1. );
+	fLLImageFitter->setParameter( 3, cen_y, fdistYmin, fdistYmax );
+	fLLImageFitter->setParameter( 4, sigmaY, 1.e-4, 2.*fParGeo->sigmaY + 1. );
+	fLLImageFitter->setParameter( 5, iSignalStart, 1.e-6, 1.e6 );
+	if( fLLImageFitter->fit() )
+	{
+		fLLImageFitter->getParameter( 0, rho, drho );
+		fLLImageFitter->getParameter( 1, cen_x, dcen_x );
+		fLLImageFitter->getParameter( 2, sigmaX, dsigmaX );
+		fLLImageFitter->getParameter( 3, cen_y, dcen_y );
+		fLLImageFitter->getParameter( 4, sigmaY, dsigmaY );
+		fLLImageFitter->getParameter( 5, signal, dsignal );
+		amin = fLLImageFitter->getLL();
+		edm = fLLImageFitter->getEDM();
+		fParLL->Fitstat = fLLImageFitter->getFitStat();
+	}
+	// fit did not converge: Minuit minimization
+	else
 	{
-		cout << "FLLFITTER STAT " << nstat << endl;
+		fLLFitter->Release( 0 );
+		fLLFitter->Release( 1 );
+		fLLFitter->Release( 3 );
+		fLLFitter->DefineParameter( 0, "rho", rho, step, 0., 0. );
+		fLLFitter->DefineParameter( 1, "meanX", cen_x, step, fdistXmin, fdistXmax );
+		fLLFitter->DefineParameter( 2, "sigmaX", sigmaX, step, 0., 2.*fParGeo->sigmaX + 1. );
+		fLLFitter->DefineParameter( 3, "meanY", cen_y, step, fdistYmin, fdistYmax );
+		fLLFitter->DefineParameter( 4, "sigmaY", sigmaY, step, 0., 2.*fParGeo->sigmaY + 1. );
+		fLLFitter->DefineParameter( 5, "signal", signal, step, 0., 1.e6 );
+		
+		// now do the minimization
+		fLLFitter->Command( "MIGRAD" );
+		// don't call HESS, trouble with migrad in the error calculation means usually to not use the errors and LL results
+		//    fLLFitter->Command( "HESSE" );
+		
+		fLLFitter->mnstat( amin, edm, errdef, nvpar, nparx, nstat );
+		fParLL->Fitstat = nstat;
+		
+		// get fit results
+		fLLFitter->GetParameter( 0, rho, drho );
+		fLLFitter->GetParameter( 1, cen_x, dcen_x );
+		fLLFitter->GetParameter( 2, sigmaX, dsigmaX );
+		fLLFitter->GetParameter( 3, cen_y, dcen_y );
+		fLLFitter->GetParameter( 4, sigmaY, dsigmaY );
+		fLLFitter->GetParameter( 5, signal, dsignal );
 	}
 	
-	// get fit results
-	fLLFitter->GetParameter( 0, rho, drho );
-	fLLFitter->GetParameter( 1, cen_x, dcen_x );
-	fLLFitter->GetParameter( 2, sigmaX, dsigmaX );
-	fLLFitter->GetParameter( 3, cen_y, dcen_y );
-	fLLFitter->GetParameter( 4, sigmaY, dsigmaY );
-	fLLFitter->GetParameter( 5, signal, dsignal );
+	if( fLLDebug )
+	{
+		cout << "FLLFITTER STAT " << fParLL->Fitstat << endl;
+	}
 	
 	if( fLLDebug )
 	{
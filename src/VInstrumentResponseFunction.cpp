@@ -92,6 +92,7 @@ bool VInstrumentResponseFunction::initialize( string iName, string iType, unsign
 			i_irf.push_back( new VInstrumentResponseFunctionData() );
 			i_irf.back()->setHistogramLogAngbinning( fRunPara->fLogAngularBin );
 			i_irf.back()->setHistogramEbinning( fRunPara->fhistoNEbins );
+			i_irf.back()->setResolutionErrorBootstrap( fRunPara->fResolutionErrorBootstrapN, fRunPara->fResolutionErrorNThreads );
 			if( !i_irf.back()->initialize( hname, iType, iNTel, iMCMaxCoreRadius ) )
 			{
 				return false;
@@ -146,10 +147,6 @@ bool VInstrumentResponseFunction::fillEventData()
 		return false;
 	}
 	
-	// spectral weight
-	double i_weight = 1.;
-	// MC energy (log10)
-	
 	///////////////////////////////////
 	// get full data set
 	///////////////////////////////////
@@ -190,63 +187,80 @@ bool VInstrumentResponseFunction::fillEventData()
 			continue;
 		}
 		
-		//////////////////////////////////////
-		// loop over all az bins
-		for( unsigned int i_az = 0; i_az < fVMinAz.size(); i_az++ )
+		fillEvent();
+	}
+	//    fAnaCuts->printCutStatistics();
+	return true;
+}
+
+/*
+ * fill histograms for the current event of the data tree
+ * (all cuts are applied before)
+ *
+*/
+void VInstrumentResponseFunction::fillEvent()
+{
+	if( !fData )
+	{
+		return;
+	}
+	
+	// spectral weight
+	double i_weight = 1.;
+	
+	// loop over all az bins
+	for( unsigned int i_az = 0; i_az < fVMinAz.size(); i_az++ )
+	{
+	
+		// check which azimuth bin we are
+		if( fData->MCze > 3. )
 		{
-		
-			// check which azimuth bin we are
-			if( fData->MCze > 3. )
+			// confine MC az to -180., 180.
+			if( fData->MCaz > 180. )
 			{
-				// confine MC az to -180., 180.
-				if( fData->MCaz > 180. )
-				{
-					fData->MCaz -= 360.;
-				}
-				// expect bin like [135,-135]
-				if( fVMinAz[i_az] > fVMaxAz[i_az] )
-				{
-					if( fData->MCaz < fVMinAz[i_az] && fData->MCaz > fVMaxAz[i_az] )
-					{
-						continue;
-					}
-				}
-				// expect bin like [-135,-45.]
-				else
-				{
-					if( fData->MCaz < fVMinAz[i_az] || fData->MCaz > fVMaxAz[i_az] )
-					{
-						continue;
-					}
-				}
+				fData->MCaz -= 360.;
 			}
-			// loop over all spectral index
-			for( unsigned int s = 0; s < fVSpectralIndex.size(); s++ )
+			// expect bin like [135,-135]
+			if( fVMinAz[i_az] > fVMaxAz[i_az] )
 			{
-				// weight by spectral index
-				if( fSpectralWeight )
+				if( fData->MCaz < fVMinAz[i_az] && fData->MCaz > fVMaxAz[i_az] )
 				{
-					fSpectralWeight->setSpectralIndex( fVSpectralIndex[s] );
-					i_weight = fSpectralWeight->getSpectralWeight( fData->MCe0 );
+					continue;
 				}
-				else
+			}
+			// expect bin like [-135,-45.]
+			else
+			{
+				if( fData->MCaz < fVMinAz[i_az] || fData->MCaz > fVMaxAz[i_az] )
 				{
-					i_weight = 0.;
+					continue;
 				}
-				
-				// fill histograms
-				if( s < fIRFData.size() && i_az < fIRFData[s].size() )
+			}
+		}
+		// loop over all spectral index
+		for( unsigned int s = 0; s < fVSpectralIndex.size(); s++ )
+		{
+			// weight by spectral index
+			if( fSpectralWeight )
+			{
+				fSpectralWeight->setSpectralIndex( fVSpectralIndex[s] );
+				i_weight = fSpectralWeight->getSpectralWeight( fData->MCe0 );
+			}
+			else
+			{
+				i_weight = 0.;
+			}
+			
+			// fill histograms
+			if( s < fIRFData.size() && i_az < fIRFData[s].size() )
+			{
+				if( fIRFData[s][i_az] )
 				{
-					if( fIRFData[s][i_az] )
-					{
-						fIRFData[s][i_az]->fill( i_weight );
-					}
+					fIRFData[s][i_az]->fill( i_weight );
 				}
 			}
 		}
 	}
-	//    fAnaCuts->printCutStatistics();
-	return true;
 }
 
 bool VInstrumentResponseFunction::fillResolutionGraphs( vector< vector< VInstrumentResponseFunctionData* > > iIRFData )
@@ -1,7 +1,9 @@
 /*! \class VInstrumentResponseFunctionData
     \brief data class for instrumental response functions
 
-
+    resolution curves are containment quantiles calculated directly
+    from the 2D histogram bin contents; uncertainties are either
+    analytic (order statistics) or from bootstrap replicas
 
 */
 
@@ -25,6 +27,7 @@ VInstrumentResponseFunctionData::VInstrumentResponseFunctionData()
 	setEnergyReconstructionMethod();
 	
 	fHistogramList = 0;
+	setResolutionErrorBootstrap();
 	setHistogramEbinning();
 	setHistogramLogAngbinning();
 	setArrayCentre();
@@ -591,7 +594,7 @@ bool VInstrumentResponseFunctionData::terminate( double iContainmentProbability,
 		fContainmentProbability[i] = iContainmentProbability;
 		if( i != E_RELA )
 		{
-			calculateResolution( f2DHisto[i], fResolutionGraph[i], f2DHisto[i]->GetName(), iContainmentProbability, iContainmentProbabilityError );
+			calculateResolution( f2DHisto[i], fResolutionGraph[i], iContainmentProbability );
 		}
 		// for relative plots get mean and spread from each bin in the histogram
 		else
@@ -605,88 +608,131 @@ bool VInstrumentResponseFunctionData::terminate( double iContainmentProbability,
 
 /*!
     calculate ithresh (usually 68%) reconstruction accuracy from 2D histogram
+
+    containment is calculated per energy bin directly from the bin contents
+    (resolution is the centre of the first bin exceeding the containment probability)
+
+    uncertainties (require at least 20 effective events per energy bin):
+    - analytic (default): order statistics of the quantile, i.e. half the
+      difference between the (interpolated) quantiles at p -/+ sqrt( p(1-p)/N_eff )
+    - bootstrap: RMS of the (interpolated) quantiles of fResolutionErrorBootstrapN
+      Poisson-resampled replicas (energy bins are processed in parallel;
+      each energy bin has its own fixed seed, results do not depend on the
+      number of threads)
 */
-TList*  VInstrumentResponseFunctionData::calculateResolution( TH2D* iHistogram, TGraphErrors* iResult, string iHistoName, double iContainmentProbability, double iContainmentProbabilityError )
+bool VInstrumentResponseFunctionData::calculateResolution( TH2D* iHistogram, TGraphErrors* iResult, double iContainmentProbability )
 {
 	if( !iHistogram || !iResult )
 	{
-		return 0;
+		return false;
 	}
 	
-	TH1D* iTemp = 0;
-	TList* hList = new TList();
+	int nX = iHistogram->GetNbinsX();
+	int nY = iHistogram->GetNbinsY();
 	
-	char iname[800];
+	// bin edges on y-axis
+	vector< double > iEdges( nY + 1, 0. );
+	for( int j = 1; j <= nY + 1; j++ )
+	{
+		iEdges[j - 1] = iHistogram->GetYaxis()->GetBinLowEdge( j );
+	}
 	
-	// set number of points in graph
-	iResult->Set( iHistogram->GetNbinsX() );
+	// bin contents and effective number of events per bin for all energy bins
+	vector< double > iContent( nX * nY, 0. );
+	vector< double > iNeff( nX * nY, 0. );
+	vector< double > iNeffTot( nX, 0. );
 	
 	// temporary vectors
 	vector< double > vEnergy;
 	vector< double > vRes;
-	vector< double > vResE;
-	
-	double i_energy = 0.;
+	vector< int >    vBin;
 	
 	//////////////////////////////////////////////////////////////////////////////
-	// loop over all energy bins and project each bin into a TH1D
-	for( int i = 1; i <= iHistogram->GetNbinsX(); i++ )
+	// loop over all energy bins
+	for( int i = 1; i <= nX; i++ )
 	{
-	
-		// define temporary histogram and fill with projection
-		if( iHistoName.size() > 0 )
+		double iTotSum = 0.;
+		double iTotSumW2 = 0.;
+		for( int j = 1; j <= nY; j++ )
 		{
-			sprintf( iname, "%s_%d", iHistoName.c_str(), i );
+			double c = iHistogram->GetBinContent( i, j );
+			double e = iHistogram->GetBinError( i, j );
+			iContent[( i - 1 ) * nY + j - 1] = c;
+			if( c > 0. && e > 0. )
+			{
+				iNeff[( i - 1 ) * nY + j - 1] = c * c / ( e * e );
+			}
+			iTotSum += c;
+			iTotSumW2 += e * e;
 		}
-		else
+		if( iTotSumW2 > 0. )
 		{
-			sprintf( iname, "iH_%d", i );
+			iNeffTot[i - 1] = iTotSum * iTotSum / iTotSumW2;
 		}
-		iTemp = iHistogram->ProjectionY( iname, i, i );
-		sprintf( iname, "log_{10} E_{0} = %.2f", iHistogram->GetXaxis()->GetBinCenter( i ) );
-		iTemp->SetTitle( iname );
-		
-		i_energy = iHistogram->GetXaxis()->GetBinCenter( i );
 		
 		//////////////////////////////////////////////////////////
 		// calculate containment
-		double iTotSum = 0.;
-		// get total number of events in histogram
-		for( int j = 1; j <= iTemp->GetNbinsX(); j++ )
-		{
-			iTotSum += iTemp->GetBinContent( j );
-		}
 		if( iTotSum  > 0. )
 		{
 			double iTempSum = 0.;
-			for( int j = 1; j <= iTemp->GetNbinsX(); j++ )
+			for( int j = 1; j <= nY; j++ )
 			{
-				iTempSum += iTemp->GetBinContent( j );
+				iTempSum += iContent[( i - 1 ) * nY + j - 1];
 				if( iTempSum / iTotSum  > iContainmentProbability )
 				{
-					vEnergy.push_back( i_energy );
-					vRes.push_back( iTemp->GetBinCenter( j ) );
-					//	       vResE.push_back( getResolutionErrorfromToyMC( iTemp->GetBinCenter( j ), iTemp->GetEntries() ) );
-					// require at least 20 events to calculate a good RMS
-					if( iTemp->GetEntries() > 20. )
-					{
-						vResE.push_back( iTemp->GetRMS() / sqrt( iTemp->GetEntries() ) );
-					}
-					else
-					{
-						vResE.push_back( 0. );
-					}
+					vEnergy.push_back( iHistogram->GetXaxis()->GetBinCenter( i ) );
+					vRes.push_back( iHistogram->GetYaxis()->GetBinCenter( j ) );
+					vBin.push_back( i - 1 );
 					break;
 				}
 			}
 		}
-		if( iHistoName.size() > 0 )
+	}
+	
+	//////////////////////////////////////////////////////////
+	// uncertainties
+	vector< double > iError( nX, 0. );
+	if( fResolutionErrorBootstrapN > 0 )
+	{
+		unsigned int iNThreads = fResolutionErrorNThreads;
+		if( iNThreads > ( unsigned int )nX )
+		{
+			iNThreads = nX;
+		}
+		if( iNThreads <= 1 )
+		{
+			calculateResolutionErrorBootstrap( 0, 1, fResolutionErrorBootstrapN,
+											   &iContent, &iNeff, &iEdges, iContainmentProbability, &iError );
+		}
+		else
 		{
-			hList->Add( iTemp );
+			ROOT::EnableThreadSafety();
+			vector< thread > iThreads;
+			for( unsigned int t = 0; t < iNThreads; t++ )
+			{
+				iThreads.push_back( thread( VInstrumentResponseFunctionData::calculateResolutionErrorBootstrap,
+											t, iNThreads, fResolutionErrorBootstrapN,
+											&iContent, &iNeff, &iEdges, iContainmentProbability, &iError ) );
+			}
+			for( unsigned int t = 0; t < iThreads.size(); t++ )
+			{
+				iThreads[t].join();
+			}
 		}
-		else if( iTemp )
+	}
+	else
+	{
+		for( int i = 0; i < nX; i++ )
 		{
-			delete iTemp;
+			if( iNeffTot[i] <= 0. )
+			{
+				continue;
+			}
+			double iDelta = sqrt( iContainmentProbability * ( 1. - iContainmentProbability ) / iNeffTot[i] );
+			double p_low = TMath::Max( iContainmentProbability - iDelta, 0. );
+			double p_up  = TMath::Min( iContainmentProbability + iDelta, 1. );
+			iError[i] = 0.5 * ( getContainmentQuantile( &iContent[i * nY], &iEdges[0], nY, p_up )
+								- getContainmentQuantile( &iContent[i * nY], &iEdges[0], nY, p_low ) );
 		}
 	}
 	
@@ -695,59 +741,115 @@ TList*  VInstrumentResponseFunctionData::calculateResolution( TH2D* iHistogram,
 	for( unsigned i = 0; i < vEnergy.size(); i++ )
 	{
 		iResult->SetPoint( i, vEnergy[i], vRes[i] );
-		iResult->SetPointError( i, 0., vResE[i] );
+		// require at least 20 events for a meaningful uncertainty
+		if( iNeffTot[vBin[i]] > 20. )
+		{
+			iResult->SetPointError( i, 0., iError[vBin[i]] );
+		}
+		else
+		{
+			iResult->SetPointError( i, 0., 0. );
+		}
 	}
 	
-	return hList;
+	return true;
 }
 
-double VInstrumentResponseFunctionData::getResolutionErrorfromToyMC( double i68, double iN )
+/*
+ * containment quantile (linear interpolation inside bins)
+ *
+ * iContent: bin contents (iN bins)
+ * iEdges:   bin edges (iN+1 values)
+ */
+double VInstrumentResponseFunctionData::getContainmentQuantile( const double* iContent, const double* iEdges, unsigned int iN, double iP )
 {
-	if( i68 < 0. || iN < 1. )
+	double iTotSum = 0.;
+	for( unsigned int j = 0; j < iN; j++ )
+	{
+		if( iContent[j] > 0. )
+		{
+			iTotSum += iContent[j];
+		}
+	}
+	if( iTotSum <= 0. )
 	{
 		return 0.;
 	}
-	
-	// number of times to run the experiment
-	const int nRun = 100;
-	
-	// histogram with results from each experiment
-	TH1D h68( "h68", "h68", 1000, 0., 1.5 );
-	
-	// histogram with angular differences
-	TH1D hDiff( "hDiff", "", 1000, 0., 1.0 );
-	
-	// normal distribution
-	TF1 f( "f", "gaus(0)", 0., 5. );
-	f.SetParameter( 0, 1. );
-	f.SetParameter( 1, 0. );
-	// normalized to 2D distribution, see Minuit table 7.1
-	f.SetParameter( 2, i68 / sqrt( 2.41 ) );
-	
-	double x = 0;
-	double y = 0.;
-	double q[] = { 0 };
-	int nq = 1;
-	double d[] = { 0.68 };
-	
-	for( int j = 0; j < nRun; j++ )
+	double iTarget = iP * iTotSum;
+	double iTempSum = 0.;
+	double iLast = iEdges[iN];
+	for( unsigned int j = 0; j < iN; j++ )
 	{
-		hDiff.Reset();
-		for( int i = 0; i < iN; i++ )
+		if( iContent[j] <= 0. )
 		{
-			x = f.GetRandom();
-			y = f.GetRandom();
-			
-			hDiff.Fill( sqrt( x * x + y * y ) );
+			continue;
 		}
-		if( hDiff.GetEntries() > 0 )
+		if( iTempSum + iContent[j] >= iTarget )
 		{
-			hDiff.GetQuantiles( nq, q, d );
-			h68.Fill( q[0] );
+			return iEdges[j] + ( iTarget - iTempSum ) / iContent[j] * ( iEdges[j + 1] - iEdges[j] );
+		}
+		iTempSum += iContent[j];
+		iLast = iEdges[j + 1];
+	}
+	return iLast;
+}
+
+/*
+ * bootstrap uncertainties of containment quantiles
+ *
+ * energy bins iThread, iThread + iNThreads, ... are processed by this call;
+ * each replica draws the effective number of events in each bin from a
+ * Poisson distribution (weights per bin are kept)
+ */
+void VInstrumentResponseFunctionData::calculateResolutionErrorBootstrap( unsigned int iThread, unsigned int iNThreads, unsigned int iNReplicas,
+		vector< double >* iContent, vector< double >* iNeff, vector< double >* iEdges,
+		double iContainmentProbability, vector< double >* iError )
+{
+	if( !iContent || !iNeff || !iEdges || !iError || iEdges->size() < 2 || iNThreads == 0 )
+	{
+		return;
+	}
+	unsigned int nY = iEdges->size() - 1;
+	unsigned int nX = iError->size();
+	vector< double > iReplica( nY, 0. );
+	for( unsigned int i = iThread; i < nX; i += iNThreads )
+	{
+		// fixed seed per energy bin
+		TRandom3 iRandom( 4357 + i );
+		double iSum = 0.;
+		double iSum2 = 0.;
+		unsigned int iN = 0;
+		for( unsigned int r = 0; r < iNReplicas; r++ )
+		{
+			bool bFilled = false;
+			for( unsigned int j = 0; j < nY; j++ )
+			{
+				double n = ( *iNeff )[i * nY + j];
+				iReplica[j] = 0.;
+				if( n > 0. )
+				{
+					iReplica[j] = ( double )iRandom.Poisson( n ) * ( *iContent )[i * nY + j] / n;
+					if( iReplica[j] > 0. )
+					{
+						bFilled = true;
+					}
+				}
+			}
+			if( !bFilled )
+			{
+				continue;
+			}
+			double q = getContainmentQuantile( &iReplica[0], &( *iEdges )[0], nY, iContainmentProbability );
+			iSum  += q;
+			iSum2 += q * q;
+			iN++;
+		}
+		if( iN > 1 )
+		{
+			double iMean = iSum / ( double )iN;
+			( *iError )[i] = sqrt( TMath::Max( iSum2 / ( double )iN - iMean * iMean, 0. ) );
 		}
 	}
-	
-	return h68.GetRMS();
 }
 
 
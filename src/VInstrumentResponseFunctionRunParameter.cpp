@@ -29,6 +29,8 @@ VInstrumentResponseFunctionRunParameter::VInstrumentResponseFunctionRunParameter
 	fLogAngularBin = 100;                 // Angular resolution Log10 (bins)
 	fResponseMatricesEbinning = 500;      // bins in the ResponseMatrices
 	fhistoNEbins = fEnergyAxisBins_log10; // E binning (affects 2D histograms only)
+	fResolutionErrorBootstrapN = 0;       // analytic uncertainties of resolution curves
+	fResolutionErrorNThreads = 1;
 	
 	fCutFileName = "";
 	fGammaHadronCutSelector = -1;
@@ -190,6 +192,19 @@ bool VInstrumentResponseFunctionRunParameter::readRunParameterFromTextFile( stri
 					is_stream >> fLogAngularBin;
 				}
 			}
+			// uncertainties of resolution curves from bootstrap replicas
+			// (number of replicas, number of threads; default: analytic order statistics)
+			else if( temp == "RESOLUTIONERRORBOOTSTRAP" )
+			{
+				if( !( is_stream >> std::ws ).eof() )
+				{
+					is_stream >> fResolutionErrorBootstrapN;
+				}
+				if( !( is_stream >> std::ws ).eof() )
+				{
+					is_stream >> fResolutionErrorNThreads;
+				}
+			}
 			// number of fine-bins for the response matrices (likelihood analysis)
 			else if( temp == "RESPONSEMATRICESEBINS" )
 			{
@@ -683,6 +698,16 @@ void VInstrumentResponseFunctionRunParameter::print()
 		cout << "CR energy spectrum used for weighted rate histogram: ";
 		cout << fCREnergySpectrumFile << " (ID" << fCREnergySpectrumID << ")" << endl;
 	}
+	cout << endl;
+	cout << "uncertainties of resolution curves: ";
+	if( fResolutionErrorBootstrapN > 0 )
+	{
+		cout << fResolutionErrorBootstrapN << " bootstrap replicas (" << fResolutionErrorNThreads << " threads)";
+	}
+	else
+	{
+		cout << "analytic (order statistics)";
+	}
 	cout << endl << endl;
 }
 
@@ -4,6 +4,8 @@ VLowGainCalibrator::VLowGainCalibrator( int run, int sw, bool isInnerHigh, TStri
 {
 
 	fIsOk = false;
+	fChargesRead = false;
+	fNThreads = 1;
 	if( outdir == "" )
 	{
 		outdir = dir;
@@ -141,7 +143,8 @@ void VLowGainCalibrator::setMonitorChargeOptions( int nLive_min, double sum_min,
 	fUseMedian = useMedian;
 	fSumMonitor_min = sum_min;
 	fLightLevelWidth = width;
-	
+	// monitor charges depend on these options
+	fChargesRead = false;
 }
 
 void VLowGainCalibrator::setFitOptions( int n_min, double pure_min, double sat_max, double nevents_min, double prob_min, double b_max )
@@ -270,27 +273,108 @@ double VLowGainCalibrator::calcMonitorCharge( int tel, int ientry )
 }
 
 
-bool VLowGainCalibrator::makeMonitorChargeHists( )
-{
+/*
 
+    read all charges needed for the calibration from the DST tree
+
+    (single pass over the tree; monitor charges are calculated once per
+     event and telescope, charges of the channels to be calibrated are
+     stored in compact per-telescope arrays)
+
+*/
+bool VLowGainCalibrator::readCharges()
+{
+	if( fChargesRead )
+	{
+		return true;
+	}
+	if( !fDsttree )
+	{
+		return false;
+	}
+	const unsigned int nChan = fChan_stop - fChan_start;
+	unsigned int nEvents = 0;
+	if( fDsttree->GetEntries() > fMinDSTEvent )
+	{
+		nEvents = TMath::Min( ( unsigned int )fDsttree->GetEntries(), fMaxDSTEvent ) - fMinDSTEvent;
+	}
+	fEventNumber.clear();
+	fEventNumber.reserve( nEvents );
 	for( int tel = 0; tel < fNTel; tel++ )
 	{
-		fMonitorChargeHist[tel]->Reset();
+		fQMon[tel].clear();
+		fQMon[tel].reserve( nEvents );
+		fQ[tel].clear();
+		fQ[tel].reserve( nEvents * nChan );
+		fQFlag[tel].clear();
+		fQFlag[tel].reserve( nEvents * nChan );
+		fQRawMax[tel].clear();
+		fQRawMax[tel].reserve( nEvents * nChan );
 	}
 	
 	for( unsigned int iEntry = fMinDSTEvent; iEntry < fDsttree->GetEntries() && iEntry < fMaxDSTEvent; iEntry++ )
 	{
 		fDsttree->GetEntry( iEntry );
 		
-		for( int tel = 0; tel < 4; tel++ )
+		fEventNumber.push_back( eventNumber );
+		for( int tel = 0; tel < fNTel; tel++ )
 		{
-		
-			double median = calcMonitorCharge( tel );
-			
-			fMonitorChargeHist[tel]->Fill( median );
-			
+			fQMon[tel].push_back( calcMonitorCharge( tel ) );
+			for( int iChan = fChan_start; iChan < fChan_stop; iChan++ )
+			{
+				fQ[tel].push_back( sum2[tel][iChan] );
+				fQFlag[tel].push_back( ( HiLo[tel][iChan] ? 1 : 0 ) | ( dead[tel][iChan] ? 2 : 0 ) );
+				fQRawMax[tel].push_back( RawMax[tel][iChan] );
+			}
+		}
+	}
+	cout << "read charges for " << fEventNumber.size() << " events" << endl;
+	fChargesRead = true;
+	return true;
+}
+
+/*
+
+    run jobs (in parallel for more than one job)
+
+*/
+void VLowGainCalibrator::runJobs( vector< sLowGainCalibratorJob >& iJobs, void ( *iFunction )( sLowGainCalibratorJob* ) )
+{
+	if( iJobs.size() == 1 )
+	{
+		iFunction( &iJobs[0] );
+		return;
+	}
+	vector< thread > iThreads;
+	for( unsigned int j = 0; j < iJobs.size(); j++ )
+	{
+		iThreads.push_back( thread( iFunction, &iJobs[j] ) );
+	}
+	for( unsigned int j = 0; j < iThreads.size(); j++ )
+	{
+		iThreads[j].join();
+	}
+}
+
+bool VLowGainCalibrator::makeMonitorChargeHists( )
+{
+
+	for( int tel = 0; tel < fNTel; tel++ )
+	{
+		fMonitorChargeHist[tel]->Reset();
+	}
+	
+	if( !readCharges() )
+	{
+		return false;
+	}
+	
+	for( int tel = 0; tel < fNTel; tel++ )
+	{
+		for( unsigned int i = 0; i < fQMon[tel].size(); i++ )
+		{
+			fMonitorChargeHist[tel]->Fill( fQMon[tel][i] );
 		}
-		
 	}
 	return true;
 	
@@ -669,8 +753,71 @@ int VLowGainCalibrator::checkLightLevels( int tel, bool iDraw )
 
 
 
+/*
+
+    light level for a given monitor charge (-1 if outside of all levels)
+
+*/
+int VLowGainCalibrator::getLightLevel( int tel, double qmon )
+{
+	for( unsigned int ilevel = 0; ilevel < fNLightLevels[tel]; ilevel++ )
+	{
+		if( qmon < fLightLevelMean[tel][ilevel] + fLightLevelWidth * fLightLevelSigma[tel][ilevel] &&  qmon > fLightLevelMean[tel][ilevel] - fLightLevelWidth * fLightLevelSigma[tel][ilevel] )
+		{
+			return ilevel;
+		}
+	} //levels
+	return -1;
+}
+
+/*
+
+    accumulate mean charges per light level for all channels of the telescopes of this job
+
+*/
+void VLowGainCalibrator::accumulateChargesJob( sLowGainCalibratorJob* iJob )
+{
+	VLowGainCalibrator* c = iJob->fCalibrator;
+	const unsigned int nChan = c->fChan_stop - c->fChan_start;
+	
+	for( unsigned int t = 0; t < iJob->fTel.size(); t++ )
+	{
+		int tel = iJob->fTel[t];
+		for( unsigned int ev = 0; ev < c->fQMon[tel].size(); ev++ )
+		{
+			int level = c->getLightLevel( tel, c->fQMon[tel][ev] );
+			if( level < 0 )
+			{
+				continue;
+			}
+			//todo test this: cut on start time of the summation window (sumfirst) for hi/lo channels
+			for( unsigned int i = 0; i < nChan; i++ )
+			{
+				unsigned int iIndex = ev * nChan + i;
+				if( c->fQFlag[tel][iIndex] & 2 )
+				{
+					continue;
+				}
+				int hilo = c->fQFlag[tel][iIndex] & 1;
+				int iChan = c->fChan_start + i;
+				double q = c->fQ[tel][iIndex] / ( hilo ? c->fLMult[tel] : 1.0 );
+				c->fN   [tel][iChan][hilo][level]++;
+				c->fNSat[tel][iChan][hilo][level] += ( c->fQRawMax[tel][iIndex] == 255 ? 1 : 0 );
+				c->fY   [tel][iChan][hilo][level] += q;
+				c->fY2  [tel][iChan][hilo][level] += q * q;
+			}//chan
+		}//ientry
+	}//tel
+}
+
 bool VLowGainCalibrator::calculateMeanCharges()
 {
+	if( !readCharges() )
+	{
+		return false;
+	}
+	const unsigned int nChan = fChan_stop - fChan_start;
+	
 	//initialise vectors
 	for( int tel = 0; tel < fNTel; tel++ )
 	{
@@ -687,109 +834,52 @@ bool VLowGainCalibrator::calculateMeanCharges()
 		}//chan
 	}//tel
 	
-	for( unsigned int ientry = fMinDSTEvent; ientry < fDsttree->GetEntries() && ientry < fMaxDSTEvent ; ientry++ )
+	// telescopes are processed in parallel
+	unsigned int iNJobs = TMath::Max( 1u, TMath::Min( fNThreads, ( unsigned int )fNTel ) );
+	vector< sLowGainCalibratorJob > iJobs( iNJobs );
+	for( int tel = 0; tel < fNTel; tel++ )
 	{
+		iJobs[tel % iNJobs].fCalibrator = this;
+		iJobs[tel % iNJobs].fTel.push_back( tel );
+	}
+	runJobs( iJobs, VLowGainCalibrator::accumulateChargesJob );
 	
-		fDsttree->GetEntry( ientry );
-		
-		for( int tel = 0; tel < fNTel; tel++ )
+	// debug trees (all events)
+	for( int tel = 0; tel < fNTel && fDebugChannels.size() > 0; tel++ )
+	{
+		fTree_tel = tel + 1;
+		for( unsigned int ev = 0; ev < fQMon[tel].size(); ev++ )
 		{
-		
-			fTree_tel = tel + 1;
-			
-			//if( fNLightLevels[tel] == 0 ) continue;	//don't bother if there are no light levels.
-			
-			double qmon = calcMonitorCharge( tel );
-			int level = -1;
-			for( unsigned int ilevel = 0; ilevel < fNLightLevels[tel]; ilevel++ )
-			{
-				if( qmon < fLightLevelMean[tel][ilevel] + fLightLevelWidth * fLightLevelSigma[tel][ilevel] &&  qmon > fLightLevelMean[tel][ilevel] - fLightLevelWidth * fLightLevelSigma[tel][ilevel] )
-				{
-					level = ilevel;
-					break;
-				}
-			} //levels
-			
-			//first calculate mean/sdev of start time for hi/lo channels.
-			
-			double start[2];
-			start[0] = 0;
-			start[1] = 0;
-			
-			double start2[2];
-			start2[0] = 0;
-			start2[1] = 0;
-			
-			double N[2];
-			N[0] = 0;
-			N[1] = 0;
-			
-			for( int iChan = fChan_start; iChan < fChan_stop; iChan++ )
-			{
-			
-				if( dead[tel][iChan] )
-				{
-					continue;
-				}
-				
-				N	[ HiLo[tel][iChan] ] ++;
-				
-				start	[ HiLo[tel][iChan] ] += sumfirst[tel][iChan];
-				start2	[ HiLo[tel][iChan] ] += sumfirst[tel][iChan] * sumfirst[tel][iChan];
-				
-			}//chan
-			
-			for( int hilo = 0; hilo < 2; hilo++ )
+			double qmon = fQMon[tel][ev];
+			int level = getLightLevel( tel, qmon );
+			for( unsigned int i = 0; i < nChan; i++ )
 			{
-				if( N[hilo] == 0 )
-				{
-					continue ;
-				}
-				start[hilo] /= N[hilo];
-				start2[hilo] /= N[hilo];
-				start2[hilo] = sqrt( start2[hilo] - start[hilo] * start[hilo] );
-			}//hilo
-			
-			for( int iChan = fChan_start; iChan < fChan_stop; iChan++ )
-			{
-			
-				if( dead[tel][iChan] )
+				unsigned int iIndex = ev * nChan + i;
+				int iChan = fChan_start + i;
+				if( ( fQFlag[tel][iIndex] & 2 ) || !isDebugChannel( iChan ) )
 				{
 					continue;
 				}
-				//todo test this			if( fabs( sumfirst[tel][iChan] - start[ HiLo[tel][iChan] ] ) > 2*start2[ HiLo[tel][iChan] ] ) continue;
-				
+				int hilo = fQFlag[tel][iIndex] & 1;
+				fTree_eventNumber = fEventNumber[ev];
+				fTree_Channel = iChan;
+				fTree_level = level;
+				fTree_hilo = hilo;
+				fTree_Q = fQ[tel][iIndex] / ( hilo ? fLMult[tel] : 1.0 ) ;
+				fTree_QMon = qmon;
+				fTree_RawMax = fQRawMax[tel][iIndex];
 				if( level > -1 )
 				{
-					fN   [tel][iChan][ HiLo[tel][iChan] ][level]++;
-					fNSat[tel][iChan][ HiLo[tel][iChan] ][level] += ( RawMax[tel][iChan] == 255 ? 1 : 0 );
-					fY   [tel][iChan][ HiLo[tel][iChan] ][level] += sum2[tel][iChan] / ( HiLo[tel][iChan] ? fLMult[tel] : 1.0 );
-					fY2  [tel][iChan][ HiLo[tel][iChan] ][level] += TMath::Power( sum2[tel][iChan] / ( HiLo[tel][iChan] ? fLMult[tel] : 1.0 ), 2 ) ;
+					fTree_QMonMean = fLightLevelMean[tel][level];
 				}
-				if( isDebugChannel( iChan ) )
+				else
 				{
-					fTree_eventNumber = eventNumber;
-					fTree_Channel = iChan;
-					fTree_level = level;
-					fTree_hilo = HiLo[tel][iChan];
-					fTree_Q = sum2[tel][iChan] / ( HiLo[tel][iChan] ? fLMult[tel] : 1.0 ) ;
-					fTree_QMon = qmon;
-					fTree_RawMax = RawMax[tel][iChan];
-					if( level > -1 )
-					{
-						fTree_QMonMean = fLightLevelMean[tel][level];
-					}
-					else
-					{
-						fTree_QMonMean = -1;
-					}
-					fDebugtree[tel]->Fill();
+					fTree_QMonMean = -1;
 				}
+				fDebugtree[tel]->Fill();
 			}//chan
-			
-		}//tel
-		
-	}//ientry
+		}//ientry
+	}//tel
 	
 	//now fix normalization etc.
 	
@@ -814,9 +904,210 @@ bool VLowGainCalibrator::calculateMeanCharges()
 	return true;
 }
 
-bool VLowGainCalibrator::doTheFit()
+/*
+
+    fit y = m * x to the fit points (errors in x and y)
+
+    minimises chi2 = sum (y - m x)^2 / (ey^2 + m^2 ex^2) (effective variance,
+    as for the fit of a TGraphErrors) with Newton steps using the analytic
+    first and second derivatives; error of m from the second derivative
+
+    (no use of global fitter objects; can be called from several threads)
+
+*/
+bool VLowGainCalibrator::fitProportional( sLowGainFitResult* iFit )
+{
+	unsigned int n = iFit->fX.size();
+	// start value: weighted least squares ignoring the errors in x
+	double sxy = 0.;
+	double sxx = 0.;
+	for( unsigned int i = 0; i < n; i++ )
+	{
+		double w = 1.;
+		if( iFit->fYErr[i] > 0. )
+		{
+			w = 1. / ( iFit->fYErr[i] * iFit->fYErr[i] );
+		}
+		sxy += w * iFit->fX[i] * iFit->fY[i];
+		sxx += w * iFit->fX[i] * iFit->fX[i];
+	}
+	if( sxx <= 0. )
+	{
+		return false;
+	}
+	double m = sxy / sxx;
+	double chi2 = 0.;
+	double d1 = 0.;
+	double d2 = 0.;
+	int    nUsed = 0;
+	bool   bConverged = false;
+	for( unsigned int iter = 0; iter < 100; iter++ )
+	{
+		// chi2 and derivatives at m
+		chi2 = 0.;
+		d1 = 0.;
+		d2 = 0.;
+		nUsed = 0;
+		for( unsigned int i = 0; i < n; i++ )
+		{
+			double x = iFit->fX[i];
+			double e2 = iFit->fXErr[i] * iFit->fXErr[i];
+			double v = iFit->fYErr[i] * iFit->fYErr[i] + m * m * e2;
+			if( v <= 0. )
+			{
+				continue;
+			}
+			double r = iFit->fY[i] - m * x;
+			chi2 += r * r / v;
+			d1 += -2. * x * r / v - 2. * m * e2 * r * r / ( v * v );
+			d2 += 2. * x * x / v + 8. * m * e2 * x * r / ( v * v ) - 2. * e2 * r * r / ( v * v )
+				  + 8. * m * m * e2 * e2 * r * r / ( v * v * v );
+			nUsed++;
+		}
+		if( nUsed == 0 )
+		{
+			return false;
+		}
+		double iStep = 0.;
+		if( d2 > 0. )
+		{
+			iStep = -d1 / d2;
+		}
+		else
+		{
+			// not convex: fixed-point step of the effective variance method
+			double a = 0.;
+			double b = 0.;
+			for( unsigned int i = 0; i < n; i++ )
+			{
+				double v = iFit->fYErr[i] * iFit->fYErr[i] + m * m * iFit->fXErr[i] * iFit->fXErr[i];
+				if( v > 0. )
+				{
+					a += iFit->fX[i] * iFit->fY[i] / v;
+					b += iFit->fX[i] * iFit->fX[i] / v;
+				}
+			}
+			if( b <= 0. )
+			{
+				return false;
+			}
+			iStep = a / b - m;
+		}
+		if( TMath::Abs( iStep ) < 1.e-10 * ( 1. + TMath::Abs( m ) ) )
+		{
+			bConverged = true;
+			break;
+		}
+		m += iStep;
+	}
+	// no convergence: chi2 and error would refer to the point before the last step
+	if( !bConverged )
+	{
+		return false;
+	}
+	iFit->fM = m;
+	iFit->fMErr = ( d2 > 0. ? sqrt( 2. / d2 ) : 99999 );
+	iFit->fChi2 = chi2;
+	iFit->fNDF = nUsed - 1;
+	return true;
+}
+
+/*
+
+    gain ratio fits for the list of fits of this job
+
+*/
+void VLowGainCalibrator::fitJob( sLowGainCalibratorJob* iJob )
 {
+	VLowGainCalibrator* c = iJob->fCalibrator;
+	for( unsigned int j = 0; j < iJob->fFit.size(); j++ )
+	{
+		sLowGainFitResult* r = &c->fFitResults[iJob->fFit[j]];
+		int tel = r->fTel;
+		int iChan = r->fChannel;
+		int hilo = r->fHiLo;
+		for( unsigned int i = 0; i < c->fNLightLevels[tel]; i++ )
+		{
+			if( c->fN[tel][iChan][hilo][i] > c->fFitNEvents_min 									//min number events
+					&& ( double )c->fN[tel][iChan][hilo][i] / ( c->fN[tel][iChan][0][i] + c->fN[tel][iChan][1][i] ) > c->fFitPure_min	//min purity
+					&& ( double )c->fNSat[tel][iChan][hilo][i] / c->fN[tel][iChan][hilo][i] < c->fFitRSat_max				//max saturation
+			  )
+			{
+				double iVar = c->fY2[tel][iChan][hilo][i] - c->fY[tel][iChan][hilo][i] * c->fY[tel][iChan][hilo][i];
+				r->fX.push_back( c->fLightLevelMean[tel][i] );
+				r->fY.push_back( c->fY[tel][iChan][hilo][i] );
+				r->fXErr.push_back( c->fLightLevelSigma[tel][i] );
+				r->fYErr.push_back( sqrt( TMath::Max( iVar, 0. ) ) / sqrt( c->fN[tel][iChan][hilo][i] ) );
+			}
+		}// light levels
+		if( r->fX.size() < c->fFitNPoints_min )
+		{
+			r->fStatus = NO_POINTS;
+			r->fM = -1;
+			r->fMErr = 99999;
+			r->fChi2 = 99999;
+			r->fNDF = -1;
+		}
+		else if( !fitProportional( r ) )
+		{
+			r->fStatus = BAD_CHI2;
+			r->fM = -1;
+			r->fMErr = 99999;
+			r->fChi2 = 99999;
+			r->fNDF = -1;
+		}
+		else
+		{
+			double p = TMath::Prob( r->fChi2, r->fNDF );
+			//else if( TMath::Abs( b ) / berr  > fFitB_max ) fTree_status[hilo] = NOT_PROPORTIONAL;
+			if( p < c->fFitProb_min )
+			{
+				r->fStatus = BAD_CHI2;
+			}
+			else
+			{
+				r->fStatus = GOOD;
+			}
+		}
+	}
+}
 
+bool VLowGainCalibrator::doTheFit()
+{
+	/////////////////////////////////////////
+	// fit all channels (in parallel)
+	fFitResults.clear();
+	for( int tel = 0; tel < fNTel; tel++ )
+	{
+		for( int iChan = fChan_start; iChan < fChan_stop; iChan++ )
+		{
+			for( int hilo = 0; hilo < 2; hilo++ )
+			{
+				sLowGainFitResult r;
+				r.fTel = tel;
+				r.fChannel = iChan;
+				r.fHiLo = hilo;
+				r.fM = -1;
+				r.fMErr = 99999;
+				r.fChi2 = 99999;
+				r.fNDF = -1;
+				r.fStatus = NO_POINTS;
+				fFitResults.push_back( r );
+			}
+		}
+	}
+	unsigned int iNJobs = TMath::Max( 1u, TMath::Min( fNThreads, ( unsigned int )fFitResults.size() ) );
+	vector< sLowGainCalibratorJob > iJobs( iNJobs );
+	for( unsigned int i = 0; i < fFitResults.size(); i++ )
+	{
+		iJobs[i % iNJobs].fCalibrator = this;
+		iJobs[i % iNJobs].fFit.push_back( i );
+	}
+	runJobs( iJobs, VLowGainCalibrator::fitJob );
+	
+	/////////////////////////////////////////
+	// fill results (in order of telescopes and channels)
+	unsigned int iFit = 0;
 	for( int tel = 0; tel < fNTel; tel++ )
 	{
 	
@@ -833,82 +1124,39 @@ bool VLowGainCalibrator::doTheFit()
 			
 			for( int hilo = 0; hilo < 2; hilo++ )
 			{
-				TString name = TString::Format( "graph_t%d_c%d_%d_%d", tel + 1, iChan, fWindow, hilo );
-				TGraphErrors* t = new TGraphErrors( 0 );
-				t->SetName( name.Data() );
-				t->SetTitle( name.Data() );
-				TF1* f = new TF1( "f", "[0]*x", 0, 1000 );
-				int N = 0;
-				for( unsigned int i = 0; i < fNLightLevels[tel]; i++ )
+				sLowGainFitResult* r = &fFitResults[iFit++];
+				if( r->fStatus == NO_POINTS && fDEBUG )
 				{
-					if( fN[tel][iChan][hilo][i] > fFitNEvents_min 									//min number events
-							&& ( double )fN[tel][iChan][hilo][i] / ( fN[tel][iChan][0][i] + fN[tel][iChan][1][i] ) > fFitPure_min	//min purity
-							&& ( double )fNSat[tel][iChan][hilo][i] / fN[tel][iChan][hilo][i] < fFitRSat_max				//max saturation
-					  )
-					{
-					
-						t->SetPoint( N, fLightLevelMean[tel][i], fY[tel][iChan][hilo][i] );
-						double eX, eY;
-						eX = fLightLevelSigma[tel][i];
-						eY = sqrt( fY2[tel][iChan][hilo][i] - fY[tel][iChan][hilo][i] * fY[tel][iChan][hilo][i] ) / sqrt( fN[tel][iChan][hilo][i] );
-						t->SetPointError( N, eX, eY );
-						N++;
-					}
-				}// light levels
-				if( N < fFitNPoints_min )
-				{
-					if( fDEBUG )
-					{
-						cout << "Warning: Less than " << fFitNPoints_min << " point" << ( fFitNPoints_min == 1 ? "" : "s" ) << " for Tel " << tel + 1 << ", channel " << iChan  << " " << hilo ;
-						cout << ", not fitting." << endl;
-					}
-					fTree_status[hilo] = NO_POINTS;
-					fTree_m[hilo] = -1;
-					fTree_mErr[hilo] = 99999;
-					fTree_chi2[hilo] = 99999;
-					fTree_ndf[hilo]	= -1;
-					
+					cout << "Warning: Less than " << fFitNPoints_min << " point" << ( fFitNPoints_min == 1 ? "" : "s" ) << " for Tel " << tel + 1 << ", channel " << iChan  << " " << hilo ;
+					cout << ", not fitting." << endl;
 				}
-				else
-				{
+				fTree_status[hilo] = ( status )r->fStatus;
+				fTree_m[hilo] = r->fM;
+				fTree_mErr[hilo] = r->fMErr;
+				fTree_chi2[hilo] = r->fChi2;
+				fTree_ndf[hilo]	= r->fNDF;
 				
-					TString opt = "";
-					if( !fDEBUG )
-					{
-						opt = "Q";
-					}
-					t->Fit( f, opt.Data() );
-					
-					if( fDEBUG || isDebugChannel( iChan ) )
-					{
-						fDebugfile[tel]->cd();
-						t->Write();
-						
-					}
-					
-					fTree_m[hilo] = f->GetParameter( 0 );
-					fTree_mErr[hilo] = f->GetParError( 0 );
-					//double b = f->GetParameter(1);
-					//double berr = f->GetParError(1);
-					
-					fTree_chi2[hilo] = f->GetChisquare();
-					fTree_ndf[hilo]	= f->GetNDF();
-					double p = TMath::Prob( fTree_chi2[hilo], fTree_ndf[hilo] );
-					
-					if( p < fFitProb_min )
-					{
-						fTree_status[hilo] = BAD_CHI2;
-					}
-					//else if( TMath::Abs( b ) / berr  > fFitB_max ) fTree_status[hilo] = NOT_PROPORTIONAL;
-					else
+				if( r->fStatus != NO_POINTS && ( fDEBUG || isDebugChannel( iChan ) ) )
+				{
+					TString name = TString::Format( "graph_t%d_c%d_%d_%d", tel + 1, iChan, fWindow, hilo );
+					TGraphErrors* t = new TGraphErrors( r->fX.size() );
+					t->SetName( name.Data() );
+					t->SetTitle( name.Data() );
+					for( unsigned int i = 0; i < r->fX.size(); i++ )
 					{
-						fTree_status[hilo] = GOOD;
+						t->SetPoint( i, r->fX[i], r->fY[i] );
+						t->SetPointError( i, r->fXErr[i], r->fYErr[i] );
 					}
-					
-					
+					TF1* f = new TF1( "f", "[0]*x", 0, 1000 );
+					f->SetParameter( 0, r->fM );
+					f->SetParError( 0, r->fMErr );
+					f->SetChisquare( r->fChi2 );
+					f->SetNDF( r->fNDF );
+					t->GetListOfFunctions()->Add( f );
+					fDebugfile[tel]->cd();
+					t->Write();
+					t->Delete();
 				}
-				f->Delete();
-				t->Delete();
 				
 			}//hilo
 			
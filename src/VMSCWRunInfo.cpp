@@ -0,0 +1,334 @@
+/*! \class VMSCWRunInfo
+    \brief run level summary of a mscw_energy output file
+
+    Filled by mscw_energy for all events written to the data tree and
+    stored in a small text file next to the mscw file (<mscw file>.runinfo).
+
+    anasum and makeRadialAcceptance use this summary for run preflight
+    checks (azimuth range, noise level, telescope participation) without
+    reading the data tree.
+
+    The sidecar file is ignored if it does not match size and modification
+    time of the mscw file.
+
+*/
+
+#include "VMSCWRunInfo.h"
+
+VMSCWRunInfo::VMSCWRunInfo()
+{
+	reset();
+}
+
+void VMSCWRunInfo::reset()
+{
+	fAzSet = false;
+	fZeSum = 0.;
+	fNZe = 0;
+	
+	fRunNumber = 0;
+	fIsMC = false;
+	fNEvents = 0;
+	fNEventsWithImages = 0;
+	fTelToAnalyze.clear();
+	fNImagesPerTel.clear();
+	fAzMin = 1.e3;
+	fAzMax = -1.e3;
+	fZeMin = 1.e3;
+	fZeMax = -1.e3;
+	fZeMean = -1.;
+	fMeanPedvars = -1.;
+	fMJDStart = 0;
+	fTimeStart = 0.;
+	fMJDStop = 0;
+	fTimeStop = 0.;
+}
+
+/*
+ * add one event of the data tree
+ *
+ * (azimuth range as in anasum: azimuth of the first telescope with
+ *  a selected image in the first and last event with selected images)
+ */
+void VMSCWRunInfo::fill( int iMJD, double iTime, ULong64_t iImgSel, double* iTelAzimuth,
+						 double iArrayPointing_Elevation, unsigned int iNTel )
+{
+	if( fNEvents == 0 )
+	{
+		fMJDStart = iMJD;
+		fTimeStart = iTime;
+	}
+	fMJDStop = iMJD;
+	fTimeStop = iTime;
+	fNEvents++;
+	
+	if( iNTel > 8 * sizeof( ULong64_t ) )
+	{
+		iNTel = 8 * sizeof( ULong64_t );
+	}
+	if( fNImagesPerTel.size() < iNTel )
+	{
+		fNImagesPerTel.resize( iNTel, 0 );
+	}
+	if( iImgSel > 0 )
+	{
+		fNEventsWithImages++;
+		bitset< 8 * sizeof( ULong64_t ) > a = iImgSel;
+		bool bFirst = true;
+		for( unsigned int t = 0; t < iNTel; t++ )
+		{
+			if( a.test( t ) )
+			{
+				fNImagesPerTel[t]++;
+				if( bFirst && iTelAzimuth )
+				{
+					if( !fAzSet )
+					{
+						fAzMin = iTelAzimuth[t];
+						fAzSet = true;
+					}
+					fAzMax = iTelAzimuth[t];
+					bFirst = false;
+				}
+			}
+		}
+	}
+	if( iArrayPointing_Elevation > 0. )
+	{
+		double ze = 90. - iArrayPointing_Elevation;
+		if( ze < fZeMin )
+		{
+			fZeMin = ze;
+		}
+		if( ze > fZeMax )
+		{
+			fZeMax = ze;
+		}
+		fZeSum += ze;
+		fNZe++;
+		fZeMean = fZeSum / ( double )fNZe;
+	}
+}
+
+bool VMSCWRunInfo::getFileInfo( string iFileName, Long64_t& iFileSize, Long_t& iFileModTime )
+{
+	Long_t iID = 0;
+	Long_t iFlags = 0;
+	if( gSystem->GetPathInfo( iFileName.c_str(), &iID, &iFileSize, &iFlags, &iFileModTime ) != 0 )
+	{
+		return false;
+	}
+	return true;
+}
+
+/*
+ * write sidecar file (call after the mscw file is closed)
+ *
+ */
+bool VMSCWRunInfo::writeSidecarFile( string iMSCWFileName )
+{
+	Long64_t iFileSize = 0;
+	Long_t iFileModTime = 0;
+	if( !getFileInfo( iMSCWFileName, iFileSize, iFileModTime ) )
+	{
+		cout << "VMSCWRunInfo::writeSidecarFile error: file not found: " << iMSCWFileName << endl;
+		return false;
+	}
+	string iSidecarFileName = getSidecarFileName( iMSCWFileName );
+	ostringstream iTempFileName;
+	iTempFileName << iSidecarFileName << "." << gSystem->GetPid() << ".tmp";
+	ofstream os( iTempFileName.str().c_str() );
+	if( !os )
+	{
+		cout << "VMSCWRunInfo::writeSidecarFile: file " << iSidecarFileName << " not writable" << endl;
+		return false;
+	}
+	os.precision( 12 );
+	os << "# run summary of mscw file " << iMSCWFileName << endl;
+	os << "VMSCWRunInfo 2" << endl;
+	os << "mscwfilesize " << iFileSize << endl;
+	os << "mscwfilemtime " << iFileModTime << endl;
+	os << "runnumber " << fRunNumber << endl;
+	os << "isMC " << fIsMC << endl;
+	os << "nevents " << fNEvents << endl;
+	os << "neventswithimages " << fNEventsWithImages << endl;
+	os << "teltoanalyze " << fTelToAnalyze.size();
+	for( unsigned int i = 0; i < fTelToAnalyze.size(); i++ )
+	{
+		os << " " << fTelToAnalyze[i];
+	}
+	os << endl;
+	os << "nimagespertel " << fNImagesPerTel.size();
+	for( unsigned int i = 0; i < fNImagesPerTel.size(); i++ )
+	{
+		os << " " << fNImagesPerTel[i];
+	}
+	os << endl;
+	os << "azimuth " << fAzMin << " " << fAzMax << endl;
+	os << "zenith " << fZeMin << " " << fZeMax << " " << fZeMean << endl;
+	os << "meanpedvars " << fMeanPedvars << endl;
+	os << "start " << fMJDStart << " " << fTimeStart << endl;
+	os << "stop " << fMJDStop << " " << fTimeStop << endl;
+	os.close();
+	if( !os.good() || gSystem->Rename( iTempFileName.str().c_str(), iSidecarFileName.c_str() ) != 0 )
+	{
+		cout << "VMSCWRunInfo::writeSidecarFile: error writing " << iSidecarFileName << endl;
+		gSystem->Unlink( iTempFileName.str().c_str() );
+		return false;
+	}
+	cout << "\t run summary written to " << iSidecarFileName << endl;
+	return true;
+}
+
+/*
+ * read sidecar file of the given mscw file
+ *
+ * returns false if the sidecar file does not exist or does not
+ * match the mscw file
+ */
+bool VMSCWRunInfo::readSidecarFile( string iMSCWFileName )
+{
+	reset();
+	string iSidecarFileName = getSidecarFileName( iMSCWFileName );
+	if( gSystem->AccessPathName( iSidecarFileName.c_str() ) )
+	{
+		return false;
+	}
+	Long64_t iFileSize = 0;
+	Long_t iFileModTime = 0;
+	if( !getFileInfo( iMSCWFileName, iFileSize, iFileModTime ) )
+	{
+		return false;
+	}
+	ifstream is( iSidecarFileName.c_str() );
+	if( !is )
+	{
+		return false;
+	}
+	bool bVersion = false;
+	bool bSize = false;
+	bool bModTime = false;
+	string iLine;
+	string iKey;
+	while( getline( is, iLine ) )
+	{
+		if( iLine.size() == 0 || iLine[0] == '#' )
+		{
+			continue;
+		}
+		istringstream is_stream( iLine );
+		is_stream >> iKey;
+		if( iKey == "VMSCWRunInfo" )
+		{
+			int iVersion = 0;
+			is_stream >> iVersion;
+			bVersion = ( iVersion == 2 );
+		}
+		else if( iKey == "mscwfilesize" )
+		{
+			Long64_t iS = 0;
+			is_stream >> iS;
+			bSize = ( iS == iFileSize );
+		}
+		else if( iKey == "mscwfilemtime" )
+		{
+			Long_t iT = 0;
+			is_stream >> iT;
+			bModTime = ( iT == iFileModTime );
+		}
+		else if( iKey == "runnumber" )
+		{
+			is_stream >> fRunNumber;
+		}
+		else if( iKey == "isMC" )
+		{
+			is_stream >> fIsMC;
+		}
+		else if( iKey == "nevents" )
+		{
+			is_stream >> fNEvents;
+		}
+		else if( iKey == "neventswithimages" )
+		{
+			is_stream >> fNEventsWithImages;
+		}
+		else if( iKey == "teltoanalyze" )
+		{
+			unsigned int n = 0;
+			is_stream >> n;
+			fTelToAnalyze.assign( n, 0 );
+			for( unsigned int i = 0; i < n; i++ )
+			{
+				is_stream >> fTelToAnalyze[i];
+			}
+		}
+		else if( iKey == "nimagespertel" )
+		{
+			unsigned int n = 0;
+			is_stream >> n;
+			fNImagesPerTel.assign( n, 0 );
+			for( unsigned int i = 0; i < n; i++ )
+			{
+				is_stream >> fNImagesPerTel[i];
+			}
+		}
+		else if( iKey == "azimuth" )
+		{
+			is_stream >> fAzMin >> fAzMax;
+		}
+		else if( iKey == "zenith" )
+		{
+			is_stream >> fZeMin >> fZeMax >> fZeMean;
+		}
+		else if( iKey == "meanpedvars" )
+		{
+			is_stream >> fMeanPedvars;
+		}
+		else if( iKey == "start" )
+		{
+			is_stream >> fMJDStart >> fTimeStart;
+		}
+		else if( iKey == "stop" )
+		{
+			is_stream >> fMJDStop >> fTimeStop;
+		}
+		if( is_stream.fail() )
+		{
+			cout << "VMSCWRunInfo::readSidecarFile: invalid line in " << iSidecarFileName << ": " << iLine << endl;
+			reset();
+			return false;
+		}
+	}
+	if( !bVersion || !bSize || !bModTime )
+	{
+		reset();
+		return false;
+	}
+	return true;
+}
+
+void VMSCWRunInfo::print()
+{
+	cout << "run " << fRunNumber;
+	if( fIsMC )
+	{
+		cout << " (MC)";
+	}
+	cout << ": " << fNEvents << " events (" << fNEventsWithImages << " with images)" << endl;
+	cout << "\t telescopes:";
+	for( unsigned int i = 0; i < fTelToAnalyze.size(); i++ )
+	{
+		cout << " T" << fTelToAnalyze[i] + 1;
+	}
+	cout << ", images per telescope:";
+	for( unsigned int i = 0; i < fNImagesPerTel.size(); i++ )
+	{
+		cout << " " << fNImagesPerTel[i];
+	}
+	cout << endl;
+	cout << "\t azimuth [" << fAzMin << "," << fAzMax << "] deg";
+	cout << ", zenith [" << fZeMin << "," << fZeMax << "] deg (mean " << fZeMean << " deg)";
+	cout << ", mean pedvars " << fMeanPedvars << endl;
+	cout << "\t time range: MJD " << fMJDStart << " " << fTimeStart << " s";
+	cout << " - MJD " << fMJDStop << " " << fTimeStop << " s" << endl;
+}
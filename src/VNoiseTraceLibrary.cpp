@@ -0,0 +1,274 @@
+/*! \class VNoiseTraceLibrary
+    \brief read-only, memory resident background trace library
+
+    All traces of the library file (trees trace_0, trace_1, ...; branch fTrace[500][64])
+    are stored in one contiguous buffer of 8 bit samples:
+
+       [telescope][entry][pixel][sample]
+
+    The buffer is written once into a sidecar file (<trace file>.evndisp.tracelib),
+    which is memory mapped in all following jobs (read-only, shared between jobs
+    running on the same machine). If the sidecar file cannot be written, the
+    library is kept in memory.
+
+    Sample values are clamped to [0,255].
+
+*/
+
+#include "VNoiseTraceLibrary.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+VNoiseTraceLibrary::VNoiseTraceLibrary( bool iDebug )
+{
+	fDebug = iDebug;
+	fTraceFileName = "";
+	fSidecarFileName = "";
+	fNTel = 0;
+	fData = 0;
+	fMappedData = 0;
+	fMappedSize = 0;
+}
+
+VNoiseTraceLibrary::~VNoiseTraceLibrary()
+{
+	unmap();
+}
+
+void VNoiseTraceLibrary::unmap()
+{
+	if( fMappedData )
+	{
+		munmap( fMappedData, fMappedSize );
+		fData = 0;
+	}
+	fMappedData = 0;
+	fMappedSize = 0;
+}
+
+/*
+ * open trace library
+ *
+ * use sidecar file if it exists and is up to date, otherwise
+ * read all trace trees and write sidecar file
+ *
+ */
+bool VNoiseTraceLibrary::open( string iTraceFileName, unsigned int iNTel )
+{
+	unmap();
+	fMemoryBuffer.clear();
+	fData = 0;
+	fTraceFileName = iTraceFileName;
+	fSidecarFileName = iTraceFileName + ".evndisp.tracelib";
+	fNTel = iNTel;
+	fNEntries.assign( fNTel, 0 );
+	fOffset.assign( fNTel, 0 );
+	
+	Long64_t iTraceFileSize = 0;
+	Long_t   iTraceFileModTime = 0;
+	if( !getTraceFileInfo( iTraceFileSize, iTraceFileModTime ) )
+	{
+		cout << "VNoiseTraceLibrary::open error, trace library not found " << fTraceFileName << endl;
+		return false;
+	}
+	
+	if( mapSidecarFile( iTraceFileSize, iTraceFileModTime ) )
+	{
+		cout << "VNoiseTraceLibrary: reading trace library from " << fSidecarFileName << endl;
+		return true;
+	}
+	
+	if( !fillFromTraceFile( iTraceFileSize, iTraceFileModTime ) )
+	{
+		return false;
+	}
+	// memory map the sidecar file (page cache is shared between jobs)
+	if( writeSidecarFile( iTraceFileSize, iTraceFileModTime )
+			&& mapSidecarFile( iTraceFileSize, iTraceFileModTime ) )
+	{
+		vector< uint8_t >().swap( fMemoryBuffer );
+	}
+	else
+	{
+		fData = &fMemoryBuffer[0];
+	}
+	return true;
+}
+
+bool VNoiseTraceLibrary::getTraceFileInfo( Long64_t& iTraceFileSize, Long_t& iTraceFileModTime )
+{
+	Long_t iID = 0;
+	Long_t iFlags = 0;
+	if( gSystem->GetPathInfo( fTraceFileName.c_str(), &iID, &iTraceFileSize, &iFlags, &iTraceFileModTime ) != 0 )
+	{
+		return false;
+	}
+	return true;
+}
+
+/*
+ * read all traces from trace library trees into memory buffer
+ *
+ */
+bool VNoiseTraceLibrary::fillFromTraceFile( Long64_t iTraceFileSize, Long_t iTraceFileModTime )
+{
+	TFile iFile( fTraceFileName.c_str() );
+	if( iFile.IsZombie() )
+	{
+		cout << "VNoiseTraceLibrary::fillFromTraceFile error, trace library not found " << fTraceFileName << endl;
+		return false;
+	}
+	cout << "VNoiseTraceLibrary: reading trace library from " << fTraceFileName << endl;
+	
+	vector< TTree* > iTree( fNTel, ( TTree* )0 );
+	Long64_t iNTraces = 0;
+	char itree[200];
+	for( unsigned int i = 0; i < fNTel; i++ )
+	{
+		sprintf( itree, "trace_%d", i );
+		iTree[i] = ( TTree* )iFile.Get( itree );
+		if( !iTree[i] || iTree[i]->GetEntries() == 0 )
+		{
+			cout << "VNoiseTraceLibrary::fillFromTraceFile error, trace tree not found or empty: " << itree << endl;
+			return false;
+		}
+		fNEntries[i] = iTree[i]->GetEntries();
+		fOffset[i] = iNTraces * fNSamples;
+		iNTraces += fNEntries[i] * fNPixel;
+	}
+	fMemoryBuffer.assign( iNTraces * fNSamples, 0 );
+	
+	short int iTrace[fNPixel][fNSamples];
+	for( unsigned int i = 0; i < fNTel; i++ )
+	{
+		iTree[i]->SetBranchAddress( "fTrace", iTrace );
+		for( Long64_t n = 0; n < fNEntries[i]; n++ )
+		{
+			iTree[i]->GetEntry( n );
+			uint8_t* iD = &fMemoryBuffer[fOffset[i] + n * fNPixel * fNSamples];
+			for( unsigned int p = 0; p < fNPixel; p++ )
+			{
+				for( unsigned int s = 0; s < fNSamples; s++ )
+				{
+					short int v = iTrace[p][s];
+					iD[p * fNSamples + s] = ( uint8_t )( v < 0 ? 0 : ( v > 255 ? 255 : v ) );
+				}
+			}
+		}
+		iTree[i]->ResetBranchAddresses();
+	}
+	iFile.Close();
+	
+	return true;
+}
+
+/*
+ * sidecar file layout:
+ *
+ *    "EVNDTRL1" | NTel, NPixel, NSamples, 0 (UInt_t) | trace file size, modification time (Long64_t)
+ *    | NEntries[NTel] (Long64_t) | padding to 64 bytes | traces (uint8_t)
+ *
+ */
+bool VNoiseTraceLibrary::writeSidecarFile( Long64_t iTraceFileSize, Long_t iTraceFileModTime )
+{
+	ostringstream iTempFileName;
+	iTempFileName << fSidecarFileName << "." << gSystem->GetPid() << ".tmp";
+	ofstream os( iTempFileName.str().c_str(), ios::out | ios::binary );
+	if( !os )
+	{
+		cout << "VNoiseTraceLibrary: sidecar file " << fSidecarFileName << " not writable (keeping trace library in memory)" << endl;
+		return false;
+	}
+	UInt_t iH[4] = { fNTel, fNPixel, fNSamples, 0 };
+	Long64_t iF[2] = { iTraceFileSize, ( Long64_t )iTraceFileModTime };
+	os.write( "EVNDTRL1", 8 );
+	os.write( ( const char* )iH, sizeof( iH ) );
+	os.write( ( const char* )iF, sizeof( iF ) );
+	os.write( ( const char* )&fNEntries[0], fNTel * sizeof( Long64_t ) );
+	size_t iHeaderSize = 8 + sizeof( iH ) + sizeof( iF ) + fNTel * sizeof( Long64_t );
+	size_t iDataOffset = ( ( iHeaderSize + 63 ) / 64 ) * 64;
+	char iPadding[64] = { 0 };
+	os.write( iPadding, iDataOffset - iHeaderSize );
+	os.write( ( const char* )&fMemoryBuffer[0], fMemoryBuffer.size() );
+	os.close();
+	if( !os.good() || gSystem->Rename( iTempFileName.str().c_str(), fSidecarFileName.c_str() ) != 0 )
+	{
+		cout << "VNoiseTraceLibrary: error writing sidecar file " << fSidecarFileName << " (keeping trace library in memory)" << endl;
+		gSystem->Unlink( iTempFileName.str().c_str() );
+		return false;
+	}
+	cout << "VNoiseTraceLibrary: trace library written to " << fSidecarFileName << endl;
+	return true;
+}
+
+/*
+ * memory map sidecar file
+ *
+ * returns false if the sidecar file does not exist or does not match
+ * the trace library file
+ */
+bool VNoiseTraceLibrary::mapSidecarFile( Long64_t iTraceFileSize, Long_t iTraceFileModTime )
+{
+	int fd = ::open( fSidecarFileName.c_str(), O_RDONLY );
+	if( fd < 0 )
+	{
+		return false;
+	}
+	struct stat iStat;
+	if( fstat( fd, &iStat ) != 0 || iStat.st_size < 40 )
+	{
+		::close( fd );
+		return false;
+	}
+	void* iMap = mmap( 0, iStat.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+	::close( fd );
+	if( iMap == MAP_FAILED )
+	{
+		return false;
+	}
+	const char* iB = ( const char* )iMap;
+	size_t iSize = iStat.st_size;
+	
+	UInt_t iH[4];
+	Long64_t iF[2];
+	memcpy( iH, iB + 8, sizeof( iH ) );
+	memcpy( iF, iB + 8 + sizeof( iH ), sizeof( iF ) );
+	size_t iHeaderSize = 8 + sizeof( iH ) + sizeof( iF ) + fNTel * sizeof( Long64_t );
+	bool bGood = ( string( iB, 8 ) == "EVNDTRL1" );
+	bGood = bGood && ( iH[0] == fNTel && iH[1] == fNPixel && iH[2] == fNSamples );
+	bGood = bGood && ( iF[0] == iTraceFileSize && iF[1] == ( Long64_t )iTraceFileModTime );
+	bGood = bGood && ( iSize >= iHeaderSize );
+	size_t iDataOffset = ( ( iHeaderSize + 63 ) / 64 ) * 64;
+	if( bGood )
+	{
+		memcpy( &fNEntries[0], iB + 8 + sizeof( iH ) + sizeof( iF ), fNTel * sizeof( Long64_t ) );
+		Long64_t iNTraces = 0;
+		for( unsigned int i = 0; i < fNTel; i++ )
+		{
+			fOffset[i] = iNTraces * fNSamples;
+			iNTraces += fNEntries[i] * fNPixel;
+			bGood = bGood && ( fNEntries[i] > 0 );
+		}
+		bGood = bGood && ( ( Long64_t )iSize == ( Long64_t )iDataOffset + iNTraces * fNSamples );
+	}
+	if( !bGood )
+	{
+		if( fDebug )
+		{
+			cout << "VNoiseTraceLibrary: ignoring outdated or invalid sidecar file " << fSidecarFileName << endl;
+		}
+		munmap( iMap, iSize );
+		return false;
+	}
+	unmap();
+	fMappedData = iMap;
+	fMappedSize = iSize;
+	fData = ( const uint8_t* )iB + iDataOffset;
+	
+	return true;
+}
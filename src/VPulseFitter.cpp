@@ -0,0 +1,564 @@
+/*! \class VPulseFitter
+    \brief fast fit of FADC pulses
+
+    fit of the pulse shapes used in VFitTraceHandler with a
+    Levenberg-Marquardt minimisation of chi2
+
+    - derivatives of the pulse shapes are calculated analytically
+    - fixed number of free parameters (pedestal is fixed); normal equations
+      are solved with a Cholesky decomposition
+    - start values are expected from a simple trace analysis (e.g. sliding window)
+    - pulse maximum, integrals and times at fractions of the maximum are
+      calculated analytically where possible (no numerical minimisation or root finding)
+
+    pulse shapes (pedestal subtracted, x in samples):
+
+    EV:    parameters (A, xbar, sigma, alpha)
+           f = A * exp( -0.5 (x-xbar)^2 / sigma^2 )                          for x < xbar
+           f = A * exp( -0.5 (x-xbar)^2 / (sigma^2 + alpha (x-xbar) ) )      for x >= xbar
+
+    GRISU: parameters (rise time, fall time, start time, normalisation)
+           (single p.e. pulse shape from grisudet, without AC coupling overshoot)
+
+    fit status follows the Minuit convention (3 = converged, 1 = not converged, 0 = failed)
+
+*/
+
+#include "VPulseFitter.h"
+
+VPulseFitter::VPulseFitter( E_PulseShape iShape )
+{
+	fMaxIterations = 50;
+	fTolerance = 1.e-6;
+	
+	fChi2 = 0.;
+	fNDF = 0;
+	fStatus = 0;
+	fNIterations = 0;
+	
+	setShape( iShape );
+}
+
+void VPulseFitter::setShape( E_PulseShape iShape )
+{
+	fShape = iShape;
+	for( unsigned int i = 0; i < fNPar; i++ )
+	{
+		fPar[i] = 0.;
+	}
+	setLimits();
+}
+
+/*
+ * parameter limits (as used for the Minuit fits in VFitTraceHandler)
+ */
+void VPulseFitter::setLimits()
+{
+	double iNSamples = ( double )fX.size();
+	if( iNSamples < 1. )
+	{
+		iNSamples = 64.;
+	}
+	if( fShape == GRISU )
+	{
+		fParMin[0] = 0.01;
+		fParMax[0] = 20.;
+		fParMin[1] = 0.;
+		fParMax[1] = 2000.;
+		fParMin[2] = -iNSamples;
+		fParMax[2] = iNSamples;
+		fParMin[3] = 0.;
+		fParMax[3] = 1.e7;
+	}
+	else
+	{
+		fParMin[0] = 0.;
+		fParMax[0] = 5.e5;
+		fParMin[1] = -iNSamples;
+		fParMax[1] = 2. * iNSamples;
+		fParMin[2] = 0.01;
+		fParMax[2] = 20.;
+		fParMin[3] = 0.;
+		fParMax[3] = 20.;
+	}
+}
+
+/*
+ * pulse shape (pedestal subtracted)
+ *
+ * derivatives with respect to all parameters are filled into dfdp (if given)
+ */
+double VPulseFitter::eval( double x, const double* p, double* dfdp )
+{
+	if( dfdp )
+	{
+		for( unsigned int i = 0; i < fNPar; i++ )
+		{
+			dfdp[i] = 0.;
+		}
+	}
+	//////////////////////////////////////////
+	// grisu pulse shape
+	if( fShape == GRISU )
+	{
+		double r = p[0];
+		double F = p[1];
+		double t = x - p[2];
+		double w = r + F;
+		if( r <= 0. || t <= 0. || t >= w )
+		{
+			return 0.;
+		}
+		double a = F / r;
+		double renorm = pow( w, a + 2. ) / ( ( a + 1. ) * ( a + 2. ) );
+		double iPowWT = pow( w - t, a );
+		double shape = t * iPowWT / renorm;
+		double f = p[3] * shape;
+		if( dfdp )
+		{
+			// derivatives of log(f) with respect to w and a
+			double dLdw = a / ( w - t ) - ( a + 2. ) / w;
+			double dLda = log( w - t ) - log( w ) + 1. / ( a + 1. ) + 1. / ( a + 2. );
+			dfdp[0] = f * ( dLdw - dLda * F / ( r * r ) );
+			dfdp[1] = f * ( dLdw + dLda / r );
+			dfdp[2] = -1. * ( p[3] * iPowWT / renorm - a * f / ( w - t ) );
+			dfdp[3] = shape;
+		}
+		return f;
+	}
+	//////////////////////////////////////////
+	// ev pulse shape
+	double A = p[0];
+	double s = p[2];
+	double alpha = p[3];
+	double d = x - p[1];
+	if( d < 0. )
+	{
+		double g = exp( -0.5 * d * d / ( s * s ) );
+		double f = A * g;
+		if( dfdp )
+		{
+			dfdp[0] = g;
+			dfdp[1] = f * d / ( s * s );
+			dfdp[2] = f * d * d / ( s * s * s );
+		}
+		return f;
+	}
+	double D = s * s + alpha * d;
+	if( D <= 0. )
+	{
+		return 0.;
+	}
+	double g = exp( -0.5 * d * d / D );
+	double f = A * g;
+	if( dfdp )
+	{
+		dfdp[0] = g;
+		dfdp[1] = f * ( d * D - 0.5 * alpha * d * d ) / ( D * D );
+		dfdp[2] = f * d * d * s / ( D * D );
+		dfdp[3] = f * 0.5 * d * d * d / ( D * D );
+	}
+	return f;
+}
+
+double VPulseFitter::getChi2( const double* p )
+{
+	double chi2 = 0.;
+	for( unsigned int i = 0; i < fX.size(); i++ )
+	{
+		double r = fY[i] - eval( fX[i], p );
+		chi2 += fW[i] * r * r;
+	}
+	return chi2;
+}
+
+/*
+ * normal equations (J^T W J) and (J^T W r) for parameters p
+ */
+bool VPulseFitter::getNormalEquations( const double* p, double iA[fNPar][fNPar], double iB[fNPar] )
+{
+	double dfdp[fNPar];
+	for( unsigned int j = 0; j < fNPar; j++ )
+	{
+		iB[j] = 0.;
+		for( unsigned int k = 0; k < fNPar; k++ )
+		{
+			iA[j][k] = 0.;
+		}
+	}
+	for( unsigned int i = 0; i < fX.size(); i++ )
+	{
+		double r = fY[i] - eval( fX[i], p, dfdp );
+		for( unsigned int j = 0; j < fNPar; j++ )
+		{
+			iB[j] += fW[i] * dfdp[j] * r;
+			for( unsigned int k = 0; k <= j; k++ )
+			{
+				iA[j][k] += fW[i] * dfdp[j] * dfdp[k];
+			}
+		}
+	}
+	for( unsigned int j = 0; j < fNPar; j++ )
+	{
+		for( unsigned int k = j + 1; k < fNPar; k++ )
+		{
+			iA[j][k] = iA[k][j];
+		}
+		if( !TMath::Finite( iB[j] ) )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+ * solve iA * iX = iB (iA symmetric, positive definite; Cholesky decomposition)
+ *
+ * iA is overwritten
+ */
+bool VPulseFitter::solve( double iA[fNPar][fNPar], double* iB, double* iX )
+{
+	for( unsigned int j = 0; j < fNPar; j++ )
+	{
+		double sum = iA[j][j];
+		for( unsigned int k = 0; k < j; k++ )
+		{
+			sum -= iA[j][k] * iA[j][k];
+		}
+		if( sum <= 0. || !TMath::Finite( sum ) )
+		{
+			return false;
+		}
+		iA[j][j] = sqrt( sum );
+		for( unsigned int i = j + 1; i < fNPar; i++ )
+		{
+			sum = iA[i][j];
+			for( unsigned int k = 0; k < j; k++ )
+			{
+				sum -= iA[i][k] * iA[j][k];
+			}
+			iA[i][j] = sum / iA[j][j];
+		}
+	}
+	// forward and back substitution
+	double y[fNPar];
+	for( unsigned int i = 0; i < fNPar; i++ )
+	{
+		double sum = iB[i];
+		for( unsigned int k = 0; k < i; k++ )
+		{
+			sum -= iA[i][k] * y[k];
+		}
+		y[i] = sum / iA[i][i];
+	}
+	for( int i = ( int )fNPar - 1; i >= 0; i-- )
+	{
+		double sum = y[i];
+		for( unsigned int k = i + 1; k < fNPar; k++ )
+		{
+			sum -= iA[k][i] * iX[k];
+		}
+		iX[i] = sum / iA[i][i];
+	}
+	return true;
+}
+
+/*
+ * fit pulse shape to trace
+ *
+ * iTrace:        FADC trace (not pedestal subtracted)
+ * iAmplitude:    start value for pulse amplitude (pedestal subtracted)
+ * iPeakPosition: start value for position of pulse maximum (in samples)
+ * iCharge:       start value for pulse integral (e.g. from sliding window integration)
+ *
+ * returns fit status (3 = converged)
+ */
+int VPulseFitter::fit( const vector< double >& iTrace, double iPed, double iPedrms,
+					   double iAmplitude, double iPeakPosition, double iCharge )
+{
+	fChi2 = 0.;
+	fStatus = 0;
+	fNIterations = 0;
+	
+	// sample values (at bin centres) and weights
+	// (errors are signal + pedestal rms, as for the Minuit fits)
+	unsigned int n = iTrace.size();
+	fX.resize( n );
+	fY.resize( n );
+	fW.resize( n );
+	for( unsigned int i = 0; i < n; i++ )
+	{
+		fX[i] = ( double )i + 0.5;
+		fY[i] = iTrace[i] - iPed;
+		double iSigma = sqrt( fabs( fY[i] ) + iPedrms * iPedrms ) / 2.;
+		if( iSigma > 0. )
+		{
+			fW[i] = 1. / ( iSigma * iSigma );
+		}
+		else
+		{
+			fW[i] = 1.;
+		}
+	}
+	fNDF = ( int )n - ( int )fNPar;
+	setLimits();
+	if( fNDF <= 0 || iAmplitude <= 0. )
+	{
+		return fStatus;
+	}
+	
+	//////////////////////////////////////////
+	// start values
+	if( fShape == GRISU )
+	{
+		fPar[0] = 2.4;
+		fPar[1] = 8.0;
+		fPar[2] = iPeakPosition - fPar[0];
+		// normalisation from pulse amplitude (maximum at t = rise time)
+		double a = fPar[1] / fPar[0];
+		double w = fPar[0] + fPar[1];
+		double renorm = pow( w, a + 2. ) / ( ( a + 1. ) * ( a + 2. ) );
+		fPar[3] = iAmplitude * renorm / ( fPar[0] * pow( fPar[1], a ) );
+	}
+	else
+	{
+		fPar[0] = iAmplitude;
+		fPar[1] = iPeakPosition;
+		// width from pulse integral (integral of a gaussian is ~2.5 x sigma x amplitude)
+		fPar[2] = 0.6;
+		fPar[3] = 1.6;
+		if( iCharge > 0. )
+		{
+			fPar[2] = iCharge / iAmplitude / 2.5;
+			if( fPar[2] < 0.3 )
+			{
+				fPar[2] = 0.3;
+			}
+			if( fPar[2] > 5. )
+			{
+				fPar[2] = 5.;
+			}
+			fPar[3] = fPar[2] * 1.6 / 0.6;
+		}
+	}
+	for( unsigned int j = 0; j < fNPar; j++ )
+	{
+		fPar[j] = TMath::Max( fParMin[j], TMath::Min( fParMax[j], fPar[j] ) );
+	}
+	
+	//////////////////////////////////////////
+	// Levenberg-Marquardt iterations
+	double iA[fNPar][fNPar];
+	double iM[fNPar][fNPar];
+	double iB[fNPar];
+	double iDelta[fNPar];
+	double iParNew[fNPar];
+	double lambda = 1.e-3;
+	fChi2 = getChi2( fPar );
+	if( !TMath::Finite( fChi2 ) )
+	{
+		return fStatus;
+	}
+	fStatus = 1;
+	for( fNIterations = 0; fNIterations < fMaxIterations; fNIterations++ )
+	{
+		if( !getNormalEquations( fPar, iA, iB ) )
+		{
+			fStatus = 0;
+			break;
+		}
+		bool iImproved = false;
+		double iChi2New = fChi2;
+		while( lambda < 1.e10 )
+		{
+			for( unsigned int j = 0; j < fNPar; j++ )
+			{
+				for( unsigned int k = 0; k < fNPar; k++ )
+				{
+					iM[j][k] = iA[j][k];
+				}
+				// parameters without any effect on chi2 are not changed
+				if( iA[j][j] > 0. )
+				{
+					iM[j][j] = iA[j][j] * ( 1. + lambda );
+				}
+				else
+				{
+					iM[j][j] = 1.;
+				}
+			}
+			if( solve( iM, iB, iDelta ) )
+			{
+				for( unsigned int j = 0; j < fNPar; j++ )
+				{
+					iParNew[j] = TMath::Max( fParMin[j], TMath::Min( fParMax[j], fPar[j] + iDelta[j] ) );
+				}
+				iChi2New = getChi2( iParNew );
+				if( TMath::Finite( iChi2New ) && iChi2New < fChi2 )
+				{
+					iImproved = true;
+					lambda = TMath::Max( lambda * 0.1, 1.e-7 );
+					break;
+				}
+			}
+			lambda *= 10.;
+		}
+		// no further improvement possible: minimum found
+		if( !iImproved )
+		{
+			fStatus = 3;
+			break;
+		}
+		double iRelChange = ( fChi2 - iChi2New ) / TMath::Max( fChi2, 1.e-12 );
+		for( unsigned int j = 0; j < fNPar; j++ )
+		{
+			fPar[j] = iParNew[j];
+		}
+		fChi2 = iChi2New;
+		if( iRelChange < fTolerance )
+		{
+			fStatus = 3;
+			break;
+		}
+	}
+	return fStatus;
+}
+
+/*
+ * position of pulse maximum (in samples)
+ */
+double VPulseFitter::getPeakPosition()
+{
+	if( fShape == GRISU )
+	{
+		// maximum of t*(w-t)^a at t = w/(a+1) = rise time
+		return fPar[2] + fPar[0];
+	}
+	return fPar[1];
+}
+
+/*
+ * pulse maximum (pedestal subtracted)
+ */
+double VPulseFitter::getAmplitude()
+{
+	if( fShape == GRISU )
+	{
+		double r = fPar[0];
+		double F = fPar[1];
+		if( r <= 0. )
+		{
+			return 0.;
+		}
+		double a = F / r;
+		double w = r + F;
+		double renorm = pow( w, a + 2. ) / ( ( a + 1. ) * ( a + 2. ) );
+		return fPar[3] * r * pow( F, a ) / renorm;
+	}
+	return fPar[0];
+}
+
+/*
+ * integral of pulse between a and b (pedestal subtracted)
+ */
+double VPulseFitter::getIntegral( double a, double b )
+{
+	if( b <= a )
+	{
+		return 0.;
+	}
+	if( fShape == GRISU )
+	{
+		double t0 = fPar[2];
+		double t1 = fPar[2] + fPar[0] + fPar[1];
+		return getSimpsonIntegral( TMath::Max( a, t0 ), TMath::Min( b, t1 ) );
+	}
+	double iSum = 0.;
+	double xbar = fPar[1];
+	double s = fPar[2];
+	// rising edge (gaussian)
+	if( a < xbar && s > 0. )
+	{
+		double u1 = ( a - xbar ) / ( s * TMath::Sqrt2() );
+		double u2 = ( TMath::Min( b, xbar ) - xbar ) / ( s * TMath::Sqrt2() );
+		iSum += fPar[0] * s * sqrt( TMath::PiOver2() ) * ( TMath::Erf( u2 ) - TMath::Erf( u1 ) );
+	}
+	// falling edge
+	if( b > xbar )
+	{
+		iSum += getSimpsonIntegral( TMath::Max( a, xbar ), b );
+	}
+	return iSum;
+}
+
+/*
+ * numerical integration of pulse shape (composite Simpson rule, step <= 1/8 sample)
+ */
+double VPulseFitter::getSimpsonIntegral( double a, double b )
+{
+	if( b <= a )
+	{
+		return 0.;
+	}
+	unsigned int n = 2 * ( unsigned int )ceil( ( b - a ) * 4. );
+	if( n < 2 )
+	{
+		n = 2;
+	}
+	double h = ( b - a ) / ( double )n;
+	double iSum = eval( a, fPar ) + eval( b, fPar );
+	for( unsigned int i = 1; i < n; i++ )
+	{
+		iSum += ( i % 2 == 1 ? 4. : 2. ) * eval( a + i * h, fPar );
+	}
+	return iSum * h / 3.;
+}
+
+/*
+ * time (in samples) when pulse crosses iFraction of its maximum
+ * on the rising or falling edge of the pulse
+ */
+double VPulseFitter::getTime( double iFraction, bool iRisingEdge )
+{
+	double iPeak = getPeakPosition();
+	if( iFraction <= 0. || iFraction >= 1. )
+	{
+		return iPeak;
+	}
+	if( fShape == EV )
+	{
+		double L = -1. * log( iFraction );
+		double s = fPar[2];
+		double alpha = fPar[3];
+		if( iRisingEdge )
+		{
+			return iPeak - s * sqrt( 2. * L );
+		}
+		// solve d^2 = 2 L ( s^2 + alpha d )
+		return iPeak + L * alpha + sqrt( L * L * alpha * alpha + 2. * L * s * s );
+	}
+	// grisu pulse: bisection (pulse is monotonic on each side of the maximum)
+	double iLevel = iFraction * getAmplitude();
+	double x1 = fPar[2];
+	double x2 = iPeak;
+	if( !iRisingEdge )
+	{
+		x1 = iPeak;
+		x2 = fPar[2] + fPar[0] + fPar[1];
+	}
+	for( unsigned int i = 0; i < 60; i++ )
+	{
+		double xm = 0.5 * ( x1 + x2 );
+		bool iAbove = ( eval( xm, fPar ) > iLevel );
+		if( iAbove == iRisingEdge )
+		{
+			x2 = xm;
+		}
+		else
+		{
+			x1 = xm;
+		}
+	}
+	return 0.5 * ( x1 + x2 );
+}
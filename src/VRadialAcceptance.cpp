@@ -97,6 +97,7 @@ VRadialAcceptance::VRadialAcceptance( VGammaHadronCuts* icuts, VAnaSumRunParamet
 	hList = new TList();
 	hListNormalizeHistograms = new TList();
 	hListFitHistograms = new TList();
+	hListNotWrittenHistograms = new TList();
 	
 	fCuts = icuts;
 	if( !fCuts )
@@ -261,6 +262,8 @@ VRadialAcceptance::VRadialAcceptance( VGammaHadronCuts* icuts, VAnaSumRunParamet
 	sprintf( hname, "hXYAccTotDeRotRadiusDependentSlice" ) ;
 	sprintf( htitle, "1D histogram from Xoff_derot and Yoff_derot, with All Events, RadiusDependentSlice%03d (Pie Slice)\n, from Phi %3.1f to %3.1f radians", centerdeg, centerdeg - ( rad_phiwidth * 180 / 3.1415 ), centerdeg + ( rad_phiwidth * 180 / 3.1415 ) ) ;
 	hXYAccTotDeRotRadiusDependentSlice000 = new TH1F( hname, htitle, rad_nbins, rad_minrad, rad_maxrad ) ;
+	hListNotWrittenHistograms->Add( hXYAccTotDeRotPhiDependentSlice );
+	hListNotWrittenHistograms->Add( hXYAccTotDeRotRadiusDependentSlice000 );
 	
 	// 2D histograms, sorted by ImgSel
 	TH2F* tmphist2 ;
@@ -271,21 +274,25 @@ VRadialAcceptance::VRadialAcceptance( VGammaHadronCuts* icuts, VAnaSumRunParamet
 		sprintf( htitle, "2D histogram of Xoff_derot and Yoff_derot, with ImgSel=%d", i ) ;
 		tmphist2 = new TH2F( hname, htitle, hn, -1.0 * hr, hr, hn, -1.0 * hr, hr ) ;
 		hXYAccImgSel.push_back( tmphist2 ) ;
+		hListNotWrittenHistograms->Add( hXYAccImgSel.back() );
 		
 		sprintf( hname, "hAccImgSelPreDeRot_%d", i ) ;
 		sprintf( htitle, "2D histogram of Xoff and Yoff, with ImgSel=%d", i ) ;
 		tmphist2 = new TH2F( hname, htitle, hn, -1.0 * hr, hr, hn, -1.0 * hr, hr ) ;
 		hXYAccImgSelPreDeRot.push_back( tmphist2 ) ;
+		hListNotWrittenHistograms->Add( hXYAccImgSelPreDeRot.back() );
 		
 		sprintf( hname, "hAccImgSelPhiDependentSlice_%d", i ) ;
 		sprintf( htitle, "1D histogram from Xoff_derot and Yoff_derot, with ImgSel=%d, PhiDependentSlice\n, %d Bins from %3.1f to %3.1f radians, from Radius %4.2f to %4.2f deg", i, phi_nbins, phi_minphi, phi_maxphi, phi_minradius, phi_maxradius ) ;
 		tmphist1 = new TH1F( hname, htitle, phi_nbins, phi_minphi, phi_maxphi ) ;
 		hXYAccImgSelPhiDependentSlice.push_back( tmphist1 ) ;
+		hListNotWrittenHistograms->Add( hXYAccImgSelPhiDependentSlice.back() );
 		
 		sprintf( hname, "hAccImgSelRadiusDependentSlice%03d_%d", centerdeg, i ) ;
 		sprintf( htitle, "1D histogram from Xoff_derot and Yoff_derot, with ImgSel=%d, RadiusDependentSlice%03d (Pie Slice)\n, from Phi %3.1f to %3.1f radians", i, centerdeg, centerdeg - ( rad_phiwidth * 180 / 3.1415 ), centerdeg + ( rad_phiwidth * 180 / 3.1415 ) ) ;
 		tmphist1 = new TH1F( hname, htitle, rad_nbins, rad_minrad, rad_maxrad ) ;
 		hXYAccImgSelRadiusDependentSlice000.push_back( tmphist1 ) ;
+		hListNotWrittenHistograms->Add( hXYAccImgSelRadiusDependentSlice000.back() );
 		
 	}
 	
@@ -297,21 +304,25 @@ VRadialAcceptance::VRadialAcceptance( VGammaHadronCuts* icuts, VAnaSumRunParamet
 		sprintf( htitle, "2D histogram of Xoff_derot and Yoff_derot, with NImages=%d", i ) ;
 		tmphist2 = new TH2F( hname, htitle, hn, -1.0 * hr, hr, hn, -1.0 * hr, hr ) ;
 		hXYAccNImages.push_back( tmphist2 ) ;
+		hListNotWrittenHistograms->Add( hXYAccNImages.back() );
 		
 		sprintf( hname, "hAccNImagesPreDeRot_%d", i ) ;
 		sprintf( htitle, "2D histogram of Xoff and Yoff, with NImages=%d", i ) ;
 		tmphist2 = new TH2F( hname, htitle, hn, -1.0 * hr, hr, hn, -1.0 * hr, hr ) ;
 		hXYAccNImagesPreDeRot.push_back( tmphist2 ) ;
+		hListNotWrittenHistograms->Add( hXYAccNImagesPreDeRot.back() );
 		
 		sprintf( hname, "hAccNImagesPhiDependentSlice_%d", i ) ;
 		sprintf( htitle, "1D histogram from Xoff_derot and Yoff_derot, with NImages=%d, PhiDependentSlice\n, %d Bins from %3.1f to %3.1f radians, from Radius %4.2f to %4.2f deg", i, phi_nbins, phi_minphi, phi_maxphi, phi_minradius, phi_maxradius ) ;
 		tmphist1 = new TH1F( hname, htitle, phi_nbins, phi_minphi, phi_maxphi ) ;
 		hXYAccNImagesPhiDependentSlice.push_back( tmphist1 ) ;
+		hListNotWrittenHistograms->Add( hXYAccNImagesPhiDependentSlice.back() );
 		
 		sprintf( hname, "hAccNImagesRadiusDependentSlice%03d_%d", centerdeg, i ) ;
 		sprintf( htitle, "2D histogram of Xoff_derot and Yoff_derot, with NImages=%d, RadiusDependentSlice%03d (Pi Slice)\n from %3.1f to %3.1f radians", i, centerdeg, centerdeg - ( rad_phiwidth * 180 / 3.1415 ), centerdeg + ( rad_phiwidth * 180 / 3.1415 ) ) ;
 		tmphist1 = new TH1F( hname, htitle, rad_nbins, rad_minrad, rad_maxrad ) ;
 		hXYAccNImagesRadiusDependentSlice000.push_back( tmphist1 ) ;
+		hListNotWrittenHistograms->Add( hXYAccNImagesRadiusDependentSlice000.back() );
 		
 	}
 	
@@ -361,6 +372,7 @@ void VRadialAcceptance::reset()
 	hList = 0;
 	hListNormalizeHistograms = 0;
 	hListFitHistograms = 0;
+	hListNotWrittenHistograms = 0;
 	
 	fXs = 0.;
 	fYs = 0.;
@@ -395,6 +407,8 @@ void VRadialAcceptance::reset()
 	
 	setEnergyReconstructionMethod();
 	setAzCut();
+	setZeCut();
+	setImgSelCut();
 	
 	fExtraHistogramMode = 0 ;
 	fExtraHistogramDir = "" ;
@@ -579,174 +593,252 @@ int VRadialAcceptance::fillAcceptanceFromData( CData* iData, int entry )
 		return -1;
 	}
 	
-	double idist = 0;
-	double i_Phi = 0.;
-	bool bPassed = false;
+	if( !applyCuts( entry ) || !isInConfiguration( iData ) )
+	{
+		return 0;
+	}
+	fillEvent( iData );
 	
+	return 1;
+}
+
+/*
+
+    fiducial area, stereo quality and gamma/hadron cuts
+
+    (cut decisions depend only on the cuts and not on the configuration
+     of this acceptance object; can therefore be shared between all
+     acceptance objects using the same cuts)
+
+*/
+bool VRadialAcceptance::applyCuts( int entry )
+{
+	if( !fCuts )
+	{
+		return false;
+	}
 	// apply some basic quality cuts
-	if( fCuts->applyInsideFiducialAreaCut() && fCuts->applyStereoQualityCuts( fEnergyReconstructionMethod, false, entry, true ) )
+	if( !fCuts->applyInsideFiducialAreaCut() || !fCuts->applyStereoQualityCuts( fEnergyReconstructionMethod, false, entry, true ) )
 	{
-		// gamma/hadron cuts
-		if( !fCuts->isGamma( entry, false ) )
+		return false;
+	}
+	// gamma/hadron cuts
+	return fCuts->isGamma( entry, false );
+}
+
+/*
+
+    check if event is inside the azimuth, zenith and image selection range of this acceptance
+
+*/
+bool VRadialAcceptance::isInConfiguration( CData* iData )
+{
+	if( !iData )
+	{
+		return false;
+	}
+	// az cut
+	if( fAzCut_min < fAzCut_max )
+	{
+		if( iData->Az <= fAzCut_min || iData->Az > fAzCut_max )
 		{
-			return 0;
+			return false;
 		}
-		
-		// az cut
-		bool bFill = false;
-		if( fAzCut_min < fAzCut_max )
+	}
+	else
+	{
+		if( iData->Az >= fAzCut_max && iData->Az <= fAzCut_min )
 		{
-			if( iData->Az > fAzCut_min && iData->Az <= fAzCut_max )
-			{
-				bFill = true;
-			}
+			return false;
 		}
-		else
+	}
+	// ze cut
+	if( iData->Ze <= fZeCut_min || iData->Ze > fZeCut_max )
+	{
+		return false;
+	}
+	// image selection
+	if( fImgSelCut > 0 && iData->ImgSel != fImgSelCut )
+	{
+		return false;
+	}
+	return true;
+}
+
+/*
+
+    fill radial acceptance histograms (no cuts applied)
+
+*/
+void VRadialAcceptance::fillEvent( CData* iData )
+{
+	double idist = 0;
+	double i_Phi = 0.;
+	
+	idist = sqrt( iData->Xoff * iData->Xoff + iData->Yoff * iData->Yoff );
+	
+	// fill 2D distribution of events
+	hXYAccTot->Fill( iData->Xoff, iData->Yoff );
+	hXYAccTotDeRot->Fill( iData->Xoff_derot, iData->Yoff_derot );
+	
+	hXYAccImgSel[iData->ImgSel]->Fill( iData->Xoff_derot, iData->Yoff_derot ) ;
+	hXYAccImgSelPreDeRot[iData->ImgSel]->Fill( iData->Xoff, iData->Yoff ) ;
+	hXYAccNImages[iData->NImages]->Fill( iData->Xoff_derot, iData->Yoff_derot ) ;
+	hXYAccNImagesPreDeRot[iData->NImages]->Fill( iData->Xoff, iData->Yoff ) ;
+	
+	// 1D histograms
+	// Radius Dependent Histograms
+	eventradius = sqrt( iData->Xoff_derot * iData->Xoff_derot + iData->Yoff_derot * iData->Yoff_derot ) ;
+	eventphi    = atan2( iData->Yoff_derot, iData->Xoff_derot ) ; // radians
+	if( eventphi < 0.0 )
+	{
+		eventphi += 2 * TMath::Pi() ;    // atan2 is from -pi to pi, we want 0 to 2pi
+	}
+	
+	// PhiDependentSlice Fill
+	if( eventradius > phi_minradius && eventradius < phi_maxradius )
+	{
+		hXYAccTotDeRotPhiDependentSlice->Fill( eventphi ) ;
+		hXYAccImgSelPhiDependentSlice[iData->ImgSel]->Fill( eventphi ) ;
+		hXYAccNImagesPhiDependentSlice[iData->NImages]->Fill( eventphi ) ;
+	}
+	
+	// RadiusDependentSlice000 Fill
+	if( eventphi > 0.0 - rad_phiwidth && eventphi < 0.0 + rad_phiwidth )
+	{
+		hXYAccTotDeRotRadiusDependentSlice000->Fill( eventradius ) ;
+		hXYAccImgSelRadiusDependentSlice000[iData->ImgSel]->Fill( eventradius ) ;
+		hXYAccNImagesRadiusDependentSlice000[iData->NImages]->Fill( eventradius ) ;
+	}
+	
+	// fill zenith angle dependent histograms
+	for( unsigned int j = 0; j < fZe.size(); j++ )
+	{
+		if( iData->Ze < fZe[j] )
 		{
-			if( iData->Az < fAzCut_max || iData->Az > fAzCut_min )
+			if( idist > 0. )
 			{
-				bFill = true;
+				hAccZe[j]->Fill( idist );
 			}
+			break;
 		}
-		if( !bFill )
+	}
+	
+	// fill azimuth angle dependend histograms (camera coordinates)
+	i_Phi = atan2( iData->Yoff, iData->Xoff ) * TMath::RadToDeg();
+	hPhiDist->Fill( i_Phi );
+	
+	for( unsigned int j = 0; j < fPhiMin.size(); j++ )
+	{
+		bool bFill = false;
+		if( i_Phi > fPhiMin[j] && i_Phi < fPhiMax[j] )
 		{
-			return 0;
+			bFill = true;
 		}
-		// no more cuts after this statement
-		bPassed = true;
-		
-		idist = sqrt( iData->Xoff * iData->Xoff + iData->Yoff * iData->Yoff );
-		
-		// fill 2D distribution of events
-		hXYAccTot->Fill( iData->Xoff, iData->Yoff );
-		hXYAccTotDeRot->Fill( iData->Xoff_derot, iData->Yoff_derot );
-		
-		hXYAccImgSel[iData->ImgSel]->Fill( iData->Xoff_derot, iData->Yoff_derot ) ;
-		hXYAccImgSelPreDeRot[iData->ImgSel]->Fill( iData->Xoff, iData->Yoff ) ;
-		hXYAccNImages[iData->NImages]->Fill( iData->Xoff_derot, iData->Yoff_derot ) ;
-		hXYAccNImagesPreDeRot[iData->NImages]->Fill( iData->Xoff, iData->Yoff ) ;
-		
-		// 1D histograms
-		// Radius Dependent Histograms
-		eventradius = sqrt( iData->Xoff_derot * iData->Xoff_derot + iData->Yoff_derot * iData->Yoff_derot ) ;
-		eventphi    = atan2( iData->Yoff_derot, iData->Xoff_derot ) ; // radians
-		if( eventphi < 0.0 )
+		else
 		{
-			eventphi += 2 * TMath::Pi() ;    // atan2 is from -pi to pi, we want 0 to 2pi
+			if( fPhiMin[j] > fPhiMax[j] )
+			{
+				if( i_Phi < fPhiMin[j] && i_Phi > fPhiMax[j] )
+				{
+					bFill = false;
+				}
+				else
+				{
+					bFill = true;
+				}
+			}
 		}
-		
-		// PhiDependentSlice Fill
-		if( eventradius > phi_minradius && eventradius < phi_maxradius )
+		if( bFill && idist > 0. )
 		{
-			hXYAccTotDeRotPhiDependentSlice->Fill( eventphi ) ;
-			hXYAccImgSelPhiDependentSlice[iData->ImgSel]->Fill( eventphi ) ;
-			hXYAccNImagesPhiDependentSlice[iData->NImages]->Fill( eventphi ) ;
+			hAccPhi[j]->Fill( idist );
 		}
-		
-		// RadiusDependentSlice000 Fill
-		if( eventphi > 0.0 - rad_phiwidth && eventphi < 0.0 + rad_phiwidth )
+	}
+	// fill azimuth angle dependend histograms (derotated camera coordinates)
+	i_Phi = atan2( iData->Yoff_derot, iData->Xoff_derot ) * TMath::RadToDeg();
+	hPhiDistDeRot->Fill( i_Phi );
+	for( unsigned int j = 0; j < fPhiMin.size(); j++ )
+	{
+		bool bFill = false;
+		if( i_Phi > fPhiMin[j] && i_Phi < fPhiMax[j] )
 		{
-			hXYAccTotDeRotRadiusDependentSlice000->Fill( eventradius ) ;
-			hXYAccImgSelRadiusDependentSlice000[iData->ImgSel]->Fill( eventradius ) ;
-			hXYAccNImagesRadiusDependentSlice000[iData->NImages]->Fill( eventradius ) ;
+			bFill = true;
 		}
-		
-		// fill zenith angle dependent histograms
-		for( unsigned int j = 0; j < fZe.size(); j++ )
+		else
 		{
-			if( iData->Ze < fZe[j] )
+			if( fPhiMin[j] > fPhiMax[j] )
 			{
-				if( idist > 0. )
+				if( i_Phi < fPhiMin[j] && i_Phi > fPhiMax[j] )
 				{
-					hAccZe[j]->Fill( idist );
+					bFill = false;
 				}
-				break;
-			}
-		}
-		
-		// fill azimuth angle dependend histograms (camera coordinates)
-		i_Phi = atan2( iData->Yoff, iData->Xoff ) * TMath::RadToDeg();
-		hPhiDist->Fill( i_Phi );
-		
-		for( unsigned int j = 0; j < fPhiMin.size(); j++ )
-		{
-			bFill = false;
-			if( i_Phi > fPhiMin[j] && i_Phi < fPhiMax[j] )
-			{
-				bFill = true;
-			}
-			else
-			{
-				if( fPhiMin[j] > fPhiMax[j] )
+				else
 				{
-					if( i_Phi < fPhiMin[j] && i_Phi > fPhiMax[j] )
-					{
-						bFill = false;
-					}
-					else
-					{
-						bFill = true;
-					}
+					bFill = true;
 				}
 			}
-			if( bFill && idist > 0. )
-			{
-				hAccPhi[j]->Fill( idist );
-			}
 		}
-		// fill azimuth angle dependend histograms (derotated camera coordinates)
-		i_Phi = atan2( iData->Yoff_derot, iData->Xoff_derot ) * TMath::RadToDeg();
-		hPhiDistDeRot->Fill( i_Phi );
-		for( unsigned int j = 0; j < fPhiMin.size(); j++ )
+		if( bFill &&  idist > 0. )
 		{
-			bool bFill = false;
-			if( i_Phi > fPhiMin[j] && i_Phi < fPhiMax[j] )
-			{
-				bFill = true;
-			}
-			else
+			hAccPhiDerot[j]->Fill( idist );
+		}
+	}
+	// fill run dependent histograms
+	for( unsigned int j = 0; j < fRunPar->fRunList.size(); j++ )
+	{
+		if( iData->runNumber == fRunPar->fRunList[j].fRunOff )
+		{
+			if( idist > 0. && j < hAccRun.size() )
 			{
-				if( fPhiMin[j] > fPhiMax[j] )
-				{
-					if( i_Phi < fPhiMin[j] && i_Phi > fPhiMax[j] )
-					{
-						bFill = false;
-					}
-					else
-					{
-						bFill = true;
-					}
-				}
+				hAccRun[j]->Fill( idist );
 			}
-			if( bFill &&  idist > 0. )
+			if( j < hXYAccRun.size() )
 			{
-				hAccPhiDerot[j]->Fill( idist );
+				hXYAccRun[j]->Fill( iData->Xoff, iData->Yoff );
 			}
+			break;
 		}
-		// fill run dependent histograms
-		for( unsigned int j = 0; j < fRunPar->fRunList.size(); j++ )
+	}
+}
+
+/*
+
+    add histograms of another acceptance object with the same configuration
+    (used to merge acceptances filled in parallel)
+
+*/
+bool VRadialAcceptance::add( VRadialAcceptance* iAcc )
+{
+	if( !iAcc || !hList || !iAcc->hList || hList->GetSize() != iAcc->hList->GetSize()
+			|| !hListNotWrittenHistograms || !iAcc->hListNotWrittenHistograms
+			|| hListNotWrittenHistograms->GetSize() != iAcc->hListNotWrittenHistograms->GetSize() )
+	{
+		cout << "VRadialAcceptance::add error: incompatible acceptance objects" << endl;
+		return false;
+	}
+	TIter next( hList );
+	TIter next_add( iAcc->hList );
+	while( TH1* h = ( TH1* )next() )
+	{
+		TH1* h_add = ( TH1* )next_add();
+		// scaling histogram is not filled
+		if( h == hscale || !h_add )
 		{
-			if( iData->runNumber == fRunPar->fRunList[j].fRunOff )
-			{
-				if( idist > 0. && j < hAccRun.size() )
-				{
-					hAccRun[j]->Fill( idist );
-				}
-				if( j < hXYAccRun.size() )
-				{
-					hXYAccRun[j]->Fill( iData->Xoff, iData->Yoff );
-				}
-				break;
-			}
+			continue;
 		}
+		h->Add( h_add );
 	}
-	
-	if( bPassed )
+	TIter next_nw( hListNotWrittenHistograms );
+	TIter next_nw_add( iAcc->hListNotWrittenHistograms );
+	while( TH1* h = ( TH1* )next_nw() )
 	{
-		return 1;
+		TH1* h_add = ( TH1* )next_nw_add();
+		if( h_add )
+		{
+			h->Add( h_add );
+		}
 	}
-	
-	return 0;
+	return true;
 }
 
 /*
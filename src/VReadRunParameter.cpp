@@ -380,6 +380,11 @@ bool VReadRunParameter::readCommandline( int argc, char* argv[] )
 		{
 			fRunPara->fCalibrationSumWindow = atoi( iTemp.substr( iTemp.rfind( "=" ) + 1, iTemp.size() ).c_str() );
 		}
+		else if( iTemp.find( "calibrationthreads" ) < iTemp.size() )
+		{
+			int iNThreads = atoi( iTemp.substr( iTemp.rfind( "=" ) + 1, iTemp.size() ).c_str() );
+			fRunPara->fCalibrationNThreads = ( iNThreads > 1 ? ( unsigned int )iNThreads : 1 );
+		}
 		else if( iTemp.find( "calibrationsumfirst" ) < iTemp.size() && iTemp != "pedestalsintimeslices" )
 		{
 			fRunPara->fCalibrationSumFirst = atoi( iTemp.substr( iTemp.rfind( "=" ) + 1, iTemp.size() ).c_str() );
@@ -684,6 +689,25 @@ bool VReadRunParameter::readCommandline( int argc, char* argv[] )
 				fRunPara->fFirstEvent = -10000;
 			}
 		}
+		// last event number (VBF files only)
+		else if( iTemp.rfind( "lastevent" ) < iTemp.size() )
+		{
+			fRunPara->fLastEvent = atoi( iTemp.substr( iTemp.rfind( "=" ) + 1, iTemp.size() ).c_str() );
+			if( fRunPara->fLastEvent < 0 )
+			{
+				fRunPara->fLastEvent = -10000;
+			}
+		}
+		// directory for VBF packet index files
+		else if( iTemp.find( "vbfindexdir" ) < iTemp.size() )
+		{
+			fRunPara->fVBFPacketIndexDirectory = iTemp1.substr( iTemp1.rfind( "=" ) + 1, iTemp1.size() );
+		}
+		// compute checksum of raw data file while reading it
+		else if( iTemp.find( "-checksum" ) < iTemp.size() )
+		{
+			fRunPara->fComputeChecksum = true;
+		}
 		// start analyzing at this minute
 		else if( iTemp.find( "timecutmin" ) < iTemp.size() )
 		{
@@ -755,6 +779,22 @@ bool VReadRunParameter::readCommandline( int argc, char* argv[] )
 				i++;
 			}
 		}
+		else if( iTemp.find( "geometrycache" ) < iTemp.size() )
+		{
+			if( iTemp2.size() > 0 )
+			{
+				fRunPara->fGeometryCacheDirectory = iTemp2;
+				i++;
+			}
+		}
+		else if( iTemp.find( "calibrationcache" ) < iTemp.size() )
+		{
+			if( iTemp2.size() > 0 )
+			{
+				fRunPara->fCalibrationCacheDirectory = iTemp2;
+				i++;
+			}
+		}
 		else if( iTemp.find( "calibrationdirectory" ) < iTemp.size() )
 		{
 			if( iTemp2.size() > 0 )
@@ -899,6 +939,10 @@ bool VReadRunParameter::readCommandline( int argc, char* argv[] )
 				fRunPara->ftracefile = "";
 			}
 		}
+		else if( iTemp.find( "tracefitminuit" ) < iTemp.size() )
+		{
+			fRunPara->ftracefitMinuit = true;
+		}
 		else if( iTemp.find( "tracefit" ) < iTemp.size() )
 		{
 			fRunPara->ftracefit = atof( iTemp.substr( iTemp.rfind( "=" ) + 1, iTemp.size() ).c_str() );
@@ -963,6 +1007,30 @@ bool VReadRunParameter::readCommandline( int argc, char* argv[] )
 		{
 			fRunPara->fWriteImagePixelList = true;
 		}
+		else if( iTemp.find( "iocompression" ) < iTemp.size() )
+		{
+			fRunPara->fTreeCompression = iTemp1.substr( iTemp1.rfind( "=" ) + 1, iTemp1.size() );
+		}
+		else if( iTemp.find( "ioautoflush" ) < iTemp.size() )
+		{
+			fRunPara->fTreeAutoFlush = atoll( iTemp.substr( iTemp.rfind( "=" ) + 1, iTemp.size() ).c_str() );
+		}
+		else if( iTemp.find( "iobasketsize" ) < iTemp.size() )
+		{
+			// basket size for all branches or for an individual branch (BRANCHNAME:BYTES)
+			if( iTemp1.find( ":" ) != string::npos )
+			{
+				fRunPara->fTreeBranchBasketSize.push_back( iTemp1.substr( iTemp1.rfind( "=" ) + 1, iTemp1.size() ) );
+			}
+			else
+			{
+				fRunPara->fTreeBasketSize = atoi( iTemp.substr( iTemp.rfind( "=" ) + 1, iTemp.size() ).c_str() );
+			}
+		}
+		else if( iTemp.find( "iothreads" ) < iTemp.size() )
+		{
+			fRunPara->fTreeIOThreads = atoi( iTemp.substr( iTemp.rfind( "=" ) + 1, iTemp.size() ).c_str() );
+		}
 		else if( i > 1 )
 		{
 			cout << "unknown command line parameter: " << iTemp << endl;
@@ -148,85 +148,9 @@ bool VSimpleStereoReconstructor::reconstruct_direction( unsigned int i_ntel,
 	////////////////////////////////////////////////
 	// Hofmann et al 1999, Method 1 (HEGRA method)
 	// (modified weights)
-	
-	float itotweight = 0.;
-	float iweight = 1.;
-	float ixs = 0.;
-	float iys = 0.;
-	float iangdiff = 0.;
-	float b1 = 0.;
-	float b2 = 0.;
-	vector< float > v_xs;
-	vector< float > v_ys;
-	fmean_iangdiff = 0.;
-	float fmean_iangdiffN = 0.;
-	
-	for( unsigned int ii = 0; ii < m.size(); ii++ )
-	{
-		for( unsigned int jj = 1; jj < m.size(); jj++ )
-		{
-			if( ii >= jj )
-			{
-				continue;
-			}
-			
-			// check minimum angle between image lines; ignore if too small
-			iangdiff = fabs( atan( m[jj] ) - atan( m[ii] ) );
-			if( iangdiff < fAxesAngles_min * TMath::DegToRad() ||
-					fabs( 180. * TMath::DegToRad() - iangdiff ) < fAxesAngles_min * TMath::DegToRad() )
-			{
-				continue;
-			}
-			// mean angle between images
-			if( iangdiff < 90. * TMath::DegToRad() )
-			{
-				fmean_iangdiff += iangdiff * TMath::RadToDeg();
-			}
-			else
-			{
-				fmean_iangdiff += ( 180. - iangdiff * TMath::RadToDeg() );
-			}
-			fmean_iangdiffN++;
-			
-			// weight is sin of angle between image lines
-			iangdiff = fabs( sin( fabs( atan( m[jj] ) - atan( m[ii] ) ) ) );
-			
-			b1 = y[ii] - m[ii] * x[ii];
-			b2 = y[jj] - m[jj] * x[jj];
-			
-			// line intersection
-			if( m[ii] != m[jj] )
-			{
-				xs = ( b2 - b1 )  / ( m[ii] - m[jj] );
-			}
-			else
-			{
-				xs = 0.;
-			}
-			ys = m[ii] * xs + b1;
-			
-			iweight  = 1. / ( 1. / w[ii] + 1. / w[jj] ); // weight 1: size of images
-			iweight *= ( 1. - l[ii] ) * ( 1. - l[jj] ); // weight 2: elongation of images (width/length)
-			iweight *= iangdiff;                      // weight 3: angular differences between the two image axis
-			iweight *= iweight;                       // use squared value
-			
-			ixs += xs * iweight;
-			iys += ys * iweight;
-			itotweight += iweight;
-			
-			v_xs.push_back( xs );
-			v_ys.push_back( ys );
-		}
-	}
-	// average difference between image pairs
-	if( fmean_iangdiffN > 0. )
-	{
-		fmean_iangdiff /= fmean_iangdiffN;
-	}
-	else
-	{
-		fmean_iangdiff = 0.;
-	}
+	float iDispDiff = 0.;
+	float itotweight = rcs_pairwise_intersection( x, y, w, m, l, fAxesAngles_min * TMath::DegToRad(),
+					   &xs, &ys, &fmean_iangdiff, &iDispDiff );
 	if( w.size() > 2 )
 	{
 		fiangdiff = fmean_iangdiff;
@@ -234,31 +158,13 @@ bool VSimpleStereoReconstructor::reconstruct_direction( unsigned int i_ntel,
 	// check validity of weight
 	if( itotweight > 0. )
 	{
-		ixs /= itotweight;
-		iys /= itotweight;
-		fShower_Xoffset = ixs;
-		fShower_Yoffset = iys;
-		// calculate dispdiff
+		fShower_Xoffset = xs;
+		fShower_Yoffset = ys;
+		// dispdiff
 		// (this is not exactly dispdiff, but
-		//  an equivalent measure comparable to dispdiff)
-		fShower_DispDiff = 0.;
-		float z = 0;
-		for( unsigned n = 0; n < v_xs.size(); n++ )
-		{
-			for( unsigned m = 0; m < v_xs.size(); m++ )
-			{
-				if( n > m )
-				{
-					fShower_DispDiff += ( v_xs[n] - v_xs[m] ) * ( v_xs[n] - v_xs[m] );
-					fShower_DispDiff += ( v_ys[n] - v_ys[m] ) * ( v_ys[n] - v_ys[m] );
-					z++;
-				}
-			}
-		}
-		if( z > 0. )
-		{
-			fShower_DispDiff /= z;
-		}
+		//  an equivalent measure comparable to dispdiff:
+		//  mean squared distance between pairwise intersection points)
+		fShower_DispDiff = iDispDiff;
 	}
 	else
 	{
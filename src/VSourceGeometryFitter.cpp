@@ -23,6 +23,7 @@ VSourceGeometryFitter::VSourceGeometryFitter()
 	fXStart         = 0;
 	fYStart         = 0;
 	fPSF            = 0.063;
+	fNThreads       = TMath::Max( std::thread::hardware_concurrency(), ( unsigned int )1 );
 	setFitterDefaultData();
 	setFitter( "RadialAsymmetricSource_LL" );
 	
@@ -38,6 +39,7 @@ VSourceGeometryFitter::VSourceGeometryFitter( string iAnaSumDataFile, int iRunNu
 	fXStart         = 0;
 	fYStart         = 0;
 	fPSF            = 0.063;
+	fNThreads       = TMath::Max( std::thread::hardware_concurrency(), ( unsigned int )1 );
 	if( !openFile( fAnasumDataFile, fRunNumber, 1 ) )
 	{
 		return;
@@ -349,6 +351,8 @@ void VSourceGeometryFitter::help()
 	{
 		cout << "\t" << fDefaultFitterData[i]->fFitterName << "   " << fDefaultFitterData[i]->fFitterDescription << endl;
 	}
+	cout << "number of threads for likelihood summation: " << fNThreads;
+	cout << " (set with VSourceGeometryFitter::setNumberOfThreads() or VSourceGeometryFitter::fitSource() )" << endl;
 }
 
 TCanvas* VSourceGeometryFitter::plot( double rmax, double zmin, double zmax, string iPlotMode )
@@ -706,8 +710,19 @@ bool VSourceGeometryFitter::setFitter( string iDescription )
 	return false;
 }
 
-void VSourceGeometryFitter::fitSource( string iHisName, double xStart, double yStart, double xyRange )
+/*
+    fit source geometry
+
+    iNThreads : number of threads for the likelihood summation
+                (0: use value set with setNumberOfThreads(); default
+                is the number of available cores)
+*/
+void VSourceGeometryFitter::fitSource( string iHisName, double xStart, double yStart, double xyRange, unsigned int iNThreads )
 {
+	if( iNThreads > 0 )
+	{
+		setNumberOfThreads( iNThreads );
+	}
 
 	fXStart = xStart;
 	fYStart = yStart;
@@ -728,20 +743,22 @@ void VSourceGeometryFitter::fitSource( string iHisName, double xStart, double yS
 		return;
 	}
 	
-	//////////////////////////////////////
-	// define minuit
-	//////////////////////////////////////
-	TFitterMinuit* fSourceGeometryFitter_MINUIT = new TFitterMinuit();
-	
 	//////////////////////////////////////
 	// set fit function
+	// (sky map bins inside the fit range are extracted once by the
+	//  fit function; functions with analytic gradients are passed
+	//  as FCNGradientBase to Migrad)
 	//////////////////////////////////////
+	ROOT::Minuit2::FCNGradientBase* iFCNGradient = 0;
+	ROOT::Minuit2::FCNBase* iFCN = 0;
+	VSourceGeometryFitterFCN* iFCNBins = 0;
 	
 	// Source #1 radial symmetric source, Chi2
-	VFun_SourceDescription_RadialSymmetricSource_Chi2 fcn_RadialSymmetricSource_Chi2( fHisSkyMap, xStart - xyRange, xStart + xyRange, yStart - xyRange, yStart + xyRange, fPSF );
 	if( fFitter->fFitterName == "RadialSymmetricSource_Chi2" )
 	{
-		fSourceGeometryFitter_MINUIT->SetMinuitFCN( &fcn_RadialSymmetricSource_Chi2 );
+		VFun_SourceDescription_RadialSymmetricSource_Chi2* fcn_RadialSymmetricSource_Chi2 = new VFun_SourceDescription_RadialSymmetricSource_Chi2( fHisSkyMap, xStart - xyRange, xStart + xyRange, yStart - xyRange, yStart + xyRange, fPSF );
+		iFCNGradient = fcn_RadialSymmetricSource_Chi2;
+		iFCNBins = fcn_RadialSymmetricSource_Chi2;
 		// update parameters
 		fFitter->fParameterInitValue[0]  = xStart;
 		fFitter->fParameterLowerLimit[0] = xStart - xyRange;
@@ -767,10 +784,11 @@ void VSourceGeometryFitter::fitSource( string iHisName, double xStart, double yS
 	
 	
 	// Source #3 radial symmetric source, LL
-	VFun_SourceDescription_RadialSymmetricSource_LL fcn_RadialSymmetricSource_LL( fHisSkyMap, xStart - xyRange, xStart + xyRange, yStart - xyRange, yStart + xyRange, fPSF );
 	if( fFitter->fFitterName == "RadialSymmetricSource_LL" )
 	{
-		fSourceGeometryFitter_MINUIT->SetMinuitFCN( &fcn_RadialSymmetricSource_LL );
+		VFun_SourceDescription_RadialSymmetricSource_LL* fcn_RadialSymmetricSource_LL = new VFun_SourceDescription_RadialSymmetricSource_LL( fHisSkyMap, xStart - xyRange, xStart + xyRange, yStart - xyRange, yStart + xyRange, fPSF );
+		iFCNGradient = fcn_RadialSymmetricSource_LL;
+		iFCNBins = fcn_RadialSymmetricSource_LL;
 		// update parameters
 		fFitter->fParameterInitValue[0]  = xStart;
 		fFitter->fParameterLowerLimit[0] = xStart - xyRange;
@@ -781,10 +799,11 @@ void VSourceGeometryFitter::fitSource( string iHisName, double xStart, double yS
 	}
 	
 	// Source #4 radial asymmetric source, LL
-	VFun_SourceDescription_RadialAsymmetricSource_LL fcn_RadialAsymmetricSource_LL( fHisSkyMap, xStart - xyRange, xStart + xyRange, yStart - xyRange, yStart + xyRange, fPSF );
 	if( fFitter->fFitterName == "RadialAsymmetricSource_LL" )
 	{
-		fSourceGeometryFitter_MINUIT->SetMinuitFCN( &fcn_RadialAsymmetricSource_LL );
+		VFun_SourceDescription_RadialAsymmetricSource_LL* fcn_RadialAsymmetricSource_LL = new VFun_SourceDescription_RadialAsymmetricSource_LL( fHisSkyMap, xStart - xyRange, xStart + xyRange, yStart - xyRange, yStart + xyRange, fPSF );
+		iFCN = fcn_RadialAsymmetricSource_LL;
+		iFCNBins = fcn_RadialAsymmetricSource_LL;
 		// update parameters
 		fFitter->fParameterInitValue[1]  = xStart;
 		fFitter->fParameterLowerLimit[1] = xStart - xyRange;
@@ -813,10 +832,11 @@ void VSourceGeometryFitter::fitSource( string iHisName, double xStart, double yS
 	*/
 	
 	// PSF description #1
-	VFun_PSFDescription_2DGauss_Chi2 fcn_2DGauss_Chi2( fHisSkyMap, xStart - xyRange, xStart + xyRange, yStart - xyRange, yStart + xyRange );
 	if( fFitter->fFitterName == "2DGauss_Chi2" )
 	{
-		fSourceGeometryFitter_MINUIT->SetMinuitFCN( &fcn_2DGauss_Chi2 );
+		VFun_PSFDescription_2DGauss_Chi2* fcn_2DGauss_Chi2 = new VFun_PSFDescription_2DGauss_Chi2( fHisSkyMap, xStart - xyRange, xStart + xyRange, yStart - xyRange, yStart + xyRange );
+		iFCNGradient = fcn_2DGauss_Chi2;
+		iFCNBins = fcn_2DGauss_Chi2;
 		// update parameters
 		fFitter->fParameterInitValue[3]  = xStart;
 		fFitter->fParameterLowerLimit[3] = xStart - xyRange;
@@ -827,10 +847,11 @@ void VSourceGeometryFitter::fitSource( string iHisName, double xStart, double yS
 	}
 	
 	// PSF description #2
-	VFun_PSFDescription_2DGauss_LL fcn_2DGauss_LL( fHisSkyMap, xStart - xyRange, xStart + xyRange, yStart - xyRange, yStart + xyRange );
 	if( fFitter->fFitterName == "2DGauss_LL" )
 	{
-		fSourceGeometryFitter_MINUIT->SetMinuitFCN( &fcn_2DGauss_LL );
+		VFun_PSFDescription_2DGauss_LL* fcn_2DGauss_LL = new VFun_PSFDescription_2DGauss_LL( fHisSkyMap, xStart - xyRange, xStart + xyRange, yStart - xyRange, yStart + xyRange );
+		iFCNGradient = fcn_2DGauss_LL;
+		iFCNBins = fcn_2DGauss_LL;
 		// update parameters
 		fFitter->fParameterInitValue[0]  = xStart;
 		fFitter->fParameterLowerLimit[0] = xStart - xyRange;
@@ -841,10 +862,11 @@ void VSourceGeometryFitter::fitSource( string iHisName, double xStart, double yS
 	}
 	
 	// PSF description #3
-	VFun_PSFDescription_LinearSuperposition2DGauss_LL fcn_LinearSuperposition2DGauss_LL( fHisSkyMap, xStart - xyRange, xStart + xyRange, yStart - xyRange, yStart + xyRange );
 	if( fFitter->fFitterName == "LinearSuperposition2DGauss_LL" )
 	{
-		fSourceGeometryFitter_MINUIT->SetMinuitFCN( &fcn_LinearSuperposition2DGauss_LL );
+		VFun_PSFDescription_LinearSuperposition2DGauss_LL* fcn_LinearSuperposition2DGauss_LL = new VFun_PSFDescription_LinearSuperposition2DGauss_LL( fHisSkyMap, xStart - xyRange, xStart + xyRange, yStart - xyRange, yStart + xyRange );
+		iFCNGradient = fcn_LinearSuperposition2DGauss_LL;
+		iFCNBins = fcn_LinearSuperposition2DGauss_LL;
 		// update parameters
 		fFitter->fParameterInitValue[0]  = xStart;
 		fFitter->fParameterLowerLimit[0] = xStart - xyRange;
@@ -854,29 +876,66 @@ void VSourceGeometryFitter::fitSource( string iHisName, double xStart, double yS
 		fFitter->fParameterUpperLimit[1] = yStart + xyRange;
 	}
 	
-	fSourceGeometryFitter_MINUIT->SetPrintLevel( 3 );
+	if( !iFCNBins )
+	{
+		cout << "VSourceGeometryFitter::fitSource: no fit function for fitter " << fFitter->fFitterName << endl;
+		return;
+	}
+	iFCNBins->setNumberOfThreads( fNThreads );
+	cout << "VSourceGeometryFitter::fitSource: " << iFCNBins->getNBins() << " bins in fit range";
+	cout << " (" << fNThreads << " thread(s))" << endl;
 	
 	// set parameters
+	// (parameters with identical lower and upper limits are unbounded)
+	ROOT::Minuit2::MnUserParameters iParameters;
 	for( unsigned int i = 0; i < fFitter->fParameterName.size(); i++ )
 	{
-		fSourceGeometryFitter_MINUIT->SetParameter( i, fFitter->fParameterName[i].c_str(), fFitter->fParameterInitValue[i], fFitter->fParameterStep[i], fFitter->fParameterLowerLimit[i], fFitter->fParameterUpperLimit[i] );
+		if( fFitter->fParameterLowerLimit[i] < fFitter->fParameterUpperLimit[i] )
+		{
+			iParameters.Add( fFitter->fParameterName[i], fFitter->fParameterInitValue[i], fFitter->fParameterStep[i],
+							 fFitter->fParameterLowerLimit[i], fFitter->fParameterUpperLimit[i] );
+		}
+		else
+		{
+			iParameters.Add( fFitter->fParameterName[i], fFitter->fParameterInitValue[i], fFitter->fParameterStep[i] );
+		}
 	}
 	
+	// start minimizing (Migrad)
+	ROOT::Minuit2::FunctionMinimum* iMinimum = 0;
+	if( iFCNGradient )
+	{
+		ROOT::Minuit2::MnMigrad iMigrad( *iFCNGradient, iParameters );
+		iMinimum = new ROOT::Minuit2::FunctionMinimum( iMigrad() );
+	}
+	else
+	{
+		ROOT::Minuit2::MnMigrad iMigrad( *iFCN, iParameters );
+		iMinimum = new ROOT::Minuit2::FunctionMinimum( iMigrad() );
+	}
 	
-	// start minimizing
-	// (default is kMigrad)
-	fSourceGeometryFitter_MINUIT->CreateMinimizer();
-	
-	fFitter->fFitResult_Status = fSourceGeometryFitter_MINUIT->Minimize();
-	cout << "Fit status " << fFitter->fFitResult_Status << endl;
+	fFitter->fFitResult_Status = ( iMinimum->IsValid() ? 0 : 1 );
+	cout << "Fit status " << fFitter->fFitResult_Status;
+	cout << " (FCN = " << iMinimum->Fval() << ", EDM = " << iMinimum->Edm() << ", " << iMinimum->NFcn() << " function calls)" << endl;
 	
 	// retrieve parameters
 	fFitter->fFitResult_Parameter.clear();
 	fFitter->fFitResult_ParameterError.clear();
 	for( unsigned int i = 0; i < fFitter->fParameterName.size(); i++ )
 	{
-		fFitter->fFitResult_Parameter.push_back( fSourceGeometryFitter_MINUIT->GetParameter( i ) );
-		fFitter->fFitResult_ParameterError.push_back( fSourceGeometryFitter_MINUIT->GetParError( i ) );
+		fFitter->fFitResult_Parameter.push_back( iMinimum->UserState().Value( i ) );
+		fFitter->fFitResult_ParameterError.push_back( iMinimum->UserState().Error( i ) );
+		cout << "\t" << fFitter->fParameterName[i] << ": " << fFitter->fFitResult_Parameter.back();
+		cout << " +- " << fFitter->fFitResult_ParameterError.back() << endl;
+	}
+	delete iMinimum;
+	if( iFCNGradient )
+	{
+		delete iFCNGradient;
+	}
+	if( iFCN )
+	{
+		delete iFCN;
 	}
 	
 	
@@ -952,35 +1011,411 @@ void VSourceGeometryFitter::fitSource( string iHisName, double xStart, double yS
 
 
 
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+/*
+    base class for fit functions
+
+    all sky map bins inside the fit range are copied once into
+    contiguous arrays; the minimizer evaluates the fit function
+    on these arrays only (no histogram access during minimization)
+
+    worker threads for the summation are started in setNumberOfThreads()
+    and wait for the next function evaluation (no threads are started
+    per evaluation)
+*/
+
+VSourceGeometryFitterFCN::VSourceGeometryFitterFCN()
+{
+	fNThreads = 1;
+	fNWorkers = 1;
+	fWorkerGeneration = 0;
+	fWorkerPending = 0;
+	bWorkerStop = false;
+	fWorkerPar = 0;
+	bWorkerGradient = false;
+}
+
+VSourceGeometryFitterFCN::~VSourceGeometryFitterFCN()
+{
+	stopWorkers();
+}
+
+/*
+    set number of threads and (re)start worker threads
+
+    (bins must be filled before, see fillBins())
+*/
+void VSourceGeometryFitterFCN::setNumberOfThreads( unsigned int iNThreads )
+{
+	stopWorkers();
+	fNThreads = iNThreads;
+	startWorkers();
+}
+
+/*
+    split bins into blocks of fBinsPerBlock bins (independent of the
+    number of threads) and start one worker thread per thread except
+    the first one (the calling thread)
+*/
+void VSourceGeometryFitterFCN::startWorkers()
+{
+	unsigned int iNBins = fN.size();
+	for( unsigned int i = 0; i < iNBins; i += fBinsPerBlock )
+	{
+		fBlockFirst.push_back( i );
+		fBlockLast.push_back( TMath::Min( i + fBinsPerBlock, iNBins ) );
+	}
+	fBlockSum.assign( fBlockFirst.size(), 0. );
+	fBlockGradient.assign( fBlockFirst.size(), vector< double >() );
+	fNWorkers = TMath::Max( TMath::Min( fNThreads, ( unsigned int )fBlockFirst.size() ), ( unsigned int )1 );
+	bWorkerStop = false;
+	for( unsigned int w = 1; w < fNWorkers; w++ )
+	{
+		fWorkers.push_back( std::thread( runWorker, this, w, fWorkerGeneration ) );
+	}
+}
+
+void VSourceGeometryFitterFCN::stopWorkers()
+{
+	if( fWorkers.size() > 0 )
+	{
+		{
+			std::lock_guard< std::mutex > iLock( fWorkerMutex );
+			bWorkerStop = true;
+		}
+		fWorkerStart.notify_all();
+		for( unsigned int i = 0; i < fWorkers.size(); i++ )
+		{
+			fWorkers[i].join();
+		}
+	}
+	fWorkers.clear();
+	fNWorkers = 1;
+	fBlockFirst.clear();
+	fBlockLast.clear();
+	fBlockSum.clear();
+	fBlockGradient.clear();
+}
+
+/*
+    sum blocks iWorker, iWorker + n, iWorker + 2n, ... (n: number of workers)
+*/
+void VSourceGeometryFitterFCN::sumBlocks( const vector< double >& par, unsigned int iWorker, bool iGradient ) const
+{
+	for( unsigned int b = iWorker; b < fBlockFirst.size(); b += fNWorkers )
+	{
+		fBlockSum[b] = evaluateBins( par, fBlockFirst[b], fBlockLast[b], ( iGradient ? &fBlockGradient[b] : ( vector< double >* )0 ) );
+	}
+}
+
+/*
+    worker thread: sum blocks of worker iWorker for each new function evaluation
+*/
+void VSourceGeometryFitterFCN::runWorker( VSourceGeometryFitterFCN* iFCN, unsigned int iWorker, unsigned int iGeneration )
+{
+	for( ;; )
+	{
+		{
+			std::unique_lock< std::mutex > iLock( iFCN->fWorkerMutex );
+			while( !iFCN->bWorkerStop && iFCN->fWorkerGeneration == iGeneration )
+			{
+				iFCN->fWorkerStart.wait( iLock );
+			}
+			if( iFCN->bWorkerStop )
+			{
+				return;
+			}
+			iGeneration = iFCN->fWorkerGeneration;
+		}
+		
+		iFCN->sumBlocks( *iFCN->fWorkerPar, iWorker, iFCN->bWorkerGradient );
+		
+		{
+			std::lock_guard< std::mutex > iLock( iFCN->fWorkerMutex );
+			iFCN->fWorkerPending--;
+			if( iFCN->fWorkerPending == 0 )
+			{
+				iFCN->fWorkerDone.notify_one();
+			}
+		}
+	}
+}
+
+void VSourceGeometryFitterFCN::fillBins( TH2D* iSkymap, double i_xmin, double i_xmax, double i_ymin, double i_ymax )
+{
+	fX.clear();
+	fY.clear();
+	fN.clear();
+	fNErr.clear();
+	if( !iSkymap )
+	{
+		return;
+	}
+	
+	int nbinsX = iSkymap->GetNbinsX();
+	int nbinsY = iSkymap->GetNbinsY();
+	for( int i = 1; i <= nbinsX; i++ )
+	{
+		double x = iSkymap->GetXaxis()->GetBinCenter( i );
+		// check x-range
+		if( x > i_xmax || x < i_xmin )
+		{
+			continue;
+		}
+		for( int j = 1; j <= nbinsY; j++ )
+		{
+			double y = iSkymap->GetYaxis()->GetBinCenter( j );
+			// check y-range
+			if( y > i_ymax || y < i_ymin )
+			{
+				continue;
+			}
+			fX.push_back( x );
+			fY.push_back( y );
+			fN.push_back( iSkymap->GetBinContent( i, j ) );
+			fNErr.push_back( iSkymap->GetBinError( i, j ) );
+		}
+	}
+}
+
+/*
+    sum fit function over all bins
+
+    blocks of bins are evaluated in parallel by the worker threads;
+    partial sums (and gradients) are added in fixed block order, and
+    the blocks do not depend on the number of threads; results are
+    therefore independent of thread scheduling and number of threads
+
+    (not reentrant: the minimizer evaluates the function sequentially)
+*/
+double VSourceGeometryFitterFCN::sumBins( const vector< double >& par, vector< double >* iGradient ) const
+{
+	// no blocks defined (setNumberOfThreads() not called)
+	if( fBlockFirst.size() == 0 )
+	{
+		return evaluateBins( par, 0, fN.size(), iGradient );
+	}
+	
+	if( iGradient )
+	{
+		for( unsigned int b = 0; b < fBlockGradient.size(); b++ )
+		{
+			fBlockGradient[b].assign( par.size(), 0. );
+		}
+	}
+	// start workers
+	if( fWorkers.size() > 0 )
+	{
+		{
+			std::lock_guard< std::mutex > iLock( fWorkerMutex );
+			fWorkerPar = &par;
+			bWorkerGradient = ( iGradient != 0 );
+			fWorkerPending = fWorkers.size();
+			fWorkerGeneration++;
+		}
+		fWorkerStart.notify_all();
+	}
+	
+	// blocks of worker 0 are summed by this thread
+	sumBlocks( par, 0, ( iGradient != 0 ) );
+	
+	// wait for workers
+	if( fWorkers.size() > 0 )
+	{
+		std::unique_lock< std::mutex > iLock( fWorkerMutex );
+		while( fWorkerPending > 0 )
+		{
+			fWorkerDone.wait( iLock );
+		}
+	}
+	
+	double iSum = 0.;
+	for( unsigned int b = 0; b < fBlockSum.size(); b++ )
+	{
+		iSum += fBlockSum[b];
+		if( iGradient )
+		{
+			for( unsigned int p = 0; p < iGradient->size() && p < fBlockGradient[b].size(); p++ )
+			{
+				( *iGradient )[p] += fBlockGradient[b][p];
+			}
+		}
+	}
+	return iSum;
+}
+
+/*
+    Poisson log-likelihood term for a single bin (neglecting background noise)
+
+    returns -LL; iDerivative is d(-LL)/d(mu)
+*/
+inline double getPoissonLikelihoodTerm( double n, double mu, double& iDerivative )
+{
+	if( n > 0. && mu > 0. )
+	{
+		iDerivative = 1. - n / mu;
+		return -1. * ( n * log( mu ) - mu - n * log( n ) + n );
+	}
+	iDerivative = 1.;
+	return mu;
+}
+
+
 VFun_PSFDescription_2DGauss_Chi2::VFun_PSFDescription_2DGauss_Chi2( TH2D* iSkymap, double i_xmin, double i_xmax, double i_ymin, double i_ymax )
 {
-	hSkyMap = iSkymap;
-	xmin = i_xmin;
-	xmax = i_xmax;
-	ymin = i_ymin;
-	ymax = i_ymax;
+	fillBins( iSkymap, i_xmin, i_xmax, i_ymin, i_ymax );
+}
+
+/*
+    chi2 = sum_i ( fT_i - n_i )^2 / e_i^2
+    fT = p0 + p1 * exp( -t2 / 2 / p2^2 ), t2 = (x-p3)^2 + (y-p4)^2
+*/
+double VFun_PSFDescription_2DGauss_Chi2::evaluateBins( const vector< double >& par, unsigned int iFirst, unsigned int iLast, vector< double >* iGradient ) const
+{
+	double sum = 0.;
+	double sigmaSource2 = par[2] * par[2];
+	
+	for( unsigned int i = iFirst; i < iLast; i++ )
+	{
+		// calculate theta2
+		double dx = fX[i] - par[3];
+		double dy = fY[i] - par[4];
+		double t2 = dx * dx + dy * dy;
+		
+		// calculate expectation from model function
+		double iExp = TMath::Exp( -1.*t2 / 2. / sigmaSource2 );
+		double fT = par[0] + par[1] * iExp;
+		if( isnan( fT ) )
+		{
+			continue;
+		}
+		
+		// calculate chi2
+		if( fNErr[i] > 0. && fN[i] > -90. )
+		{
+			double iW = 1. / fNErr[i] / fNErr[i];
+			sum += ( fT - fN[i] ) * ( fT - fN[i] ) * iW;
+			if( iGradient )
+			{
+				double dF = 2. * ( fT - fN[i] ) * iW;
+				( *iGradient )[0] += dF;
+				( *iGradient )[1] += dF * iExp;
+				( *iGradient )[2] += dF * par[1] * iExp * t2 / ( sigmaSource2 * par[2] );
+				( *iGradient )[3] += dF * par[1] * iExp * dx / sigmaSource2;
+				( *iGradient )[4] += dF * par[1] * iExp * dy / sigmaSource2;
+			}
+		}
+	}
+	return sum;
 }
 
 
+
 VFun_PSFDescription_2DGauss_LL::VFun_PSFDescription_2DGauss_LL( TH2D* iSkymap, double i_xmin, double i_xmax, double i_ymin, double i_ymax )
 {
-	hSkyMap = iSkymap;
-	xmin = i_xmin;
-	xmax = i_xmax;
-	ymin = i_ymin;
-	ymax = i_ymax;
+	fillBins( iSkymap, i_xmin, i_xmax, i_ymin, i_ymax );
+}
+
+/*
+    -LL for a radial symmetric gaussian
+    mu = 1 / sqrt( 2 pi ) / sigma * exp( -r2 / 2 / sigma^2 )
+*/
+double VFun_PSFDescription_2DGauss_LL::evaluateBins( const vector< double >& par, unsigned int iFirst, unsigned int iLast, vector< double >* iGradient ) const
+{
+	double  LL = 0.;
+	double  meanX  = par[0];
+	double  meanY  = par[1];
+	double  sigma = par[2];
+	if( sigma < 0. )
+	{
+		return 0.;
+	}
+	double  sigma2 = sigma * sigma;
+	double  iNorm = sqrt( 1. / 2. / M_PI / sigma2 );
+	double  dLL = 0.;
+	
+	for( unsigned int i = iFirst; i < iLast; i++ )
+	{
+		// check for valid entries
+		if( fN[i] <= -999. )
+		{
+			continue;
+		}
+		double dx = fX[i] - meanX;
+		double dy = fY[i] - meanY;
+		double r2 = dx * dx + dy * dy;
+		double mu = iNorm * exp( -1. / 2. * r2 / sigma2 );
+		
+		LL += getPoissonLikelihoodTerm( fN[i], mu, dLL );
+		if( iGradient )
+		{
+			( *iGradient )[0] += dLL * mu * dx / sigma2;
+			( *iGradient )[1] += dLL * mu * dy / sigma2;
+			( *iGradient )[2] += dLL * mu * ( -1. / sigma + r2 / sigma2 / sigma );
+		}
+	}
+	return LL;
 }
 
 
+
 VFun_PSFDescription_LinearSuperposition2DGauss_LL::VFun_PSFDescription_LinearSuperposition2DGauss_LL( TH2D* iSkymap, double i_xmin, double i_xmax, double i_ymin, double i_ymax )
 {
-	hSkyMap = iSkymap;
-	xmin = i_xmin;
-	xmax = i_xmax;
-	ymin = i_ymin;
-	ymax = i_ymax;
+	fillBins( iSkymap, i_xmin, i_xmax, i_ymin, i_ymax );
 }
 
+/*
+    -LL for a superposition of two radial symmetric gaussians
+    mu = alpha * g1 + ( 1 - alpha ) * g2
+*/
+double VFun_PSFDescription_LinearSuperposition2DGauss_LL::evaluateBins( const vector< double >& par, unsigned int iFirst, unsigned int iLast, vector< double >* iGradient ) const
+{
+	double  LL = 0.;
+	double  meanX  = par[0];
+	double  meanY  = par[1];
+	double  sigma1 = par[2];        // central spot
+	double  sigma2 = par[3];        // broad halo
+	double  alpha  = par[4];        // relative importance of each component , alpha = 1 only central spot matters
+	if( sigma1 < 0. || sigma2 < 0. )
+	{
+		return 0.;
+	}
+	double  s1_2 = sigma1 * sigma1;
+	double  s2_2 = sigma2 * sigma2;
+	double  iNorm1 = sqrt( 1. / 2. / M_PI / s1_2 );
+	double  iNorm2 = sqrt( 1. / 2. / M_PI / s2_2 );
+	double  dLL = 0.;
+	
+	for( unsigned int i = iFirst; i < iLast; i++ )
+	{
+		// check for valid entries
+		if( fN[i] <= -999. )
+		{
+			continue;
+		}
+		double dx = fX[i] - meanX;
+		double dy = fY[i] - meanY;
+		double r2 = dx * dx + dy * dy;
+		double g1 = iNorm1 * exp( -1. / 2. * r2 / s1_2 );
+		double g2 = iNorm2 * exp( -1. / 2. * r2 / s2_2 );
+		double mu = alpha * g1 + ( 1. - alpha ) * g2;
+		
+		LL += getPoissonLikelihoodTerm( fN[i], mu, dLL );
+		if( iGradient )
+		{
+			double iW = alpha * g1 / s1_2 + ( 1. - alpha ) * g2 / s2_2;
+			( *iGradient )[0] += dLL * iW * dx;
+			( *iGradient )[1] += dLL * iW * dy;
+			( *iGradient )[2] += dLL * alpha * g1 * ( -1. / sigma1 + r2 / s1_2 / sigma1 );
+			( *iGradient )[3] += dLL * ( 1. - alpha ) * g2 * ( -1. / sigma2 + r2 / s2_2 / sigma2 );
+			( *iGradient )[4] += dLL * ( g1 - g2 );
+		}
+	}
+	return LL;
+}
+
+
 
 
 /*
@@ -996,14 +1431,53 @@ VFun_PSFDescription_LinearSuperposition2DGauss_LL::VFun_PSFDescription_LinearSup
 
 VFun_SourceDescription_RadialSymmetricSource_Chi2::VFun_SourceDescription_RadialSymmetricSource_Chi2( TH2D* iSkymap, double i_xmin, double i_xmax, double i_ymin, double i_ymax, double i_psf )
 {
-	hSkyMap = iSkymap;
-	xmin = i_xmin;
-	xmax = i_xmax;
-	ymin = i_ymin;
-	ymax = i_ymax;
+	fillBins( iSkymap, i_xmin, i_xmax, i_ymin, i_ymax );
 	sigmaPSF = i_psf;
 }
 
+/*
+    fT = p3 * exp( -t2 / 2 / ( p2^2 + sigmaPSF^2 ) ), t2 = (x-p0)^2 + (y-p1)^2
+*/
+double VFun_SourceDescription_RadialSymmetricSource_Chi2::evaluateBins( const vector< double >& par, unsigned int iFirst, unsigned int iLast, vector< double >* iGradient ) const
+{
+	double sum = 0.;
+	double sigmaSRC = par[2];
+	double s2 = sigmaSRC * sigmaSRC + sigmaPSF * sigmaPSF;
+	
+	for( unsigned int i = iFirst; i < iLast; i++ )
+	{
+		// calculate theta2
+		double dx = fX[i] - par[0];
+		double dy = fY[i] - par[1];
+		double t2 = dx * dx + dy * dy;
+		
+		// calculate expectation from model function
+		double iExp = TMath::Exp( -1.*t2 / 2. / s2 );
+		double fT = par[3] * iExp;
+		if( isnan( fT ) )
+		{
+			continue;
+		}
+		
+		// calculate chi2
+		if( fNErr[i] > 0. && fN[i] > -90. )
+		{
+			double iW = 1. / fNErr[i] / fNErr[i];
+			sum += ( fT - fN[i] ) * ( fT - fN[i] ) * iW;
+			if( iGradient )
+			{
+				double dF = 2. * ( fT - fN[i] ) * iW;
+				( *iGradient )[0] += dF * fT * dx / s2;
+				( *iGradient )[1] += dF * fT * dy / s2;
+				( *iGradient )[2] += dF * fT * t2 * sigmaSRC / s2 / s2;
+				( *iGradient )[3] += dF * iExp;
+			}
+		}
+	}
+	return sum;
+}
+
+
 
 
 /*
@@ -1042,25 +1516,97 @@ VFun_SourceDescription_RadialSymmetricSource_Chi2::VFun_SourceDescription_Radial
 
 VFun_SourceDescription_RadialSymmetricSource_LL::VFun_SourceDescription_RadialSymmetricSource_LL( TH2D* iSkymap, double i_xmin, double i_xmax, double i_ymin, double i_ymax, double i_psf )
 {
-	hSkyMap = iSkymap;
-	xmin = i_xmin;
-	xmax = i_xmax;
-	ymin = i_ymin;
-	ymax = i_ymax;
+	fillBins( iSkymap, i_xmin, i_xmax, i_ymin, i_ymax );
 	sigmaPSF = i_psf;
 }
 
+/*
+    mu = 1 / 2 / pi / s2 * exp( -r2 / 2 / s2 ), s2 = sigmaSRC^2 + sigmaPSF^2
+*/
+double VFun_SourceDescription_RadialSymmetricSource_LL::evaluateBins( const vector< double >& par, unsigned int iFirst, unsigned int iLast, vector< double >* iGradient ) const
+{
+	double  LL = 0.;
+	double  meanX = par[0];
+	double  meanY = par[1];
+	double  sigmaSRC = par[2];
+	if( sigmaSRC <= 0. )
+	{
+		return 0.;
+	}
+	double  s2 = sigmaSRC * sigmaSRC + sigmaPSF * sigmaPSF;
+	double  dLL = 0.;
+	
+	for( unsigned int i = iFirst; i < iLast; i++ )
+	{
+		// check for valid entries
+		if( fN[i] <= -999. )
+		{
+			continue;
+		}
+		double dx = fX[i] - meanX;
+		double dy = fY[i] - meanY;
+		double r2 = dx * dx + dy * dy;
+		double mu = exp( -1. / 2. * r2 / s2 ) / 2. / M_PI / s2;
+		
+		LL += getPoissonLikelihoodTerm( fN[i], mu, dLL );
+		if( iGradient )
+		{
+			( *iGradient )[0] += dLL * mu * dx / s2;
+			( *iGradient )[1] += dLL * mu * dy / s2;
+			( *iGradient )[2] += dLL * mu * ( -1. / s2 + r2 / 2. / s2 / s2 ) * 2. * sigmaSRC;
+		}
+	}
+	return LL;
+}
+
+
 
 VFun_SourceDescription_RadialAsymmetricSource_LL::VFun_SourceDescription_RadialAsymmetricSource_LL( TH2D* iSkymap, double i_xmin, double i_xmax, double i_ymin, double i_ymax, double i_psf )
 {
-	hSkyMap = iSkymap;
-	xmin = i_xmin;
-	xmax = i_xmax;
-	ymin = i_ymin;
-	ymax = i_ymax;
+	fillBins( iSkymap, i_xmin, i_xmax, i_ymin, i_ymax );
 	sigmaPSF = i_psf;
 }
 
+/*
+    radial asymmetric gaussian (no analytic gradient)
+*/
+double VFun_SourceDescription_RadialAsymmetricSource_LL::evaluateBins( const vector< double >& par, unsigned int iFirst, unsigned int iLast, vector< double >* iGradient ) const
+{
+	double  LL = 0.;
+	double  meanX = par[1];
+	double  sigmaX = par[2];
+	double  meanY = par[3];
+	double  sigmaY = par[4];
+	double  angle = par[0];
+	double  sX = sqrt( sigmaX * sigmaX + sigmaPSF * sigmaPSF );
+	double  sY = sqrt( sigmaY * sigmaY + sigmaPSF * sigmaPSF );
+	double  rho = 1. / 2. * tan( 2 * angle ) * ( sigmaX * sigmaX - sigmaY * sigmaY ) / sX / sY;
+	
+	if( rho * rho >= 1. || sigmaX <= 0. || sigmaY <= 0. )
+	{
+		return 0.;
+	}
+	double  iNorm = 1. / 2. / M_PI / sX / sY / sqrt( 1. - rho * rho );
+	double  dLL = 0.;
+	
+	for( unsigned int i = iFirst; i < iLast; i++ )
+	{
+		// check for valid entries
+		if( fN[i] <= -999. )
+		{
+			continue;
+		}
+		double dx = ( fX[i] - meanX ) / sX;
+		double dy = ( fY[i] - meanY ) / sY;
+		double mu = dx * dx + dy * dy - 2. * rho * dx * dy;
+		mu = iNorm * exp( -1. / 2. / ( 1. - rho * rho ) * mu );
+		
+		LL += getPoissonLikelihoodTerm( fN[i], mu, dLL );
+	}
+	return LL;
+}
+
+
 
 
 ///////////////////////////////////////////////////////////////////////////////
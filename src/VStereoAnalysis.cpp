@@ -11,6 +11,10 @@ VStereoAnalysis::VStereoAnalysis( bool ion, string i_hsuffix, VAnaSumRunParamete
 	fDebug = false;
 	
 	fDataFile = 0;
+	fDataRun = 0;
+	fDataRunTree = 0;
+	fCuts = 0;
+	fDL3_Acceptance = 0;
 	fInstrumentEpochMinor = "NOT_SET";
 	fDirTot = iDirTot;
 	fDirTotRun = iDirRun;
@@ -39,6 +43,9 @@ VStereoAnalysis::VStereoAnalysis( bool ion, string i_hsuffix, VAnaSumRunParamete
 	
 	fRunPara = irunpara;
 	fDL3EventTree = 0;
+#ifndef NOFITS
+	fDL3FITSWriter = 0;
+#endif
 	fDeadTimeStorage = 0.;
 	
 	fVsky = new VSkyCoordinates() ;
@@ -129,6 +136,46 @@ VStereoAnalysis::VStereoAnalysis( bool ion, string i_hsuffix, VAnaSumRunParamete
 }
 
 
+/*
+ * (histograms and trees are owned by the output file and deleted when closing it)
+ */
+VStereoAnalysis::~VStereoAnalysis()
+{
+#ifndef NOFITS
+	if( fDL3FITSWriter )
+	{
+		delete fDL3FITSWriter;
+	}
+#endif
+	closeDataFile();
+	if( fDL3_Acceptance )
+	{
+		delete fDL3_Acceptance;
+	}
+	if( fCuts )
+	{
+		delete fCuts;
+	}
+	delete fTimeMask;
+	delete fMap;
+	delete fMapUC;
+	delete fVsky;
+	for( unsigned int i = 0; i < fAstro.size(); i++ )
+	{
+		delete fAstro[i];
+	}
+	for( unsigned int i = 0; i < fDeadTime.size(); i++ )
+	{
+		delete fDeadTime[i];
+	}
+	for( unsigned int i = 0; i < fHisto.size(); i++ )
+	{
+		delete fHisto[i];
+	}
+	delete fHistoTot;
+}
+
+
 /*!
  *
  * establish run times (mean, start, end and duration) for a list of runs
@@ -1944,6 +1991,9 @@ double VStereoAnalysis::getRawRate()
 
 CData* VStereoAnalysis::getDataFromFile( int i_runNumber )
 {
+	// data file of previous run
+	closeDataFile();
+	
 	CData* c = 0;
 	for( unsigned int i = 0; i < fRunPara->fRunList.size(); i++ )
 	{
@@ -1992,10 +2042,24 @@ CData* VStereoAnalysis::getDataFromFile( int i_runNumber )
 
 bool VStereoAnalysis::closeDataFile()
 {
+	if( fCuts )
+	{
+		fCuts->setDataTree( 0 );
+	}
+	if( fDataRun )
+	{
+		// (CData destructor deletes the file of the data tree)
+		fDataRun->fChain = 0;
+		delete fDataRun;
+		fDataRun = 0;
+	}
 	if( fDataFile )
 	{
 		fDataFile->Close();
+		delete fDataFile;
+		fDataFile = 0;
 	}
+	fDataRunTree = 0;
 	
 	return true;
 }
@@ -2249,6 +2313,25 @@ bool VStereoAnalysis::init_DL3Tree( int irun, int icounter )
 	{
 		fDL3_Acceptance = 0;
 	}
+#ifndef NOFITS
+	// DL3 FITS file (gamma-like events only)
+	if( fRunPara->fDL3FITSDirectory.size() > 0 && icounter < ( int )fRunPara->fRunList.size() )
+	{
+		if( !fDL3FITSWriter )
+		{
+			fDL3FITSWriter = new VDL3FITSWriter();
+		}
+		char iFITSFile[1000];
+		sprintf( iFITSFile, "%s/%d.dl3.fits", fRunPara->fDL3FITSDirectory.c_str(), irun );
+		if( !fDL3FITSWriter->open( iFITSFile, irun, fRunPara->fRunList[icounter].fTarget,
+								   fRunPara->fRunList[icounter].fArrayPointingRAJ2000,
+								   fRunPara->fRunList[icounter].fArrayPointingDecJ2000 ) )
+		{
+			cout << "VStereoAnalysis::init_DL3Tree error opening DL3 FITS file " << iFITSFile << endl;
+			exit( EXIT_FAILURE );
+		}
+	}
+#endif
 	return true;
 }
 
@@ -2344,6 +2427,16 @@ void VStereoAnalysis::fill_DL3Tree( CData* c, double i_xderot, double i_yderot,
 	{
 		fDL3EventTree->Fill();
 	}
+#ifndef NOFITS
+	if( fDL3FITSWriter && fDL3FITSWriter->isOpen() && bIsGamma )
+	{
+		fDL3FITSWriter->fillEvent( fDL3EventTree_eventNumber, fDL3EventTree_MJD, fDL3EventTree_Time,
+								   fDL3EventTree_RA, fDL3EventTree_DEC, fDL3EventTree_Erec,
+								   fDL3EventTree_El, fDL3EventTree_Az, fDL3EventTree_NImages,
+								   fDL3EventTree_XGroundCore, fDL3EventTree_YGroundCore,
+								   fDL3EventTree_MSCW, fDL3EventTree_MSCL );
+	}
+#endif
 }
 
 /*
@@ -2361,5 +2454,37 @@ void VStereoAnalysis::write_DL3Tree()
 	if( fDL3_Acceptance )
 	{
 		delete fDL3_Acceptance;
+		fDL3_Acceptance = 0;
+	}
+#ifndef NOFITS
+	// finalize DL3 FITS file (dead time fraction is set in writeHistograms)
+	if( fDL3FITSWriter && fDL3FITSWriter->isOpen() )
+	{
+		fDL3FITSWriter->writeGTI( fTimeMask );
+		// effective area vs true energy (ENERG_LO/ENERG_HI are true energies):
+		// the mean effective area is vs true energy for fEffectiveAreaVsEnergyMC == 0 only,
+		// otherwise use the MC effective area (filled for the likelihood analysis)
+		TGraphAsymmErrors* iEffectiveAreaTrueEnergy = 0;
+		if( fRunPara->fEffectiveAreaVsEnergyMC == 0 )
+		{
+			iEffectiveAreaTrueEnergy = gMeanEffectiveArea;
+		}
+		else if( fRunPara->fLikelihoodAnalysis )
+		{
+			iEffectiveAreaTrueEnergy = gMeanEffectiveAreaMC;
+		}
+		if( iEffectiveAreaTrueEnergy && fCuts && fHisCounter < ( int )fRunPara->fRunList.size() )
+		{
+			fDL3FITSWriter->writeEffectiveArea( iEffectiveAreaTrueEnergy, fRunPara->fRunList[fHisCounter].fmaxradius,
+												sqrt( fCuts->getTheta2Cut_max() ) );
+		}
+		else
+		{
+			cout << "VStereoAnalysis::write_DL3Tree() warning: no effective area vs true energy available; ";
+			cout << "no EFFECTIVE AREA HDU written to DL3 file" << endl;
+			cout << "	 (requires effective areas vs MC energy or likelihood analysis)" << endl;
+		}
+		fDL3FITSWriter->close( fRunPara->fScalarDeadTimeFrac );
 	}
+#endif
 }
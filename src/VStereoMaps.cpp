@@ -68,6 +68,16 @@ VStereoMaps::VStereoMaps( bool iuc, int iRandomSeed, bool iTMPL_RE_nMaxoffsource
 }
 
 
+VStereoMaps::~VStereoMaps()
+{
+	if( fAcceptance )
+	{
+		delete fAcceptance;
+	}
+	delete fRandom;
+}
+
+
 void VStereoMaps::setTargetShift( double iW, double iN )
 {
 	fTargetShiftWest = iW;
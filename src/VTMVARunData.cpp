@@ -21,6 +21,10 @@ VTMVARunData::VTMVARunData()
 	fnTrain_Signal = 0;
 	fnTrain_Background = 0;
 	
+	fPrepareTrainingThreads = 1;
+	fTrainingSampleSeed = 0;
+	fTrainingSampleCacheDirectory = "";
+	
 	fQualityCuts = "1";
 	fQualityCutsBkg = "1";
 	fMCxyoffCut = "1";
@@ -360,6 +364,12 @@ void VTMVARunData::print()
 	cout << endl;
 	cout << endl;
 	cout << "prepare training options: " << fPrepareTrainingOptions << endl;
+	cout << "preparation of training samples: " << fPrepareTrainingThreads << " thread(s), seed " << fTrainingSampleSeed;
+	if( fTrainingSampleCacheDirectory.size() > 0 )
+	{
+		cout << ", cache directory " << fTrainingSampleCacheDirectory;
+	}
+	cout << endl;
 	cout << "energy bin(s) [log10(TeV)] (" << fEnergyCutData.size() << "): ";
 	for( unsigned int i = 0; i < fEnergyCutData.size(); i++ )
 	{
@@ -584,6 +594,45 @@ bool VTMVARunData::readConfigurationFile( char* iC )
 					return false;
 				}
 			}
+			// number of threads used for the preparation of training samples
+			if( temp == "PREPARE_TRAINING_THREADS" )
+			{
+				if( !( is_stream >> std::ws ).eof() )
+				{
+					is_stream >> fPrepareTrainingThreads;
+				}
+				else
+				{
+					cout << "VTMVARunData::readConfigurationFile error while reading input for variable PREPARE_TRAINING_THREADS" << endl;
+					return false;
+				}
+			}
+			// seed for random selection of training events
+			if( temp == "TRAINING_SAMPLE_SEED" )
+			{
+				if( !( is_stream >> std::ws ).eof() )
+				{
+					is_stream >> fTrainingSampleSeed;
+				}
+				else
+				{
+					cout << "VTMVARunData::readConfigurationFile error while reading input for variable TRAINING_SAMPLE_SEED" << endl;
+					return false;
+				}
+			}
+			// directory with cached training samples
+			if( temp == "TRAINING_SAMPLE_CACHE" )
+			{
+				if( !( is_stream >> std::ws ).eof() )
+				{
+					is_stream >> fTrainingSampleCacheDirectory;
+				}
+				else
+				{
+					cout << "VTMVARunData::readConfigurationFile error while reading input for variable TRAINING_SAMPLE_CACHE" << endl;
+					return false;
+				}
+			}
 			// signal weight
 			if( temp == "SIGNALWEIGHT" )
 			{
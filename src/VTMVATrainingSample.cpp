@@ -0,0 +1,409 @@
+/*! \class VTMVATrainingSample
+    \brief training samples for TMVA
+
+    - events are selected from each input file independently
+      (in parallel using several threads, see processFiles())
+    - selected events are stored per input file and merged in the order
+      of the input files, i.e. the training sample does not depend on
+      the number of threads
+    - training samples can be written to and read from cache files;
+      cache files are identified by a key calculated from the
+      selection and variable configuration (see getKey())
+
+*/
+
+#include "VTMVATrainingSample.h"
+
+VTMVATrainingSample::VTMVATrainingSample( string iName, string iTitle )
+{
+	fDebug = false;
+	
+	fName = iName;
+	fTitle = iTitle;
+	if( fTitle.size() == 0 )
+	{
+		fTitle = fName;
+	}
+}
+
+/*
+ * add a variable (branch) to the training sample
+ *
+ * allowed types: D=Double_t, F=Float_t, I=Int_t, i=UInt_t
+ */
+void VTMVATrainingSample::addVariable( string iName, char iType )
+{
+	if( iType != 'D' && iType != 'F' && iType != 'I' && iType != 'i' )
+	{
+		cout << "VTMVATrainingSample::addVariable warning: unknown type " << iType;
+		cout << " for variable " << iName << " (using Double_t)" << endl;
+		iType = 'D';
+	}
+	fVariableName.push_back( iName );
+	fVariableType.push_back( iType );
+}
+
+/*
+ * set number of input files (must be called before filling)
+ */
+void VTMVATrainingSample::setNFiles( unsigned int iNFiles )
+{
+	fFileData.clear();
+	fFileData.resize( iNFiles );
+}
+
+/*
+ * vector with selected events for the given input file
+ *
+ * (events are added row by row, with the variables in the order
+ *  as defined with addVariable())
+ *
+ * different threads must use different files
+ */
+vector< double >* VTMVATrainingSample::getFileData( unsigned int iFile )
+{
+	if( iFile < fFileData.size() )
+	{
+		return &fFileData[iFile];
+	}
+	return 0;
+}
+
+Long64_t VTMVATrainingSample::getEntries( unsigned int iFile )
+{
+	if( iFile >= fFileData.size() || fVariableName.size() == 0 )
+	{
+		return 0;
+	}
+	return ( Long64_t )( fFileData[iFile].size() / fVariableName.size() );
+}
+
+Long64_t VTMVATrainingSample::getEntries()
+{
+	Long64_t n = 0;
+	for( unsigned int i = 0; i < fFileData.size(); i++ )
+	{
+		n += getEntries( i );
+	}
+	return n;
+}
+
+void VTMVATrainingSample::clear()
+{
+	for( unsigned int i = 0; i < fFileData.size(); i++ )
+	{
+		vector< double >().swap( fFileData[i] );
+	}
+}
+
+/*
+ * fill a tree with all selected events
+ *
+ * events are filled in the order of the input files
+ * (tree is attached to the current directory)
+ */
+TTree* VTMVATrainingSample::getTree()
+{
+	unsigned int iNVar = fVariableName.size();
+	vector< Double_t > iD( iNVar, 0. );
+	vector< Float_t >  iF( iNVar, 0. );
+	vector< Int_t >    iI( iNVar, 0 );
+	vector< UInt_t >   iU( iNVar, 0 );
+	
+	TTree* iTree = new TTree( fName.c_str(), fTitle.c_str() );
+	for( unsigned int v = 0; v < iNVar; v++ )
+	{
+		string iLeaf = fVariableName[v] + "/" + fVariableType[v];
+		if( fVariableType[v] == 'F' )
+		{
+			iTree->Branch( fVariableName[v].c_str(), &iF[v], iLeaf.c_str() );
+		}
+		else if( fVariableType[v] == 'I' )
+		{
+			iTree->Branch( fVariableName[v].c_str(), &iI[v], iLeaf.c_str() );
+		}
+		else if( fVariableType[v] == 'i' )
+		{
+			iTree->Branch( fVariableName[v].c_str(), &iU[v], iLeaf.c_str() );
+		}
+		else
+		{
+			iTree->Branch( fVariableName[v].c_str(), &iD[v], iLeaf.c_str() );
+		}
+	}
+	if( iNVar == 0 )
+	{
+		return iTree;
+	}
+	
+	for( unsigned int f = 0; f < fFileData.size(); f++ )
+	{
+		for( unsigned int r = 0; r + iNVar <= fFileData[f].size(); r += iNVar )
+		{
+			for( unsigned int v = 0; v < iNVar; v++ )
+			{
+				iD[v] = fFileData[f][r + v];
+				iF[v] = ( Float_t )iD[v];
+				iI[v] = ( Int_t )iD[v];
+				iU[v] = ( UInt_t )iD[v];
+			}
+			iTree->Fill();
+		}
+	}
+	// addresses point to local variables
+	iTree->ResetBranchAddresses();
+	
+	return iTree;
+}
+
+/*
+ * key identifying a training sample
+ * (MD5 sum of all strings describing the sample configuration,
+ *  e.g. cuts, variables, input files)
+ */
+string VTMVATrainingSample::getKey( vector< string > iConfiguration )
+{
+	TMD5 iMD5;
+	for( unsigned int i = 0; i < iConfiguration.size(); i++ )
+	{
+		iMD5.Update( ( const UChar_t* )iConfiguration[i].c_str(), iConfiguration[i].size() );
+		iMD5.Update( ( const UChar_t* )"\n", 1 );
+	}
+	iMD5.Final();
+	return string( iMD5.AsString() );
+}
+
+/*
+ * strings identifying the given input files for the sample key
+ * (file name, size and modification time; regenerated files
+ *  with the same names result in a different key)
+ */
+vector< string > VTMVATrainingSample::getFileKeys( vector< string > iFileName )
+{
+	vector< string > iFileKeys;
+	for( unsigned int i = 0; i < iFileName.size(); i++ )
+	{
+		ostringstream iKey;
+		iKey << iFileName[i];
+		FileStat_t iStat;
+		if( gSystem->GetPathInfo( iFileName[i].c_str(), iStat ) == 0 )
+		{
+			iKey << " " << iStat.fSize << " " << iStat.fMtime;
+		}
+		iFileKeys.push_back( iKey.str() );
+	}
+	return iFileKeys;
+}
+
+/*
+ * seed for random number generator used for the given input file
+ *
+ * (splitmix64 finaliser; seeds are independent of the
+ *  order in which files are processed)
+ */
+UInt_t VTMVATrainingSample::getSeed( UInt_t iSeed, unsigned int iFile )
+{
+	ULong64_t z = ( ULong64_t )iSeed + ( ULong64_t )( iFile + 1 ) * 0x9E3779B97F4A7C15ULL;
+	z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+	z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+	z = z ^ ( z >> 31 );
+	UInt_t iS = ( UInt_t )( z & 0xFFFFFFFFULL );
+	// TRandom3 uses a time dependent seed for 0
+	if( iS == 0 )
+	{
+		iS = 1;
+	}
+	return iS;
+}
+
+/*
+ * read training sample from cache file
+ *
+ * returns false if cache file does not exist or if keys are different
+ */
+bool VTMVATrainingSample::readCache( string iCacheFileName, string iKey )
+{
+	if( gSystem->AccessPathName( iCacheFileName.c_str() ) )
+	{
+		return false;
+	}
+	TDirectory* iG_CurrentDirectory = gDirectory;
+	TFile* iF = new TFile( iCacheFileName.c_str() );
+	if( iF->IsZombie() )
+	{
+		cout << "VTMVATrainingSample::readCache: error opening cache file " << iCacheFileName << endl;
+		delete iF;
+		iG_CurrentDirectory->cd();
+		return false;
+	}
+	TNamed* iK = ( TNamed* )iF->Get( "TrainingSampleKey" );
+	TTree* iT = ( TTree* )iF->Get( fName.c_str() );
+	if( !iK || !iT || iKey != iK->GetTitle() )
+	{
+		cout << "VTMVATrainingSample::readCache: cache file " << iCacheFileName;
+		cout << " does not match sample configuration (ignoring cache file)" << endl;
+		iF->Close();
+		delete iF;
+		iG_CurrentDirectory->cd();
+		return false;
+	}
+	unsigned int iNVar = fVariableName.size();
+	vector< Double_t > iD( iNVar, 0. );
+	vector< Float_t >  iFl( iNVar, 0. );
+	vector< Int_t >    iI( iNVar, 0 );
+	vector< UInt_t >   iU( iNVar, 0 );
+	for( unsigned int v = 0; v < iNVar; v++ )
+	{
+		if( !iT->GetBranch( fVariableName[v].c_str() ) )
+		{
+			cout << "VTMVATrainingSample::readCache: variable " << fVariableName[v];
+			cout << " not found in cache file " << iCacheFileName << endl;
+			iF->Close();
+			delete iF;
+			iG_CurrentDirectory->cd();
+			return false;
+		}
+		if( fVariableType[v] == 'F' )
+		{
+			iT->SetBranchAddress( fVariableName[v].c_str(), &iFl[v] );
+		}
+		else if( fVariableType[v] == 'I' )
+		{
+			iT->SetBranchAddress( fVariableName[v].c_str(), &iI[v] );
+		}
+		else if( fVariableType[v] == 'i' )
+		{
+			iT->SetBranchAddress( fVariableName[v].c_str(), &iU[v] );
+		}
+		else
+		{
+			iT->SetBranchAddress( fVariableName[v].c_str(), &iD[v] );
+		}
+	}
+	// cache file contains the merged sample
+	setNFiles( 1 );
+	fFileData[0].reserve( iT->GetEntries() * iNVar );
+	for( Long64_t n = 0; n < iT->GetEntries(); n++ )
+	{
+		iT->GetEntry( n );
+		for( unsigned int v = 0; v < iNVar; v++ )
+		{
+			if( fVariableType[v] == 'F' )
+			{
+				fFileData[0].push_back( iFl[v] );
+			}
+			else if( fVariableType[v] == 'I' )
+			{
+				fFileData[0].push_back( iI[v] );
+			}
+			else if( fVariableType[v] == 'i' )
+			{
+				fFileData[0].push_back( iU[v] );
+			}
+			else
+			{
+				fFileData[0].push_back( iD[v] );
+			}
+		}
+	}
+	cout << "\t reading training sample " << fName << " from cache file " << iCacheFileName;
+	cout << " (" << getEntries() << " entries)" << endl;
+	iF->Close();
+	delete iF;
+	iG_CurrentDirectory->cd();
+	return true;
+}
+
+/*
+ * write training sample to cache file
+ *
+ * (written to a temporary file first, as several jobs might
+ *  use the same cache directory)
+ */
+bool VTMVATrainingSample::writeCache( string iCacheFileName, string iKey )
+{
+	TDirectory* iG_CurrentDirectory = gDirectory;
+	ostringstream iTempFileName;
+	iTempFileName << iCacheFileName << "." << gSystem->GetPid() << ".tmp";
+	TFile* iF = new TFile( iTempFileName.str().c_str(), "RECREATE" );
+	if( iF->IsZombie() )
+	{
+		cout << "VTMVATrainingSample::writeCache: error opening cache file " << iTempFileName.str() << endl;
+		delete iF;
+		iG_CurrentDirectory->cd();
+		return false;
+	}
+	TNamed iK( "TrainingSampleKey", iKey.c_str() );
+	iK.Write();
+	TTree* iT = getTree();
+	iT->Write();
+	iF->Close();
+	delete iF;
+	iG_CurrentDirectory->cd();
+	if( gSystem->Rename( iTempFileName.str().c_str(), iCacheFileName.c_str() ) != 0 )
+	{
+		cout << "VTMVATrainingSample::writeCache: error moving cache file to " << iCacheFileName << endl;
+		return false;
+	}
+	cout << "\t training sample " << fName << " written to cache file " << iCacheFileName << endl;
+	return true;
+}
+
+/*
+ * call iFileProcessor for all input files
+ *
+ * files are distributed dynamically over iNThreads threads
+ * (iFileProcessor must only access data of the given file)
+ */
+bool VTMVATrainingSample::processFiles( unsigned int iNFiles, unsigned int iNThreads,
+										function< bool( unsigned int ) > iFileProcessor )
+{
+	if( iNThreads > iNFiles )
+	{
+		iNThreads = iNFiles;
+	}
+	if( iNThreads <= 1 )
+	{
+		for( unsigned int i = 0; i < iNFiles; i++ )
+		{
+			if( !iFileProcessor( i ) )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	
+	cout << "\t processing " << iNFiles << " input files using " << iNThreads << " threads" << endl;
+	ROOT::EnableThreadSafety();
+	atomic< unsigned int > iNextFile( 0 );
+	atomic< bool > iSuccess( true );
+	vector< thread > iThreads;
+	for( unsigned int t = 0; t < iNThreads; t++ )
+	{
+		iThreads.push_back( thread( VTMVATrainingSample::processFileQueue,
+									iNFiles, &iNextFile, &iSuccess, &iFileProcessor ) );
+	}
+	for( unsigned int t = 0; t < iThreads.size(); t++ )
+	{
+		iThreads[t].join();
+	}
+	return iSuccess;
+}
+
+void VTMVATrainingSample::processFileQueue( unsigned int iNFiles, atomic< unsigned int >* iNextFile,
+		atomic< bool >* iSuccess, function< bool( unsigned int ) >* iFileProcessor )
+{
+	while( *iSuccess )
+	{
+		unsigned int i = ( *iNextFile )++;
+		if( i >= iNFiles )
+		{
+			break;
+		}
+		if( !( *iFileProcessor )( i ) )
+		{
+			*iSuccess = false;
+		}
+	}
+}
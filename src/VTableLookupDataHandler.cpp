@@ -46,6 +46,14 @@ VTableLookupDataHandler::VTableLookupDataHandler( bool iwrite, VTableLookupRunPa
 	fDeadTime->defineHistograms( 0, true );
 	
 	fOutFile = 0;
+	fTreeIOPolicy = new VTreeIOPolicy();
+	if( !fTreeIOPolicy->set( fTLRunParameter->fTreeCompression, fTLRunParameter->fTreeAutoFlush,
+							 fTLRunParameter->fTreeBasketSize, fTLRunParameter->fTreeBranchBasketSize,
+							 fTLRunParameter->fTreeIOThreads ) )
+	{
+		cout << "VTableLookupDataHandler::VTableLookupDataHandler error: invalid I/O settings" << endl;
+		exit( EXIT_FAILURE );
+	}
 	
 	fNMethods = 0;
 	fMethod = fTLRunParameter->rec_method;
@@ -156,15 +164,13 @@ void VTableLookupDataHandler::fill()
 	
 	if( fTLRunParameter->bWriteReconstructedEventsOnly >= 0 || fTLRunParameter->bWriteReconstructedEventsOnly == -2 )
 	{
-		if( isReconstructed() )
+		if( !isReconstructed() )
 		{
-			fOTree->Fill();
+			return;
 		}
 	}
-	else
-	{
-		fOTree->Fill();
-	}
+	fOTree->Fill();
+	fRunInfo.fill( MJD, time, fImgSel, fTelAzimuth, fArrayPointing_Elevation, fNTel );
 }
 
 
@@ -1033,6 +1039,8 @@ bool VTableLookupDataHandler::setInputFile( vector< string > iInput )
 	
 	// update runparameters
 	fTLRunParameter->update( fTshowerpars );
+	// read cache (reduces number of read requests on shared file systems)
+	VTreeIOPolicy::setReadCache( fTshowerpars, fTLRunParameter->fTreeReadCacheSize );
 	// get file format version of eventdisplay (tree version)
 	if( fTLRunParameter )
 	{
@@ -1082,6 +1090,7 @@ bool VTableLookupDataHandler::setInputFile( vector< string > iInput )
 			cout << "VTableLookupDataHandler::setInputFile: error while retrieving data trees (3)" << endl;
 			exit( EXIT_FAILURE );
 		}
+		VTreeIOPolicy::setReadCache( iT, fTLRunParameter->fTreeReadCacheSize );
 		// get first entry to check if chain is there
 		gErrorIgnoreLevel = 5000;
 		if( iT->GetEntry( 0 ) > 0 )
@@ -1315,6 +1324,7 @@ bool VTableLookupDataHandler::setOutputFile( string iOutput, string iOption, str
 		cout << "VTableLookupDataHandler::setOutputFile error while opening output file " << foutputfile << "\t" << iOption << endl;
 		exit( EXIT_FAILURE );
 	}
+	fTreeIOPolicy->apply( fOutFile );
 	// define output tree
 	char iTT[2000];
 	
@@ -1608,6 +1618,10 @@ bool VTableLookupDataHandler::setOutputFile( string iOutput, string iOption, str
 		fEmissionHeightT[i] = -99.;
 	}
 	
+	// basket sizes, auto flush, parallel compression
+	fTreeIOPolicy->apply( fOTree );
+	fTreeIOPolicy->print();
+	
 	readRunParameter();
 	
 	return true;
@@ -1674,6 +1688,7 @@ bool VTableLookupDataHandler::readRunParameter()
 					}
 					iPar->fTelToAnalyze = iTelToAnalyze;
 				}
+				fRunInfo.fTelToAnalyze = iPar->fTelToAnalyze;
 				if( fOutFile )
 				{
 					fOutFile->cd();
@@ -1882,6 +1897,12 @@ bool VTableLookupDataHandler::terminate( TNamed* iM )
 		fOutFile->Close();
 		cout << "...outputfile closed" << endl;
 		cout << "(" << fOutFile->GetName() << ")" << endl;
+		
+		// run summary for anasum preflight checks
+		fRunInfo.fRunNumber = runNumber;
+		fRunInfo.fIsMC = fIsMC;
+		fRunInfo.fMeanPedvars = fTLRunParameter->meanpedvars;
+		fRunInfo.writeSidecarFile( fOutFile->GetName() );
 	}
 	
 	return true;
@@ -59,6 +59,12 @@ VTableLookupRunParameter::VTableLookupRunParameter()
 	fNentries = 1234567890;
 	fMaxRunTime = 1.e9;
 	
+	fTreeCompression = "";
+	fTreeAutoFlush = 0;
+	fTreeBasketSize = 0;
+	fTreeIOThreads = 0;
+	fTreeReadCacheSize = 0;
+	
 	printpara = "";
 	
 	meanpedvars = 0.;
@@ -108,6 +114,36 @@ bool VTableLookupRunParameter::fillParameters( int argc, char* argv[] )
 				i++;
 			}
 		}
+		// I/O settings (note: must be checked before '-o')
+		else if( iTemp.find( "-iocompression" ) < iTemp.size() )
+		{
+			fTreeCompression = iTemp.substr( iTemp.rfind( "=" ) + 1, iTemp.size() );
+		}
+		else if( iTemp.find( "-ioautoflush" ) < iTemp.size() )
+		{
+			fTreeAutoFlush = atoll( iTemp.substr( iTemp.rfind( "=" ) + 1, iTemp.size() ).c_str() );
+		}
+		else if( iTemp.find( "-iobasketsize" ) < iTemp.size() )
+		{
+			// basket size for all branches or for an individual branch (BRANCHNAME:BYTES)
+			if( iTemp.find( ":" ) != string::npos )
+			{
+				fTreeBranchBasketSize.push_back( iTemp.substr( iTemp.rfind( "=" ) + 1, iTemp.size() ) );
+			}
+			else
+			{
+				fTreeBasketSize = atoi( iTemp.substr( iTemp.rfind( "=" ) + 1, iTemp.size() ).c_str() );
+			}
+		}
+		else if( iTemp.find( "-iothreads" ) < iTemp.size() )
+		{
+			fTreeIOThreads = atoi( iTemp.substr( iTemp.rfind( "=" ) + 1, iTemp.size() ).c_str() );
+		}
+		else if( iTemp.find( "-iocachesize" ) < iTemp.size() )
+		{
+			// cache size given in MB
+			fTreeReadCacheSize = ( Long64_t )( atof( iTemp.substr( iTemp.rfind( "=" ) + 1, iTemp.size() ).c_str() ) * 1024. * 1024. );
+		}
 		else if( iTemp.find( "-o" ) < iTemp.size() )
 		{
 			if( iTemp2.size() > 0 )
@@ -613,6 +649,27 @@ void VTableLookupRunParameter::print( int iP )
 	{
 		cout << "updating instrument epoch from default epoch file" << endl;
 	}
+	if( fTreeCompression.size() > 0 )
+	{
+		cout << "output tree compression: " << fTreeCompression << endl;
+	}
+	if( fTreeAutoFlush != 0 || fTreeBasketSize > 0 || fTreeBranchBasketSize.size() > 0 )
+	{
+		cout << "output tree auto flush: " << fTreeAutoFlush << ", basket size: " << fTreeBasketSize;
+		for( unsigned int i = 0; i < fTreeBranchBasketSize.size(); i++ )
+		{
+			cout << ", " << fTreeBranchBasketSize[i];
+		}
+		cout << endl;
+	}
+	if( fTreeIOThreads > 0 )
+	{
+		cout << "parallel basket compression with " << fTreeIOThreads << " threads" << endl;
+	}
+	if( fTreeReadCacheSize > 0 )
+	{
+		cout << "read cache for input trees: " << fTreeReadCacheSize / 1024 / 1024 << " MB" << endl;
+	}
 	
 	if( iP >= 1 )
 	{
@@ -58,19 +58,8 @@ void VTraceHandler::setTrace( VVirtualDataReader* iReader, unsigned int iNSample
 	
 	///////////////////////////////////////
 	// copy trace from raw data reader
-	if( iNSamples != fpTrace.size() )
-	{
-		fpTrace.clear();
-		for( unsigned int i = 0; i < iNSamples; i++ )
-		{
-			fpTrace.push_back( iReader->getSample_double( iHitID, i + fMC_FADCTraceStart, ( i == 0 ) ) );
-		}
-	}
-	else for( unsigned int i = 0; i < iNSamples; i++ )
-		{
-			fpTrace[i] = iReader->getSample_double( iHitID, i + fMC_FADCTraceStart, ( i == 0 ) );
-		}
-		
+	iReader->getSamples_double( iHitID, fMC_FADCTraceStart, iNSamples, fpTrace );
+	
 	fpTrazeSize = int( fpTrace.size() );
 	
 	////////////////////////////
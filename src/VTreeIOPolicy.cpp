@@ -0,0 +1,246 @@
+/*! \class VTreeIOPolicy
+    \brief I/O settings for output trees (compression, auto flush, basket sizes, parallel compression)
+           and read cache for input trees
+
+    compression is given as ALGORITHM:LEVEL, e.g. ZSTD:5, LZ4:4, ZLIB:1, LZMA:9
+    (ROOT default is used when no compression string is given)
+
+    basket sizes for individual branches are given as BRANCHNAME:BYTES
+
+    parallel compression of baskets uses ROOT's implicit multi threading
+    (baskets are compressed in parallel whenever the tree is flushed)
+
+*/
+
+#include "VTreeIOPolicy.h"
+
+VTreeIOPolicy::VTreeIOPolicy()
+{
+	fDebug = false;
+	
+	fCompressionAlgorithm = -1;
+	fCompressionLevel = 1;
+	fAutoFlush = 0;
+	fBasketSize = 0;
+	fNThreads = 0;
+}
+
+/*
+ * set I/O parameters
+ *
+ * iCompression      ALGORITHM:LEVEL (empty string: ROOT default)
+ * iAutoFlush        auto flush (>0: entries; <0: bytes; 0: ROOT default)
+ * iBasketSize       default basket size for all branches (0: ROOT default)
+ * iBranchBasketSize list of basket sizes for individual branches (BRANCHNAME:BYTES)
+ * iNThreads         number of threads used for basket compression (0: off)
+ *
+ */
+bool VTreeIOPolicy::set( string iCompression, Long64_t iAutoFlush, int iBasketSize,
+						 vector< string > iBranchBasketSize, unsigned int iNThreads )
+{
+	if( !setCompression( iCompression ) )
+	{
+		return false;
+	}
+	fAutoFlush = iAutoFlush;
+	fBasketSize = iBasketSize;
+	
+	fBranchBasketSize.clear();
+	for( unsigned int i = 0; i < iBranchBasketSize.size(); i++ )
+	{
+		size_t iP = iBranchBasketSize[i].rfind( ":" );
+		if( iP == string::npos || iP == 0 )
+		{
+			cout << "VTreeIOPolicy::set error: invalid basket size definition ";
+			cout << iBranchBasketSize[i] << " (expected BRANCHNAME:BYTES)" << endl;
+			return false;
+		}
+		int iSize = atoi( iBranchBasketSize[i].substr( iP + 1, iBranchBasketSize[i].size() ).c_str() );
+		if( iSize <= 0 )
+		{
+			cout << "VTreeIOPolicy::set error: invalid basket size for branch ";
+			cout << iBranchBasketSize[i].substr( 0, iP ) << endl;
+			return false;
+		}
+		fBranchBasketSize[iBranchBasketSize[i].substr( 0, iP )] = iSize;
+	}
+	
+	fNThreads = iNThreads;
+	if( fNThreads > 0 )
+	{
+#ifdef R__USE_IMT
+		if( !ROOT::IsImplicitMTEnabled() )
+		{
+			ROOT::EnableImplicitMT( fNThreads );
+		}
+#else
+		cout << "VTreeIOPolicy::set warning: ROOT compiled without implicit multi threading support; ";
+		cout << "ignoring parallel basket compression" << endl;
+		fNThreads = 0;
+#endif
+	}
+	return true;
+}
+
+/*
+ * translate compression string (ALGORITHM:LEVEL) into ROOT algorithm and level
+ */
+bool VTreeIOPolicy::setCompression( string iCompression )
+{
+	fCompressionAlgorithm = -1;
+	fCompressionLevel = 1;
+	if( iCompression.size() == 0 )
+	{
+		return true;
+	}
+	string iAlgorithm = iCompression;
+	size_t iP = iCompression.find( ":" );
+	if( iP != string::npos )
+	{
+		iAlgorithm = iCompression.substr( 0, iP );
+		fCompressionLevel = atoi( iCompression.substr( iP + 1, iCompression.size() ).c_str() );
+	}
+	iAlgorithm = VUtilities::upperCase( iAlgorithm );
+	// values as in ROOT::RCompressionSetting::EAlgorithm
+	if( iAlgorithm == "ZLIB" )
+	{
+		fCompressionAlgorithm = 1;
+	}
+	else if( iAlgorithm == "LZMA" )
+	{
+		fCompressionAlgorithm = 2;
+	}
+	else if( iAlgorithm == "LZ4" )
+	{
+		fCompressionAlgorithm = 4;
+	}
+	else if( iAlgorithm == "ZSTD" )
+	{
+		fCompressionAlgorithm = 5;
+	}
+	else
+	{
+		cout << "VTreeIOPolicy::setCompression error: unknown compression algorithm " << iAlgorithm;
+		cout << " (allowed values: ZLIB, LZMA, LZ4, ZSTD)" << endl;
+		return false;
+	}
+	if( fCompressionLevel < 0 || fCompressionLevel > 9 )
+	{
+		cout << "VTreeIOPolicy::setCompression error: invalid compression level " << fCompressionLevel;
+		cout << " (allowed values: 0-9)" << endl;
+		return false;
+	}
+	return true;
+}
+
+/*
+ * compression settings in ROOT format (100 * algorithm + level)
+ *
+ * returns -1 for ROOT default
+ */
+int VTreeIOPolicy::getCompressionSettings()
+{
+	if( fCompressionAlgorithm < 0 )
+	{
+		return -1;
+	}
+	return fCompressionAlgorithm * 100 + fCompressionLevel;
+}
+
+bool VTreeIOPolicy::isDefault()
+{
+	return ( fCompressionAlgorithm < 0 && fAutoFlush == 0 && fBasketSize == 0
+			 && fBranchBasketSize.size() == 0 && fNThreads == 0 );
+}
+
+/*
+ * set compression for all objects written to this file
+ * (must be called before the trees are created)
+ */
+void VTreeIOPolicy::apply( TFile* iFile )
+{
+	if( !iFile || getCompressionSettings() < 0 )
+	{
+		return;
+	}
+	iFile->SetCompressionSettings( getCompressionSettings() );
+}
+
+/*
+ * set auto flush, basket sizes and parallel compression for this tree
+ * (must be called after all branches are defined)
+ */
+void VTreeIOPolicy::apply( TTree* iTree )
+{
+	if( !iTree )
+	{
+		return;
+	}
+	if( fBasketSize > 0 )
+	{
+		iTree->SetBasketSize( "*", fBasketSize );
+	}
+	map< string, int >::iterator iter;
+	for( iter = fBranchBasketSize.begin(); iter != fBranchBasketSize.end(); ++iter )
+	{
+		iTree->SetBasketSize( iter->first.c_str(), iter->second );
+	}
+	if( fAutoFlush != 0 )
+	{
+		iTree->SetAutoFlush( fAutoFlush );
+	}
+#ifdef R__USE_IMT
+	iTree->SetImplicitMT( fNThreads > 0 );
+#endif
+	if( fDebug )
+	{
+		cout << "VTreeIOPolicy::apply tree " << iTree->GetName() << endl;
+	}
+}
+
+/*
+ * read cache for input trees or chains
+ *
+ * branches read during the first iLearnEntries entries are
+ * added to the cache (learning phase)
+ */
+void VTreeIOPolicy::setReadCache( TTree* iTree, Long64_t iCacheSize, Long64_t iLearnEntries )
+{
+	if( !iTree || iCacheSize <= 0 )
+	{
+		return;
+	}
+	iTree->SetCacheSize( iCacheSize );
+	iTree->SetCacheLearnEntries( ( Int_t )iLearnEntries );
+}
+
+void VTreeIOPolicy::print()
+{
+	if( isDefault() )
+	{
+		return;
+	}
+	cout << "tree I/O settings:";
+	if( fCompressionAlgorithm > 0 )
+	{
+		cout << " compression " << getCompressionSettings();
+	}
+	if( fAutoFlush != 0 )
+	{
+		cout << ", auto flush " << fAutoFlush;
+	}
+	if( fBasketSize > 0 )
+	{
+		cout << ", basket size " << fBasketSize;
+	}
+	map< string, int >::iterator iter;
+	for( iter = fBranchBasketSize.begin(); iter != fBranchBasketSize.end(); ++iter )
+	{
+		cout << ", " << iter->first << ":" << iter->second;
+	}
+	if( fNThreads > 0 )
+	{
+		cout << ", parallel basket compression (" << fNThreads << " threads)";
+	}
+	cout << endl;
+}
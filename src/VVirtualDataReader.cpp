@@ -22,3 +22,17 @@ double VVirtualDataReader::getSample_double( unsigned channel, unsigned sample,
 	
 	return ( double )getSample( channel, sample, iNewNoiseTrace );
 }
+
+/*
+ * fill a trace of iNSamples samples starting at iFirstSample
+ *
+ * (a new noise trace is requested for the first sample)
+ */
+void VVirtualDataReader::getSamples_double( unsigned channel, unsigned iFirstSample, unsigned iNSamples, vector< double >& iTrace )
+{
+	iTrace.resize( iNSamples );
+	for( unsigned int i = 0; i < iNSamples; i++ )
+	{
+		iTrace[i] = getSample_double( channel, i + iFirstSample, ( i == 0 ) );
+	}
+}
@@ -26,7 +26,10 @@ string outfile = "output.ansum.root";
 // run types:
 //   0:  sequentiell analysis of a list file
 //   1:  combine a list of runs and do a combined analysis
+//   2:  incremental analysis (analyse new or changed runs into run cache directory, then as 1)
 unsigned int runType = 0;
+// directory with per-run anasum files (run type 2)
+string runCacheDir = "";
 // location of data files (might be mscw file (run type 0) or anasum result file (run type 1 )
 string datadir = "";
 // run parameter file
@@ -64,6 +67,12 @@ bool testCommandlineArguments()
 		cout << "error: missing required command line argument --datadir (-d)" << endl;
 		return false;
 	}
+	// require run cache directory for incremental analysis
+	if( runType == 2 && runCacheDir.size() < 1 )
+	{
+		cout << "error: missing command line argument --cachedir (-c) (required for run type 2)" << endl;
+		return false;
+	}
 	return true;
 }
 
@@ -99,6 +108,7 @@ int main( int argc, char* argv[] )
 	
 	// initialize analysis
 	VAnaSum* anasum = new VAnaSum( datadir, analysisType );
+	anasum->setRunCacheDirectory( runCacheDir );
 	anasum->initialize( listfilename, listShortfilename, singletel - 1, runType, outfile, fRandomSeed, fRunParameterfile );
 	cout << endl;
 	
@@ -139,11 +149,12 @@ int parseOptions( int argc, char* argv[] )
 			{"singletelescope", required_argument, 0, 's'},
 			{"randomseed", required_argument, 0, 'r'},
 			{"runType", required_argument, 0, 'i'},
+			{"cachedir", required_argument, 0, 'c'},
 			{"parameterfile",  required_argument, 0, 'f'},
 			{0, 0, 0, 0}
 		};
 		int option_index = 0;
-		int c = getopt_long( argc, argv, "h:l:k:m:o:d:s:r:i:u:f:g", long_options, &option_index );
+		int c = getopt_long( argc, argv, "h:l:k:m:o:d:s:r:i:c:u:f:g", long_options, &option_index );
 		if( optopt != 0 )
 		{
 			cout << "error: unknown option" << endl;
@@ -195,6 +206,9 @@ int parseOptions( int argc, char* argv[] )
 			case 'i':
 				runType = ( unsigned int )atoi( optarg );
 				break;
+			case 'c':
+				runCacheDir = optarg;
+				break;
 			case 'm':
 				analysisType = atoi( optarg );
 				break;
@@ -1,11 +1,22 @@
 /*! \file combineDISPTables.cpp
     \brief merge different DISP tables into one file
 
+    tables for the same zenith angle, azimuth bin, wobble offset and noise
+    level (e.g. filled from different MC files) are combined into one table
 
+    the number of values, sums and sums of squares per bin stored with each
+    table are added exactly; mean and error per bin are derived from the
+    combined sums (miss values of each table are calculated with the disp
+    values of that table)
+
+    tables without stored statistics (older versions) are combined
+    approximately from mean, error and number of events per bin
+    (see VDispTableStatistics::addHistogram())
 
 */
 
 #include "VGlobalRunParameter.h"
+#include "VDispTable.h"
 #include "VDispTableReader.h"
 
 #include "TFile.h"
@@ -19,6 +30,35 @@
 #include <string>
 #include <vector>
 
+using namespace std;
+
+// disp table entries with same ze, az, woff and noise
+struct sDispTableNode
+{
+	float ze;
+	unsigned int az_bin;
+	float az_min;
+	float az_max;
+	float woff;
+	float pedvar;
+	double pedvarSum;
+	double pedvarN;
+	vector< unsigned int > fFile;       // file index
+	vector< int > fEntry;               // tree entry
+};
+
+/*
+ * get total number of events in table of current tree entry
+ */
+double getNumberOfEvents( VDispTableReader* a )
+{
+	if( a && a->h2D_DispTableN )
+	{
+		return a->h2D_DispTableN->GetSumOfWeights();
+	}
+	return 0.;
+}
+
 
 int main( int argc, char* argv[] )
 {
@@ -69,46 +109,176 @@ int main( int argc, char* argv[] )
 	fData->initialize( false );
 	
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-	// loop over all files
+	// loop over all files and find table entries with same ze, az, woff and noise
+	vector< TFile* > fFile;
+	vector< VDispTableReader* > fTable;
+	vector< sDispTableNode > fNode;
 	for( unsigned int i = 0; i < fInputFile.size(); i++ )
 	{
 		cout << "now reading " << fInputFile[i] << endl;
-		TFile f( fInputFile[i].c_str() );
-		if( f.IsZombie() )
+		fFile.push_back( new TFile( fInputFile[i].c_str() ) );
+		if( fFile.back()->IsZombie() )
 		{
 			cout << "error reading input file " << fInputFile[i] << endl;
 			exit( -1 );
 		}
 		// read disp table from this file
-		VDispTableReader* a = ( VDispTableReader* )f.Get( "dispTable" );
+		VDispTableReader* a = ( VDispTableReader* )fFile.back()->Get( "dispTable" );
 		if( !a )
 		{
 			cout << "error: no disp table found in " << fInputFile[i] << endl;
 			exit( -1 );
 		}
-		a->initialize( true );
+		a->initialize( true, true );
 		TTree* t = a->getTree();
 		if( !t )
 		{
 			cout << "error: no tree in disp table in " << fInputFile[i] << endl;
 			exit( -1 );
 		}
+		if( !a->hasStatistics() )
+		{
+			cout << "warning: no table statistics found in " << fInputFile[i];
+			cout << " (older table version); tables are combined approximately" << endl;
+		}
+		fTable.push_back( a );
+		if( i == 0 )
+		{
+			fData->fWidthScaleParameter = a->fWidthScaleParameter;
+			fData->fLengthScaleParameter = a->fLengthScaleParameter;
+		}
 		// loop over all file entries
 		for( int j = 0; j < t->GetEntries(); j++ )
 		{
 			t->GetEntry( j );
 			
-			cout << "\t filling entry " << j << "\t" << a->ze << "\t" << a->az_min << "\t" << a->az_max << "\t" << a->woff << "\t" << a->pedvar << endl;
-			
-			fData->fill( a->ze, a->az_bin, a->az_min, a->az_max, a->woff, a->pedvar, ( TH2* )a->h2D_DispTable, ( TH2* )a->h2D_DispTableN, ( TH2* )a->h2D_DispPhiTable, ( TH2* )a->h2D_DispMissTable, ( TH3* )a->h3D_DispTable, ( TH3* )a->h3D_DispTableN, ( TH3* )a->h3D_DispPhiTable, ( TH3* )a->h3D_DispMissTable );
+			cout << "\t reading entry " << j << "\t" << a->ze << "\t" << a->az_min << "\t" << a->az_max << "\t" << a->woff << "\t" << a->pedvar << endl;
 			
+			// same tolerances as in VDispTableReader::initialize()
+			unsigned int n = 0;
+			for( n = 0; n < fNode.size(); n++ )
+			{
+				if( TMath::Abs( fNode[n].ze - a->ze ) < 1.e-2 && fNode[n].az_bin == a->az_bin
+						&& TMath::Abs( fNode[n].woff - a->woff ) < 1.e-2 && TMath::Abs( fNode[n].pedvar - a->pedvar ) < 5.e-1 )
+				{
+					break;
+				}
+			}
+			if( n == fNode.size() )
+			{
+				sDispTableNode iNode;
+				iNode.ze = a->ze;
+				iNode.az_bin = a->az_bin;
+				iNode.az_min = a->az_min;
+				iNode.az_max = a->az_max;
+				iNode.woff = a->woff;
+				iNode.pedvar = a->pedvar;
+				iNode.pedvarSum = 0.;
+				iNode.pedvarN = 0.;
+				fNode.push_back( iNode );
+			}
+			fNode[n].fFile.push_back( i );
+			fNode[n].fEntry.push_back( j );
+			fNode[n].pedvarSum += a->pedvar * getNumberOfEvents( a );
+			fNode[n].pedvarN   += getNumberOfEvents( a );
+		}
+	}
+	
+	//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// combine and fill tables
+	for( unsigned int n = 0; n < fNode.size(); n++ )
+	{
+		VDispTableStatistics* i2D = 0;
+		VDispTableStatistics* i3D = 0;
+		TH2F* h2D[4] = { 0, 0, 0, 0 };
+		TH3F* h3D[4] = { 0, 0, 0, 0 };
+		for( unsigned int j = 0; j < fNode[n].fFile.size(); j++ )
+		{
+			VDispTableReader* a = fTable[fNode[n].fFile[j]];
+			a->getTree()->GetEntry( fNode[n].fEntry[j] );
+			if( !a->h2D_DispTable || !a->h2D_DispTableN || !a->h2D_DispPhiTable || !a->h2D_DispMissTable
+					|| !a->h3D_DispTable || !a->h3D_DispTableN || !a->h3D_DispPhiTable || !a->h3D_DispMissTable )
+			{
+				cout << "error: missing disp table histograms in " << fInputFile[fNode[n].fFile[j]] << endl;
+				exit( -1 );
+			}
 			if( j == 0 )
 			{
-				fData->fWidthScaleParameter = a->fWidthScaleParameter;
-				fData->fLengthScaleParameter = a->fLengthScaleParameter;
+				i2D = new VDispTableStatistics( a->h2D_DispTable );
+				i3D = new VDispTableStatistics( a->h3D_DispTable );
+				h2D[0] = ( TH2F* )a->h2D_DispTable->Clone( "h2D_combined_DispTable" );
+				h2D[1] = ( TH2F* )a->h2D_DispTableN->Clone( "h2D_combined_DispTableN" );
+				h2D[2] = ( TH2F* )a->h2D_DispPhiTable->Clone( "h2D_combined_DispPhiTable" );
+				h2D[3] = ( TH2F* )a->h2D_DispMissTable->Clone( "h2D_combined_DispMissTable" );
+				h3D[0] = ( TH3F* )a->h3D_DispTable->Clone( "h3D_combined_DispTable" );
+				h3D[1] = ( TH3F* )a->h3D_DispTableN->Clone( "h3D_combined_DispTableN" );
+				h3D[2] = ( TH3F* )a->h3D_DispPhiTable->Clone( "h3D_combined_DispPhiTable" );
+				h3D[3] = ( TH3F* )a->h3D_DispMissTable->Clone( "h3D_combined_DispMissTable" );
 			}
+			// exact: add sums per bin
+			if( a->hasStatistics() )
+			{
+				if( !i2D->addSparseStatistics( a->f2D_StatisticsBin, a->f2D_Statistics )
+						|| !i3D->addSparseStatistics( a->f3D_StatisticsBin, a->f3D_Statistics ) )
+				{
+					cout << "error: inconsistent disp table statistics in " << fInputFile[fNode[n].fFile[j]] << endl;
+					exit( -1 );
+				}
+			}
+			// approximate: reconstruct sums from mean, error and number of events
+			else if( !i2D->addEventHistogram( a->h2D_DispTableN )
+					|| !i2D->addHistogram( VDispTableStatistics::E_DISP, a->h2D_DispTable, a->h2D_DispTableN )
+					|| !i2D->addHistogram( VDispTableStatistics::E_PHI, a->h2D_DispPhiTable, a->h2D_DispTableN )
+					|| !i2D->addHistogram( VDispTableStatistics::E_MISS, a->h2D_DispMissTable, a->h2D_DispTableN )
+					|| !i3D->addEventHistogram( a->h3D_DispTableN )
+					|| !i3D->addHistogram( VDispTableStatistics::E_DISP, a->h3D_DispTable, a->h3D_DispTableN )
+					|| !i3D->addHistogram( VDispTableStatistics::E_PHI, a->h3D_DispPhiTable, a->h3D_DispTableN )
+					|| !i3D->addHistogram( VDispTableStatistics::E_MISS, a->h3D_DispMissTable, a->h3D_DispTableN ) )
+			{
+				cout << "error: inconsistent disp table binning in " << fInputFile[fNode[n].fFile[j]] << endl;
+				exit( -1 );
+			}
+		}
+		if( !i2D || !i3D )
+		{
+			continue;
+		}
+		i2D->fillHistogram( VDispTableStatistics::E_DISP, h2D[0] );
+		i2D->fillEventHistogram( h2D[1] );
+		i2D->fillHistogram( VDispTableStatistics::E_PHI, h2D[2] );
+		i2D->fillHistogram( VDispTableStatistics::E_MISS, h2D[3] );
+		i3D->fillHistogram( VDispTableStatistics::E_DISP, h3D[0] );
+		i3D->fillEventHistogram( h3D[1] );
+		i3D->fillHistogram( VDispTableStatistics::E_PHI, h3D[2] );
+		i3D->fillHistogram( VDispTableStatistics::E_MISS, h3D[3] );
+		
+		if( fNode[n].pedvarN > 0. )
+		{
+			fNode[n].pedvar = fNode[n].pedvarSum / fNode[n].pedvarN;
 		}
-		f.Close();
+		cout << "\t filling entry " << n << "\t" << fNode[n].ze << "\t" << fNode[n].az_min << "\t" << fNode[n].az_max;
+		cout << "\t" << fNode[n].woff << "\t" << fNode[n].pedvar << " (combined from " << fNode[n].fFile.size() << " table(s))" << endl;
+		
+		// combined sums per bin (output remains mergeable)
+		i2D->getSparseStatistics( fData->f2D_StatisticsBin, fData->f2D_Statistics );
+		i3D->getSparseStatistics( fData->f3D_StatisticsBin, fData->f3D_Statistics );
+		
+		fData->fill( fNode[n].ze, fNode[n].az_bin, fNode[n].az_min, fNode[n].az_max, fNode[n].woff, fNode[n].pedvar,
+					 ( TH2* )h2D[0], ( TH2* )h2D[1], ( TH2* )h2D[2], ( TH2* )h2D[3], ( TH3* )h3D[0], ( TH3* )h3D[1], ( TH3* )h3D[2], ( TH3* )h3D[3] );
+		// reset tables of output data class (only bins with entries are copied in fill())
+		fData->reset();
+		
+		delete i2D;
+		delete i3D;
+		for( unsigned int h = 0; h < 4; h++ )
+		{
+			delete h2D[h];
+			delete h3D[h];
+		}
+	}
+	for( unsigned int i = 0; i < fFile.size(); i++ )
+	{
+		fFile[i]->Close();
 	}
 	//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	fTot->cd();
@@ -8,6 +8,9 @@
 
     tables are then used in VArrayAnalyzer for direction reconstruction
 
+    tables for the same ze, az, woff, pedvar produced in different jobs (e.g. for
+    different MC files) can be merged with combineDISPTables
+
 */
 
 #include "VGlobalRunParameter.h"
@@ -32,6 +35,8 @@ using namespace std;
 unsigned int fNTel = 4;
 // total number of events to use for table generation (per simulation file; -1 = use all events)
 int fNTotEvents = -1;
+// number of threads used to fill the tables (entries of each simulation file are split between threads)
+unsigned int fNThreads = 1;
 // quality cuts
 int f_ntubes_min = 4;
 double f_size_min = 0.;
@@ -113,6 +118,11 @@ bool readInputParameter( string i_filename )
 				is_stream >> temp;
 				fNTotEvents = atoi( temp.c_str() );
 			}
+			else if( temp == "NTHREADS" )
+			{
+				is_stream >> temp;
+				fNThreads = ( unsigned int )atoi( temp.c_str() );
+			}
 			else if( temp == "NUMBEROFTELESCOPES" )
 			{
 				is_stream >> temp;
@@ -160,6 +170,7 @@ bool readInputParameter( string i_filename )
 	cout << "quality cut: ntubes > " << f_ntubes_min << ", size > " << f_size_min << ", length > " << f_length_min << ", loss < " << f_loss_max << endl;
 	cout << "read in " << f_ze.size() << " zenith bins, " << f_woff.size() << " wobble offset bins and " << f_noise.size() << " noise level bins" << endl;
 	cout << "(total number of events to read from each MC data file: " << fNTotEvents << ")" << endl;
+	cout << "(number of threads: " << fNThreads << ")" << endl;
 	cout << endl;
 	
 	return true;
@@ -205,6 +216,7 @@ int main( int argc, char* argv[] )
 	VDispTable* fDisp = new VDispTable( fNTel, iTableFile );
 	fDisp->setQualityCuts( f_ntubes_min, f_size_min, f_length_min, f_loss_max );
 	fDisp->setWidthLengthScalingParameters( fWidthScaleParameter, fLengthScaleParameter );
+	fDisp->setNumberOfThreads( fNThreads );
 	
 	// add four azimuth bins
 	fDisp->addAzBin( 135., -135. );
@@ -34,6 +34,8 @@
 using namespace std;
 
 VEffectiveAreaCalculatorMCHistograms* copyMCHistograms( TChain* c );
+void fillEventData( CData* d, VEffectiveAreaCalculator* iEffArea, bool bEffectiveAreas,
+					vector< VInstrumentResponseFunction* > iIRF, unsigned int iIRFMethod );
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 int main( int argc, char* argv[] )
@@ -193,34 +195,6 @@ int main( int argc, char* argv[] )
 	
 	CData d( c, true, 6, true );
 	fCuts->setDataTree( &d );
-	TH1D* hE0mc = ( TH1D* )gDirectory->Get( "hE0mc" );
-	
-	/////////////////////////////////////////////////////////////////////////////
-	// fill resolution plots
-	for( unsigned int i = 0; i < f_IRF_Name.size(); i++ )
-	{
-		if( f_IRF[i] )
-		{
-			f_IRF[i]->setDataTree( &d );
-			f_IRF[i]->setCuts( fCuts );
-			if( f_IRF[i]->doNotDuplicateIRFs() )
-			{
-				f_IRF[i]->fill();
-			}
-			else if( f_IRF[i]->getDuplicationID() < f_IRF.size() && f_IRF[f_IRF[i]->getDuplicationID()] )
-			{
-				f_IRF[i]->fillResolutionGraphs( f_IRF[f_IRF[i]->getDuplicationID()]->getIRFData() );
-			}
-			
-			if( fCuts_AngularResolutionName.size() > 0 && f_IRF_Name[i] == fCuts_AngularResolutionName )
-			{
-				if( fCuts->getDirectionCutSelector() == 2 )
-				{
-					fCuts->setIRFGraph( f_IRF[i]->getAngularResolutionGraph( 0, 0 ) );
-				}
-			}
-		}
-	}
 	
 	/////////////////////////////////////////////////////////////////////////////
 	// calculate effective areas
@@ -294,9 +268,73 @@ int main( int argc, char* argv[] )
 		fStopWatch.Print();
 	}
 	
-	// fill effective areas
-	if( !fRunPara->fFillMCHistograms && fRunPara->fFillingMode != 1 && fRunPara->fFillingMode != 2 )
+	/////////////////////////////////////////////////////////////////////////////
+	// fill resolution plots and effective areas
+	//
+	// single loop over the data tree; cuts are evaluated once per event
+	// and shared between resolution and effective area filling
+	// (two loops are needed if the angular resolution is used in the direction cut)
+	bool bFillEffectiveAreas = ( !fRunPara->fFillMCHistograms && fRunPara->fFillingMode != 1 && fRunPara->fFillingMode != 2 );
+	bool bIRFDirectionCut = ( fCuts_AngularResolutionName.size() > 0 && fCuts->getDirectionCutSelector() == 2 );
+	if( bFillEffectiveAreas )
+	{
+		fOutputfile->cd();
+		if( !fEffectiveAreaCalculator.initializeFill( &d, fMC_histo, fRunPara->fEnergyReconstructionMethod ) )
+		{
+			bFillEffectiveAreas = false;
+		}
+	}
+	vector< VInstrumentResponseFunction* > f_IRF_fill;
+	for( unsigned int i = 0; i < f_IRF.size(); i++ )
+	{
+		if( f_IRF[i] )
+		{
+			f_IRF[i]->setDataTree( &d );
+			f_IRF[i]->setCuts( fCuts );
+			if( f_IRF[i]->doNotDuplicateIRFs() )
+			{
+				f_IRF_fill.push_back( f_IRF[i] );
+			}
+		}
+	}
+	fillEventData( &d, &fEffectiveAreaCalculator, ( bFillEffectiveAreas && !bIRFDirectionCut ),
+				   f_IRF_fill, fRunPara->fEnergyReconstructionMethod );
+	
+	/////////////////////////////////////////////////////////////////////////////
+	// fill resolution graphs
+	for( unsigned int i = 0; i < f_IRF_Name.size(); i++ )
+	{
+		if( f_IRF[i] )
+		{
+			if( f_IRF[i]->doNotDuplicateIRFs() )
+			{
+				f_IRF[i]->fillResolutionGraphs( f_IRF[i]->getIRFData() );
+			}
+			else if( f_IRF[i]->getDuplicationID() < f_IRF.size() && f_IRF[f_IRF[i]->getDuplicationID()] )
+			{
+				f_IRF[i]->fillResolutionGraphs( f_IRF[f_IRF[i]->getDuplicationID()]->getIRFData() );
+			}
+			
+			if( fCuts_AngularResolutionName.size() > 0 && f_IRF_Name[i] == fCuts_AngularResolutionName )
+			{
+				if( fCuts->getDirectionCutSelector() == 2 )
+				{
+					fCuts->setIRFGraph( f_IRF[i]->getAngularResolutionGraph( 0, 0 ) );
+				}
+			}
+		}
+	}
+	
+	// effective areas
+	if( bFillEffectiveAreas )
 	{
+		// second loop required for direction cuts depending on angular resolution
+		if( bIRFDirectionCut )
+		{
+			fillEventData( &d, &fEffectiveAreaCalculator, true,
+						   vector< VInstrumentResponseFunction* >(), fRunPara->fEnergyReconstructionMethod );
+		}
+		
 		fOutputfile->cd();
 		
 		// copy angular resolution graphs to effective areas
@@ -330,7 +368,7 @@ int main( int argc, char* argv[] )
 			}
 		}
 		
-		fEffectiveAreaCalculator.fill( hE0mc, &d, fMC_histo, fRunPara->fEnergyReconstructionMethod );
+		fEffectiveAreaCalculator.terminateFill();
 		fStopWatch.Print();
 	}
 	
@@ -424,4 +462,63 @@ VEffectiveAreaCalculatorMCHistograms* copyMCHistograms( TChain* c )
 	return iMC_his;
 }
 
-
+/*
+ * loop over all events in the data tree and fill resolution functions and effective areas
+ *
+ * cuts are evaluated once per event (see VEffectiveAreaCalculator::evaluateCuts);
+ * resolution functions are filled for all events, effective areas
+ * starting at the first entry defined in the effective area calculator
+ *
+ */
+void fillEventData( CData* d, VEffectiveAreaCalculator* iEffArea, bool bEffectiveAreas,
+					vector< VInstrumentResponseFunction* > iIRF, unsigned int iIRFMethod )
+{
+	if( !d || !d->fChain || !iEffArea )
+	{
+		return;
+	}
+	bool bIRF = ( iIRF.size() > 0 );
+	if( !bIRF && !bEffectiveAreas )
+	{
+		return;
+	}
+	
+	Long64_t d_nentries = d->fChain->GetEntries();
+	Long64_t i_start = 0;
+	if( bEffectiveAreas )
+	{
+		i_start = iEffArea->getFirstEntryToFill();
+	}
+	cout << "filling " << iIRF.size() << " resolution function(s)";
+	if( bEffectiveAreas )
+	{
+		cout << " and effective areas";
+	}
+	cout << ": total number of data events: " << d_nentries << endl;
+	
+	sEffectiveAreaCutDecision iCut;
+	for( Long64_t i = ( bIRF ? 0 : i_start ); i < d_nentries; i++ )
+	{
+		d->GetEntry( i );
+		
+		bool bEffectiveAreaEvent = ( bEffectiveAreas && i >= i_start );
+		iEffArea->evaluateCuts( d, i, iCut, bEffectiveAreaEvent, bIRF, iIRFMethod );
+		
+		// resolution functions
+		if( bIRF && iCut.bMCXYoff && iCut.bFiducialArea && iCut.bStereoQualityIRF && iCut.bGamma )
+		{
+			for( unsigned int f = 0; f < iIRF.size(); f++ )
+			{
+				if( iIRF[f] )
+				{
+					iIRF[f]->fillEvent();
+				}
+			}
+		}
+		// effective areas
+		if( bEffectiveAreaEvent )
+		{
+			iEffArea->fillEvent( d, iCut );
+		}
+	}
+}
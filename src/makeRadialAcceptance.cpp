@@ -3,12 +3,19 @@
  *
  *   use off events which pass all gamma/hadron separation cuts
  *
+ *   all acceptance configurations (azimuth bins, zenith bins, image
+ *   selections, cut files) are filled in a single pass over the data;
+ *   cuts are evaluated once per event and cut file.
+ *   Runs are processed in parallel (option --threads).
+ *
  */
 
 #include "CData.h"
 #include "TFile.h"
+#include "TROOT.h"
 
 #include "VEvndispRunParameter.h"
+#include "VMSCWRunInfo.h"
 #include "VRadialAcceptance.h"
 #include "VGammaHadronCuts.h"
 #include "VAnaSumRunParameter.h"
@@ -17,6 +24,7 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 #include <sys/stat.h>
 
@@ -24,7 +32,7 @@ using namespace std;
 
 int parseOptions( int argc, char* argv[] );
 string listfilename = "";
-string cutfilename = "";
+vector< string > cutfilename;
 string outfile = "acceptance.root";
 unsigned int ntel = 4;                   // this shouldn't be changed unless you really unterstand why
 string datadir = "../eventdisplay/output";
@@ -34,6 +42,40 @@ struct stat sb ;
 double fMaxDistanceAllowed = 2.0;
 string teltoanastring = "1234";
 vector<unsigned int> teltoana;
+unsigned int nthreads = 1;
+vector< double > zebins;
+vector< ULong64_t > imgselbins;
+
+VAnaSumRunParameter* fRunPara = 0;
+vector< string > fMSCWFileName;
+vector< bool > fRunHasEvents;
+
+// one acceptance configuration (one output directory)
+struct sAcceptanceConfiguration
+{
+	unsigned int fCutSet;                          // index of cut file
+	string    fDirName;                            // empty: top directory of this cut file
+	string    fDirTitle;
+	double    fMaxDistance;
+	double    fAzMin;
+	double    fAzMax;
+	double    fZeMin;
+	double    fZeMax;
+	ULong64_t fImgSel;
+};
+vector< sAcceptanceConfiguration > fAccConfig;
+vector< unsigned int > fCutSetFirstConfig;        // first configuration for each cut file (all events)
+
+// fill job: runs processed by one thread
+struct sAcceptanceFillJob
+{
+	vector< unsigned int > fRunIndex;             // index in run list
+	vector< VGammaHadronCuts* > fCuts;            // one per cut file
+	vector< VRadialAcceptance* > fAcc;            // one per acceptance configuration
+	vector< Long64_t > fNEventsAfterCuts;         // one per cut file
+	bool bPrint;
+	bool bSuccess;
+};
 
 
 bool check_if_file_exists( const std::string& name )
@@ -46,6 +88,304 @@ bool check_if_file_exists( const std::string& name )
 	return false;
 }
 
+/*
+ * mscw file name for a run (in datadir or in datadir/<run/10000>)
+ *
+ */
+string getMSCWFileName( int iRun )
+{
+	ostringstream ifile;
+	ifile <<  datadir << "/" << iRun << ".mscw.root";
+	if( ! check_if_file_exists( ifile.str() ) )
+	{
+		ifile.str( "" );
+		ifile <<  datadir << "/" << iRun / 10000;
+		ifile << "/" << iRun << ".mscw.root";
+		if( ! check_if_file_exists( ifile.str() ) )
+		{
+			cout << "Error reading " << ifile.str() << endl;
+			exit( EXIT_FAILURE );
+		}
+	}
+	return ifile.str();
+}
+
+/*
+ * check that the telescope combination in the run agrees with the requested one
+ *
+ */
+bool checkTelescopeCombination( vector< unsigned int > iTelToAnalyze, string iFileName )
+{
+	if( teltoana.size() != iTelToAnalyze.size()
+			|| !equal( teltoana.begin(), teltoana.end(), iTelToAnalyze.begin() ) )
+	{
+		cout << endl;
+		cout << "error: Requested telescopes " << teltoanastring;
+		cout << " do not equal telescopes in run " << iFileName << endl;
+		cout << "PAR ";
+		for( unsigned int i = 0; i < iTelToAnalyze.size(); i++ )
+		{
+			cout << iTelToAnalyze[i] << "  ";
+		}
+		cout << endl;
+		cout << "USER ";
+		for( unsigned int i = 0; i < teltoana.size(); i++ )
+		{
+			cout << teltoana[i] << "  ";
+		}
+		cout << endl;
+		cout << "\t" << teltoana.size() << "\t" << iTelToAnalyze.size() << endl;
+		return false;
+	}
+	return true;
+}
+
+/*
+ * read gamma/hadron cuts from cut file
+ *
+ */
+VGammaHadronCuts* readCutFile( string iCutFile )
+{
+	VGammaHadronCuts* iCuts = new VGammaHadronCuts();
+	iCuts->initialize();
+	iCuts->setNTel( ntel );
+	iCuts->setTelToAnalyze( teltoana );
+	if( !iCuts->readCuts( iCutFile, 2 ) )
+	{
+		cout << "error reading cut file: " << iCutFile << endl;
+		cout << "exiting..." << endl;
+		exit( EXIT_FAILURE );
+	}
+	return iCuts;
+}
+
+/*
+ * cuts and acceptance objects for all configurations
+ *
+ */
+void initializeFillJob( sAcceptanceFillJob* iJob, vector< TDirectory* >* iDir )
+{
+	for( unsigned int c = 0; c < cutfilename.size(); c++ )
+	{
+		iJob->fCuts.push_back( readCutFile( cutfilename[c] ) );
+		iJob->fNEventsAfterCuts.push_back( 0 );
+	}
+	for( unsigned int k = 0; k < fAccConfig.size(); k++ )
+	{
+		if( iDir && k < iDir->size() && ( *iDir )[k] )
+		{
+			( *iDir )[k]->cd();
+		}
+		iJob->fAcc.push_back( new VRadialAcceptance( iJob->fCuts[fAccConfig[k].fCutSet], fRunPara, fAccConfig[k].fMaxDistance ) );
+		iJob->fAcc.back()->setAzCut( fAccConfig[k].fAzMin, fAccConfig[k].fAzMax );
+		iJob->fAcc.back()->setZeCut( fAccConfig[k].fZeMin, fAccConfig[k].fZeMax );
+		iJob->fAcc.back()->setImgSelCut( fAccConfig[k].fImgSel );
+	}
+	iJob->bSuccess = false;
+}
+
+/*
+ * delete data tree reader and run parameters of a run
+ * (file is closed by the caller, not by the CData destructor)
+ *
+ */
+void deleteRunData( CData* d, VEvndispRunParameter* iParV2 )
+{
+	if( d )
+	{
+		d->fChain = 0;
+		delete d;
+	}
+	if( iParV2 )
+	{
+		delete iParV2;
+	}
+}
+
+/*
+ * fill acceptances for all runs of this job
+ *
+ * each event is read once; cuts are evaluated once per cut file
+ * and the event is filled into all configurations using these cuts
+ *
+ */
+void fillAcceptanceJob( sAcceptanceFillJob* iJob )
+{
+	iJob->bSuccess = false;
+	vector< bool > bPassed( iJob->fCuts.size(), false );
+	for( unsigned int r = 0; r < iJob->fRunIndex.size(); r++ )
+	{
+		unsigned int i = iJob->fRunIndex[r];
+		string ifile = fMSCWFileName[i];
+		ostringstream iMessage;
+		iMessage << "now chaining " << ifile;
+		iMessage << " (wobble offset " << -1.*fRunPara->fRunList[i].fWobbleNorth;
+		iMessage << ", " << fRunPara->fRunList[i].fWobbleWest << ")" << endl;
+		cout << iMessage.str();
+		// get data tree
+		TFile fTest( ifile.c_str() );
+		if( fTest.IsZombie() )
+		{
+			cout << "Error reading " << ifile << endl;
+			return;
+		}
+		TTree* c = ( TTree* )fTest.Get( "data" );
+		CData* d = new CData( c, false, 5, true );
+		
+		// Check number of telescopes in run
+		VEvndispRunParameter* iParV2 = ( VEvndispRunParameter* )fTest.Get( "runparameterV2" );
+		if( !iParV2 )
+		{
+			cout << "Error reading run parameters " << endl;
+			deleteRunData( d, iParV2 );
+			continue;
+		}
+		iMessage.str( "" );
+		iMessage << "Testing telescope multiplicity " << teltoanastring << endl;
+		cout << iMessage.str();
+		if( !checkTelescopeCombination( iParV2->fTelToAnalyze, ifile ) )
+		{
+			deleteRunData( d, iParV2 );
+			return;
+		}
+		
+		// set gamma/hadron cuts
+		bool bCutsRead = true;
+		for( unsigned int s = 0; s < iJob->fCuts.size(); s++ )
+		{
+			iJob->fCuts[s]->setInstrumentEpoch( iParV2->getInstrumentATMString() );
+			if( !iJob->fCuts[s]->readCuts( cutfilename[s], 2 ) )
+			{
+				cout << "run " << fRunPara->fRunList[i].fRunOff << ": ";
+				cout << "error reading cut file: " << cutfilename[s] << endl;
+				bCutsRead = false;
+				break;
+			}
+			iJob->fCuts[s]->initializeCuts( fRunPara->fRunList[i].fRunOff, datadir );
+			// pointer to data tree
+			iJob->fCuts[s]->setDataTree( d );
+			if( iJob->bPrint )
+			{
+				iJob->fCuts[s]->printCutSummary();
+			}
+		}
+		if( !bCutsRead )
+		{
+			deleteRunData( d, iParV2 );
+			continue;
+		}
+		
+		// data trees and cuts
+		int nentries = d->fChain->GetEntries();
+		if( entries > 0 )
+		{
+			nentries = entries;
+		}
+		vector< Long64_t > i_entries_after_cuts( iJob->fCuts.size(), 0 );
+		
+		// loop over all entries in data trees and fill acceptance curves
+		for( int n = 0; n < nentries; n++ )
+		{
+			d->GetEntry( n );
+			
+			if( n == 0 && d->isMC() )
+			{
+				cout << "\t (analysing MC data)" << endl;
+			}
+			
+			// cuts (evaluated once per cut file)
+			for( unsigned int s = 0; s < iJob->fCuts.size(); s++ )
+			{
+				bPassed[s] = iJob->fAcc[fCutSetFirstConfig[s]]->applyCuts( n );
+				if( bPassed[s] )
+				{
+					i_entries_after_cuts[s]++;
+				}
+			}
+			for( unsigned int k = 0; k < iJob->fAcc.size(); k++ )
+			{
+				if( bPassed[fAccConfig[k].fCutSet] && iJob->fAcc[k]->isInConfiguration( d ) )
+				{
+					iJob->fAcc[k]->fillEvent( d );
+				}
+			}
+		}
+		iMessage.str( "" );
+		iMessage << "run " << fRunPara->fRunList[i].fRunOff << ": " << nentries << " events (before cuts)";
+		iMessage << ", number of entries after cuts:";
+		for( unsigned int s = 0; s < i_entries_after_cuts.size(); s++ )
+		{
+			iMessage << " " << i_entries_after_cuts[s];
+			iJob->fNEventsAfterCuts[s] += i_entries_after_cuts[s];
+		}
+		iMessage << endl;
+		cout << iMessage.str();
+		
+		for( unsigned int s = 0; s < iJob->fCuts.size(); s++ )
+		{
+			iJob->fCuts[s]->setDataTree( 0 );
+		}
+		deleteRunData( d, iParV2 );
+		fTest.Close();
+	}
+	iJob->bSuccess = true;
+}
+
+/*
+ * run fill jobs (in parallel for more than one job)
+ *
+ */
+bool runFillJobs( vector< sAcceptanceFillJob >& iJobs )
+{
+	if( iJobs.size() == 1 )
+	{
+		fillAcceptanceJob( &iJobs[0] );
+	}
+	else
+	{
+		ROOT::EnableThreadSafety();
+		vector< thread > iThreads;
+		for( unsigned int j = 0; j < iJobs.size(); j++ )
+		{
+			iThreads.push_back( thread( fillAcceptanceJob, &iJobs[j] ) );
+		}
+		for( unsigned int j = 0; j < iThreads.size(); j++ )
+		{
+			iThreads[j].join();
+		}
+	}
+	for( unsigned int j = 0; j < iJobs.size(); j++ )
+	{
+		if( !iJobs[j].bSuccess )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+ * parse comma separated list of values
+ *
+ */
+template< typename T > vector< T > parseList( string iList )
+{
+	vector< T > iV;
+	istringstream is_stream( iList );
+	string iTemp;
+	while( getline( is_stream, iTemp, ',' ) )
+	{
+		if( iTemp.size() > 0 )
+		{
+			istringstream is_value( iTemp );
+			T iValue;
+			is_value >> iValue;
+			iV.push_back( iValue );
+		}
+	}
+	return iV;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 int main( int argc, char* argv[] )
 {
@@ -61,7 +401,7 @@ int main( int argc, char* argv[] )
 		}
 	}
 	
-	VAnaSumRunParameter* fRunPara = new VAnaSumRunParameter();
+	fRunPara = new VAnaSumRunParameter();
 	
 	cout << endl;
 	cout << "makeRadialAcceptance " << fRunPara->getEVNDISP_VERSION() << endl << endl;
@@ -90,20 +430,38 @@ int main( int argc, char* argv[] )
 		exit( EXIT_FAILURE );
 	}
 	
-	// read gamma/hadron cuts from cut file
-	VGammaHadronCuts* fCuts = new VGammaHadronCuts();
-	fCuts->initialize();
-	fCuts->setNTel( ntel );
-	fCuts->setTelToAnalyze( teltoana );
-	if( !fCuts->readCuts( cutfilename, 2 ) )
-	{
-		cout << "error reading cut file: " << cutfilename << endl;
+	// read gamma/hadron cuts from cut files
+	if( cutfilename.size() == 0 )
+	{
+		cout << "error: no cut file given" << endl;
 		cout << "exiting..." << endl;
 		exit( EXIT_FAILURE );
 	}
 	
 	cout << "total number of files to read: " << fRunPara->fRunList.size() << endl;
 	
+	// preflight checks using the run summaries written by mscw_energy
+	// (file names, telescope combination, empty runs; no event data is read)
+	fRunHasEvents.assign( fRunPara->fRunList.size(), true );
+	for( unsigned int i = 0; i < fRunPara->fRunList.size(); i++ )
+	{
+		fMSCWFileName.push_back( getMSCWFileName( fRunPara->fRunList[i].fRunOff ) );
+		VMSCWRunInfo iRunInfo;
+		if( iRunInfo.readSidecarFile( fMSCWFileName.back() ) )
+		{
+			if( iRunInfo.fTelToAnalyze.size() > 0
+					&& !checkTelescopeCombination( iRunInfo.fTelToAnalyze, fMSCWFileName.back() ) )
+			{
+				exit( EXIT_FAILURE );
+			}
+			if( iRunInfo.fNEvents == 0 )
+			{
+				cout << "run " << fRunPara->fRunList[i].fRunOff << ": no events in data tree, skipping run" << endl;
+				fRunHasEvents[i] = false;
+			}
+		}
+	}
+	
 	// create output file
 	TFile* fo = new TFile( outfile.c_str(), "RECREATE" );
 	if( fo->IsZombie() )
@@ -112,34 +470,12 @@ int main( int argc, char* argv[] )
 		return 0;
 	}
 	cout << endl << "writing acceptance curves to " << fo->GetName() << endl;
-	TDirectory* facc_dir = ( TDirectory* )fo;
 	
-	// create acceptance object
-	VRadialAcceptance* facc = new VRadialAcceptance( fCuts, fRunPara, fMaxDistanceAllowed );
-	
-	// set facc to write extra histograms if necessary
-	if( histdir.size() > 0 )
-	{
-		if( stat( histdir.c_str(), &sb ) == 0 && S_ISDIR( sb.st_mode ) ) // then directory 'histdir' exists
-		{
-			//facc->SetExtraHistogramMode( 1 ) ;
-			facc->SetExtraHistogramDirectory( histdir ) ;
-		}
-		else
-		{
-			cout << "Error, directory specified by makeRadialAcceptance -w option '" << histdir << "' does not exist, exiting..." << endl;
-			return 0;
-		}
-	}
-	
-	// az dependent measurement
-	vector< VRadialAcceptance* > facc_az;
-	vector< string > fDirName;
-	vector< string > fDirTitle;
-	vector< TDirectory* > facc_az_dir;
+	/////////////////////////////////////////////////////////////////////////
+	// acceptance configurations
+	// (for each cut file: all events, az bins, ze bins, image selections)
 	vector< double > iAz_min;
 	vector< double > iAz_max;
-	
 	iAz_min.push_back( 337.5 );
 	iAz_max.push_back( 22.5 );
 	for( unsigned int i = 1; i < 8; i++ )
@@ -147,163 +483,181 @@ int main( int argc, char* argv[] )
 		iAz_min.push_back( -22.5 + 45. * ( double )i );
 		iAz_max.push_back( 22.5 + 45. * ( double )i );
 	}
+	vector< TDirectory* > facc_dir;
 	char htemp[200];
-	for( unsigned int i = 0; i < iAz_min.size(); i++ )
+	for( unsigned int c = 0; c < cutfilename.size(); c++ )
 	{
-		if( facc_dir )
+		TDirectory* iCutDir = ( TDirectory* )fo;
+		if( c > 0 )
 		{
-			facc_dir->cd();
+			sprintf( htemp, "cuts_%d", c );
+			string iTitle = "radial acceptance for cut file " + cutfilename[c];
+			iCutDir = fo->mkdir( htemp, iTitle.c_str() );
 		}
-		sprintf( htemp, "az_%d", i );
-		fDirName.push_back( htemp );
-		sprintf( htemp, "AZ dependend radial acceptance, %.2f < az < %.2f", iAz_min[i], iAz_max[i] );
-		fDirTitle.push_back( htemp );
-		facc_az_dir.push_back( fo->mkdir( fDirName.back().c_str(), fDirTitle.back().c_str() ) );
-		if( facc_az_dir.back() )
+		if( !iCutDir )
 		{
-			facc_az_dir.back()->cd();
-			facc_az.push_back( new VRadialAcceptance( fCuts, fRunPara ) );
-			facc_az.back()->setAzCut( iAz_min[i], iAz_max[i] );
-			cout << "initializing AZ dependend radial acceptance class for ";
-			cout << iAz_min[i] << " < az <= " <<   iAz_max[i] << endl;
+			cout << "makeRadialAcceptance: error creating output directory for cut file " << cutfilename[c] << endl;
+			exit( EXIT_FAILURE );
 		}
-	}
-	
-	// loop over all files and fill acceptances
-	for( unsigned int i = 0; i < fRunPara->fRunList.size(); i++ )
-	{
-		ostringstream ifile;
-		ifile <<  datadir << "/" << fRunPara->fRunList[i].fRunOff << ".mscw.root";
-		if( ! check_if_file_exists( ifile.str() ) )
+		sAcceptanceConfiguration iConfig;
+		iConfig.fCutSet = c;
+		iConfig.fDirName = "";
+		iConfig.fDirTitle = "";
+		iConfig.fMaxDistance = fMaxDistanceAllowed;
+		iConfig.fAzMin = -1.e9;
+		iConfig.fAzMax = 1.e9;
+		iConfig.fZeMin = -1.e9;
+		iConfig.fZeMax = 1.e9;
+		iConfig.fImgSel = 0;
+		fCutSetFirstConfig.push_back( fAccConfig.size() );
+		fAccConfig.push_back( iConfig );
+		facc_dir.push_back( iCutDir );
+		
+		// az dependent measurement
+		iConfig.fMaxDistance = -99.;
+		for( unsigned int i = 0; i < iAz_min.size(); i++ )
 		{
-			ifile.str( "" );
-			ifile <<  datadir << "/" << fRunPara->fRunList[i].fRunOff / 10000;
-			ifile << "/" << fRunPara->fRunList[i].fRunOff << ".mscw.root";
-			if( ! check_if_file_exists( ifile.str() ) )
-			{
-				cout << "Error reading " << ifile.str() << endl;
-				exit( EXIT_FAILURE );
-			}
+			sprintf( htemp, "az_%d", i );
+			iConfig.fDirName = htemp;
+			sprintf( htemp, "AZ dependend radial acceptance, %.2f < az < %.2f", iAz_min[i], iAz_max[i] );
+			iConfig.fDirTitle = htemp;
+			iConfig.fAzMin = iAz_min[i];
+			iConfig.fAzMax = iAz_max[i];
+			fAccConfig.push_back( iConfig );
+			facc_dir.push_back( iCutDir->mkdir( iConfig.fDirName.c_str(), iConfig.fDirTitle.c_str() ) );
 		}
-		cout << "now chaining " << ifile.str();
-		cout << " (wobble offset " << -1.*fRunPara->fRunList[i].fWobbleNorth;
-		cout << ", " << fRunPara->fRunList[i].fWobbleWest << ")" << endl;
-		// get data tree
-		TFile fTest( ifile.str().c_str() );
-		if( fTest.IsZombie() )
+		iConfig.fAzMin = -1.e9;
+		iConfig.fAzMax = 1.e9;
+		// ze dependent measurement
+		for( unsigned int i = 0; i + 1 < zebins.size(); i++ )
 		{
-			cout << "Error reading " << ifile.str() << endl;
-			exit( EXIT_FAILURE );
+			sprintf( htemp, "ze_%d", i );
+			iConfig.fDirName = htemp;
+			sprintf( htemp, "ZE dependend radial acceptance, %.2f < ze < %.2f", zebins[i], zebins[i + 1] );
+			iConfig.fDirTitle = htemp;
+			iConfig.fZeMin = zebins[i];
+			iConfig.fZeMax = zebins[i + 1];
+			fAccConfig.push_back( iConfig );
+			facc_dir.push_back( iCutDir->mkdir( iConfig.fDirName.c_str(), iConfig.fDirTitle.c_str() ) );
 		}
-		TTree* c = ( TTree* )fTest.Get( "data" );
-		CData* d = new CData( c, false, 5, true );
-		
-		// Check number of telescopes in run
-		VEvndispRunParameter* iParV2 = ( VEvndispRunParameter* )fTest.Get( "runparameterV2" );
-		if( !iParV2 )
+		iConfig.fZeMin = -1.e9;
+		iConfig.fZeMax = 1.e9;
+		// image selection dependent measurement
+		for( unsigned int i = 0; i < imgselbins.size(); i++ )
 		{
-			cout << "Error reading run parameters " << endl;
-			continue;
+			sprintf( htemp, "imgsel_%llu", ( unsigned long long )imgselbins[i] );
+			iConfig.fDirName = htemp;
+			sprintf( htemp, "ImgSel dependend radial acceptance, ImgSel = %llu", ( unsigned long long )imgselbins[i] );
+			iConfig.fDirTitle = htemp;
+			iConfig.fImgSel = imgselbins[i];
+			fAccConfig.push_back( iConfig );
+			facc_dir.push_back( iCutDir->mkdir( iConfig.fDirName.c_str(), iConfig.fDirTitle.c_str() ) );
 		}
-		cout << "Testing telescope multiplicity " << teltoanastring << endl;
-		if( teltoana.size() != iParV2->fTelToAnalyze.size()
-				|| !equal( teltoana.begin(), teltoana.end(), iParV2->fTelToAnalyze.begin() ) )
+	}
+	for( unsigned int k = 0; k < facc_dir.size(); k++ )
+	{
+		if( !facc_dir[k] )
 		{
-			cout << endl;
-			cout << "error: Requested telescopes " << teltoanastring;
-			cout << " do not equal telescopes in run " << ifile.str() << endl;
-			cout << "PAR ";
-			for( unsigned int i = 0; i < iParV2->fTelToAnalyze.size(); i++ )
-			{
-				cout << iParV2->fTelToAnalyze[i] << "  ";
-			}
-			cout << endl;
-			cout << "USER ";
-			for( unsigned int i = 0; i < teltoana.size(); i++ )
-			{
-				cout << teltoana[i] << "  ";
-			}
-			cout << endl;
-			cout << "\t" << teltoana.size() << "\t" << iParV2->fTelToAnalyze.size() << endl;
+			cout << "makeRadialAcceptance: error creating output directory " << fAccConfig[k].fDirName << endl;
 			exit( EXIT_FAILURE );
 		}
-		
-		// set gamma/hadron cuts
-		fCuts->setInstrumentEpoch( iParV2->getInstrumentATMString() );
-		if( !fCuts->readCuts( cutfilename, 2 ) )
+	}
+	cout << "filling " << fAccConfig.size() << " acceptance configurations for ";
+	cout << cutfilename.size() << " cut file(s)" << endl;
+	
+	/////////////////////////////////////////////////////////////////////////
+	// fill jobs (runs are distributed over the threads)
+	vector< unsigned int > iRunIndex;
+	for( unsigned int i = 0; i < fRunPara->fRunList.size(); i++ )
+	{
+		if( fRunHasEvents[i] )
 		{
-			cout << "run " << fRunPara->fRunList[i].fRunOff << ": ";
-			cout << "error reading cut file: " << cutfilename << endl;
-			continue;
+			iRunIndex.push_back( i );
 		}
-		fCuts->initializeCuts( fRunPara->fRunList[i].fRunOff, datadir );
-		// pointer to data tree
-		fCuts->setDataTree( d );
-		
-		if( !d )
+	}
+	unsigned int iNJobs = nthreads;
+	if( iNJobs > iRunIndex.size() )
+	{
+		iNJobs = iRunIndex.size();
+	}
+	if( iNJobs < 1 )
+	{
+		iNJobs = 1;
+	}
+	if( iNJobs > 1 )
+	{
+		cout << "filling acceptances using " << iNJobs << " threads" << endl;
+	}
+	vector< sAcceptanceFillJob > iJobs( iNJobs );
+	// histograms of first job are written to the output file
+	initializeFillJob( &iJobs[0], &facc_dir );
+	// all other jobs: histograms are merged into first job
+	bool iAddDirectory = TH1::AddDirectoryStatus();
+	TH1::AddDirectory( kFALSE );
+	for( unsigned int j = 1; j < iJobs.size(); j++ )
+	{
+		initializeFillJob( &iJobs[j], 0 );
+	}
+	TH1::AddDirectory( iAddDirectory );
+	for( unsigned int i = 0; i < iRunIndex.size(); i++ )
+	{
+		iJobs[i % iNJobs].fRunIndex.push_back( iRunIndex[i] );
+	}
+	for( unsigned int j = 0; j < iJobs.size(); j++ )
+	{
+		iJobs[j].bPrint = ( iNJobs == 1 );
+	}
+	
+	// set facc to write extra histograms if necessary
+	VRadialAcceptance* facc = iJobs[0].fAcc[0];
+	if( histdir.size() > 0 )
+	{
+		if( stat( histdir.c_str(), &sb ) == 0 && S_ISDIR( sb.st_mode ) ) // then directory 'histdir' exists
 		{
-			cout << "makeRadialAcceptance: no data tree defined: run " << fRunPara->fRunList[i].fRunOff << endl;
-			return 0;
+			//facc->SetExtraHistogramMode( 1 ) ;
+			facc->SetExtraHistogramDirectory( histdir ) ;
 		}
-		// data trees and cuts
-		int nentries = d->fChain->GetEntries();
-		if( entries > 0 )
+		else
 		{
-			nentries = entries;
+			cout << "Error, directory specified by makeRadialAcceptance -w option '" << histdir << "' does not exist, exiting..." << endl;
+			return 0;
 		}
-		
-		cout << "filling acceptance curves with " << nentries << " events (before cuts)" << endl;
-		
-		if( fCuts )
+	}
+	
+	// loop over all files and fill acceptances
+	if( !runFillJobs( iJobs ) )
+	{
+		cout << "makeRadialAcceptance: error filling acceptances" << endl;
+		exit( EXIT_FAILURE );
+	}
+	
+	// merge acceptances
+	for( unsigned int j = 1; j < iJobs.size(); j++ )
+	{
+		for( unsigned int k = 0; k < iJobs[0].fAcc.size(); k++ )
 		{
-			fCuts->printCutSummary();
+			iJobs[0].fAcc[k]->add( iJobs[j].fAcc[k] );
 		}
-		
-		int neventStats = 0;
-		int i_entries_after_cuts = 0;
-		
-		// loop over all entries in data trees and fill acceptance curves
-		for( int n = 0; n < nentries; n++ )
+		for( unsigned int c = 0; c < iJobs[0].fNEventsAfterCuts.size(); c++ )
 		{
-			d->GetEntry( n );
-			
-			if( n == 0 and d->isMC() )
-			{
-				cout << "\t (analysing MC data)" << endl;
-			}
-			
-			neventStats = facc->fillAcceptanceFromData( d, n );
-			
-			for( unsigned int a = 0; a < facc_az.size(); a++ )
-			{
-				if( facc_az[a] )
-				{
-					facc_az[a]->fillAcceptanceFromData( d, n );
-				}
-			}
-			
-			if( neventStats < 0 )
-			{
-				break;
-			}
-			i_entries_after_cuts += neventStats;
+			iJobs[0].fNEventsAfterCuts[c] += iJobs[j].fNEventsAfterCuts[c];
 		}
-		cout << "total number of entries after cuts: " << i_entries_after_cuts << endl;
-		cout << endl << endl;
-		
-		fTest.Close();
 	}
+	for( unsigned int c = 0; c < cutfilename.size(); c++ )
+	{
+		cout << "total number of entries after cuts (" << cutfilename[c] << "): ";
+		cout << iJobs[0].fNEventsAfterCuts[c] << endl;
+	}
+	cout << endl << endl;
 	
 	// write acceptance files to disk
-	
-	facc->calculate2DBinNormalizationConstant() ;
-	facc->terminate( facc_dir );
-	for( unsigned int a = 0; a < facc_az_dir.size(); a++ )
+	for( unsigned int k = 0; k < iJobs[0].fAcc.size(); k++ )
 	{
-		if( facc_az[a] )
+		if( fAccConfig[k].fDirName.size() == 0 )
 		{
-			facc_az[a]->terminate( facc_az_dir[a] );
+			iJobs[0].fAcc[k]->calculate2DBinNormalizationConstant() ;
 		}
+		iJobs[0].fAcc[k]->terminate( facc_dir[k] );
 	}
 	
 	fo->Close();
@@ -331,10 +685,13 @@ int parseOptions( int argc, char* argv[] )
 			{"datadir", required_argument, 0, 'd'},
 			{"writehists", optional_argument, 0, 'w'},
 			{"teltoana", required_argument, 0, 't'},
+			{"threads", required_argument, 0, 'j'},
+			{"zebins", required_argument, 0, 'z'},
+			{"imgsel", required_argument, 0, 'i'},
 			{0, 0, 0, 0}
 		};
 		int option_index = 0;
-		int c = getopt_long( argc, argv, "ht:l:e:m:o:d:n:c:w:t:", long_options, &option_index );
+		int c = getopt_long( argc, argv, "ht:l:e:m:o:d:n:c:w:t:j:z:i:", long_options, &option_index );
 		if( optopt != 0 )
 		{
 			cout << "error: unknown option" << endl;
@@ -367,13 +724,16 @@ int parseOptions( int argc, char* argv[] )
 				cout << endl;
 				cout << "Options are:" << endl;
 				cout << "-l --runlist [simple run list file name]" << endl;
-				cout << "-c --cutfile [cut file name]" << endl;
+				cout << "-c --cutfile [cut file name] (repeat for several cut files)" << endl;
 				cout << "-d --datadir [directory for input mscw root files]" << endl;
 				cout << "-o --outfile [output ROOT file name]" << endl;
 				cout << "-e --entries [number of entries]" << endl;
 				cout << "-m --maxdist [max distance from camera centre (deg)]" << endl;
 				cout << "-w --writehists [directory]" << endl ;
 				cout << "-t --teltoana <telescopes>" << endl;
+				cout << "-z --zebins [comma separated list of zenith angle bin edges (deg)]" << endl;
+				cout << "-i --imgsel [comma separated list of image selections (bit coded)]" << endl;
+				cout << "-j --threads [number of threads]" << endl;
 				cout << endl;
 				exit( EXIT_SUCCESS );
 				break;
@@ -390,8 +750,8 @@ int parseOptions( int argc, char* argv[] )
 				listfilename = optarg;
 				break;
 			case 'c':
-				cutfilename = optarg;
-				cout << "Cut File Name is " << cutfilename << endl;
+				cutfilename.push_back( optarg );
+				cout << "Cut File Name is " << cutfilename.back() << endl;
 				break;
 			case 'm':
 				fMaxDistanceAllowed = atof( optarg );
@@ -408,6 +768,18 @@ int parseOptions( int argc, char* argv[] )
 				teltoanastring = optarg;
 				cout << "Telescopes to analyse: " << teltoanastring << endl;
 				break;
+			case 'j':
+				nthreads = ( unsigned int )atoi( optarg );
+				cout << "Number of threads: " << nthreads << endl;
+				break;
+			case 'z':
+				zebins = parseList< double >( optarg );
+				cout << "Zenith angle bins: " << optarg << endl;
+				break;
+			case 'i':
+				imgselbins = parseList< ULong64_t >( optarg );
+				cout << "Image selections: " << optarg << endl;
+				break;
 			case '?':
 				break;
 			default:
@@ -1,6 +1,10 @@
 /*! \file splitVBF.cpp
     \brief split one vbf file into several ones; use splitSimVBF for VERITAS simulations files
 
+    with a packet index of the vbf file stored in the index directory (see VBFPacketIndex),
+    each output file contains the same number of events; otherwise the
+    file is split by number of packets (last file gets the remaining packets)
+
 */
 
 
@@ -16,6 +20,8 @@
 // include the configuration mask utilities, which give us parseConfigMask()
 #include "VConfigMaskUtil.h"
 
+#include "VBFPacketIndex.h"
+
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -28,14 +34,14 @@ using namespace VConfigMaskUtil;
 
 void usage( char* prog )
 {
-	cout << "Usage: " << prog << " [input.vbf] [numberOfFiles] [newRunNumber]" << endl;
+	cout << "Usage: " << prog << " [input.vbf] [numberOfFiles] [newRunNumber] [packet index directory (optional)]" << endl;
 	exit( -1 );
 }
 
 int main( int argc, char** argv )
 {
 
-	if( argc != 4 )
+	if( argc != 4 && argc != 5 )
 	{
 		usage( argv[0] );
 	}
@@ -56,8 +62,56 @@ int main( int argc, char** argv )
 	const int numPackets = reader.numPackets();
 	cout << "Packets: " << numPackets << endl;
 	
-	const int numPacketsPerFile = int( numPackets / numberOfFiles );
-	cout << "\nPackets/file: " << numPacketsPerFile << endl;
+	if( numberOfFiles < 1 )
+	{
+		usage( argv[0] );
+	}
+	
+	// packet index (used only if stored in the index directory;
+	// building it here would require an additional pass over the file)
+	VBFPacketIndex packetIndex;
+	bool bIndex = false;
+	if( argc == 5 )
+	{
+		packetIndex.setIndexDirectory( argv[4] );
+		bIndex = ( packetIndex.openIndexFile( argv[1] ) && ( int )packetIndex.getNPackets() == numPackets );
+	}
+	
+	// first packet of each file (last file gets remaining events or packets)
+	vector< int > startPacket( numberOfFiles + 1, numPackets );
+	startPacket[0] = 0;
+	if( bIndex )
+	{
+		const unsigned int numEvents = packetIndex.getNEvents();
+		const unsigned int numEventsPerFile = numEvents / numberOfFiles;
+		cout << "Events: " << numEvents << endl;
+		cout << "\nEvents/file: " << numEventsPerFile << endl;
+		
+		unsigned int eventCount = 0;
+		int ifileStart = 1;
+		for( int ipacket = 0; ipacket < numPackets && ifileStart < numberOfFiles; ipacket++ )
+		{
+			const sVBFPacketIndexEntry& entry = packetIndex.getEntry( ipacket );
+			if( entry.fFlags & ( VBFPacketIndex::eArrayEvent | VBFPacketIndex::eSimulationData ) )
+			{
+				if( eventCount == ifileStart * numEventsPerFile )
+				{
+					startPacket[ifileStart] = ipacket;
+					ifileStart++;
+				}
+				eventCount++;
+			}
+		}
+	}
+	else
+	{
+		const int numPacketsPerFile = int( numPackets / numberOfFiles );
+		cout << "\nPackets/file: " << numPacketsPerFile << endl;
+		for( int ifile = 1; ifile < numberOfFiles; ifile++ )
+		{
+			startPacket[ifile] = ifile * numPacketsPerFile;
+		}
+	}
 	
 	// Extraction the .vbf from the input filename
 	string inputFileName( argv[1] );
@@ -76,10 +130,14 @@ int main( int argc, char** argv )
 	
 	try
 	{
-		// Searching for sim header and storing it
+		// Searching for sim header (from packet index, if available) and storing it
 		int ipacketHeader = -1;
 		for( int ipacket = 0; ipacket < numPackets; ipacket++ )
 		{
+			if( bIndex && !packetIndex.hasSimulationHeader( ipacket ) )
+			{
+				continue;
+			}
 			packetHeader = reader.readPacket( ipacket );
 			if( packetHeader && packetHeader->hasSimulationHeader() )
 			{
@@ -89,6 +147,8 @@ int main( int argc, char** argv )
 				ipacketHeader = ipacket;
 				break;
 			} // if packet
+			delete packetHeader;
+			packetHeader = NULL;
 		} // ipacket
 		
 		for( int ifile = 0; ifile < numberOfFiles; ifile++ )
@@ -106,8 +166,8 @@ int main( int argc, char** argv )
 			int globalEventCount = 1;
 			bool writePacket = true;
 			
-			const int startPacket = ifile * numPacketsPerFile;
-			const int endPacket = ( ifile + 1 ) * numPacketsPerFile;
+			const int firstPacket = startPacket[ifile];
+			const int endPacket = startPacket[ifile + 1];
 			
 			if( header )
 			{
@@ -115,7 +175,7 @@ int main( int argc, char** argv )
 				writer.writePacket( packetHeader );
 			}
 			
-			for( int ipacket = startPacket; ipacket < endPacket; ipacket++ )
+			for( int ipacket = firstPacket; ipacket < endPacket; ipacket++ )
 			{
 			
 				if( ipacket == ipacketHeader )
@@ -20,6 +20,7 @@
 #include "TMVA/Reader.h"
 #include "TMVA/Tools.h"
 
+#include <functional>
 #include <iostream>
 #include <map>
 #include <sstream>
@@ -33,6 +34,7 @@
 #include "VDetectorTree.h"
 #include "VGlobalRunParameter.h"
 #include "VSimpleStereoReconstructor.h"
+#include "VTMVATrainingSample.h"
 #include "VUtilities.h"
 
 using namespace std;
@@ -57,6 +59,16 @@ pair<float, float> getArrayPointing( Cshowerpars* i_showerpars )
 map< ULong64_t, TTree* > fMapOfTrainingTree;
 map< ULong64_t, unsigned int > fMapOfNTelescopeType;
 /////////////////////////////////////////////////////
+// telescope configuration (read from first input file;
+// read-only while filling the training samples in parallel)
+vector< ULong64_t > fTelType;
+vector< float > fTelX;
+vector< float > fTelY;
+vector< float > fTelZ;
+vector< float > fFOV_tel;
+// training samples (one per telescope type)
+map< ULong64_t, VTMVATrainingSample* > fMapOfTrainingSample;
+/////////////////////////////////////////////////////
 
 /*
 
@@ -374,92 +386,20 @@ bool readTrainingFile( string iTargetML, ULong64_t iTelType, string iDataDirecto
 
 /******************************************************************************************
 
-   write the training file used for the TMVA training
-   (simply a tree with all the necessary variables; one tree per telescope type)
+   fill the training samples with the events of one input file
 
-   output as a root file (might be temporary, steer with scripts)
+   (called in parallel for different input files; all trees, chains
+    and reconstruction helpers used here are local to this call)
 
 */
-bool writeTrainingFile( const string iInputFile, ULong64_t iTelType,
-						unsigned int iRecID, string iArrayList,
-						bool redo_stereo_reconstruction )
+bool fillTrainingSample( vector< string > iInputFileList, ULong64_t iTelType,
+						 unsigned int iRecID, bool redo_stereo_reconstruction,
+						 bool iSingleTelescopeAnalysis, unsigned int iFile )
 {
-	////////////////////////////
-	// read list of input files
-	vector< string > iInputFileList = fillInputFile_fromList( iInputFile );
-	if( iInputFileList.size() == 0 )
+	if( iFile >= iInputFileList.size() )
 	{
-		cout << "writeTrainingFile error: input file list is empty" << endl;
 		return false;
 	}
-	// (assume in the following that iInputFileList has a reasonable size)
-	
-	/////////////////////////////
-	// telescope configuration
-	TChain i_telChain( "telconfig" );
-	i_telChain.Add( iInputFileList[0].c_str(), 0 );
-	cout << "reading telescope list from ";
-	cout << iInputFileList[0] << endl;
-	
-	Ctelconfig i_tel( &i_telChain );
-	i_tel.GetEntry( 0 );
-	unsigned int i_ntel = i_tel.NTel;
-	
-	vector< unsigned int > iHyperArrayID;
-	vector< float > iFOV_tel;
-	
-	// get list of telescopes - hyperarray values
-	for( int t = 0; t < i_tel.fChain->GetEntries(); t++ )
-	{
-		i_tel.GetEntry( t );
-		
-		iHyperArrayID.push_back( i_tel.TelID_hyperArray );
-		iFOV_tel.push_back( i_tel.FOV );
-		cout << "\t FOV for telescope " << iHyperArrayID.back() << ": " << iFOV_tel.back() << endl;
-	}
-	
-	// use all telescope for reconstruction
-	vector< bool > fUseTelescope( i_ntel, true );
-	
-	// vector with telescope position
-	// (includes all telescopes, even those
-	// of other types)
-	// (unfortunately inconsistent in data
-	//  types required)
-	vector< float > fTelX;
-	vector< float > fTelY;
-	vector< float > fTelZ;
-	vector< double > fEM_TelX;
-	vector< double > fEM_TelY;
-	vector< double > fEM_TelZ;
-	vector< ULong64_t > fTelType;
-	unsigned int f_ntelType = 0;
-	for( unsigned int i = 0; i < i_ntel; i++ )
-	{
-		i_tel.GetEntry( i );
-		
-		fTelX.push_back( i_tel.TelX );
-		fTelY.push_back( i_tel.TelY );
-		fTelZ.push_back( i_tel.TelZ );
-		fEM_TelX.push_back( i_tel.TelX );
-		fEM_TelY.push_back( i_tel.TelY );
-		fEM_TelZ.push_back( i_tel.TelZ );
-		fTelType.push_back( i_tel.TelType );
-		
-		if( i < fUseTelescope.size() && !fUseTelescope[i] )
-		{
-			continue;
-		}
-		if( i_tel.TelType == iTelType
-				|| iTelType == 0 )
-		{
-			f_ntelType++;
-		}
-	}
-	
-	///////////////////////////////////////////////////
-	// definition of training trees (one per telescope type)
-	
 	int runNumber = -1;
 	int eventNumber = -1;
 	unsigned int tel = 0;
@@ -508,105 +448,16 @@ bool writeTrainingFile( const string iInputFile, ULong64_t iTelType,
 	float EmissionHeight = -1.;
 	int   Fitstat = -1;
 	
-	fMapOfTrainingTree.clear();
-	cout << "total number of telescopes: " << i_ntel;
-	cout << " (selected " << f_ntelType << ")" << endl;
-	for( unsigned int i = 0; i < i_ntel; i++ )
-	{
-		i_tel.GetEntry( i );
-		
-		// select telescope type
-		if( iTelType != 0 && i_tel.TelType != iTelType )
-		{
-			continue;
-		}
-		// check if telescope is in telescope list
-		if( i < fUseTelescope.size() && !fUseTelescope[i] )
-		{
-			continue;
-		}
-		
-		if( fMapOfTrainingTree.find( i_tel.TelType ) == fMapOfTrainingTree.end() )
-		{
-			ostringstream iTreeName;
-			iTreeName << "dispTree_" << i_tel.TelType;
-			ostringstream iTreeTitle;
-			iTreeTitle << "training tree for modified disp method (telescope type " << i_tel.TelType << ")";
-			fMapOfTrainingTree[i_tel.TelType] = new TTree( iTreeName.str().c_str(), iTreeTitle.str().c_str() );
-			
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "runNumber", &runNumber, "runNumber/I" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "eventNumber", &eventNumber, "eventNumber/I" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "tel",         &tel, "tel/i" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "cen_x", &cen_x, "cen_x/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "cen_y", &cen_y, "cen_y/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "sinphi", &sinphi, "sinphi/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "cosphi", &cosphi, "cosphi/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "size", &size, "size/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "ntubes", &ntubes, "ntubes/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "loss", &loss, "loss/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "asym", &asym, "asym/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "width", &width, "width/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "length", &length, "length/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "wol", &wol, "wol/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "dist", &dist, "dist/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "fui", &fui, "fui/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "tgrad_x", &tgrad_x, "tgrad_x/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "meanPedvar_Image", &meanPedvar_Image, "meanPedvar_Image/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "Fitstat", &Fitstat, "Fitstat/I" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "MCe0", &MCe0, "MCe0/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "MCxoff", &MCxoff, "MCxoff/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "MCyoff", &MCyoff, "MCyoff/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "MCxcore", &MCxcore, "MCxcore/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "MCycore", &MCycore, "MCycore/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "MCrcore", &MCrcore, "MCrcore/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "Xcore", &Xcore, "Xcore/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "Ycore", &Ycore, "Ycore/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "Rcore", &Rcore, "Rcore/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "Xoff", &Xoff, "Xoff/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "Yoff", &Yoff, "Yoff/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "LTrig", &LTrig, "LTrig/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "NImages", &NImages, "NImages/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "EHeight", &EmissionHeight, "EHeight/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "TelElevation", &TelElevation, "TelElevation/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "TelAzimuth", &TelAzimuth, "TelAzimuth/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "MCaz", &MCaz, "MCaz/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "MCze", &MCze, "MCze/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "Ze", &ze, "Ze/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "Az", &az, "Az/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "disp", &disp, "disp/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "dispError", &dispError, "dispError/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "dispSign", &dispSign, "dispSign/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "cross", &cross, "cross/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "dispPhi", &dispPhi, "dispPhi/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "dispCrossError", &dispCrossError, "dispCrossError/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "dispEnergy", &dispEnergy, "dispEnergy/F" );
-			fMapOfTrainingTree[i_tel.TelType]->Branch( "dispCore", &dispCore, "dispCore/F" );
-		}
-	}
-	
-	////////////////////////////////////////////
-	// filling of training trees;
-	cout << "filling training trees for " << fMapOfTrainingTree.size() << " telescope type(s)" << endl;
-	cout << "\t found " << f_ntelType << " telescopes of telescope type " << iTelType << endl;
-	bool iSingleTelescopeAnalysis = false;
-	if( f_ntelType == 1 )
-	{
-		iSingleTelescopeAnalysis = true;
-		cout << "\t single telescope analysis" << endl;
-	}
-	fMapOfNTelescopeType[iTelType] = f_ntelType;
-	
 	// get showerpars tree
 	TChain i_showerparsTree( "showerpars" );
-	for( unsigned int f = 0; f < iInputFileList.size(); f++ )
-	{
-		i_showerparsTree.Add( iInputFileList[f].c_str(), 0 );
-	}
+	i_showerparsTree.Add( iInputFileList[iFile].c_str(), 0 );
 	Cshowerpars i_showerpars( &i_showerparsTree, true, true );
 	
 	// get all tpars tree
+	// (and training sample for each telescope)
 	vector< TChain* > i_tparsTree;
 	vector< Ctpars* > i_tpars;
+	vector< vector< double >* > i_data( fTelType.size(), 0 );
 	for( unsigned int i = 0; i < fTelType.size(); i++ )
 	{
 		if( iTelType == 0 || iTelType == fTelType[i] )
@@ -614,23 +465,26 @@ bool writeTrainingFile( const string iInputFile, ULong64_t iTelType,
 			ostringstream iTreeName;
 			iTreeName << "Tel_" << i + 1 << "/tpars";
 			i_tparsTree.push_back( new TChain( iTreeName.str().c_str() ) );
-			for( unsigned int f = 0; f < iInputFileList.size(); f++ )
+			i_tparsTree.back()->Add( iInputFileList[iFile].c_str(), 0 );
+			i_tpars.push_back( new Ctpars( i_tparsTree.back(), true, true ) );
+			// (map is not modified while filling)
+			map< ULong64_t, VTMVATrainingSample* >::iterator iSample_iter = fMapOfTrainingSample.find( fTelType[i] );
+			if( iSample_iter != fMapOfTrainingSample.end() )
 			{
-				i_tparsTree.back()->Add( iInputFileList[f].c_str(), 0 );
+				i_data[i] = iSample_iter->second->getFileData( iFile );
 			}
-			i_tpars.push_back( new Ctpars( i_tparsTree.back(), true, true ) );
-			cout << "\t found tree " << iTreeName.str();
-			cout << " (teltype " << fTelType[i] << ")";
-			cout << ", entries: ";
-			cout << i_tpars.back()->fChain->GetEntries() << endl;
 		}
 		else
 		{
 			i_tpars.push_back( 0 );
-			cout << "\t ignore tree for telescope type " << fTelType[i] << endl;
 		}
 	}
 	
+	// telescope positions for stereo reconstruction
+	vector< double > fEM_TelX( fTelX.begin(), fTelX.end() );
+	vector< double > fEM_TelY( fTelY.begin(), fTelY.end() );
+	vector< double > fEM_TelZ( fTelZ.begin(), fTelZ.end() );
+	
 	// temporary variables for emission height calculation
 	VEmissionHeightCalculator* fEmissionHeightCalculator = new VEmissionHeightCalculator();
 	fEmissionHeightCalculator->setTelescopePositions( fTelX, fTelY, fTelZ );
@@ -651,8 +505,6 @@ bool writeTrainingFile( const string iInputFile, ULong64_t iTelType,
 	/////////////////////////////////////////////////
 	// loop over all events in trees
 	int nentries = i_showerpars.fChain->GetEntries();
-	cout << "Loop over " << nentries << " entries in source files" << endl;
-	
 	for( int n = 0; n < nentries; n++ )
 	{
 		// read events from event trees
@@ -663,6 +515,18 @@ bool writeTrainingFile( const string iInputFile, ULong64_t iTelType,
 		{
 			cout << "Error: invalid reconstruction ID.";
 			cout << " Maximum allowed value is " << i_showerpars.NMethods << endl;
+			for( unsigned int i = 0; i < i_tpars.size(); i++ )
+			{
+				if( i_tpars[i] )
+				{
+					delete i_tpars[i];
+				}
+			}
+			for( unsigned int i = 0; i < i_tparsTree.size(); i++ )
+			{
+				delete i_tparsTree[i];
+			}
+			delete fEmissionHeightCalculator;
 			return false;
 		}
 		
@@ -781,9 +645,9 @@ bool writeTrainingFile( const string iInputFile, ULong64_t iTelType,
 			}
 			// check if event is not completely out of the FOV
 			// (use 20% x size of the camera)
-			if( i < iFOV_tel.size()
+			if( i < fFOV_tel.size()
 					&& sqrt( i_showerpars.MCxoff * i_showerpars.MCxoff
-							 + i_showerpars.MCyoff * i_showerpars.MCyoff ) > iFOV_tel[i] * 0.5 * 1.2 )
+							 + i_showerpars.MCyoff * i_showerpars.MCyoff ) > fFOV_tel[i] * 0.5 * 1.2 )
 			{
 				continue;
 			}
@@ -895,9 +759,55 @@ bool writeTrainingFile( const string iInputFile, ULong64_t iTelType,
 			dispEnergy = log10( i_showerpars.MCe0 ) / log10( i_tpars[i]->size );
 			dispCore   = Rcore;
 			
-			if( fMapOfTrainingTree.find( fTelType[i] ) != fMapOfTrainingTree.end() )
+			if( i_data[i] )
 			{
-				fMapOfTrainingTree[fTelType[i]]->Fill();
+				i_data[i]->push_back( runNumber );
+				i_data[i]->push_back( eventNumber );
+				i_data[i]->push_back( tel );
+				i_data[i]->push_back( cen_x );
+				i_data[i]->push_back( cen_y );
+				i_data[i]->push_back( sinphi );
+				i_data[i]->push_back( cosphi );
+				i_data[i]->push_back( size );
+				i_data[i]->push_back( ntubes );
+				i_data[i]->push_back( loss );
+				i_data[i]->push_back( asym );
+				i_data[i]->push_back( width );
+				i_data[i]->push_back( length );
+				i_data[i]->push_back( wol );
+				i_data[i]->push_back( dist );
+				i_data[i]->push_back( fui );
+				i_data[i]->push_back( tgrad_x );
+				i_data[i]->push_back( meanPedvar_Image );
+				i_data[i]->push_back( Fitstat );
+				i_data[i]->push_back( MCe0 );
+				i_data[i]->push_back( MCxoff );
+				i_data[i]->push_back( MCyoff );
+				i_data[i]->push_back( MCxcore );
+				i_data[i]->push_back( MCycore );
+				i_data[i]->push_back( MCrcore );
+				i_data[i]->push_back( Xcore );
+				i_data[i]->push_back( Ycore );
+				i_data[i]->push_back( Rcore );
+				i_data[i]->push_back( Xoff );
+				i_data[i]->push_back( Yoff );
+				i_data[i]->push_back( LTrig );
+				i_data[i]->push_back( NImages );
+				i_data[i]->push_back( EmissionHeight );
+				i_data[i]->push_back( TelElevation );
+				i_data[i]->push_back( TelAzimuth );
+				i_data[i]->push_back( MCaz );
+				i_data[i]->push_back( MCze );
+				i_data[i]->push_back( ze );
+				i_data[i]->push_back( az );
+				i_data[i]->push_back( disp );
+				i_data[i]->push_back( dispError );
+				i_data[i]->push_back( dispSign );
+				i_data[i]->push_back( cross );
+				i_data[i]->push_back( dispPhi );
+				i_data[i]->push_back( dispCrossError );
+				i_data[i]->push_back( dispEnergy );
+				i_data[i]->push_back( dispCore );
 			}
 		}
 	}
@@ -909,6 +819,277 @@ bool writeTrainingFile( const string iInputFile, ULong64_t iTelType,
 			delete i_tpars[i];
 		}
 	}
+	for( unsigned int i = 0; i < i_tparsTree.size(); i++ )
+	{
+		delete i_tparsTree[i];
+	}
+	delete fEmissionHeightCalculator;
+	
+	return true;
+}
+
+/******************************************************************************************
+
+   new (empty) training sample for the given telescope type
+
+   (variables are filled in this order in fillTrainingSample())
+
+*/
+VTMVATrainingSample* newTrainingSample( ULong64_t iTelType )
+{
+	ostringstream iTreeName;
+	iTreeName << "dispTree_" << iTelType;
+	ostringstream iTreeTitle;
+	iTreeTitle << "training tree for modified disp method (telescope type " << iTelType << ")";
+	VTMVATrainingSample* iSample = new VTMVATrainingSample( iTreeName.str(), iTreeTitle.str() );
+	iSample->addVariable( "runNumber", 'I' );
+	iSample->addVariable( "eventNumber", 'I' );
+	iSample->addVariable( "tel", 'i' );
+	iSample->addVariable( "cen_x", 'F' );
+	iSample->addVariable( "cen_y", 'F' );
+	iSample->addVariable( "sinphi", 'F' );
+	iSample->addVariable( "cosphi", 'F' );
+	iSample->addVariable( "size", 'F' );
+	iSample->addVariable( "ntubes", 'F' );
+	iSample->addVariable( "loss", 'F' );
+	iSample->addVariable( "asym", 'F' );
+	iSample->addVariable( "width", 'F' );
+	iSample->addVariable( "length", 'F' );
+	iSample->addVariable( "wol", 'F' );
+	iSample->addVariable( "dist", 'F' );
+	iSample->addVariable( "fui", 'F' );
+	iSample->addVariable( "tgrad_x", 'F' );
+	iSample->addVariable( "meanPedvar_Image", 'F' );
+	iSample->addVariable( "Fitstat", 'I' );
+	iSample->addVariable( "MCe0", 'F' );
+	iSample->addVariable( "MCxoff", 'F' );
+	iSample->addVariable( "MCyoff", 'F' );
+	iSample->addVariable( "MCxcore", 'F' );
+	iSample->addVariable( "MCycore", 'F' );
+	iSample->addVariable( "MCrcore", 'F' );
+	iSample->addVariable( "Xcore", 'F' );
+	iSample->addVariable( "Ycore", 'F' );
+	iSample->addVariable( "Rcore", 'F' );
+	iSample->addVariable( "Xoff", 'F' );
+	iSample->addVariable( "Yoff", 'F' );
+	iSample->addVariable( "LTrig", 'F' );
+	iSample->addVariable( "NImages", 'F' );
+	iSample->addVariable( "EHeight", 'F' );
+	iSample->addVariable( "TelElevation", 'F' );
+	iSample->addVariable( "TelAzimuth", 'F' );
+	iSample->addVariable( "MCaz", 'F' );
+	iSample->addVariable( "MCze", 'F' );
+	iSample->addVariable( "Ze", 'F' );
+	iSample->addVariable( "Az", 'F' );
+	iSample->addVariable( "disp", 'F' );
+	iSample->addVariable( "dispError", 'F' );
+	iSample->addVariable( "dispSign", 'F' );
+	iSample->addVariable( "cross", 'F' );
+	iSample->addVariable( "dispPhi", 'F' );
+	iSample->addVariable( "dispCrossError", 'F' );
+	iSample->addVariable( "dispEnergy", 'F' );
+	iSample->addVariable( "dispCore", 'F' );
+	
+	return iSample;
+}
+
+/*
+ * name of cache file with training sample for the given telescope type
+ */
+string getCacheFileName( string iCacheDirectory, ULong64_t iTelType, string iCacheKey )
+{
+	ostringstream iCacheFileName;
+	iCacheFileName << iCacheDirectory << "/dispTree_" << iTelType << "_" << iCacheKey << ".root";
+	return iCacheFileName.str();
+}
+
+/******************************************************************************************
+
+   write the training file used for the TMVA training
+   (simply a tree with all the necessary variables; one tree per telescope type)
+
+   input files are processed in parallel (iNThreads); trees are filled
+   in the order of the input files and do not depend on the number of threads
+
+   training samples are cached in iCacheDirectory (if given); the cache
+   key includes the input files, telescope type and reconstruction ID
+
+   output as a root file (might be temporary, steer with scripts)
+
+*/
+bool writeTrainingFile( const string iInputFile, ULong64_t iTelType,
+						unsigned int iRecID, string iArrayList,
+						bool redo_stereo_reconstruction,
+						unsigned int iNThreads, string iCacheDirectory )
+{
+	////////////////////////////
+	// read list of input files
+	vector< string > iInputFileList = fillInputFile_fromList( iInputFile );
+	if( iInputFileList.size() == 0 )
+	{
+		cout << "writeTrainingFile error: input file list is empty" << endl;
+		return false;
+	}
+	// (assume in the following that iInputFileList has a reasonable size)
+	
+	/////////////////////////////
+	// telescope configuration
+	TChain i_telChain( "telconfig" );
+	i_telChain.Add( iInputFileList[0].c_str(), 0 );
+	cout << "reading telescope list from ";
+	cout << iInputFileList[0] << endl;
+	
+	Ctelconfig i_tel( &i_telChain );
+	i_tel.GetEntry( 0 );
+	unsigned int i_ntel = i_tel.NTel;
+	
+	vector< unsigned int > iHyperArrayID;
+	fFOV_tel.clear();
+	
+	// get list of telescopes - hyperarray values
+	for( int t = 0; t < i_tel.fChain->GetEntries(); t++ )
+	{
+		i_tel.GetEntry( t );
+		
+		iHyperArrayID.push_back( i_tel.TelID_hyperArray );
+		fFOV_tel.push_back( i_tel.FOV );
+		cout << "\t FOV for telescope " << iHyperArrayID.back() << ": " << fFOV_tel.back() << endl;
+	}
+	
+	// use all telescope for reconstruction
+	vector< bool > fUseTelescope( i_ntel, true );
+	
+	// vector with telescope position
+	// (includes all telescopes, even those
+	// of other types)
+	// (unfortunately inconsistent in data
+	//  types required)
+	fTelX.clear();
+	fTelY.clear();
+	fTelZ.clear();
+	fTelType.clear();
+	unsigned int f_ntelType = 0;
+	for( unsigned int i = 0; i < i_ntel; i++ )
+	{
+		i_tel.GetEntry( i );
+		
+		fTelX.push_back( i_tel.TelX );
+		fTelY.push_back( i_tel.TelY );
+		fTelZ.push_back( i_tel.TelZ );
+		fTelType.push_back( i_tel.TelType );
+		
+		if( i < fUseTelescope.size() && !fUseTelescope[i] )
+		{
+			continue;
+		}
+		if( i_tel.TelType == iTelType
+				|| iTelType == 0 )
+		{
+			f_ntelType++;
+		}
+	}
+	
+	///////////////////////////////////////////////////
+	// definition of training samples (one per telescope type)
+	
+	fMapOfTrainingTree.clear();
+	fMapOfTrainingSample.clear();
+	cout << "total number of telescopes: " << i_ntel;
+	cout << " (selected " << f_ntelType << ")" << endl;
+	for( unsigned int i = 0; i < i_ntel; i++ )
+	{
+		// select telescope type
+		if( iTelType != 0 && fTelType[i] != iTelType )
+		{
+			continue;
+		}
+		// check if telescope is in telescope list
+		if( i < fUseTelescope.size() && !fUseTelescope[i] )
+		{
+			continue;
+		}
+		
+		if( fMapOfTrainingSample.find( fTelType[i] ) == fMapOfTrainingSample.end() )
+		{
+			fMapOfTrainingSample[fTelType[i]] = newTrainingSample( fTelType[i] );
+		}
+	}
+	
+	////////////////////////////////////////////
+	// filling of training trees;
+	cout << "filling training trees for " << fMapOfTrainingSample.size() << " telescope type(s)" << endl;
+	cout << "\t found " << f_ntelType << " telescopes of telescope type " << iTelType << endl;
+	bool iSingleTelescopeAnalysis = false;
+	if( f_ntelType == 1 )
+	{
+		iSingleTelescopeAnalysis = true;
+		cout << "\t single telescope analysis" << endl;
+	}
+	fMapOfNTelescopeType[iTelType] = f_ntelType;
+	
+	map< ULong64_t, VTMVATrainingSample* >::iterator iSample_iter;
+	
+	////////////////////////////////////////////
+	// read training samples from cache
+	string iCacheKey = "";
+	bool iReadFromCache = false;
+	if( iCacheDirectory.size() > 0 && fMapOfTrainingSample.size() > 0 )
+	{
+		vector< string > iConfiguration;
+		ostringstream iSelection;
+		iSelection << "teltype " << iTelType << " recid " << iRecID << " redo_stereo " << redo_stereo_reconstruction;
+		iConfiguration.push_back( iSelection.str() );
+		vector< string > iVariableName = fMapOfTrainingSample.begin()->second->getVariableNames();
+		iConfiguration.insert( iConfiguration.end(), iVariableName.begin(), iVariableName.end() );
+		vector< string > iFileKeys = VTMVATrainingSample::getFileKeys( iInputFileList );
+		iConfiguration.insert( iConfiguration.end(), iFileKeys.begin(), iFileKeys.end() );
+		iCacheKey = VTMVATrainingSample::getKey( iConfiguration );
+		gSystem->mkdir( iCacheDirectory.c_str(), true );
+		
+		iReadFromCache = true;
+		for( iSample_iter = fMapOfTrainingSample.begin(); iSample_iter != fMapOfTrainingSample.end(); ++iSample_iter )
+		{
+			if( !iSample_iter->second->readCache( getCacheFileName( iCacheDirectory, iSample_iter->first, iCacheKey ), iCacheKey ) )
+			{
+				iReadFromCache = false;
+				break;
+			}
+		}
+	}
+	
+	////////////////////////////////////////////
+	// fill training samples (in parallel for all input files)
+	if( !iReadFromCache )
+	{
+		for( iSample_iter = fMapOfTrainingSample.begin(); iSample_iter != fMapOfTrainingSample.end(); ++iSample_iter )
+		{
+			iSample_iter->second->setNFiles( iInputFileList.size() );
+		}
+		cout << "Loop over events in " << iInputFileList.size() << " source files" << endl;
+		if( !VTMVATrainingSample::processFiles( iInputFileList.size(), iNThreads,
+												bind( fillTrainingSample, iInputFileList, iTelType, iRecID,
+														redo_stereo_reconstruction, iSingleTelescopeAnalysis,
+														placeholders::_1 ) ) )
+		{
+			return false;
+		}
+		if( iCacheKey.size() > 0 )
+		{
+			for( iSample_iter = fMapOfTrainingSample.begin(); iSample_iter != fMapOfTrainingSample.end(); ++iSample_iter )
+			{
+				iSample_iter->second->writeCache( getCacheFileName( iCacheDirectory, iSample_iter->first, iCacheKey ), iCacheKey );
+			}
+		}
+	}
+	
+	////////////////////////////////////////////
+	// training trees (events in the order of the input files)
+	for( iSample_iter = fMapOfTrainingSample.begin(); iSample_iter != fMapOfTrainingSample.end(); ++iSample_iter )
+	{
+		fMapOfTrainingTree[iSample_iter->first] = iSample_iter->second->getTree();
+		delete iSample_iter->second;
+	}
+	fMapOfTrainingSample.clear();
 	
 	return true;
 }
@@ -941,7 +1122,8 @@ int main( int argc, char* argv[] )
 		cout << "                                     <train vs test fraction> <RecID> <telescope type>" << endl;
 		cout << "                                     [train for angular / energy / core reconstruction]" << endl;
 		cout << "                                     [MVA options] [array layout file] [directory with training trees]" << endl;
-		cout << "                                     [quality cut] [use image parameter errors (default=off=0)]";
+		cout << "                                     [quality cut] [use image parameter errors (default=off=0)]" << endl;
+		cout << "                                     [number of threads] [training sample cache directory]";
 		cout << endl;
 		cout << endl;
 		
@@ -952,6 +1134,8 @@ int main( int argc, char* argv[] )
 		cout << "                       (for VTS - these are telescope numbers)" << endl;
 		cout << "     optional: train for energy/core reconstruction = \"BDTDispEnergy\"/\"BDTDispCore\"";
 		cout << "(default = \"BDTDisp\": train for angular reconstrution)" << endl;
+		cout << "     optional: number of threads used to fill the training trees (default = 1; trees do not depend on it)" << endl;
+		cout << "     optional: directory with cached training trees (reused if input files and configuration are unchanged)" << endl;
 		cout << endl;
 		exit( EXIT_SUCCESS );
 	}
@@ -988,6 +1172,16 @@ int main( int argc, char* argv[] )
 	{
 		iQualityCut = argv[10];
 	}
+	unsigned int iNThreads = 1;
+	if( argc >= 13 )
+	{
+		iNThreads = atoi( argv[12] );
+	}
+	string       iCacheDirectory = "";
+	if( argc >= 14 )
+	{
+		iCacheDirectory = argv[13];
+	}
 	bool redo_stereo_reconstruction = false;
 	
 	///////////////////////////
@@ -1009,6 +1203,14 @@ int main( int argc, char* argv[] )
 	}
 	cout << endl;
 	cout << "using events for reconstruction ID " << iRecID << endl;
+	if( iNThreads > 1 )
+	{
+		cout << "filling training trees using " << iNThreads << " threads" << endl;
+	}
+	if( iCacheDirectory.size() > 0 )
+	{
+		cout << "training tree cache directory: " << iCacheDirectory << endl;
+	}
 	
 	/////////////////////////
 	if( fTrainTest <= 0.0 || fTrainTest >= 1.0 )
@@ -1039,7 +1241,8 @@ int main( int argc, char* argv[] )
 	//////////////////////
 	// fill training file
 	if( iDataDirectory.size() == 0
-			&& !writeTrainingFile( fInputFile, iTelType, iRecID, iLayoutFile, redo_stereo_reconstruction ) )
+			&& !writeTrainingFile( fInputFile, iTelType, iRecID, iLayoutFile, redo_stereo_reconstruction,
+								   iNThreads, iCacheDirectory ) )
 	{
 		cout << "error writing training file " << endl;
 		cout << "exiting..." << endl;
@@ -8,8 +8,10 @@
 #include "TFile.h"
 #include "TH1D.h"
 #include "TMath.h"
+#include "TRandom3.h"
 #include "TSystem.h"
 #include "TTree.h"
+#include "TTreeFormula.h"
 
 #include "TMVA/Config.h"
 #include "TMVA/DataLoader.h"
@@ -17,12 +19,14 @@
 #include "TMVA/Reader.h"
 #include "TMVA/Tools.h"
 
+#include <functional>
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <vector>
 
 #include "VTMVARunData.h"
+#include "VTMVATrainingSample.h"
 
 using namespace std;
 
@@ -33,38 +37,76 @@ TTree* prepareSelectedEventsTree( VTMVARunData* iRun, TCut iCut, bool iSignal );
 
 
 /*
- * prepare training / testing trees with reduced number of events
- *
- *   - apply pre-cuts here
- *   - copy only variables which are needed for TMVA into new tree
- *   - delete full trees (IMPORTANT)
+ * fraction of events kept for training and testing
  *
+ * require training and testing sample
+ * (add factor 10 to make sure that there are plenty
+ * of testing events)
  */
-TTree* prepareSelectedEventsTree( VTMVARunData* iRun, TCut iCut,
-								  bool iSignal )
+double getFractionOfEventsToKeep( VTMVARunData* iRun, bool iSignal, Long64_t iNEventsAfterCuts, unsigned int iNFiles )
 {
-	if( !iRun )
+	if( iNEventsAfterCuts <= 0 )
 	{
-		return 0;
+		return 0.;
 	}
-	vector< TChain* > iTreeVector;
-	string iDataTree_reducedName;
+	double i_event_selected = ( double )iRun->fnTrain_Background;
 	if( iSignal )
 	{
-		cout << "Preparing reduced signal trees" << endl;
-		iTreeVector = iRun->fSignalTree;
-		iDataTree_reducedName = "data_signal";
+		i_event_selected = ( double )iRun->fnTrain_Signal;
 	}
-	else
+	double i_fraction_of_events_to_keep =  i_event_selected / ( double )iNEventsAfterCuts;
+	i_fraction_of_events_to_keep *= 10.;
+	if( iNFiles > 0 )
 	{
-		cout << "Preparing reduced background trees" << endl;
-		iTreeVector = iRun->fBackgroundTree;
-		iDataTree_reducedName = "data_background";
+		i_fraction_of_events_to_keep /= ( double )iNFiles;
+	}
+	if( i_fraction_of_events_to_keep > 1. )
+	{
+		i_fraction_of_events_to_keep = 1.;
+	}
+	return i_fraction_of_events_to_keep;
+}
+
+/*
+ * select events from a single input file
+ *
+ *   - apply pre-cuts
+ *   - select a random subsample (random numbers are seeded per file,
+ *     i.e. the selection does not depend on the number of threads)
+ *   - copy selected events into the training sample
+ *
+ * (called in parallel for different input files; each call uses its own chain)
+ */
+bool selectEventsFromFile( VTMVARunData* iRun, VTMVATrainingSample* iSample, string iCut, bool iSignal,
+						   vector< Long64_t >* iNEventsAfterCuts, unsigned int iFile )
+{
+	if( !iRun || !iSample || !iNEventsAfterCuts || iFile >= iNEventsAfterCuts->size() )
+	{
+		return false;
+	}
+	string iFileName;
+	if( iSignal && iFile < iRun->fSignalFileName.size() )
+	{
+		iFileName = iRun->fSignalFileName[iFile];
+	}
+	else if( !iSignal && iFile < iRun->fBackgroundFileName.size() )
+	{
+		iFileName = iRun->fBackgroundFileName[iFile];
+	}
+	vector< double >* iData = iSample->getFileData( iFile );
+	if( iFileName.size() == 0 || !iData )
+	{
+		return false;
+	}
+	TChain iChain( "data" );
+	if( iChain.Add( iFileName.c_str() ) == 0 )
+	{
+		cout << "Error: no data tree in " << iFileName << endl;
+		return false;
 	}
-	// reduced tree (and name)
-	TTree* iDataTree_reduced = 0;
 	// list of variables copied.
 	// must include at least the variables used for the training
+	// (same order as in prepareSelectedEventsTree())
 	Double_t Ze = 0.;
 	Double_t Az = 0.;
 	Double_t WobbleN = 0;
@@ -83,145 +125,229 @@ TTree* prepareSelectedEventsTree( VTMVARunData* iRun, TCut iCut,
 	Double_t SizeSecondMax = 0.;
 	Double_t DispDiff = 0.;
 	Double_t MCe0 = 0.;
-	iDataTree_reduced = new TTree( iDataTree_reducedName.c_str(), iDataTree_reducedName.c_str() );
-	iDataTree_reduced->Branch( "Ze", &Ze, "Ze/D" );
-	iDataTree_reduced->Branch( "Az", &Az, "Az/D" );
-	iDataTree_reduced->Branch( "WobbleN", &WobbleN, "WobbleN/D" );
-	iDataTree_reduced->Branch( "WobbleE", &WobbleE, "WobbleE/D" );
-	iDataTree_reduced->Branch( "MSCW", &MSCW, "MSCW/D" );
-	iDataTree_reduced->Branch( "MSCL", &MSCL, "MSCL/D" );
-	iDataTree_reduced->Branch( "ErecS", &ErecS, "ErecS/D" );
-	iDataTree_reduced->Branch( "EChi2S", &EChi2S, "EChi2S/D" );
-	iDataTree_reduced->Branch( "Xcore", &Xcore, "Xcore/D" );
-	iDataTree_reduced->Branch( "Ycore", &Ycore, "Ycore/D" );
-	iDataTree_reduced->Branch( "Xoff_derot", &Xoff_derot, "Xoff_derot/D" );
-	iDataTree_reduced->Branch( "Yoff_derot", &Yoff_derot, "Yoff_derot/D" );
-	iDataTree_reduced->Branch( "NImages", &NImages, "NImages/I" );
-	iDataTree_reduced->Branch( "EmissionHeight", &EmissionHeight, "EmissionHeight/F" );
-	iDataTree_reduced->Branch( "EmissionHeightChi2", &EmissionHeightChi2, "EmissionHeightChi2/F" );
-	iDataTree_reduced->Branch( "SizeSecondMax", &SizeSecondMax, "SizeSecondMax/D" );
-	iDataTree_reduced->Branch( "DispDiff", &DispDiff, "DispDiff/D" );
-	iDataTree_reduced->Branch( "MCe0", &MCe0, "MCe0/D" );
-	
-	Long64_t n = 0;
+	iChain.SetBranchAddress( "Ze", &Ze );
+	iChain.SetBranchAddress( "Az", &Az );
+	iChain.SetBranchAddress( "WobbleN", &WobbleN );
+	iChain.SetBranchAddress( "WobbleE", &WobbleE );
+	iChain.SetBranchAddress( "MSCW", &MSCW );
+	iChain.SetBranchAddress( "MSCL", &MSCL );
+	iChain.SetBranchAddress( "ErecS", &ErecS );
+	iChain.SetBranchAddress( "EChi2S", &EChi2S );
+	iChain.SetBranchAddress( "Xcore", &Xcore );
+	iChain.SetBranchAddress( "Ycore", &Ycore );
+	iChain.SetBranchAddress( "Xoff_derot", &Xoff_derot );
+	iChain.SetBranchAddress( "Yoff_derot", &Yoff_derot );
+	iChain.SetBranchAddress( "NImages", &NImages );
+	iChain.SetBranchAddress( "EmissionHeight", &EmissionHeight );
+	iChain.SetBranchAddress( "EmissionHeightChi2", &EmissionHeightChi2 );
+	iChain.SetBranchAddress( "SizeSecondMax", &SizeSecondMax );
+	iChain.SetBranchAddress( "DispDiff", &DispDiff );
+	if( iChain.GetBranchStatus( "MCe0" ) )
+	{
+		iChain.SetBranchAddress( "MCe0", &MCe0 );
+	}
+	Long64_t nentries = iChain.GetEntries();
+	if( nentries <= 0 || iChain.LoadTree( 0 ) < 0 )
+	{
+		return true;
+	}
 	
-	for( unsigned  int i = 0; i < iTreeVector.size(); i++ )
+	/////////////////////////////////////
+	// apply pre-cuts
+	vector< Long64_t > iSelectedEntries;
+	TTreeFormula iCutFormula( "preCuts", iCut.c_str(), &iChain );
+	if( iCutFormula.GetNdim() == 0 )
+	{
+		cout << "Error: invalid pre-cuts " << iCut << endl;
+		return false;
+	}
+	iChain.SetNotify( &iCutFormula );
+	for( Long64_t n = 0; n < nentries; n++ )
 	{
-		if( iTreeVector[i] )
+		if( iChain.LoadTree( n ) < 0 )
 		{
-			iTreeVector[i]->SetBranchAddress( "Ze", &Ze );
-			iTreeVector[i]->SetBranchAddress( "Az", &Az );
-			iTreeVector[i]->SetBranchAddress( "WobbleN", &WobbleN );
-			iTreeVector[i]->SetBranchAddress( "WobbleE", &WobbleE );
-			iTreeVector[i]->SetBranchAddress( "MSCW", &MSCW );
-			iTreeVector[i]->SetBranchAddress( "MSCL", &MSCL );
-			iTreeVector[i]->SetBranchAddress( "ErecS", &ErecS );
-			iTreeVector[i]->SetBranchAddress( "EChi2S", &EChi2S );
-			iTreeVector[i]->SetBranchAddress( "Xcore", &Xcore );
-			iTreeVector[i]->SetBranchAddress( "Ycore", &Ycore );
-			iTreeVector[i]->SetBranchAddress( "Xoff_derot", &Xoff_derot );
-			iTreeVector[i]->SetBranchAddress( "Yoff_derot", &Yoff_derot );
-			iTreeVector[i]->SetBranchAddress( "NImages", &NImages );
-			iTreeVector[i]->SetBranchAddress( "EmissionHeight", &EmissionHeight );
-			iTreeVector[i]->SetBranchAddress( "EmissionHeightChi2", &EmissionHeightChi2 );
-			iTreeVector[i]->SetBranchAddress( "SizeSecondMax", &SizeSecondMax );
-			iTreeVector[i]->SetBranchAddress( "DispDiff", &DispDiff );
-			if( iTreeVector[i]->GetBranchStatus( "MCe0" ) )
-			{
-				iTreeVector[i]->SetBranchAddress( "MCe0", &MCe0 );
-			}
-			if( !iDataTree_reduced )
-			{
-				cout << "Error preparing reduced tree" << endl;
-				return 0;
-			}
-			iTreeVector[i]->Draw( ">>elist", iCut, "entrylist" );
-			TEntryList* elist = ( TEntryList* )gDirectory->Get( "elist" );
-			if( elist && elist->GetN() > 0 )
-			{
-				// select a random subsample
-				// require trainging and testing sample
-				// (add factor 10 to make sure that there are plenty
-				// of testing events)
-				double i_event_selected = ( double )iRun->fnTrain_Background;
-				if( iSignal )
-				{
-					i_event_selected = ( double )iRun->fnTrain_Signal;
-				}
-				double i_fraction_of_events_to_keep =  i_event_selected / ( double )elist->GetN();
-				i_fraction_of_events_to_keep *= 10.;
-				if( iTreeVector.size() > 0. )
-				{
-					i_fraction_of_events_to_keep /= ( double )iTreeVector.size();
-				}
-				if( i_fraction_of_events_to_keep > 1. )
-				{
-					i_fraction_of_events_to_keep = 1.;
-				}
-				cout << "\t keeping " << i_fraction_of_events_to_keep * 100. << "\% of events of ";
-				if( iSignal )
-				{
-					cout << iRun->fSignalFileName[i];
-				}
-				else
-				{
-					cout << iRun->fBackgroundFileName[i];
-				}
-				cout << " (training events: " << i_event_selected;
-				cout << ", events after pre-cuts: " << elist->GetN() << " number of runs: " << iTreeVector.size() << ")";
-				cout << endl;
-				for( Long64_t el = 0; el < elist->GetN(); el++ )
-				{
-					if( gRandom->Uniform() > i_fraction_of_events_to_keep )
-					{
-						continue;
-					}
-					Long64_t treeEntry = elist->GetEntry( el );
-					iTreeVector[i]->GetEntry( treeEntry );
-					iDataTree_reduced->Fill();
-					n++;
-				}
-			}
-			// remove this tree
-			if( iSignal )
-			{
-				iRun->fSignalTree[i]->Delete();
-				iRun->fSignalTree[i] = 0;
-			}
-			else
+			break;
+		}
+		// event is selected if any instance passes the cuts
+		// (as in TTree::Draw)
+		Int_t iNData = iCutFormula.GetNdata();
+		for( Int_t d = 0; d < iNData; d++ )
+		{
+			if( iCutFormula.EvalInstance( d ) != 0. )
 			{
-				iRun->fBackgroundTree[i]->Delete();
-				iRun->fBackgroundTree[i] = 0;
+				iSelectedEntries.push_back( n );
+				break;
 			}
 		}
 	}
-	if( iSignal && iDataTree_reduced )
+	iChain.SetNotify( 0 );
+	( *iNEventsAfterCuts )[iFile] = ( Long64_t )iSelectedEntries.size();
+	
+	/////////////////////////////////////
+	// select a random subsample
+	double i_fraction_of_events_to_keep = getFractionOfEventsToKeep( iRun, iSignal,
+										  ( Long64_t )iSelectedEntries.size(),
+										  iNEventsAfterCuts->size() );
+	TRandom3 iRandom( VTMVATrainingSample::getSeed( iRun->fTrainingSampleSeed, iFile ) );
+	for( unsigned int el = 0; el < iSelectedEntries.size(); el++ )
 	{
-		cout << "\t Reduced signal tree entries: " << iDataTree_reduced->GetEntries() << endl;
+		if( iRandom.Uniform() > i_fraction_of_events_to_keep )
+		{
+			continue;
+		}
+		iChain.GetEntry( iSelectedEntries[el] );
+		iData->push_back( Ze );
+		iData->push_back( Az );
+		iData->push_back( WobbleN );
+		iData->push_back( WobbleE );
+		iData->push_back( MSCW );
+		iData->push_back( MSCL );
+		iData->push_back( ErecS );
+		iData->push_back( EChi2S );
+		iData->push_back( Xcore );
+		iData->push_back( Ycore );
+		iData->push_back( Xoff_derot );
+		iData->push_back( Yoff_derot );
+		iData->push_back( NImages );
+		iData->push_back( EmissionHeight );
+		iData->push_back( EmissionHeightChi2 );
+		iData->push_back( SizeSecondMax );
+		iData->push_back( DispDiff );
+		iData->push_back( MCe0 );
+	}
+	return true;
+}
+
+/*
+ * prepare training / testing trees with reduced number of events
+ *
+ *   - apply pre-cuts here
+ *   - copy only variables which are needed for TMVA into new tree
+ *   - delete full trees (IMPORTANT)
+ *
+ *   input files are processed in parallel (see PREPARE_TRAINING_THREADS);
+ *   reduced trees are optionally cached (see TRAINING_SAMPLE_CACHE)
+ *
+ */
+TTree* prepareSelectedEventsTree( VTMVARunData* iRun, TCut iCut,
+								  bool iSignal )
+{
+	if( !iRun )
+	{
+		return 0;
 	}
-	else if( iDataTree_reduced )
+	vector< string > iFileName;
+	string iDataTree_reducedName;
+	if( iSignal )
 	{
-		cout << "\t Reduced background tree entries: " << iDataTree_reduced->GetEntries() << endl;
+		cout << "Preparing reduced signal trees" << endl;
+		iFileName = iRun->fSignalFileName;
+		iDataTree_reducedName = "data_signal";
 	}
 	else
 	{
-		cout << "Error in reducing data trees (missing tree)" << endl;
-		return 0;
+		cout << "Preparing reduced background trees" << endl;
+		iFileName = iRun->fBackgroundFileName;
+		iDataTree_reducedName = "data_background";
 	}
-	// cleanup all remaining trees
-	for( unsigned int i = 0; i < iTreeVector.size(); i++ )
+	// remove full trees (files are read again per thread)
+	for( unsigned int i = 0; i < iFileName.size(); i++ )
 	{
-		if( iSignal && iRun->fSignalTree[i] )
+		if( iSignal && i < iRun->fSignalTree.size() && iRun->fSignalTree[i] )
 		{
 			iRun->fSignalTree[i]->Delete();
 			iRun->fSignalTree[i] = 0;
 		}
-		else if( !iSignal && iRun->fBackgroundTree[i] )
+		else if( !iSignal && i < iRun->fBackgroundTree.size() && iRun->fBackgroundTree[i] )
 		{
 			iRun->fBackgroundTree[i]->Delete();
 			iRun->fBackgroundTree[i] = 0;
 		}
 	}
+	// list of variables copied (order as in selectEventsFromFile())
+	VTMVATrainingSample iSample( iDataTree_reducedName );
+	iSample.addVariable( "Ze", 'D' );
+	iSample.addVariable( "Az", 'D' );
+	iSample.addVariable( "WobbleN", 'D' );
+	iSample.addVariable( "WobbleE", 'D' );
+	iSample.addVariable( "MSCW", 'D' );
+	iSample.addVariable( "MSCL", 'D' );
+	iSample.addVariable( "ErecS", 'D' );
+	iSample.addVariable( "EChi2S", 'D' );
+	iSample.addVariable( "Xcore", 'D' );
+	iSample.addVariable( "Ycore", 'D' );
+	iSample.addVariable( "Xoff_derot", 'D' );
+	iSample.addVariable( "Yoff_derot", 'D' );
+	iSample.addVariable( "NImages", 'I' );
+	iSample.addVariable( "EmissionHeight", 'F' );
+	iSample.addVariable( "EmissionHeightChi2", 'F' );
+	iSample.addVariable( "SizeSecondMax", 'D' );
+	iSample.addVariable( "DispDiff", 'D' );
+	iSample.addVariable( "MCe0", 'D' );
+	
+	/////////////////////////////////////
+	// cached training sample
+	// (key: selection, variables, number of training events, seed, input files (name, size, modification time))
+	string iCacheFileName = "";
+	string iCacheKey = "";
+	if( iRun->fTrainingSampleCacheDirectory.size() > 0 )
+	{
+		vector< string > iConfiguration;
+		iConfiguration.push_back( iDataTree_reducedName );
+		iConfiguration.push_back( iCut.GetTitle() );
+		ostringstream iTrainingEvents;
+		iTrainingEvents << iRun->fnTrain_Signal << ":" << iRun->fnTrain_Background << ":" << iRun->fTrainingSampleSeed;
+		iConfiguration.push_back( iTrainingEvents.str() );
+		vector< string > iVariableName = iSample.getVariableNames();
+		iConfiguration.insert( iConfiguration.end(), iVariableName.begin(), iVariableName.end() );
+		vector< string > iFileKeys = VTMVATrainingSample::getFileKeys( iFileName );
+		iConfiguration.insert( iConfiguration.end(), iFileKeys.begin(), iFileKeys.end() );
+		iCacheKey = VTMVATrainingSample::getKey( iConfiguration );
+		gSystem->mkdir( iRun->fTrainingSampleCacheDirectory.c_str(), true );
+		iCacheFileName = iRun->fTrainingSampleCacheDirectory + "/" + iDataTree_reducedName + "_" + iCacheKey + ".root";
+	}
+	if( iCacheFileName.size() > 0 && iSample.readCache( iCacheFileName, iCacheKey ) )
+	{
+		TTree* iDataTree_reduced = iSample.getTree();
+		cout << "\t Reduced tree entries (from cache): " << iDataTree_reduced->GetEntries() << endl;
+		return iDataTree_reduced;
+	}
+	
+	/////////////////////////////////////
+	// select events (in parallel for all input files)
+	iSample.setNFiles( iFileName.size() );
+	vector< Long64_t > iNEventsAfterCuts( iFileName.size(), 0 );
+	if( !VTMVATrainingSample::processFiles( iFileName.size(), iRun->fPrepareTrainingThreads,
+											bind( selectEventsFromFile, iRun, &iSample, string( iCut.GetTitle() ), iSignal,
+													&iNEventsAfterCuts, placeholders::_1 ) ) )
+	{
+		cout << "Error in reducing data trees" << endl;
+		return 0;
+	}
+	for( unsigned int i = 0; i < iFileName.size(); i++ )
+	{
+		cout << "\t keeping ";
+		cout << getFractionOfEventsToKeep( iRun, iSignal, iNEventsAfterCuts[i], iFileName.size() ) * 100.;
+		cout << "\% of events of " << iFileName[i];
+		cout << " (training events: " << ( iSignal ? iRun->fnTrain_Signal : iRun->fnTrain_Background );
+		cout << ", events after pre-cuts: " << iNEventsAfterCuts[i] << " number of runs: " << iFileName.size() << ")";
+		cout << endl;
+	}
+	if( iCacheFileName.size() > 0 )
+	{
+		iSample.writeCache( iCacheFileName, iCacheKey );
+	}
+	
+	// reduced tree (filled in the order of the input files)
+	TTree* iDataTree_reduced = iSample.getTree();
+	if( iSignal )
+	{
+		cout << "\t Reduced signal tree entries: " << iDataTree_reduced->GetEntries() << endl;
+	}
+	else
+	{
+		cout << "\t Reduced background tree entries: " << iDataTree_reduced->GetEntries() << endl;
+	}
 	return iDataTree_reduced;
 }
 